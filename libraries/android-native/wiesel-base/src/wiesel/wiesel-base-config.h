@@ -26,4 +26,7 @@
 #define WIESEL_THREADAPI_PTHREAD	1
 #define WIESEL_THREADAPI_WIN32		0
 
+// enables the built-in cpu profiler
+#define WIESEL_PROFILER_ENABLED		0
+
 #endif // __WIESEL_BASE_CONFIG_H__
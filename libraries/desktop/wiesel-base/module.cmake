@@ -25,6 +25,10 @@ if (
 endif()
 
 
+# optional features
+option(WIESEL_PROFILER_ENABLED "Enables the built-in cpu profiler" OFF)
+
+
 # finally, create the config file
 configure_file(
 		${WIESEL_SRC_DIR}/base/wiesel/wiesel-base-config.in
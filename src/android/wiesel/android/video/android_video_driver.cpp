@@ -21,6 +21,7 @@
  */
 #include "android_video_driver.h"
 #include <wiesel/video/gl/gl.h>
+#include <wiesel/video/gl/gl_state_cache.h>
 #include <wiesel/ui/touchhandler.h>
 #include <wiesel/util/log.h>
 #include <assert.h>
@@ -29,6 +30,7 @@
 using namespace wiesel;
 using namespace wiesel::android;
 using namespace wiesel::video;
+using namespace wiesel::video::gl;
 
 
 
@@ -194,8 +196,8 @@ bool AndroidVideoDeviceDriver::resize() {
 	eglQuerySurface(display, surface, EGL_HEIGHT, &h);
 	CHECK_GL_ERROR;
 
-	// setup viewport
-	glViewport(0, 0, w, h);
+	// setup viewport, through the state cache to keep its cached viewport valid
+	GlStateCache::instance()->setViewport(0, 0, w, h);
 
 	// update screen size and projection
 	updateScreenSize(w, h);
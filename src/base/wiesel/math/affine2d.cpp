@@ -0,0 +1,156 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "affine2d.h"
+#include "simd.h"
+
+#include <math.h>
+
+
+using namespace wiesel;
+
+
+const affine2d		affine2d::identity = affine2d(
+												1.0f,	0.0f,
+												0.0f,	1.0f,
+												0.0f,	0.0f
+										);
+
+
+
+
+affine2d::affine2d(float a, float b, float c, float d, float tx, float ty) {
+	this->a  = a;
+	this->b  = b;
+	this->c  = c;
+	this->d  = d;
+	this->tx = tx;
+	this->ty = ty;
+
+	return;
+}
+
+
+affine2d affine2d::compose(const vector2d &pivot, float scale_x, float scale_y, float rotation, const vector2d &position) {
+	float sin = sinf(rotation);
+	float cos = cosf(rotation);
+
+	affine2d result;
+	result.a  = cos * scale_x;
+	result.b  = sin * scale_x;
+	result.c  = -sin * scale_y;
+	result.d  = cos * scale_y;
+	result.tx = position.x - (result.a * pivot.x) - (result.c * pivot.y);
+	result.ty = position.y - (result.b * pivot.x) - (result.d * pivot.y);
+
+	return result;
+}
+
+
+
+
+float affine2d::det() const {
+	return (a * d) - (b * c);
+}
+
+
+affine2d affine2d::inverted() const {
+	float det = this->det();
+
+	if (det == 0.0f) {
+		return identity;
+	}
+
+	float inv = 1.0f / det;
+
+	affine2d result;
+	result.a  =  d * inv;
+	result.b  = -b * inv;
+	result.c  = -c * inv;
+	result.d  =  a * inv;
+	result.tx = -(result.a * tx) - (result.c * ty);
+	result.ty = -(result.b * tx) - (result.d * ty);
+
+	return result;
+}
+
+
+matrix4x4 affine2d::toMatrix4x4() const {
+	return matrix4x4(
+				a,		c,		0.0f,	tx,
+				b,		d,		0.0f,	ty,
+				0.0f,	0.0f,	1.0f,	0.0f,
+				0.0f,	0.0f,	0.0f,	1.0f
+	);
+}
+
+
+
+
+affine2d wiesel::operator *(const affine2d &a, const affine2d &b) {
+	return affine2d(
+				(b.a * a.a)  + (b.c * a.b),
+				(b.b * a.a)  + (b.d * a.b),
+				(b.a * a.c)  + (b.c * a.d),
+				(b.b * a.c)  + (b.d * a.d),
+				(b.a * a.tx) + (b.c * a.ty) + b.tx,
+				(b.b * a.tx) + (b.d * a.ty) + b.ty
+	);
+}
+
+
+matrix4x4 wiesel::operator *(const affine2d &a, const matrix4x4 &b) {
+	// the first two rows of 'a' as 4x4 matrix, the remaining rows are identity
+	simd::float4 a1 = simd::set4(a.a, a.c, 0.0f, a.tx);
+	simd::float4 a2 = simd::set4(a.b, a.d, 0.0f, a.ty);
+
+	matrix4x4 result;
+
+	for(int row=0; row<4; row++) {
+		const float *b_row = b.m + row * 4;
+
+		simd::float4 r = simd::set4(0.0f, 0.0f, b_row[2], b_row[3]);
+		r = simd::madd4(r, a1, simd::splat4(b_row[0]));
+		r = simd::madd4(r, a2, simd::splat4(b_row[1]));
+
+		simd::store4(result.m + row * 4, r);
+	}
+
+	return result;
+}
+
+
+vector2d wiesel::operator *(const vector2d &v, const affine2d &t) {
+	return vector2d(
+			(v.x * t.a) + (v.y * t.c) + t.tx,
+			(v.x * t.b) + (v.y * t.d) + t.ty
+	);
+}
+
+
+std::ostream& wiesel::operator <<(std::ostream &o, const affine2d &t) {
+	o
+		<<	"{ " << t.a << ',' << t.c << ',' << t.tx << ',' << std::endl
+		<<	"  " << t.b << ',' << t.d << ',' << t.ty << " }"
+	;
+
+	return o;
+}
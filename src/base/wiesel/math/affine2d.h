@@ -0,0 +1,112 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#ifndef __WIESEL_MATH_AFFINE2D_H__
+#define	__WIESEL_MATH_AFFINE2D_H__
+
+#include <wiesel/wiesel-base.def>
+
+#include "matrix.h"
+#include "vector2d.h"
+
+#include <ostream>
+
+
+namespace wiesel {
+
+	/**
+	 * @brief A compact 2x3 matrix for affine transformations in 2D space.
+	 * A point will be transformed by
+	 *		x' = a * x + c * y + tx
+	 *		y' = b * x + d * y + ty
+	 * which is the same as a \ref matrix4x4 with m11=a, m12=c, m14=tx,
+	 * m21=b, m22=d, m24=ty and identity in the remaining rows and columns.
+	 */
+	class WIESEL_BASE_EXPORT affine2d
+	{
+	public:
+		/// creates a new uninitialised transformation.
+		affine2d() {}
+
+		/// creates a new transformation with the given values.
+		affine2d(float a, float b, float c, float d, float tx, float ty);
+
+		/// destructor
+		~affine2d() {};
+
+		/**
+		 * @brief Creates a transformation, which moves a point by the negative pivot,
+		 * scales, rotates and finally moves it to the given position.
+		 * This is the same result as translate, scale, rotateZ and translate
+		 * on a \ref matrix4x4, but requires only a single sin and cos.
+		 * @param pivot		The pivot point, which will be moved into the origin.
+		 * @param scale_x	The scale factor on the X axis.
+		 * @param scale_y	The scale factor on the Y axis.
+		 * @param rotation	The rotation in radians.
+		 * @param position	The translation applied after scaling and rotation.
+		 */
+		static affine2d compose(
+						const vector2d &pivot,
+						float scale_x, float scale_y,
+						float rotation,
+						const vector2d &position
+		);
+
+	public:
+		/// get the determinant of this transformation.
+		float det() const;
+
+		/// get the inverted transformation.
+		affine2d inverted() const;
+
+		/// get this transformation as a 4x4 matrix.
+		matrix4x4 toMatrix4x4() const;
+
+	public:
+		float	a,	b;
+		float	c,	d;
+		float	tx,	ty;
+
+	public:
+		/// the identity transformation
+		static const affine2d identity;
+	};
+
+
+	/**
+	 * @brief Concatenates two transformations, so the result applies \c a first and \c b after it.
+	 * Uses the same order as the multiplication of two \ref matrix4x4 objects.
+	 */
+	WIESEL_BASE_EXPORT affine2d operator *(const affine2d &a, const affine2d &b);
+
+	/**
+	 * @brief Concatenates a 2D transformation with a 4x4 matrix.
+	 * The result is the same as <tt>a.toMatrix4x4() * b</tt>, but skips
+	 * all multiplications with the constant rows of \c a.
+	 */
+	WIESEL_BASE_EXPORT matrix4x4 operator *(const affine2d &a, const matrix4x4 &b);
+
+	WIESEL_BASE_EXPORT vector2d operator *(const vector2d &v, const affine2d &t);
+
+	WIESEL_BASE_EXPORT std::ostream& operator <<(std::ostream &o, const affine2d &t);
+
+}
+#endif	/* __WIESEL_MATH_AFFINE2D_H__ */
@@ -20,7 +20,10 @@
  * Boston, MA 02110-1301 USA
  */
 #include "matrix.h"
+#include "simd.h"
 #include "utils.h"
+#include "vector2d.h"
+#include "vector3d.h"
 
 #include <assert.h>
 #include <math.h>
@@ -193,23 +196,58 @@ matrix4x4 matrix4x4::transposed() const {
 
 
 
+/**
+ * @brief Replaces two rows of a matrix by a combination of both.
+ * Multiplying with a matrix, which differs from the identity only within these rows,
+ * touches only the rows of the multiplied matrix, so the full multiplication can be skipped.
+ * The operands are summed up in the same order like in the full multiplication,
+ * so the result stays the same.
+ */
+static inline void combineRows(float *row1, float *row2, float a11, float a12, float a21, float a22) {
+	simd::float4 r1 = simd::load4(row1);
+	simd::float4 r2 = simd::load4(row2);
+
+	simd::store4(row1, simd::madd4(simd::mul4(r1, simd::splat4(a11)), r2, simd::splat4(a12)));
+	simd::store4(row2, simd::madd4(simd::mul4(r1, simd::splat4(a21)), r2, simd::splat4(a22)));
+
+	return;
+}
+
+
+/**
+ * @brief Adds a multiple of the matrix' last row to another row.
+ */
+static inline void addScaledLastRow(float *m, int row, float s) {
+	simd::store4(m + row * 4, simd::madd4(simd::load4(m + row * 4), simd::load4(m + 12), simd::splat4(s)));
+	return;
+}
+
+
+/**
+ * @brief Scales a single row of a matrix.
+ */
+static inline void scaleRow(float *m, int row, float s) {
+	simd::store4(m + row * 4, simd::mul4(simd::load4(m + row * 4), simd::splat4(s)));
+	return;
+}
+
+
+
+
 void matrix4x4::translate(float x, float y) {
-	*this *= matrix4x4(
-						1.0f, 0.0f, 0.0f,    x,
-						0.0f, 1.0f, 0.0f,    y,
-						0.0f, 0.0f, 1.0f, 0.0f,
-						0.0f, 0.0f, 0.0f, 1.0f
-	);
+	addScaledLastRow(m, 0, x);
+	addScaledLastRow(m, 1, y);
+
+	return;
 }
 
 
 void matrix4x4::translate(float x, float y, float z) {
-	*this *= matrix4x4(
-						1.0f, 0.0f, 0.0f,    x,
-						0.0f, 1.0f, 0.0f,    y,
-						0.0f, 0.0f, 1.0f,    z,
-						0.0f, 0.0f, 0.0f, 1.0f
-	);
+	addScaledLastRow(m, 0, x);
+	addScaledLastRow(m, 1, y);
+	addScaledLastRow(m, 2, z);
+
+	return;
 }
 
 
@@ -217,12 +255,7 @@ void matrix4x4::rotateX(float a) {
 	float sin = sinf(a);
 	float cos = cosf(a);
 
-	*this *= matrix4x4(
-						1.0f, 0.0f, 0.0f, 0.0f,
-						0.0f, +cos, -sin, 0.0f,
-						0.0f, +sin, +cos, 0.0f,
-						0.0f, 0.0f, 0.0f, 1.0f
-	);
+	combineRows(m + 4, m + 8, +cos, -sin, +sin, +cos);
 
 	return;
 }
@@ -232,12 +265,7 @@ void matrix4x4::rotateY(float a) {
 	float sin = sinf(a);
 	float cos = cosf(a);
 
-	*this *= matrix4x4(
-						+cos, 0.0f, +sin, 0.0f,
-						0.0f, 1.0f, 0.0f, 0.0f,
-						-sin, 0.0f, +cos, 0.0f,
-						0.0f, 0.0f, 0.0f, 1.0f
-	);
+	combineRows(m + 0, m + 8, +cos, +sin, -sin, +cos);
 
 	return;
 }
@@ -247,60 +275,78 @@ void matrix4x4::rotateZ(float a) {
 	float sin = sinf(a);
 	float cos = cosf(a);
 
-	*this *= matrix4x4(
-						+cos, -sin, 0.0f, 0.0f,
-						+sin, +cos, 0.0f, 0.0f,
-						0.0f, 0.0f, 1.0f, 0.0f,
-						0.0f, 0.0f, 0.0f, 1.0f
-	);
+	combineRows(m + 0, m + 4, +cos, -sin, +sin, +cos);
 
 	return;
 }
 
 
 void matrix4x4::scale(float x, float y, float z) {
-	*this *= matrix4x4(
-						   x, 0.0f, 0.0f, 0.0f,
-						0.0f,    y, 0.0f, 0.0f,
-						0.0f, 0.0f,    z, 0.0f,
-						0.0f, 0.0f, 0.0f, 1.0f
-	);
+	scaleRow(m, 0, x);
+	scaleRow(m, 1, y);
+	scaleRow(m, 2, z);
 
 	return;
 }
 
 
 void matrix4x4::scaleX(float s) {
-	*this *= matrix4x4(
-						   s, 0.0f, 0.0f, 0.0f,
-						0.0f, 1.0f, 0.0f, 0.0f,
-						0.0f, 0.0f, 1.0f, 0.0f,
-						0.0f, 0.0f, 0.0f, 1.0f
-	);
-
+	scaleRow(m, 0, s);
 	return;
 }
 
 
 void matrix4x4::scaleY(float s) {
-	*this *= matrix4x4(
-						1.0f, 0.0f, 0.0f, 0.0f,
-						0.0f,    s, 0.0f, 0.0f,
-						0.0f, 0.0f, 1.0f, 0.0f,
-						0.0f, 0.0f, 0.0f, 1.0f
-	);
-
+	scaleRow(m, 1, s);
 	return;
 }
 
 
 void matrix4x4::scaleZ(float s) {
-	*this *= matrix4x4(
-						1.0f, 0.0f, 0.0f, 0.0f,
-						0.0f, 1.0f, 0.0f, 0.0f,
-						0.0f, 0.0f,    s, 0.0f,
-						0.0f, 0.0f, 0.0f, 1.0f
-	);
+	scaleRow(m, 2, s);
+	return;
+}
+
+
+
+
+void matrix4x4::transform(const vector2d *src, vector2d *dst, size_t count) const {
+	// with the matrix' columns, each vector needs a single multiplication per component
+	simd::float4 c1 = simd::set4(m11, m21, m31, m41);
+	simd::float4 c2 = simd::set4(m12, m22, m32, m42);
+	simd::float4 c4 = simd::set4(m14, m24, m34, m44);
+	float result[4];
+
+	for(size_t i=0; i<count; i++) {
+		simd::float4 r = simd::mul4(simd::splat4(src[i].x), c1);
+		r = simd::madd4(r, simd::splat4(src[i].y), c2);
+		r = simd::add4(r, c4);
+
+		simd::store4(result, r);
+		dst[i] = vector2d(result[0], result[1]);
+	}
+
+	return;
+}
+
+
+void matrix4x4::transform(const vector3d *src, vector3d *dst, size_t count) const {
+	// with the matrix' columns, each vector needs a single multiplication per component
+	simd::float4 c1 = simd::set4(m11, m21, m31, m41);
+	simd::float4 c2 = simd::set4(m12, m22, m32, m42);
+	simd::float4 c3 = simd::set4(m13, m23, m33, m43);
+	simd::float4 c4 = simd::set4(m14, m24, m34, m44);
+	float result[4];
+
+	for(size_t i=0; i<count; i++) {
+		simd::float4 r = simd::mul4(simd::splat4(src[i].x), c1);
+		r = simd::madd4(r, simd::splat4(src[i].y), c2);
+		r = simd::madd4(r, simd::splat4(src[i].z), c3);
+		r = simd::add4(r, c4);
+
+		simd::store4(result, r);
+		dst[i] = vector3d(result[0], result[1], result[2]);
+	}
 
 	return;
 }
@@ -377,27 +423,26 @@ matrix4x4& matrix4x4::operator /=(const matrix4x4 &other) {
 
 
 matrix4x4 wiesel::operator *(const matrix4x4 &a, const matrix4x4 &b) {
-	return matrix4x4(
-			(a.m11 * b.m11) + (a.m21 * b.m12) + (a.m31 * b.m13) + (a.m41 * b.m14),
-			(a.m12 * b.m11) + (a.m22 * b.m12) + (a.m32 * b.m13) + (a.m42 * b.m14),
-			(a.m13 * b.m11) + (a.m23 * b.m12) + (a.m33 * b.m13) + (a.m43 * b.m14),
-			(a.m14 * b.m11) + (a.m24 * b.m12) + (a.m34 * b.m13) + (a.m44 * b.m14),
-
-			(a.m11 * b.m21) + (a.m21 * b.m22) + (a.m31 * b.m23) + (a.m41 * b.m24),
-			(a.m12 * b.m21) + (a.m22 * b.m22) + (a.m32 * b.m23) + (a.m42 * b.m24),
-			(a.m13 * b.m21) + (a.m23 * b.m22) + (a.m33 * b.m23) + (a.m43 * b.m24),
-			(a.m14 * b.m21) + (a.m24 * b.m22) + (a.m34 * b.m23) + (a.m44 * b.m24),
-
-			(a.m11 * b.m31) + (a.m21 * b.m32) + (a.m31 * b.m33) + (a.m41 * b.m34),
-			(a.m12 * b.m31) + (a.m22 * b.m32) + (a.m32 * b.m33) + (a.m42 * b.m34),
-			(a.m13 * b.m31) + (a.m23 * b.m32) + (a.m33 * b.m33) + (a.m43 * b.m34),
-			(a.m14 * b.m31) + (a.m24 * b.m32) + (a.m34 * b.m33) + (a.m44 * b.m34),
-
-			(a.m11 * b.m41) + (a.m21 * b.m42) + (a.m31 * b.m43) + (a.m41 * b.m44),
-			(a.m12 * b.m41) + (a.m22 * b.m42) + (a.m32 * b.m43) + (a.m42 * b.m44),
-			(a.m13 * b.m41) + (a.m23 * b.m42) + (a.m33 * b.m43) + (a.m43 * b.m44),
-			(a.m14 * b.m41) + (a.m24 * b.m42) + (a.m34 * b.m43) + (a.m44 * b.m44)
-	);
+	simd::float4 a1 = simd::load4(a.m +  0);
+	simd::float4 a2 = simd::load4(a.m +  4);
+	simd::float4 a3 = simd::load4(a.m +  8);
+	simd::float4 a4 = simd::load4(a.m + 12);
+
+	matrix4x4 result;
+
+	// each row of the result is a combination of all rows of 'a'
+	for(int row=0; row<4; row++) {
+		const float *b_row = b.m + row * 4;
+
+		simd::float4 r = simd::mul4(a1, simd::splat4(b_row[0]));
+		r = simd::madd4(r, a2, simd::splat4(b_row[1]));
+		r = simd::madd4(r, a3, simd::splat4(b_row[2]));
+		r = simd::madd4(r, a4, simd::splat4(b_row[3]));
+
+		simd::store4(result.m + row * 4, r);
+	}
+
+	return result;
 }
 
 
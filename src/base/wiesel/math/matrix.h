@@ -25,10 +25,14 @@
 #include <wiesel/wiesel-base.def>
 
 #include <ostream>
+#include <stddef.h>
 
 
 namespace wiesel {
 
+	class vector2d;
+	class vector3d;
+
 	/**
 	 * @brief A class covering a 4x4 matrix for 3D transformation.
 	 */
@@ -135,6 +139,24 @@ namespace wiesel {
 		/// scale on z-axis
 		void scaleZ(float s);
 
+	// batch operations
+	public:
+		/**
+		 * @brief Transforms an array of 2D vectors by this matrix.
+		 * Each result equals <tt>src[i] * matrix</tt>, but the matrix needs
+		 * to be prepared only once for the whole array.
+		 * \c src and \c dst may point to the same array.
+		 */
+		void transform(const vector2d *src, vector2d *dst, size_t count) const;
+
+		/**
+		 * @brief Transforms an array of 3D vectors by this matrix.
+		 * Each result equals <tt>src[i] * matrix</tt>, but the matrix needs
+		 * to be prepared only once for the whole array.
+		 * \c src and \c dst may point to the same array.
+		 */
+		void transform(const vector3d *src, vector3d *dst, size_t count) const;
+
 	// tests
 	public:
 		/**
@@ -0,0 +1,169 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#ifndef __WIESEL_MATH_SIMD_H__
+#define	__WIESEL_MATH_SIMD_H__
+
+#include <wiesel/wiesel-base.def>
+
+
+/**
+ * The vector instruction set used by the math classes is selected at compile time.
+ * SSE is available on each x86-64 target, NEON on most ARM targets.
+ * Defining WIESEL_MATH_NO_SIMD falls back to the plain scalar implementation.
+ */
+#if !defined(WIESEL_MATH_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+	#define WIESEL_MATH_SSE		1
+	#include <xmmintrin.h>
+#elif !defined(WIESEL_MATH_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+	#define WIESEL_MATH_NEON	1
+	#include <arm_neon.h>
+#endif
+
+
+namespace wiesel {
+namespace simd {
+
+#if defined(WIESEL_MATH_SSE)
+
+	/// a vector of four floats
+	typedef __m128 float4;
+
+	/// loads four floats, which don't need to be aligned.
+	inline float4 load4(const float *p) {
+		return _mm_loadu_ps(p);
+	}
+
+	/// stores four floats, which don't need to be aligned.
+	inline void store4(float *p, float4 v) {
+		_mm_storeu_ps(p, v);
+	}
+
+	/// creates a vector of four different values.
+	inline float4 set4(float x, float y, float z, float w) {
+		return _mm_setr_ps(x, y, z, w);
+	}
+
+	/// creates a vector with the same value in each field.
+	inline float4 splat4(float f) {
+		return _mm_set1_ps(f);
+	}
+
+	inline float4 add4(float4 a, float4 b) {
+		return _mm_add_ps(a, b);
+	}
+
+	inline float4 mul4(float4 a, float4 b) {
+		return _mm_mul_ps(a, b);
+	}
+
+#elif defined(WIESEL_MATH_NEON)
+
+	/// a vector of four floats
+	typedef float32x4_t float4;
+
+	/// loads four floats, which don't need to be aligned.
+	inline float4 load4(const float *p) {
+		return vld1q_f32(p);
+	}
+
+	/// stores four floats, which don't need to be aligned.
+	inline void store4(float *p, float4 v) {
+		vst1q_f32(p, v);
+	}
+
+	/// creates a vector of four different values.
+	inline float4 set4(float x, float y, float z, float w) {
+		const float v[4] = { x, y, z, w };
+		return vld1q_f32(v);
+	}
+
+	/// creates a vector with the same value in each field.
+	inline float4 splat4(float f) {
+		return vdupq_n_f32(f);
+	}
+
+	inline float4 add4(float4 a, float4 b) {
+		return vaddq_f32(a, b);
+	}
+
+	inline float4 mul4(float4 a, float4 b) {
+		return vmulq_f32(a, b);
+	}
+
+#else
+
+	/// a vector of four floats
+	struct float4 {
+		float	v[4];
+	};
+
+	/// loads four floats, which don't need to be aligned.
+	inline float4 load4(const float *p) {
+		float4 r = {{ p[0], p[1], p[2], p[3] }};
+		return r;
+	}
+
+	/// stores four floats, which don't need to be aligned.
+	inline void store4(float *p, float4 v) {
+		p[0] = v.v[0];
+		p[1] = v.v[1];
+		p[2] = v.v[2];
+		p[3] = v.v[3];
+	}
+
+	/// creates a vector of four different values.
+	inline float4 set4(float x, float y, float z, float w) {
+		float4 r = {{ x, y, z, w }};
+		return r;
+	}
+
+	/// creates a vector with the same value in each field.
+	inline float4 splat4(float f) {
+		float4 r = {{ f, f, f, f }};
+		return r;
+	}
+
+	inline float4 add4(float4 a, float4 b) {
+		float4 r = {{ a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] }};
+		return r;
+	}
+
+	inline float4 mul4(float4 a, float4 b) {
+		float4 r = {{ a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] }};
+		return r;
+	}
+
+#endif
+
+	/**
+	 * @brief Computes \c a + (b * c).
+	 * The multiplication is rounded before the addition, so the result
+	 * matches the scalar code on each platform.
+	 */
+	inline float4 madd4(float4 a, float4 b, float4 c) {
+		return add4(a, mul4(b, c));
+	}
+
+}
+}
+
+#endif	/* __WIESEL_MATH_SIMD_H__ */
@@ -0,0 +1,84 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#ifndef __WIESEL_UTIL_ATOMIC_H__
+#define	__WIESEL_UTIL_ATOMIC_H__
+
+#include "wiesel/wiesel-base-config.h"
+
+// use the compiler intrinsics on windows, so this header can be included
+// anywhere without pulling in windows.h
+#if WIESEL_THREADAPI_WIN32
+#	include <intrin.h>
+#endif
+
+namespace wiesel {
+
+	/**
+	 * @brief Atomically increments a value and returns the new value.
+	 */
+	inline long atomicIncrement(volatile long *value) {
+		#if WIESEL_THREADAPI_WIN32
+			return _InterlockedIncrement(value);
+		#else
+			return __sync_add_and_fetch(value, 1);
+		#endif
+	}
+
+	/**
+	 * @brief Atomically decrements a value and returns the new value.
+	 */
+	inline long atomicDecrement(volatile long *value) {
+		#if WIESEL_THREADAPI_WIN32
+			return _InterlockedDecrement(value);
+		#else
+			return __sync_sub_and_fetch(value, 1);
+		#endif
+	}
+
+	/**
+	 * @brief Reads a value with a full memory barrier.
+	 */
+	inline long atomicLoad(const volatile long *value) {
+		#if WIESEL_THREADAPI_WIN32
+			return _InterlockedCompareExchange(const_cast<volatile long*>(value), 0, 0);
+		#else
+			return __sync_fetch_and_add(const_cast<volatile long*>(value), 0);
+		#endif
+	}
+
+	/**
+	 * @brief Replaces a pointer with \c exchange, when it's current value equals \c comparand.
+	 * @return The previous value of the pointer.
+	 */
+	template <class T>
+	inline T* atomicCompareAndSwap(T* volatile *pointer, T *comparand, T *exchange) {
+		#if WIESEL_THREADAPI_WIN32
+			return static_cast<T*>(_InterlockedCompareExchangePointer(
+					reinterpret_cast<void* volatile*>(pointer), exchange, comparand
+			));
+		#else
+			return __sync_val_compare_and_swap(pointer, comparand, exchange);
+		#endif
+	}
+}
+
+#endif	// __WIESEL_UTIL_ATOMIC_H__
@@ -0,0 +1,106 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "clock.h"
+
+#include "wiesel/wiesel-base-config.h"
+
+#if WIESEL_THREADAPI_PTHREAD
+#	include <sched.h>
+#	include <sys/time.h>
+#	include <time.h>
+#	include <unistd.h>
+#elif WIESEL_THREADAPI_WIN32
+#	include <windows.h>
+#endif
+
+// use the monotonic clock where available, otherwise fall back to the wall clock
+#if WIESEL_THREADAPI_PTHREAD && defined(_POSIX_TIMERS) && (_POSIX_TIMERS > 0) && defined(CLOCK_MONOTONIC)
+#	define WIESEL_CLOCK_MONOTONIC	1
+#else
+#	define WIESEL_CLOCK_MONOTONIC	0
+#endif
+
+using namespace wiesel;
+
+
+/// the time left, where sleeping becomes too inaccurate.
+#if WIESEL_THREADAPI_WIN32
+static const double SLEEP_MARGIN	= 0.002;
+#else
+static const double SLEEP_MARGIN	= 0.001;
+#endif
+
+
+double Clock::getTime() {
+	#if WIESEL_THREADAPI_WIN32
+		static LARGE_INTEGER frequency = { 0 };
+		if (frequency.QuadPart == 0) {
+			QueryPerformanceFrequency(&frequency);
+		}
+
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+		return double(now.QuadPart) / double(frequency.QuadPart);
+	#elif WIESEL_CLOCK_MONOTONIC
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return double(now.tv_sec) + double(now.tv_nsec) / 1000000000.0;
+	#else
+		// not monotonic, so the time may jump when the system time changes
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		return double(now.tv_sec) + double(now.tv_usec) / 1000000.0;
+	#endif
+}
+
+
+void Clock::sleepUntil(double time) {
+	for(;;) {
+		double remaining = time - getTime();
+		if (remaining <= 0.0) {
+			break;
+		}
+
+		if (remaining > SLEEP_MARGIN) {
+			// sleep, but wake up a bit earlier to catch the exact time
+			double duration = remaining - SLEEP_MARGIN;
+
+			#if WIESEL_THREADAPI_WIN32
+				Sleep(duration >= 0.001 ? static_cast<DWORD>(duration * 1000.0) : 1);
+			#elif WIESEL_THREADAPI_PTHREAD
+				struct timespec request;
+				request.tv_sec	= static_cast<time_t>(duration);
+				request.tv_nsec	= static_cast<long>((duration - double(request.tv_sec)) * 1000000000.0);
+				nanosleep(&request, NULL);
+			#endif
+		}
+		else {
+			#if WIESEL_THREADAPI_WIN32
+				SwitchToThread();
+			#elif WIESEL_THREADAPI_PTHREAD
+				sched_yield();
+			#endif
+		}
+	}
+
+	return;
+}
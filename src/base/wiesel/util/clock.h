@@ -0,0 +1,59 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#ifndef __WIESEL_UTIL_CLOCK_H__
+#define	__WIESEL_UTIL_CLOCK_H__
+
+#include <wiesel/wiesel-base.def>
+
+
+namespace wiesel {
+
+	/**
+	 * @brief Access to a monotonic high resolution clock.
+	 * Unlike \c clock(), this measures the real time elapsed, including
+	 * the time the process was waiting for vsync or I/O.
+	 * On platforms without a monotonic clock, the wall clock will be used instead.
+	 */
+	class WIESEL_BASE_EXPORT Clock
+	{
+	private:
+		Clock() {}
+
+	public:
+		/**
+		 * @brief Get the current time in seconds.
+		 * The time is relative to an unspecified point and can only be used
+		 * to measure the time between two calls. It will never go backwards.
+		 */
+		static double getTime();
+
+		/**
+		 * @brief Blocks the current thread until the clock reaches the given time.
+		 * The thread sleeps for most of the time and only yields it's time slice
+		 * for the last moments, where sleeping would be too inaccurate.
+		 * @param time	The time to wait for, as returned by \ref getTime.
+		 */
+		static void sleepUntil(double time);
+	};
+}
+
+#endif	// __WIESEL_UTIL_CLOCK_H__
@@ -0,0 +1,592 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "job_system.h"
+#include "atomic.h"
+
+#include <assert.h>
+
+#if WIESEL_THREADAPI_PTHREAD
+#include <unistd.h>
+#endif
+
+using namespace wiesel;
+
+
+/// the job system, the current thread is working for.
+static WIESEL_THREAD_LOCAL const JobSystem*		current_job_system	= NULL;
+
+/// the queue index of the current thread within it's job system.
+static WIESEL_THREAD_LOCAL unsigned int			current_job_queue	= 0;
+
+
+namespace wiesel {
+
+	/**
+	 * @brief A job executing a single \ref IRunnable object.
+	 */
+	class RunnableJob : public Job
+	{
+	public:
+		RunnableJob(IRunnable *runnable) {
+			this->runnable = runnable;
+			return;
+		}
+
+		virtual ~RunnableJob() {
+			return;
+		}
+
+		virtual void run() {
+			runnable->run();
+			return;
+		}
+
+	private:
+		IRunnable*		runnable;
+	};
+
+
+	/**
+	 * @brief A job handing over a task to the main thread.
+	 */
+	class MainThreadJob : public Job
+	{
+	public:
+		MainThreadJob(IMainThreadDispatcher *dispatcher, IRunnable *runnable) {
+			this->dispatcher	= dispatcher;
+			this->runnable		= keep(runnable);
+			return;
+		}
+
+		virtual ~MainThreadJob() {
+			release(runnable);
+			return;
+		}
+
+		virtual void run() {
+			dispatcher->dispatchToMainThread(runnable);
+			return;
+		}
+
+	private:
+		IMainThreadDispatcher*	dispatcher;
+		IRunnable*				runnable;
+	};
+}
+
+
+
+
+Job::Job() {
+	this->state					= Idle;
+	this->pending_dependencies	= 0;
+	this->detached				= false;
+	return;
+}
+
+Job::~Job() {
+	assert(state != Waiting);
+	assert(state != Queued);
+	return;
+}
+
+
+bool Job::isFinished() const {
+	return atomicLoad(&state) == Finished;
+}
+
+
+
+
+JobSystem::Worker::Worker(JobSystem *system, unsigned int index) {
+	this->system	= system;
+	this->index		= index;
+	return;
+}
+
+JobSystem::Worker::~Worker() {
+	return;
+}
+
+void JobSystem::Worker::run() {
+	system->work(index);
+	return;
+}
+
+
+
+
+JobSystem::JobSystem(unsigned int num_workers) {
+	this->queued_jobs				= 0;
+	this->shutdown					= false;
+	this->main_thread_dispatcher	= NULL;
+
+	#if WIESEL_THREADAPI_PTHREAD
+		pthread_mutex_init(&state_mutex, NULL);
+		pthread_cond_init(&state_changed, NULL);
+	#elif WIESEL_THREADAPI_WIN32
+		InitializeCriticalSection(&state_mutex);
+		InitializeConditionVariable(&state_changed);
+	#endif
+
+	// all queues need to exist, before the first worker starts
+	for(unsigned int i=0; i<=num_workers; i++) {
+		JobQueue *queue = new JobQueue();
+
+		#if WIESEL_THREADAPI_PTHREAD
+			pthread_mutex_init(&queue->mutex, NULL);
+		#elif WIESEL_THREADAPI_WIN32
+			InitializeCriticalSection(&queue->mutex);
+		#endif
+
+		queues.push_back(queue);
+	}
+
+	for(unsigned int i=0; i<num_workers; i++) {
+		Worker *worker = keep(new Worker(this, i + 1));
+
+		if (worker->start()) {
+			workers.push_back(worker);
+		}
+		else {
+			release(worker);
+		}
+	}
+
+	return;
+}
+
+
+JobSystem::~JobSystem() {
+	lockState();
+	shutdown = true;
+
+	#if WIESEL_THREADAPI_PTHREAD
+		pthread_cond_broadcast(&state_changed);
+	#elif WIESEL_THREADAPI_WIN32
+		WakeAllConditionVariable(&state_changed);
+	#endif
+
+	unlockState();
+
+	for(std::vector<Worker*>::iterator it=workers.begin(); it!=workers.end(); it++) {
+		(*it)->join();
+		release(*it);
+	}
+
+	workers.clear();
+
+	for(std::vector<JobQueue*>::iterator it=queues.begin(); it!=queues.end(); it++) {
+		// all jobs should have been finished before
+		assert((*it)->jobs.empty());
+
+		#if WIESEL_THREADAPI_PTHREAD
+			pthread_mutex_destroy(&(*it)->mutex);
+		#elif WIESEL_THREADAPI_WIN32
+			DeleteCriticalSection(&(*it)->mutex);
+		#endif
+
+		delete *it;
+	}
+
+	queues.clear();
+
+	#if WIESEL_THREADAPI_PTHREAD
+		pthread_cond_destroy(&state_changed);
+		pthread_mutex_destroy(&state_mutex);
+	#elif WIESEL_THREADAPI_WIN32
+		DeleteCriticalSection(&state_mutex);
+	#endif
+
+	return;
+}
+
+
+unsigned int JobSystem::getNumberOfCores() {
+	#if WIESEL_THREADAPI_PTHREAD
+		long cores = sysconf(_SC_NPROCESSORS_ONLN);
+		if (cores > 0) {
+			return static_cast<unsigned int>(cores);
+		}
+	#elif WIESEL_THREADAPI_WIN32
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		if (info.dwNumberOfProcessors > 0) {
+			return static_cast<unsigned int>(info.dwNumberOfProcessors);
+		}
+	#endif
+
+	return 1;
+}
+
+
+void JobSystem::submit(Job *job) {
+	schedule(job, NULL, 0, false);
+	return;
+}
+
+
+void JobSystem::submit(Job *job, Job *dependency) {
+	schedule(job, &dependency, 1, false);
+	return;
+}
+
+
+void JobSystem::submit(Job *job, const std::vector<Job*> &dependencies) {
+	schedule(job, dependencies.empty() ? NULL : &dependencies[0], dependencies.size(), false);
+	return;
+}
+
+
+void JobSystem::submitDetached(Job *job, Job *dependency) {
+	schedule(job, &dependency, 1, true);
+	return;
+}
+
+
+void JobSystem::schedule(Job *job, Job * const *dependencies, size_t num_dependencies, bool detached) {
+	assert(job);
+	if (job == NULL) {
+		return;
+	}
+
+	// detached jobs will be released by the thread, which executed them.
+	// this is safe, because the reference counter of SharedObject is atomic.
+	if (detached) {
+		keep(job);
+	}
+
+	lockState();
+
+	assert(job->state == Job::Idle || job->state == Job::Finished);
+	job->state					= Job::Waiting;
+	job->detached				= detached;
+	job->pending_dependencies	= 0;
+
+	for(size_t i=0; i<num_dependencies; i++) {
+		Job *dependency = dependencies[i];
+
+		if (dependency && dependency->state != Job::Finished) {
+			assert(dependency != job);
+			dependency->continuations.push_back(job);
+			++(job->pending_dependencies);
+		}
+	}
+
+	bool ready = (job->pending_dependencies == 0);
+	if (ready) {
+		job->state = Job::Queued;
+	}
+
+	unlockState();
+
+	if (ready) {
+		enqueue(job);
+	}
+
+	return;
+}
+
+
+void JobSystem::enqueue(Job *job) {
+	// without any workers, there's nobody else to run the job
+	if (workers.empty()) {
+		execute(job);
+		return;
+	}
+
+	JobQueue *queue = queues[getCurrentQueue()];
+
+	lock(queue);
+	queue->jobs.push_back(job);
+	unlock(queue);
+
+	atomicIncrement(&queued_jobs);
+
+	// wake up sleeping workers
+	lockState();
+
+	#if WIESEL_THREADAPI_PTHREAD
+		pthread_cond_broadcast(&state_changed);
+	#elif WIESEL_THREADAPI_WIN32
+		WakeAllConditionVariable(&state_changed);
+	#endif
+
+	unlockState();
+
+	return;
+}
+
+
+Job *JobSystem::findJob() {
+	if (atomicLoad(&queued_jobs) == 0) {
+		return NULL;
+	}
+
+	unsigned int own_index	= getCurrentQueue();
+	size_t num_queues		= queues.size();
+	Job *job				= NULL;
+
+	// take the newest job from the own queue
+	JobQueue *own_queue = queues[own_index];
+	lock(own_queue);
+
+	if (own_queue->jobs.empty() == false) {
+		job = own_queue->jobs.back();
+		own_queue->jobs.pop_back();
+	}
+
+	unlock(own_queue);
+
+	// otherwise steal the oldest job from another queue
+	for(size_t i=1; job == NULL && i<num_queues; i++) {
+		JobQueue *queue = queues[(own_index + i) % num_queues];
+		lock(queue);
+
+		if (queue->jobs.empty() == false) {
+			job = queue->jobs.front();
+			queue->jobs.pop_front();
+		}
+
+		unlock(queue);
+	}
+
+	if (job) {
+		atomicDecrement(&queued_jobs);
+	}
+
+	return job;
+}
+
+
+void JobSystem::execute(Job *job) {
+	job->run();
+
+	std::vector<Job*> continuations;
+	std::vector<Job*> ready;
+	bool detached = job->detached;
+
+	lockState();
+
+	continuations.swap(job->continuations);
+
+	for(std::vector<Job*>::iterator it=continuations.begin(); it!=continuations.end(); it++) {
+		if (--((*it)->pending_dependencies) == 0) {
+			(*it)->state = Job::Queued;
+			ready.push_back(*it);
+		}
+	}
+
+	// the job may be destroyed by it's owner from now on
+	job->state = Job::Finished;
+
+	#if WIESEL_THREADAPI_PTHREAD
+		pthread_cond_broadcast(&state_changed);
+	#elif WIESEL_THREADAPI_WIN32
+		WakeAllConditionVariable(&state_changed);
+	#endif
+
+	unlockState();
+
+	for(std::vector<Job*>::iterator it=ready.begin(); it!=ready.end(); it++) {
+		enqueue(*it);
+	}
+
+	if (detached) {
+		release(job);
+	}
+
+	return;
+}
+
+
+void JobSystem::wait(Job *job) {
+	assert(job);
+	if (job == NULL) {
+		return;
+	}
+
+	// waiting for a job, which was never submitted would block forever
+	assert(atomicLoad(&job->state) != Job::Idle);
+
+	while(job->isFinished() == false) {
+		Job *other = findJob();
+
+		if (other) {
+			execute(other);
+			continue;
+		}
+
+		lockState();
+
+		while(job->state != Job::Finished && atomicLoad(&queued_jobs) == 0) {
+			#if WIESEL_THREADAPI_PTHREAD
+				pthread_cond_wait(&state_changed, &state_mutex);
+			#elif WIESEL_THREADAPI_WIN32
+				SleepConditionVariableCS(&state_changed, &state_mutex, INFINITE);
+			#endif
+		}
+
+		unlockState();
+	}
+
+	return;
+}
+
+
+void JobSystem::runOnMainThreadAfter(Job *job, IRunnable *runnable) {
+	assert(main_thread_dispatcher);
+	assert(runnable);
+
+	if (main_thread_dispatcher && runnable) {
+		submitDetached(new MainThreadJob(main_thread_dispatcher, runnable), job);
+	}
+
+	return;
+}
+
+
+void JobSystem::setMainThreadDispatcher(IMainThreadDispatcher *dispatcher) {
+	this->main_thread_dispatcher = dispatcher;
+	return;
+}
+
+
+void JobSystem::run(const std::vector<IRunnable*> &tasks) {
+	std::vector<Job*> jobs;
+
+	for(std::vector<IRunnable*>::const_iterator it=tasks.begin(); it!=tasks.end(); it++) {
+		jobs.push_back(keep(new RunnableJob(*it)));
+	}
+
+	runJobs(jobs);
+
+	return;
+}
+
+
+void JobSystem::runJobs(const std::vector<Job*> &jobs) {
+	for(std::vector<Job*>::const_iterator it=jobs.begin(); it!=jobs.end(); it++) {
+		submit(*it);
+	}
+
+	for(std::vector<Job*>::const_iterator it=jobs.begin(); it!=jobs.end(); it++) {
+		wait(*it);
+	}
+
+	for(std::vector<Job*>::const_iterator it=jobs.begin(); it!=jobs.end(); it++) {
+		release(*it);
+	}
+
+	return;
+}
+
+
+void JobSystem::work(unsigned int index) {
+	current_job_system	= this;
+	current_job_queue	= index;
+
+	for(;;) {
+		Job *job = findJob();
+
+		if (job) {
+			execute(job);
+			continue;
+		}
+
+		lockState();
+
+		while(shutdown == false && atomicLoad(&queued_jobs) == 0) {
+			#if WIESEL_THREADAPI_PTHREAD
+				pthread_cond_wait(&state_changed, &state_mutex);
+			#elif WIESEL_THREADAPI_WIN32
+				SleepConditionVariableCS(&state_changed, &state_mutex, INFINITE);
+			#endif
+		}
+
+		bool quit = shutdown;
+
+		unlockState();
+
+		if (quit) {
+			break;
+		}
+	}
+
+	current_job_system	= NULL;
+	current_job_queue	= 0;
+
+	return;
+}
+
+
+unsigned int JobSystem::getCurrentQueue() const {
+	if (current_job_system == this) {
+		return current_job_queue;
+	}
+
+	return 0;
+}
+
+
+void JobSystem::lock(JobQueue *queue) {
+	#if WIESEL_THREADAPI_PTHREAD
+		pthread_mutex_lock(&queue->mutex);
+	#elif WIESEL_THREADAPI_WIN32
+		EnterCriticalSection(&queue->mutex);
+	#endif
+
+	return;
+}
+
+
+void JobSystem::unlock(JobQueue *queue) {
+	#if WIESEL_THREADAPI_PTHREAD
+		pthread_mutex_unlock(&queue->mutex);
+	#elif WIESEL_THREADAPI_WIN32
+		LeaveCriticalSection(&queue->mutex);
+	#endif
+
+	return;
+}
+
+
+void JobSystem::lockState() {
+	#if WIESEL_THREADAPI_PTHREAD
+		pthread_mutex_lock(&state_mutex);
+	#elif WIESEL_THREADAPI_WIN32
+		EnterCriticalSection(&state_mutex);
+	#endif
+
+	return;
+}
+
+
+void JobSystem::unlockState() {
+	#if WIESEL_THREADAPI_PTHREAD
+		pthread_mutex_unlock(&state_mutex);
+	#elif WIESEL_THREADAPI_WIN32
+		LeaveCriticalSection(&state_mutex);
+	#endif
+
+	return;
+}
@@ -0,0 +1,339 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#ifndef __WIESEL_UTIL_JOB_SYSTEM_H__
+#define	__WIESEL_UTIL_JOB_SYSTEM_H__
+
+#include "thread.h"
+
+#include "wiesel/wiesel-base-config.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <deque>
+#include <vector>
+
+#if WIESEL_THREADAPI_PTHREAD
+#	include <pthread.h>
+#endif
+
+#if WIESEL_THREADAPI_WIN32
+#	include <windows.h>
+#endif
+
+namespace wiesel {
+
+	class JobSystem;
+
+
+	/**
+	 * @brief A single unit of work, which can be executed by a \ref JobSystem.
+	 * A job may depend on other jobs, so it will be started not before all of it's
+	 * dependencies have been finished.
+	 * The job system does not change the reference counter of any submitted job
+	 * unless it was submitted with \ref JobSystem::submitDetached, so the caller
+	 * needs to keep each job alive, until it has been finished.
+	 */
+	class WIESEL_BASE_EXPORT Job : public IRunnable
+	{
+	friend class JobSystem;
+
+	public:
+		Job();
+		virtual ~Job();
+
+	public:
+		/**
+		 * @brief Checks, if this job has been finished.
+		 */
+		bool isFinished() const;
+
+	private:
+		enum State {
+			Idle,
+			Waiting,
+			Queued,
+			Finished
+		};
+
+		/// the current state, changed by the job system only.
+		volatile long		state;
+
+		/// the number of unfinished jobs, this job is waiting for.
+		long				pending_dependencies;
+
+		/// jobs waiting for this job to be finished.
+		std::vector<Job*>	continuations;
+
+		/// when true, the job system releases the job after it has been finished.
+		bool				detached;
+	};
+
+
+
+	/**
+	 * @brief Interface for a mechanism to execute tasks on the application's main thread.
+	 */
+	class WIESEL_BASE_EXPORT IMainThreadDispatcher
+	{
+	public:
+		virtual ~IMainThreadDispatcher() {}
+
+	public:
+		/**
+		 * @brief Executes a task on the main thread.
+		 * Can be called from any thread.
+		 */
+		virtual void dispatchToMainThread(IRunnable *runnable) = 0;
+	};
+
+
+
+	/**
+	 * @brief Executes jobs on a set of worker threads.
+	 * Each worker owns a queue of jobs. New jobs submitted by a worker will be added
+	 * to it's own queue, which will be processed newest first, while idle workers
+	 * steal the oldest jobs from the queues of other workers.
+	 * Threads waiting for a job will help executing other jobs in the meantime.
+	 *
+	 * Each queue is a deque guarded by it's own mutex. The mutex is only contended
+	 * when a worker steals from another queue, so a lock-free Chase-Lev deque would
+	 * not gain much, but needs a growable ring buffer with safe reclamation and
+	 * stronger memory ordering than the CAS helpers in atomic.h provide.
+	 * Jobs may be kept and released on any thread, because the reference counter
+	 * of \ref SharedObject is atomic.
+	 */
+	class WIESEL_BASE_EXPORT JobSystem
+	{
+	public:
+		/**
+		 * @brief Creates a new job system.
+		 * @param num_workers	The number of worker threads. Threads waiting for jobs
+		 *						will execute jobs as well, so the number of cores minus one
+		 *						would be a good value. With zero workers, all jobs will
+		 *						be executed by waiting threads only.
+		 */
+		JobSystem(unsigned int num_workers);
+
+		~JobSystem();
+
+	public:
+		/**
+		 * @brief Get the number of processor cores available on this system.
+		 */
+		static unsigned int getNumberOfCores();
+
+		/**
+		 * @brief Get the number of worker threads of this job system.
+		 */
+		inline unsigned int getNumberOfWorkers() const {
+			return static_cast<unsigned int>(workers.size());
+		}
+
+	// jobs
+	public:
+		/**
+		 * @brief Submits a job to be executed as soon as possible.
+		 */
+		void submit(Job *job);
+
+		/**
+		 * @brief Submits a job to be executed after another job has been finished.
+		 * @param job			The job to be executed.
+		 * @param dependency	The job to wait for. May be \c NULL.
+		 */
+		void submit(Job *job, Job *dependency);
+
+		/**
+		 * @brief Submits a job to be executed after a list of other jobs have been finished.
+		 * @param job			The job to be executed.
+		 * @param dependencies	All jobs to wait for.
+		 */
+		void submit(Job *job, const std::vector<Job*> &dependencies);
+
+		/**
+		 * @brief Submits a job, which will be owned by the job system.
+		 * The job will be released after it has been finished, so the caller
+		 * must not keep any other reference to this job.
+		 * @param job			The job to be executed.
+		 * @param dependency	The job to wait for. May be \c NULL.
+		 */
+		void submitDetached(Job *job, Job *dependency=NULL);
+
+		/**
+		 * @brief Waits, until a job has been finished.
+		 * The calling thread executes other jobs while waiting.
+		 */
+		void wait(Job *job);
+
+		/**
+		 * @brief Executes a task on the main thread, after a job has been finished.
+		 * Requires a dispatcher set by \ref setMainThreadDispatcher.
+		 * The job system keeps a reference to the task until it was dispatched.
+		 * @param job		The job to wait for. May be \c NULL.
+		 * @param runnable	The task to be executed on the main thread.
+		 */
+		void runOnMainThreadAfter(Job *job, IRunnable *runnable);
+
+		/**
+		 * @brief Sets the mechanism, which executes tasks on the application's main thread.
+		 */
+		void setMainThreadDispatcher(IMainThreadDispatcher *dispatcher);
+
+	// helpers
+	public:
+		/**
+		 * @brief Executes all tasks in parallel and waits until all of them have been finished.
+		 * The tasks need to be independent from each other, because they
+		 * may run in any order.
+		 */
+		void run(const std::vector<IRunnable*> &tasks);
+
+		/**
+		 * @brief Calls a function object for all ranges within [begin, end) in parallel
+		 * and waits until all of them have been finished.
+		 * The function object will be called with the first and the last + 1 index
+		 * of each range, like <tt>body(range_begin, range_end)</tt>.
+		 * @param begin		The first index.
+		 * @param end		The last index + 1.
+		 * @param grain		The maximum number of indices processed by a single job.
+		 * @param body		The function object to be called for each range.
+		 */
+		template <class BODY>
+		void parallelFor(size_t begin, size_t end, size_t grain, BODY &body) {
+			if (grain == 0) {
+				grain = 1;
+			}
+
+			std::vector<Job*> jobs;
+			for(size_t range_begin=begin; range_begin<end; range_begin+=grain) {
+				size_t range_end = (end - range_begin > grain) ? range_begin + grain : end;
+				jobs.push_back(keep(new RangeJob<BODY>(&body, range_begin, range_end)));
+			}
+
+			runJobs(jobs);
+
+			return;
+		}
+
+	private:
+		/**
+		 * @brief A job calling a function object for a range of indices.
+		 */
+		template <class BODY>
+		class RangeJob : public Job
+		{
+		public:
+			RangeJob(BODY *body, size_t begin, size_t end) : body(body), begin(begin), end(end) {}
+
+			virtual void run() {
+				(*body)(begin, end);
+			}
+
+		private:
+			BODY*	body;
+			size_t	begin;
+			size_t	end;
+		};
+
+		/**
+		 * @brief A single queue of jobs.
+		 */
+		struct JobQueue {
+			std::deque<Job*>		jobs;
+
+			#if WIESEL_THREADAPI_PTHREAD
+				pthread_mutex_t		mutex;
+			#elif WIESEL_THREADAPI_WIN32
+				CRITICAL_SECTION	mutex;
+			#endif
+		};
+
+		/**
+		 * @brief A single worker thread of the job system.
+		 */
+		class Worker : public Thread
+		{
+		public:
+			Worker(JobSystem *system, unsigned int index);
+			virtual ~Worker();
+
+		public:
+			virtual void run();
+
+		private:
+			JobSystem*		system;
+			unsigned int	index;
+		};
+
+		/// submits, waits for and releases a list of jobs.
+		void runJobs(const std::vector<Job*> &jobs);
+
+		/// submits a job with a list of dependencies.
+		void schedule(Job *job, Job * const *dependencies, size_t num_dependencies, bool detached);
+
+		/// adds a job to the queue of the current thread.
+		void enqueue(Job *job);
+
+		/// takes the next job from the own queue or steals one from other queues.
+		Job *findJob();
+
+		/// executes a job and starts all jobs waiting for it.
+		void execute(Job *job);
+
+		/// the main loop of each worker thread.
+		void work(unsigned int index);
+
+		/// get the index of the queue, which belongs to the current thread.
+		unsigned int getCurrentQueue() const;
+
+		static void lock(JobQueue *queue);
+		static void unlock(JobQueue *queue);
+
+		void lockState();
+		void unlockState();
+
+	private:
+		std::vector<Worker*>		workers;
+
+		/// one queue for each worker and one more for all other threads at index 0.
+		std::vector<JobQueue*>		queues;
+
+		/// the number of jobs within all queues.
+		volatile long				queued_jobs;
+
+		bool						shutdown;
+
+		IMainThreadDispatcher*		main_thread_dispatcher;
+
+	// api specific
+	private:
+		#if WIESEL_THREADAPI_PTHREAD
+			pthread_mutex_t		state_mutex;
+			pthread_cond_t		state_changed;
+		#elif WIESEL_THREADAPI_WIN32
+			CRITICAL_SECTION	state_mutex;
+			CONDITION_VARIABLE	state_changed;
+		#endif
+	};
+}
+
+#endif	// __WIESEL_UTIL_JOB_SYSTEM_H__
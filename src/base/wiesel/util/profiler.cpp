@@ -0,0 +1,408 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "profiler.h"
+#include "atomic.h"
+#include "clock.h"
+#include "thread.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+
+using namespace wiesel;
+
+
+/**
+ * @brief A phase, which was started, but not yet finished.
+ */
+struct OpenPhase {
+	const char*		name;
+	double			start;
+};
+
+/// the phases currently open on this thread.
+static WIESEL_THREAD_LOCAL OpenPhase		open_phases[Profiler::MAX_DEPTH];
+
+/// the number of phases currently open on this thread, including those exceeding MAX_DEPTH.
+static WIESEL_THREAD_LOCAL uint32_t			open_phases_depth	= 0;
+
+/// the number identifying this thread within the profiler, zero when not yet assigned.
+static WIESEL_THREAD_LOCAL uint32_t			profiler_thread		= 0;
+
+/// the last thread number assigned.
+static volatile long						last_profiler_thread	= 0;
+
+
+/**
+ * @brief Writes a string as a JSON string literal.
+ */
+static void writeJsonString(std::ostream &out, const char *str) {
+	out << '"';
+
+	for(const char *c=str; *c; c++) {
+		if (*c == '"' || *c == '\\') {
+			out << '\\';
+		}
+
+		out << *c;
+	}
+
+	out << '"';
+
+	return;
+}
+
+
+/**
+ * @brief Collects the time spent within a phase or the values of a counter over all frames.
+ */
+struct PhaseSummary {
+	PhaseSummary() : calls(0), total(0.0), max_per_frame(0.0), current_frame(0.0) {}
+
+	size_t		calls;
+	double		total;
+	double		max_per_frame;
+	double		current_frame;
+};
+
+
+
+
+Profiler::Profiler() {
+	this->current_frame		= 0;
+	this->completed_frames	= 0;
+	this->next_frame_number	= 0;
+	this->enabled			= true;
+
+	#if WIESEL_THREADAPI_PTHREAD
+		pthread_mutex_init(&mutex, NULL);
+	#elif WIESEL_THREADAPI_WIN32
+		InitializeCriticalSection(&mutex);
+	#endif
+
+	setCapacity(DEFAULT_CAPACITY);
+
+	return;
+}
+
+Profiler::~Profiler() {
+	#if WIESEL_THREADAPI_PTHREAD
+		pthread_mutex_destroy(&mutex);
+	#elif WIESEL_THREADAPI_WIN32
+		DeleteCriticalSection(&mutex);
+	#endif
+
+	return;
+}
+
+
+Profiler *Profiler::getInstance() {
+	static Profiler instance;
+	return &instance;
+}
+
+
+void Profiler::setEnabled(bool enabled) {
+	this->enabled = enabled;
+	return;
+}
+
+
+void Profiler::setCapacity(size_t frames) {
+	assert(frames > 0);
+
+	lock();
+
+	// one more frame, which is currently recorded
+	this->frames.clear();
+	this->frames.resize(frames + 1);
+	this->current_frame		= 0;
+	this->completed_frames	= 0;
+
+	Frame &frame	= this->frames[0];
+	frame.number	= next_frame_number++;
+	frame.start		= Clock::getTime();
+	frame.duration	= 0.0;
+
+	unlock();
+
+	return;
+}
+
+
+void Profiler::begin(const char *name) {
+	// nested phases exceeding the maximum depth are counted, but not recorded
+	if (open_phases_depth < MAX_DEPTH) {
+		OpenPhase &phase = open_phases[open_phases_depth];
+		phase.name	= name;
+		phase.start	= Clock::getTime();
+	}
+
+	++open_phases_depth;
+
+	return;
+}
+
+
+void Profiler::end() {
+	assert(open_phases_depth > 0);
+	if (open_phases_depth == 0) {
+		return;
+	}
+
+	uint32_t depth = --open_phases_depth;
+	if (depth >= MAX_DEPTH || enabled == false) {
+		return;
+	}
+
+	double now = Clock::getTime();
+	const OpenPhase &phase = open_phases[depth];
+
+	if (profiler_thread == 0) {
+		profiler_thread = static_cast<uint32_t>(atomicIncrement(&last_profiler_thread));
+	}
+
+	lock();
+
+	Frame &frame = frames[current_frame];
+
+	Event event;
+	event.name		= phase.name;
+	event.start		= phase.start - frame.start;
+	event.duration	= now - phase.start;
+	event.depth		= depth;
+	event.thread	= profiler_thread;
+	frame.events.push_back(event);
+
+	unlock();
+
+	return;
+}
+
+
+void Profiler::setCounter(const char *name, double value) {
+	if (enabled == false) {
+		return;
+	}
+
+	lock();
+
+	std::vector<Counter> &counters = frames[current_frame].counters;
+	std::vector<Counter>::iterator it = counters.begin();
+
+	for(; it!=counters.end(); it++) {
+		if (strcmp(it->name, name) == 0) {
+			it->value = value;
+			break;
+		}
+	}
+
+	if (it == counters.end()) {
+		Counter counter;
+		counter.name	= name;
+		counter.value	= value;
+		counters.push_back(counter);
+	}
+
+	unlock();
+
+	return;
+}
+
+
+void Profiler::nextFrame() {
+	if (enabled == false) {
+		return;
+	}
+
+	double now = Clock::getTime();
+
+	lock();
+
+	frames[current_frame].duration = now - frames[current_frame].start;
+
+	current_frame		= (current_frame + 1) % frames.size();
+	completed_frames	= std::min(completed_frames + 1, frames.size() - 1);
+
+	// the event list keeps it's memory, so recording won't allocate after a few frames
+	Frame &frame	= frames[current_frame];
+	frame.number	= next_frame_number++;
+	frame.start		= now;
+	frame.duration	= 0.0;
+	frame.events.clear();
+	frame.counters.clear();
+
+	unlock();
+
+	return;
+}
+
+
+size_t Profiler::getNumberOfFrames() const {
+	return completed_frames;
+}
+
+
+const Profiler::Frame *Profiler::getFrame(size_t index) const {
+	assert(index < completed_frames);
+	if (index >= completed_frames) {
+		return NULL;
+	}
+
+	return &frames[(current_frame + frames.size() - completed_frames + index) % frames.size()];
+}
+
+
+void Profiler::writeChromeTrace(std::ostream &out) {
+	lock();
+
+	double first_start = completed_frames ? getFrame(0)->start : 0.0;
+	bool first_event = true;
+
+	out << "{\"traceEvents\":[";
+
+	for(size_t i=0; i<completed_frames; i++) {
+		const Frame *frame = getFrame(i);
+		double frame_start = frame->start - first_start;
+
+		// the frame itself will be shown on a separate track
+		out << (first_event ? "\n" : ",\n");
+		out << "{\"name\":\"Frame " << frame->number << "\",\"cat\":\"frame\",\"ph\":\"X\"";
+		out << ",\"ts\":" << (frame_start * 1000000.0);
+		out << ",\"dur\":" << (frame->duration * 1000000.0);
+		out << ",\"pid\":1,\"tid\":0}";
+		first_event = false;
+
+		for(std::vector<Event>::const_iterator it=frame->events.begin(); it!=frame->events.end(); it++) {
+			out << ",\n{\"name\":";
+			writeJsonString(out, it->name);
+			out << ",\"cat\":\"wiesel\",\"ph\":\"X\"";
+			out << ",\"ts\":" << ((frame_start + it->start) * 1000000.0);
+			out << ",\"dur\":" << (it->duration * 1000000.0);
+			out << ",\"pid\":1,\"tid\":" << it->thread << "}";
+		}
+
+		for(std::vector<Counter>::const_iterator it=frame->counters.begin(); it!=frame->counters.end(); it++) {
+			out << ",\n{\"name\":";
+			writeJsonString(out, it->name);
+			out << ",\"cat\":\"counter\",\"ph\":\"C\"";
+			out << ",\"ts\":" << (frame_start * 1000000.0);
+			out << ",\"pid\":1,\"args\":{\"value\":" << it->value << "}}";
+		}
+	}
+
+	out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	unlock();
+
+	return;
+}
+
+
+void Profiler::writeSummary(std::ostream &out) {
+	lock();
+
+	std::map<std::string, PhaseSummary> phases;
+	std::map<std::string, PhaseSummary> counters;
+	double total_frame_time	= 0.0;
+	double max_frame_time	= 0.0;
+
+	for(size_t i=0; i<completed_frames; i++) {
+		const Frame *frame = getFrame(i);
+		total_frame_time	+= frame->duration;
+		max_frame_time		=  std::max(max_frame_time, frame->duration);
+
+		for(std::vector<Event>::const_iterator it=frame->events.begin(); it!=frame->events.end(); it++) {
+			PhaseSummary &phase = phases[it->name];
+			phase.calls			+= 1;
+			phase.total			+= it->duration;
+			phase.current_frame	+= it->duration;
+		}
+
+		for(std::map<std::string, PhaseSummary>::iterator it=phases.begin(); it!=phases.end(); it++) {
+			it->second.max_per_frame = std::max(it->second.max_per_frame, it->second.current_frame);
+			it->second.current_frame = 0.0;
+		}
+
+		for(std::vector<Counter>::const_iterator it=frame->counters.begin(); it!=frame->counters.end(); it++) {
+			PhaseSummary &counter = counters[it->name];
+			counter.calls			+= 1;
+			counter.total			+= it->value;
+			counter.max_per_frame	=  std::max(counter.max_per_frame, it->value);
+		}
+	}
+
+	double num_frames = completed_frames ? double(completed_frames) : 1.0;
+
+	out << "frames: " << completed_frames;
+	out << ", average: " << (total_frame_time / num_frames * 1000.0) << " ms";
+	out << ", max: " << (max_frame_time * 1000.0) << " ms" << std::endl;
+	out << "phase\tcalls/frame\taverage ms\tmax ms" << std::endl;
+
+	for(std::map<std::string, PhaseSummary>::iterator it=phases.begin(); it!=phases.end(); it++) {
+		out << it->first;
+		out << '\t' << (double(it->second.calls) / num_frames);
+		out << '\t' << (it->second.total / num_frames * 1000.0);
+		out << '\t' << (it->second.max_per_frame * 1000.0);
+		out << std::endl;
+	}
+
+	if (counters.empty() == false) {
+		out << "counter\taverage\tmax" << std::endl;
+
+		for(std::map<std::string, PhaseSummary>::iterator it=counters.begin(); it!=counters.end(); it++) {
+			out << it->first;
+			out << '\t' << (it->second.total / double(it->second.calls));
+			out << '\t' << it->second.max_per_frame;
+			out << std::endl;
+		}
+	}
+
+	unlock();
+
+	return;
+}
+
+
+void Profiler::lock() {
+	#if WIESEL_THREADAPI_PTHREAD
+		pthread_mutex_lock(&mutex);
+	#elif WIESEL_THREADAPI_WIN32
+		EnterCriticalSection(&mutex);
+	#endif
+
+	return;
+}
+
+
+void Profiler::unlock() {
+	#if WIESEL_THREADAPI_PTHREAD
+		pthread_mutex_unlock(&mutex);
+	#elif WIESEL_THREADAPI_WIN32
+		LeaveCriticalSection(&mutex);
+	#endif
+
+	return;
+}
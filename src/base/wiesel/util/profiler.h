@@ -0,0 +1,272 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#ifndef __WIESEL_UTIL_PROFILER_H__
+#define	__WIESEL_UTIL_PROFILER_H__
+
+#include <wiesel/wiesel-base.def>
+
+#include "wiesel/wiesel-base-config.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ostream>
+#include <vector>
+
+#if WIESEL_THREADAPI_PTHREAD
+#	include <pthread.h>
+#endif
+
+#if WIESEL_THREADAPI_WIN32
+#	include <windows.h>
+#endif
+
+
+#define WIESEL_PROFILER_CONCAT_IMPL(a, b)	a##b
+#define WIESEL_PROFILER_CONCAT(a, b)		WIESEL_PROFILER_CONCAT_IMPL(a, b)
+
+#if WIESEL_PROFILER_ENABLED
+	/**
+	 * @brief Measures the time until the end of the current scope.
+	 * @param name	A string literal naming the measured phase.
+	 */
+#	define WIESEL_PROFILE_SCOPE(name)	::wiesel::ProfilerScope WIESEL_PROFILER_CONCAT(__profiler_scope_, __LINE__)(name)
+
+	/**
+	 * @brief Finishes the current frame of the profiler and starts the next one.
+	 */
+#	define WIESEL_PROFILE_NEXT_FRAME()	::wiesel::Profiler::getInstance()->nextFrame()
+
+	/**
+	 * @brief Stores a value for the current frame, like the number of draw calls.
+	 * @param name	A string literal naming the counter.
+	 * @param value	The counter's value.
+	 */
+#	define WIESEL_PROFILE_COUNTER(name, value)	::wiesel::Profiler::getInstance()->setCounter(name, double(value))
+#else
+#	define WIESEL_PROFILE_SCOPE(name)
+#	define WIESEL_PROFILE_NEXT_FRAME()
+#	define WIESEL_PROFILE_COUNTER(name, value)
+#endif
+
+
+namespace wiesel {
+
+	/**
+	 * @brief Records the time spent within named phases of each frame.
+	 * Phases are measured by \ref WIESEL_PROFILE_SCOPE and may be nested.
+	 * The profiler keeps the phases of the last frames in a ring buffer,
+	 * which can be written as a Chrome trace_event JSON file (to be opened
+	 * in chrome://tracing) or as a summary of all phases.
+	 * When the profiler was disabled with \c WIESEL_PROFILER_ENABLED,
+	 * all scopes will be compiled out and no frames will be recorded.
+	 */
+	class WIESEL_BASE_EXPORT Profiler
+	{
+	private:
+		Profiler();
+		~Profiler();
+
+	public:
+		/**
+		 * @brief A single measured phase.
+		 */
+		struct Event {
+			/// the name of this phase.
+			const char*		name;
+
+			/// the start time in seconds, relative to the start of the frame.
+			double			start;
+
+			/// the time spent within this phase in seconds.
+			double			duration;
+
+			/// the number of phases this phase is nested in.
+			uint32_t		depth;
+
+			/// a number identifying the thread, which was running this phase.
+			uint32_t		thread;
+		};
+
+		/**
+		 * @brief A value stored for a single frame.
+		 */
+		struct Counter {
+			/// the name of this counter.
+			const char*		name;
+
+			/// the value of this counter.
+			double			value;
+		};
+
+		/**
+		 * @brief All phases measured within a single frame.
+		 */
+		struct Frame {
+			/// the number of this frame since the profiler was created.
+			uint32_t			number;
+
+			/// the time this frame has started, as returned by \ref Clock::getTime.
+			double				start;
+
+			/// the total time of this frame in seconds.
+			double				duration;
+
+			/// all phases finished within this frame.
+			std::vector<Event>	events;
+
+			/// all counters set within this frame.
+			std::vector<Counter>	counters;
+		};
+
+		/// the maximum depth of nested phases.
+		static const uint32_t	MAX_DEPTH			= 32;
+
+		/// the number of frames recorded by default.
+		static const size_t		DEFAULT_CAPACITY	= 120;
+
+	public:
+		/**
+		 * @brief Get the global profiler instance.
+		 */
+		static Profiler *getInstance();
+
+	// recording
+	public:
+		/**
+		 * @brief Enables or disables recording new frames.
+		 */
+		void setEnabled(bool enabled);
+
+		/**
+		 * @brief Checks, if the profiler is recording new frames.
+		 */
+		inline bool isEnabled() const {
+			return enabled;
+		}
+
+		/**
+		 * @brief Sets the number of frames kept by the profiler.
+		 * This discards all recorded frames.
+		 */
+		void setCapacity(size_t frames);
+
+		/**
+		 * @brief Get the number of frames kept by the profiler.
+		 */
+		inline size_t getCapacity() const {
+			return frames.size() - 1;
+		}
+
+		/**
+		 * @brief Starts a new phase on the current thread.
+		 * @param name	The name of the phase. The string will not be copied,
+		 *				so it needs to stay valid, like a string literal.
+		 */
+		void begin(const char *name);
+
+		/**
+		 * @brief Finishes the latest phase started on the current thread.
+		 */
+		void end();
+
+		/**
+		 * @brief Sets the value of a counter for the current frame.
+		 * @param name	The name of the counter. The string will not be copied,
+		 *				so it needs to stay valid, like a string literal.
+		 * @param value	The value of the counter.
+		 */
+		void setCounter(const char *name, double value);
+
+		/**
+		 * @brief Finishes the current frame and starts the next one.
+		 */
+		void nextFrame();
+
+	// results
+	public:
+		/**
+		 * @brief Get the number of completed frames recorded.
+		 */
+		size_t getNumberOfFrames() const;
+
+		/**
+		 * @brief Get a completed frame, where zero is the oldest frame recorded.
+		 */
+		const Frame *getFrame(size_t index) const;
+
+		/**
+		 * @brief Writes all completed frames as a Chrome trace_event JSON document.
+		 */
+		void writeChromeTrace(std::ostream &out);
+
+		/**
+		 * @brief Writes the average and maximum time per frame of each phase
+		 * and the average and maximum value of each counter.
+		 */
+		void writeSummary(std::ostream &out);
+
+	private:
+		void lock();
+		void unlock();
+
+	private:
+		/// the ring buffer of frames, including the frame currently recorded.
+		std::vector<Frame>		frames;
+
+		/// the index of the frame currently recorded.
+		size_t					current_frame;
+
+		/// the number of completed frames within the ring buffer.
+		size_t					completed_frames;
+
+		uint32_t				next_frame_number;
+		bool					enabled;
+
+	// api specific
+	private:
+		#if WIESEL_THREADAPI_PTHREAD
+			pthread_mutex_t		mutex;
+		#elif WIESEL_THREADAPI_WIN32
+			CRITICAL_SECTION	mutex;
+		#endif
+	};
+
+
+
+	/**
+	 * @brief Measures the time between construction and destruction of this object.
+	 * Should be used via \ref WIESEL_PROFILE_SCOPE.
+	 */
+	class ProfilerScope
+	{
+	public:
+		inline ProfilerScope(const char *name) {
+			Profiler::getInstance()->begin(name);
+		}
+
+		inline ~ProfilerScope() {
+			Profiler::getInstance()->end();
+		}
+	};
+}
+
+#endif	// __WIESEL_UTIL_PROFILER_H__
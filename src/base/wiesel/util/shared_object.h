@@ -24,6 +24,8 @@
 
 #include <wiesel/wiesel-base.def>
 
+#include "atomic.h"
+
 #include <assert.h>
 #include <stddef.h>
 #include <list>
@@ -41,6 +43,8 @@ namespace wiesel {
 	 * the reference counter. When the reference counter hits zero, the object will be deleted.
 	 * Objects which are never retained will be deleted next time,
 	 * when \ref SharedObject::purgeDeadObjects() is called.
+	 * The reference counter is changed atomically, so references may be
+	 * taken and released on any thread.
 	 *
 	 * By design, this class should be used as a virtual base class only.
 	 */
@@ -62,11 +66,11 @@ namespace wiesel {
 		 * @brief get the current value of the reference counter.
 		 */
 		inline int getReferenceCount() const {
-			return references;
+			return static_cast<int>(atomicLoad(&references));
 		}
 
 	private:
-		mutable int		references;
+		mutable volatile long	references;
 	};
 	
 	
@@ -74,14 +78,14 @@ namespace wiesel {
 	
 	inline void _keep(const SharedObject *obj) {
 		assert(obj != NULL);
-		++obj->references;
+		atomicIncrement(&obj->references);
 	}
 
 	inline void _release(const SharedObject *obj) {
 		assert(obj != NULL);
 		assert(obj->references > 0);
 		
-		if ((--obj->references) <= 0) {
+		if (atomicDecrement(&obj->references) <= 0) {
 			delete obj;
 		}
 	}
@@ -0,0 +1,113 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "task_queue.h"
+#include "atomic.h"
+#include "thread.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+#include <algorithm>
+
+using namespace wiesel;
+
+
+TaskQueue::TaskQueue() {
+	this->head = NULL;
+	return;
+}
+
+TaskQueue::~TaskQueue() {
+	std::vector<IRunnable*> remaining;
+	takeAll(&remaining);
+
+	for(std::vector<IRunnable*>::iterator it=remaining.begin(); it!=remaining.end(); it++) {
+		release(*it);
+	}
+
+	return;
+}
+
+
+void TaskQueue::push(IRunnable *runnable) {
+	assert(runnable);
+	if (runnable == NULL) {
+		return;
+	}
+
+	Entry *entry	= new Entry();
+	entry->runnable	= keep(runnable);
+
+	// link the new entry in front of the current head
+	Entry *current = head;
+	for(;;) {
+		entry->next = current;
+
+		Entry *previous = atomicCompareAndSwap<Entry>(&head, current, entry);
+		if (previous == current) {
+			break;
+		}
+
+		current = previous;
+	}
+
+	return;
+}
+
+
+bool TaskQueue::takeAll(std::vector<IRunnable*> *tasks) {
+	// detach the whole list at once
+	Entry *current = head;
+	for(;;) {
+		if (current == NULL) {
+			return false;
+		}
+
+		Entry *previous = atomicCompareAndSwap<Entry>(&head, current, static_cast<Entry*>(NULL));
+		if (previous == current) {
+			break;
+		}
+
+		current = previous;
+	}
+
+	// the list starts with the newest entry, so it will be inserted in reverse order
+	size_t first = tasks->size();
+	for(Entry *entry=current; entry!=NULL; entry=entry->next) {
+		tasks->push_back(entry->runnable);
+	}
+
+	std::reverse(tasks->begin() + first, tasks->end());
+
+	while(current) {
+		Entry *next = current->next;
+		delete current;
+		current = next;
+	}
+
+	return true;
+}
+
+
+bool TaskQueue::empty() const {
+	return head == NULL;
+}
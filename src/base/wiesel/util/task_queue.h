@@ -0,0 +1,83 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#ifndef __WIESEL_UTIL_TASK_QUEUE_H__
+#define	__WIESEL_UTIL_TASK_QUEUE_H__
+
+#include <wiesel/wiesel-base.def>
+
+#include <vector>
+
+namespace wiesel {
+
+	class IRunnable;
+
+
+	/**
+	 * @brief A queue of tasks with multiple producers and a single consumer.
+	 * Any thread can add tasks without locking, while a single thread
+	 * takes all queued tasks at once.
+	 */
+	class WIESEL_BASE_EXPORT TaskQueue
+	{
+	public:
+		TaskQueue();
+
+		/**
+		 * @brief Releases all tasks, which were not taken from the queue.
+		 */
+		~TaskQueue();
+
+	public:
+		/**
+		 * @brief Adds a task to the queue. Can be called from any thread.
+		 * The queue keeps a reference to the task until it has been taken.
+		 * This relies on the atomic reference counter of \ref SharedObject,
+		 * because the main thread may release other references at the same time.
+		 */
+		void push(IRunnable *runnable);
+
+		/**
+		 * @brief Moves all queued tasks into a list in the order they were added.
+		 * The references of the queue will be moved into the list as well,
+		 * so the caller needs to release each task.
+		 * Only one thread may take tasks from the queue.
+		 * @return \c true, when any task was added to the list.
+		 */
+		bool takeAll(std::vector<IRunnable*> *tasks);
+
+		/**
+		 * @brief Checks, if there are any tasks queued.
+		 */
+		bool empty() const;
+
+	private:
+		struct Entry {
+			IRunnable*	runnable;
+			Entry*		next;
+		};
+
+		/// the latest entry added to the queue.
+		Entry* volatile		head;
+	};
+}
+
+#endif	// __WIESEL_UTIL_TASK_QUEUE_H__
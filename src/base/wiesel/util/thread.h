@@ -37,6 +37,12 @@
 #	include <process.h>
 #endif
 
+#if WIESEL_THREADAPI_WIN32
+#	define WIESEL_THREAD_LOCAL		__declspec(thread)
+#else
+#	define WIESEL_THREAD_LOCAL		__thread
+#endif
+
 namespace wiesel {
 
 	class Thread;
@@ -21,6 +21,10 @@
  */
 #include "application.h"
 
+#include <wiesel/video/render_context.h>
+#include <wiesel/video/render_statistics.h>
+#include <wiesel/util/profiler.h>
+
 #include <algorithm>
 
 
@@ -28,11 +32,13 @@ using namespace wiesel;
 
 
 Application::Application() {
+	render_statistics = new video::RenderStatistics();
 	return;
 }
 
 Application::~Application() {
 	clearSceneStack();
+	delete render_statistics;
 	return;
 }
 
@@ -45,6 +51,8 @@ void Application::onRun(float) {
 
 
 void Application::onRender(video::RenderContext *render_context) {
+	WIESEL_PROFILE_SCOPE("Application::onRender");
+
 	// draw all scenes
 	for(SceneList::iterator it=scene_stack.begin(); it!=scene_stack.end(); it++) {
 		(*it)->render(render_context);
@@ -54,6 +62,17 @@ void Application::onRender(video::RenderContext *render_context) {
 }
 
 
+const video::RenderStatistics& Application::getRenderStatistics() const {
+	return *render_statistics;
+}
+
+
+void Application::setRenderStatistics(const video::RenderStatistics &statistics) {
+	*render_statistics = statistics;
+	return;
+}
+
+
 
 
 bool Application::pushScene(Scene *scene) {
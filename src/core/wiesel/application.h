@@ -32,6 +32,10 @@
 
 namespace wiesel {
 
+	namespace video {
+		struct RenderStatistics;
+	}
+
 
 	/**
 	 * @brief An abstract class implementing the application logic.
@@ -84,6 +88,19 @@ namespace wiesel {
 		 */
 		virtual void onRender(video::RenderContext *render_context);
 
+		/**
+		 * @brief Get the render statistics of the last completed frame.
+		 * The statistics will be updated each time the render context has finished a frame,
+		 * so they already contain the draw calls made in the latest \ref onRender.
+		 */
+		const video::RenderStatistics& getRenderStatistics() const;
+
+		/**
+		 * @brief Stores the statistics of a completed frame.
+		 * Called by the \ref video::RenderContext at the end of \ref video::RenderContext::postRender.
+		 */
+		void setRenderStatistics(const video::RenderStatistics &statistics);
+
 	// scene stack
 	public:
 		/**
@@ -117,7 +134,8 @@ namespace wiesel {
 		}
 
 	private:
-		SceneList		scene_stack;
+		SceneList					scene_stack;
+		video::RenderStatistics*	render_statistics;
 	};
 
 }
@@ -24,6 +24,9 @@
 #include <wiesel/util/shared_object.h>
 #include <wiesel/util/log.h>
 #include <wiesel/util/thread.h>
+#include <wiesel/util/clock.h>
+#include <wiesel/util/job_system.h>
+#include <wiesel/util/profiler.h>
 #include <wiesel/module.h>
 #include <wiesel/module_registry.h>
 
@@ -31,7 +34,6 @@
 
 #include <assert.h>
 #include <stddef.h>
-#include <time.h>
 
 #include <algorithm>
 
@@ -39,11 +41,37 @@
 using namespace wiesel;
 
 
+/**
+ * @brief Hands over tasks from the engine's job system to the main thread.
+ */
+class EngineMainThreadDispatcher : public IMainThreadDispatcher
+{
+public:
+	virtual void dispatchToMainThread(IRunnable *runnable) {
+		Engine::getInstance()->runOnMainThread(runnable);
+	}
+};
+
+static EngineMainThreadDispatcher	main_thread_dispatcher;
+
+
+/// the maximum time of a single frame, which will be simulated in fixed timestep mode.
+/// Longer frames will slow down the simulation instead of piling up more and more updates.
+static const double MAX_FIXED_FRAME_TIME	= 0.25;
+
+
+
 Engine		Engine::instance;
 
 
 Engine::Engine() {
-	mainthread			= keep(new Thread());
+	jobs				= NULL;
+	main_thread_task_budget	= 0.0f;
+
+	fixed_timestep			= 0.0f;
+	fixed_time_accumulator	= 0.0;
+	interpolation_alpha		= 1.0f;
+	frame_rate_limit		= 0.0f;
 
 	exit_requested		= false;
 	application			= NULL;
@@ -54,7 +82,13 @@ Engine::Engine() {
 Engine::~Engine() {
 	shutdown();
 
-	clear_ref(mainthread);
+	// release tasks, which were not executed
+	run_once_queue.takeAll(&run_once);
+	for(std::vector<IRunnable*>::iterator it=run_once.begin(); it!=run_once.end(); it++) {
+		release(*it);
+	}
+
+	run_once.clear();
 
 	return;
 }
@@ -197,57 +231,108 @@ void Engine::run(Application *app) {
 	// reset the exit_requested flag before starting the main loop
 	exit_requested = false;
 
+	// one worker per core, the main thread works on the tasks, too
+	unsigned int cores = JobSystem::getNumberOfCores();
+	this->jobs = new JobSystem(cores > 1 ? cores - 1 : 0);
+	this->jobs->setMainThreadDispatcher(&main_thread_dispatcher);
+
 	// first onRun before entering the main loop
 	for(std::vector<Platform*>::iterator it=platforms.begin(); it!=platforms.end(); it++) {
 		(*it)->onRunFirst();
 	}
 
 	// timers
-	clock_t now_t = clock();
-	clock_t last_t;
+	double now_t = Clock::getTime();
+	double last_t;
+
+	fixed_time_accumulator	= 0.0;
+	interpolation_alpha		= 1.0f;
 
 	bool done = false;
 	do {
 		done = false;
 
+		// each iteration of the main loop is one frame for the profiler
+		WIESEL_PROFILE_NEXT_FRAME();
+		WIESEL_PROFILE_SCOPE("Engine::run");
+
 		for(std::vector<Platform*>::iterator it=platforms.begin(); it!=platforms.end(); it++) {
+			WIESEL_PROFILE_SCOPE("Platform::onRun");
 			Platform *platform = *it;
 			done |= platform->onRun();
 		}
 
 		// measure time of this frame
 		last_t = now_t;
-		now_t  = clock();
-		float dt = (float(now_t - last_t) / CLOCKS_PER_SEC);
+		now_t  = Clock::getTime();
+		float dt = float(now_t - last_t);
 
 		// run all 'runOnMainThread' objects
+		// tasks exceeding the time budget of the last frame will be executed first
+		run_once_queue.takeAll(&run_once);
+
 		if (run_once.empty() == false) {
-			mainthread->lock();
+			WIESEL_PROFILE_SCOPE("Engine::runOnMainThread");
+			double tasks_start_t = Clock::getTime();
+			size_t executed = 0;
+
+			while(executed < run_once.size()) {
+				IRunnable *runnable = run_once[executed++];
+				runnable->run();
+				release(runnable);
+
+				if (
+						main_thread_task_budget > 0.0f
+					&&	(Clock::getTime() - tasks_start_t) >= main_thread_task_budget
+				) {
+					break;
+				}
+			}
+
+			run_once.erase(run_once.begin(), run_once.begin() + executed);
+		}
 
-			for(std::vector<IRunnable*>::iterator it=run_once.begin(); it!=run_once.end();) {
-				(*it)->run();
-				release(*it);
+		// in fixed timestep mode, run as many updates as fit into the elapsed time
+		if (fixed_timestep > 0.0f) {
+			fixed_time_accumulator += std::min(double(dt), MAX_FIXED_FRAME_TIME);
 
-				it = run_once.erase(it);
+			while(fixed_time_accumulator >= fixed_timestep) {
+				updateUpdateables(fixed_timestep);
+				fixed_time_accumulator -= fixed_timestep;
 			}
 
-			mainthread->unlock();
+			interpolation_alpha = float(fixed_time_accumulator / fixed_timestep);
+		}
+		else {
+			updateUpdateables(dt);
+			interpolation_alpha = 1.0f;
 		}
 
-		// run all updateable objects
-		for(int i=updateables.size(); --i>=0;) {
-			updateables.at(i)->update(dt);
+		// update the transforms of all scenes, before the application renders them
+		const SceneList *scenes = application->getSceneStack();
+		for(SceneList::const_iterator it=scenes->begin(); it!=scenes->end(); it++) {
+			WIESEL_PROFILE_SCOPE("Scene::updateTransforms");
+			(*it)->updateTransforms(jobs);
 		}
 
 		// the application's onRun will be invoked every frame
 		// the application may decide itself, what to do in each state
-		application->onRun(dt);
+		{
+			WIESEL_PROFILE_SCOPE("Application::onRun");
+			application->onRun(dt);
+		}
 
 		// free the latest autorelease object
 		autorelease(NULL);
 
 		// exit requested by application?
 		done |= exit_requested;
+
+		// wait for the next frame, when running faster than the frame rate limit
+		if (frame_rate_limit > 0.0f && !done) {
+			WIESEL_PROFILE_SCOPE("Engine::frameRateLimit");
+			Clock::sleepUntil(now_t + 1.0 / frame_rate_limit);
+		}
 	}
 	while(!done);
 
@@ -255,6 +340,26 @@ void Engine::run(Application *app) {
 	application->onShutdown();
 	clear_ref(application);
 
+	delete jobs;
+	jobs = NULL;
+
+	return;
+}
+
+
+void Engine::updateUpdateables(float dt) {
+	WIESEL_PROFILE_SCOPE("Engine::updateUpdateables");
+
+	// run all thread-safe updateable objects in parallel
+	updateThreadSafeUpdateables(jobs, updateables, dt);
+
+	// run all other updateable objects
+	for(int i=updateables.size(); --i>=0;) {
+		if (updateables.at(i)->isThreadSafe() == false) {
+			updateables.at(i)->update(dt);
+		}
+	}
+
 	return;
 }
 
@@ -287,13 +392,27 @@ void Engine::unregisterUpdateable(IUpdateable* updateable) {
 
 
 void Engine::runOnMainThread(IRunnable* runnable) {
-	mainthread->lock();
+	run_once_queue.push(runnable);
+	return;
+}
+
+
+void Engine::setMainThreadTaskBudget(float seconds) {
+	this->main_thread_task_budget = seconds;
+	return;
+}
 
-	std::vector<IRunnable*>::iterator it = std::find(run_once.begin(), run_once.end(), runnable);
-	if (it == run_once.end()) {
-		run_once.push_back(keep(runnable));
-	}
 
-	mainthread->unlock();
+void Engine::setFixedTimestep(float seconds) {
+	this->fixed_timestep			= seconds;
+	this->fixed_time_accumulator	= 0.0;
+	this->interpolation_alpha		= 1.0f;
+	return;
+}
+
+
+void Engine::setFrameRateLimit(float fps) {
+	this->frame_rate_limit = fps;
+	return;
 }
 
@@ -28,6 +28,8 @@
 #include "application.h"
 #include "engine_interfaces.h"
 
+#include <wiesel/util/task_queue.h>
+
 #include <string>
 
 
@@ -38,6 +40,7 @@ namespace wiesel {
 	class DataSource;
 	class FileSystem;
 	class IRunnable;
+	class JobSystem;
 	class Thread;
 	class TouchHandler;
 
@@ -152,18 +155,106 @@ namespace wiesel {
 		/**
 		 * @brief Registers a task, which will be executed on the main thread.
 		 * The task will be exewcuted only once and released after that.
+		 * This function can be called from any thread without blocking.
 		 */
 		void runOnMainThread(IRunnable *runnable);
 
+		/**
+		 * @brief Limits the time spent each frame for executing tasks registered
+		 * via \ref runOnMainThread. Tasks exceeding the budget will be executed
+		 * within the next frames. At least one task will be executed each frame.
+		 * @param seconds	The time budget in seconds or zero for no limit.
+		 */
+		void setMainThreadTaskBudget(float seconds);
+
+		/**
+		 * @brief Get the time budget for executing main thread tasks each frame.
+		 * @return The time budget in seconds or zero, when there's no limit.
+		 */
+		inline float getMainThreadTaskBudget() const {
+			return main_thread_task_budget;
+		}
+
+	// timing
+	public:
+		/**
+		 * @brief Enables the fixed timestep mode, where all \ref IUpdateable objects
+		 * will be updated with a constant time step, independent from the frame rate.
+		 * Depending on the time elapsed, there may be multiple or no updates each frame.
+		 * The remaining time can be used to interpolate between the last two
+		 * simulation states, see \ref getInterpolationAlpha.
+		 * @param seconds	The time step in seconds or zero to update once each frame
+		 *					with the time elapsed since the last frame.
+		 */
+		void setFixedTimestep(float seconds);
+
+		/**
+		 * @brief Get the time step used in fixed timestep mode.
+		 * @return The time step in seconds or zero, when the fixed timestep mode is disabled.
+		 */
+		inline float getFixedTimestep() const {
+			return fixed_timestep;
+		}
+
+		/**
+		 * @brief Get the fraction of a time step, which was not yet simulated in this frame.
+		 * Rendering can use this value to interpolate between the previous and the
+		 * current simulation state. Without a fixed timestep, this is always 1.0.
+		 */
+		inline float getInterpolationAlpha() const {
+			return interpolation_alpha;
+		}
+
+		/**
+		 * @brief Limits the number of frames per second.
+		 * When a frame finishes early, the main thread sleeps until the next frame is due.
+		 * @param fps	The maximum number of frames per second or zero for no limit.
+		 */
+		void setFrameRateLimit(float fps);
+
+		/**
+		 * @brief Get the maximum number of frames per second.
+		 * @return The frame rate limit or zero, when there's no limit.
+		 */
+		inline float getFrameRateLimit() const {
+			return frame_rate_limit;
+		}
+
+	// workers
+	public:
+		/**
+		 * @brief Get the job system used to update scenes and thread-safe updateables in parallel.
+		 * The job system will be available while the main loop is running.
+		 * Results of jobs can be handed back to the main thread
+		 * via \ref JobSystem::runOnMainThreadAfter.
+		 * @return The engine's job system or \c NULL, when the main loop is not running.
+		 */
+		inline JobSystem *getJobSystem() {
+			return jobs;
+		}
+
+	private:
+		/**
+		 * @brief Updates all registered \ref IUpdateable objects.
+		 */
+		void updateUpdateables(float dt);
+
 	// static members
 	private:
 		static Engine					instance;
 	
 	// instance members
 	private:
-		Thread*							mainthread;
+		JobSystem*						jobs;
 
+		TaskQueue						run_once_queue;
 		std::vector<IRunnable*>			run_once;
+		float							main_thread_task_budget;
+
+		float							fixed_timestep;
+		double							fixed_time_accumulator;
+		float							interpolation_alpha;
+		float							frame_rate_limit;
 		std::vector<IUpdateable*>		updateables;
 
 		bool							exit_requested;
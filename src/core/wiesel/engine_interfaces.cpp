@@ -21,9 +21,28 @@
  */
 #include "engine_interfaces.h"
 
+#include <wiesel/util/job_system.h>
+
 using namespace wiesel;
 
 
+/**
+ * @brief Updates a range of thread-safe updateable objects.
+ */
+struct UpdateableRange
+{
+	const std::vector<IUpdateable*>*	updateables;
+	float								dt;
+
+	void operator()(size_t begin, size_t end) {
+		for(size_t i=begin; i<end; i++) {
+			(*updateables)[i]->update(dt);
+		}
+	}
+};
+
+
+
 IUpdateable::IUpdateable() {
 	return;
 }
@@ -32,3 +51,32 @@ IUpdateable::~IUpdateable() {
 	return;
 }
 
+bool IUpdateable::isThreadSafe() const {
+	return false;
+}
+
+
+
+
+void wiesel::updateThreadSafeUpdateables(JobSystem *jobs, const std::vector<IUpdateable*> &updateables, float dt) {
+	std::vector<IUpdateable*> thread_safe_updateables;
+	for(int i=updateables.size(); --i>=0;) {
+		if (updateables.at(i)->isThreadSafe()) {
+			thread_safe_updateables.push_back(updateables.at(i));
+		}
+	}
+
+	UpdateableRange body;
+	body.updateables	= &thread_safe_updateables;
+	body.dt				= dt;
+
+	if (jobs) {
+		jobs->parallelFor(0, thread_safe_updateables.size(), 1, body);
+	}
+	else {
+		body(0, thread_safe_updateables.size());
+	}
+
+	return;
+}
+
@@ -26,9 +26,14 @@
 
 #include <wiesel/util/shared_object.h>
 
+#include <vector>
+
 
 namespace wiesel {
 
+	class JobSystem;
+
+
 	/**
 	 * @brief Interface for classes, which wants to receive periodically updates.
 	 * To receive updates, the object has to be received on the engine object.
@@ -46,8 +51,32 @@ namespace wiesel {
 		 * @param dt The time which has elapsed since the last update in seconds.
 		 */
 		virtual void update(float dt) = 0;
+
+		/**
+		 * @brief Tells the engine, whether this object can be updated on a worker thread.
+		 * Thread-safe objects will be updated in parallel with other thread-safe objects,
+		 * so they must neither access shared data without synchronization, nor
+		 * register or unregister any updateables within \ref update.
+		 * Thread-safe objects must not modify the scene graph, even when each object
+		 * only changes it's own nodes: changing a node's transformation, bounds or
+		 * children updates the state of all it's parents and a global transform epoch
+		 * without synchronization. Keeping and releasing references is allowed.
+		 * The default implementation returns \c false.
+		 */
+		virtual bool isThreadSafe() const;
 	};
 
+
+	/**
+	 * @brief Updates all thread-safe objects of a list in parallel.
+	 * Returns, when all of them have been updated. Objects, which are
+	 * not thread-safe will be skipped.
+	 * @param jobs			The job system to be used or \c NULL to update on the calling thread.
+	 * @param updateables	The objects to be updated.
+	 * @param dt			The time which has elapsed since the last update in seconds.
+	 */
+	void WIESEL_CORE_EXPORT updateThreadSafeUpdateables(JobSystem *jobs, const std::vector<IUpdateable*> &updateables, float dt);
+
 }
 
 #endif /* __WIESEL_ENGINE_INTERFACES_H__ */
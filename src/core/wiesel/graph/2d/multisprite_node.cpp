@@ -27,6 +27,9 @@
 #include "wiesel/video/shaders.h"
 #include "wiesel/video/video_driver.h"
 
+#include <algorithm>
+#include <typeinfo>
+
 using namespace wiesel;
 using namespace wiesel::video;
 
@@ -36,6 +39,13 @@ MultiSpriteNode::MultiSpriteNode() {
 	this->vbo			= NULL;
 	this->vbo_dirty		= true;
 	this->hit_detection	= SpriteHitDetection_InnerBounds;
+	this->hit_grid		= NULL;
+	this->default_shader		= NULL;
+	this->instancing_enabled	= false;
+	this->instances				= NULL;
+	this->unit_quad				= NULL;
+	this->instances_dirty		= true;
+	this->instances_compatible	= false;
 
 	return;
 }
@@ -46,6 +56,13 @@ MultiSpriteNode::MultiSpriteNode(Texture *texture) {
 	this->vbo			= NULL;
 	this->vbo_dirty		= true;
 	this->hit_detection	= SpriteHitDetection_InnerBounds;
+	this->hit_grid		= NULL;
+	this->default_shader		= NULL;
+	this->instancing_enabled	= false;
+	this->instances				= NULL;
+	this->unit_quad				= NULL;
+	this->instances_dirty		= true;
+	this->instances_compatible	= false;
 
 	setTexture(texture);
 
@@ -55,6 +72,8 @@ MultiSpriteNode::MultiSpriteNode(Texture *texture) {
 
 MultiSpriteNode::~MultiSpriteNode() {
 	clear_ref(vbo);
+	clear_ref(instances);
+	clear_ref(unit_quad);
 
 	setTexture(NULL);
 	clear();
@@ -63,6 +82,11 @@ MultiSpriteNode::~MultiSpriteNode() {
 }
 
 
+bool MultiSpriteNode::usesAffineTransform() const {
+	return typeid(*this) == typeid(MultiSpriteNode);
+}
+
+
 MultiSpriteNode::index_t MultiSpriteNode::addSprite(SpriteFrame* sprite, float offset_x, float offset_y) {
 	return addSprite(sprite, vector2d(offset_x, offset_y));
 }
@@ -99,6 +123,15 @@ MultiSpriteNode::index_t MultiSpriteNode::addSprite(SpriteFrame* sprite, const v
 
 		// need to update the vertex buffer
 		vbo_dirty = true;
+		invalidateHitGrid();
+
+		// an existing instance buffer just needs one more instance
+		if (instances && !instances_dirty && instances_compatible && isInstanceCompatible(sprite)) {
+			writeInstance(instances->allocVertices(1), entries.back());
+		}
+		else {
+			instances_dirty = true;
+		}
 
 		return idx;
 	}
@@ -121,6 +154,37 @@ void MultiSpriteNode::removeSprite(index_t idx) {
 
 		// bounds need to be updated
 		updateBounds();
+
+		vbo_dirty = true;
+		instances_dirty = true;
+		invalidateHitGrid();
+	}
+
+	return;
+}
+
+
+void MultiSpriteNode::setSpriteOffset(index_t idx, const vector2d &offset) {
+	assert(idx < entries.size());
+	if (idx < entries.size()) {
+		EntryList::iterator it = entries.begin();
+		std::advance(it, idx);
+
+		it->offset = offset;
+
+		// bounds need to be updated
+		updateBounds();
+
+		vbo_dirty = true;
+		invalidateHitGrid();
+
+		// just update the affected instance
+		if (instances && !instances_dirty && instances_compatible) {
+			writeInstance(instances->editVertexRange(idx, 1), *it);
+		}
+		else {
+			instances_dirty = true;
+		}
 	}
 
 	return;
@@ -134,11 +198,84 @@ void MultiSpriteNode::clear() {
 
 	entries.clear();
 
+	vbo_dirty = true;
+	instances_dirty = true;
+	invalidateHitGrid();
+	setContentDirty();
+
+	return;
+}
+
+
+void MultiSpriteNode::setSpriteHitDetection(SpriteHitDetection hit) {
+	if (this->hit_detection != hit) {
+		this->hit_detection = hit;
+		invalidateHitGrid();
+	}
+
+	return;
+}
+
+
+void MultiSpriteNode::setInstancingEnabled(bool enabled) {
+	this->instancing_enabled = enabled;
 	return;
 }
 
 
+void MultiSpriteNode::invalidateHitGrid() {
+	if (hit_grid) {
+		delete hit_grid;
+		hit_grid = NULL;
+	}
+
+	return;
+}
+
+
+const SpatialGrid *MultiSpriteNode::getHitGrid() const {
+	// for only a few entries, a linear search is fast enough
+	if (hit_grid == NULL && entries.size() >= 16) {
+		// use the average sprite size as cell size
+		float cell_size = 0.0f;
+		for(EntryList::const_iterator it=entries.begin(); it!=entries.end(); it++) {
+			cell_size += std::max(it->sprite->getSize().width, it->sprite->getSize().height);
+		}
+
+		cell_size /= entries.size();
+
+		hit_grid = new SpatialGrid(cell_size > 0.0f ? cell_size : 1.0f);
+
+		SpatialGrid::item_t index = 0;
+		for(EntryList::const_iterator it=entries.begin(); it!=entries.end(); it++, index++) {
+			rectangle bounds;
+
+			if (getSpriteHitDetection() == SpriteHitDetection_InnerBounds) {
+				bounds = it->sprite->getInnerRect();
+				bounds.position += it->offset;
+			}
+			else {
+				bounds = rectangle(it->offset, it->sprite->getSize());
+			}
+
+			hit_grid->insert(index, bounds);
+		}
+	}
+
+	return hit_grid;
+}
+
+
 bool MultiSpriteNode::hitBy(const vector2d& local) const {
+	// use the grid to test only the entries near the given location
+	const SpatialGrid *grid = getHitGrid();
+	if (grid) {
+		SpatialGrid::ItemList candidates;
+		grid->findItemsAt(local, &candidates);
+
+		return candidates.empty() == false;
+	}
+
 	switch(getSpriteHitDetection()) {
 		default:
 		case SpriteHitDetection_OuterBounds: {
@@ -195,15 +332,32 @@ void MultiSpriteNode::onTextureChanged(uint16_t index, Texture *old_texture, Tex
 
 void MultiSpriteNode::onDraw(video::RenderContext *render_context) {
 	if (getTexture() && !entries.empty()) {
+		// draw all sprites as instances of a single quad, unless a custom shader is used
+		if (
+				instancing_enabled
+			&&	render_context->isInstancingSupported()
+			&&	render_context->isCapturing() == false
+			&&	(getShader() == NULL || getShader() == default_shader)
+		) {
+			if (instances_dirty) {
+				rebuildInstanceBuffer();
+			}
+
+			if (instances_compatible) {
+				render_context->setShader(Shaders::instance()->getSpriteInstanceShader());
+				applyTextureConfigTo(render_context);
+				render_context->setModelviewMatrix(getWorldTransform());
+				render_context->drawInstanced(video::TriangleStrip, unit_quad, instances);
+
+				return;
+			}
+		}
+
 		if (vbo_dirty) {
 			rebuildVertexBuffer();
 		}
 
-		applyShaderConfigTo(render_context);
-		applyTextureConfigTo(render_context);
-
-		render_context->setModelviewMatrix(getWorldTransform());
-		render_context->draw(video::Triangles, vbo, indices);
+		render_context->submit(video::Triangles, vbo, indices, getWorldTransform(), this, this);
 	}
 
 	return;
@@ -239,6 +393,9 @@ void MultiSpriteNode::rebuildVertexBuffer() {
 		float texture_w = getTexture()->getSize().width;
 		float texture_h = getTexture()->getSize().height;
 
+		// allocate all vertices at once and write them sequentially
+		VertexBuffer::Cursor cursor = vbo->addVertices(entries.size() * 4);
+
 		for (EntryList::const_iterator it=entries.begin(); it!=entries.end(); it++) {
 			SpriteFrame *frame = it->sprite;
 
@@ -248,33 +405,104 @@ void MultiSpriteNode::rebuildVertexBuffer() {
 			float sprite_w = frame->getInnerRect().size.width;
 			float sprite_h = frame->getInnerRect().size.height;
 
-			VertexBuffer::index_t idx0 = vbo->addVertex(sprite_x,            sprite_y + sprite_h);
-			VertexBuffer::index_t idx1 = vbo->addVertex(sprite_x,            sprite_y           );
-			VertexBuffer::index_t idx2 = vbo->addVertex(sprite_x + sprite_w, sprite_y + sprite_h);
-			VertexBuffer::index_t idx3 = vbo->addVertex(sprite_x + sprite_w, sprite_y           );
-
-			vbo->setVertexTextureCoordinate(idx0, tex_coords.tl.u/texture_w, tex_coords.tl.v/texture_h);
-			vbo->setVertexTextureCoordinate(idx1, tex_coords.bl.u/texture_w, tex_coords.bl.v/texture_h);
-			vbo->setVertexTextureCoordinate(idx2, tex_coords.tr.u/texture_w, tex_coords.tr.v/texture_h);
-			vbo->setVertexTextureCoordinate(idx3, tex_coords.br.u/texture_w, tex_coords.br.v/texture_h);
-
-			indices->addIndex(idx0);
-			indices->addIndex(idx1);
-			indices->addIndex(idx2);
-			indices->addIndex(idx1);
-			indices->addIndex(idx3);
-			indices->addIndex(idx2);
+			cursor.position(sprite_x,            sprite_y + sprite_h).texcoord(tex_coords.tl.u/texture_w, tex_coords.tl.v/texture_h).next();
+			cursor.position(sprite_x,            sprite_y           ).texcoord(tex_coords.bl.u/texture_w, tex_coords.bl.v/texture_h).next();
+			cursor.position(sprite_x + sprite_w, sprite_y + sprite_h).texcoord(tex_coords.tr.u/texture_w, tex_coords.tr.v/texture_h).next();
+			cursor.position(sprite_x + sprite_w, sprite_y           ).texcoord(tex_coords.br.u/texture_w, tex_coords.br.v/texture_h).next();
 		}
+
+		// two triangles per quad
+		indices->addQuads(0, entries.size());
 	}
 
 	if (getShader() == NULL) {
-		setShader(Shaders::instance()->getShaderFor(vbo));
+		default_shader = Shaders::instance()->getShaderFor(vbo);
+		setShader(default_shader);
 	}
 
 	return;
 }
 
 
+void MultiSpriteNode::rebuildInstanceBuffer() {
+	if (instances == NULL) {
+		instances = keep(new TVertexBuffer<SpriteInstance>());
+	}
+
+	// a quad from (0,0) to (1,1), which will be scaled and moved by each instance
+	if (unit_quad == NULL) {
+		unit_quad = keep(new VertexBuffer());
+		unit_quad->setupVertexPositions(2);
+		unit_quad->addVertex(0.0f, 0.0f);
+		unit_quad->addVertex(1.0f, 0.0f);
+		unit_quad->addVertex(0.0f, 1.0f);
+		unit_quad->addVertex(1.0f, 1.0f);
+	}
+
+	if (instances_dirty) {
+		instances_dirty      = false;
+		instances_compatible = true;
+
+		instances->reset();
+
+		for (EntryList::const_iterator it=entries.begin(); it!=entries.end(); it++) {
+			if (isInstanceCompatible(it->sprite) == false) {
+				instances_compatible = false;
+				instances->reset();
+				break;
+			}
+		}
+
+		if (instances_compatible) {
+			SpriteInstance *instance = instances->allocVertices(entries.size());
+
+			for (EntryList::const_iterator it=entries.begin(); it!=entries.end(); it++, instance++) {
+				writeInstance(instance, *it);
+			}
+		}
+	}
+
+	return;
+}
+
+
+bool MultiSpriteNode::isInstanceCompatible(const SpriteFrame *frame) const {
+	// the texture coordinates will be interpolated between two corners,
+	// so rotated or skewed frames cannot be drawn as instance
+	const SpriteFrame::TextureCoords &tex_coords = frame->getTextureCoordinates();
+
+	return
+			tex_coords.tl.u == tex_coords.bl.u
+		&&	tex_coords.tr.u == tex_coords.br.u
+		&&	tex_coords.tl.v == tex_coords.tr.v
+		&&	tex_coords.bl.v == tex_coords.br.v
+	;
+}
+
+
+void MultiSpriteNode::writeInstance(SpriteInstance *instance, const Entry &entry) const {
+	const SpriteFrame *frame = entry.sprite;
+	const SpriteFrame::TextureCoords &tex_coords = frame->getTextureCoordinates();
+	float texture_w = getTexture()->getSize().width;
+	float texture_h = getTexture()->getSize().height;
+
+	instance->x  = frame->getInnerRect().position.x + entry.offset.x;
+	instance->y  = frame->getInnerRect().position.y + entry.offset.y;
+	instance->r  = 0xff;
+	instance->g  = 0xff;
+	instance->b  = 0xff;
+	instance->a  = 0xff;
+	instance->w  = frame->getInnerRect().size.width;
+	instance->h  = frame->getInnerRect().size.height;
+	instance->u0 = tex_coords.bl.u / texture_w;
+	instance->v0 = tex_coords.bl.v / texture_h;
+	instance->u1 = tex_coords.tr.u / texture_w;
+	instance->v1 = tex_coords.tr.v / texture_h;
+
+	return;
+}
+
+
 void MultiSpriteNode::updateBounds() {
 	rectangle bounds;
 
@@ -25,9 +25,11 @@
 #include <wiesel/wiesel-core.def>
 
 #include "node2d.h"
+#include "wiesel/graph/spatial_index.h"
 #include "sprite_node.h"
 #include "wiesel/video/texture.h"
 #include "wiesel/video/texture_target.h"
+#include "wiesel/video/typed_vertexbuffer.h"
 #include "wiesel/video/vertexbuffer.h"
 #include "wiesel/geometry.h"
 
@@ -51,6 +53,10 @@ namespace wiesel {
 	 *
 	 * This Node is designed to provide a very basic functionality, so each sprite can
 	 * have an individual offset, but no custom transformations like scaling or rotation.
+	 *
+	 * When instancing is enabled and supported by the render context, all sprites will
+	 * be drawn from a single unit quad and a compact per-instance buffer, so changing
+	 * or adding a single sprite only updates one instance instead of rebuilding all vertices.
 	 */
 	class WIESEL_CORE_EXPORT MultiSpriteNode :
 			public Node2D,
@@ -103,6 +109,22 @@ namespace wiesel {
 			return hit_detection;
 		}
 
+		/**
+		 * @brief Enables or disables instanced rendering of the sprites.
+		 * Instancing will only be used, when the render context supports it,
+		 * no custom shader was assigned to this node and the texture
+		 * coordinates of all sprite frames are not rotated.
+		 * Otherwise, the sprites will be drawn from a common vertex buffer.
+		 */
+		void setInstancingEnabled(bool enabled);
+
+		/**
+		 * @brief Checks, if instanced rendering is enabled for this node.
+		 */
+		inline bool isInstancingEnabled() const {
+			return instancing_enabled;
+		}
+
 	// managing entries
 	public:
 		/**
@@ -128,6 +150,13 @@ namespace wiesel {
 		 */
 		void removeSprite(index_t idx);
 
+		/**
+		 * @brief Changes the offset of an existing sprite.
+		 * @param idx		The index of the sprite to be moved.
+		 * @param offset	The new offset of this sprite, relative to this node's bottom left corner.
+		 */
+		void setSpriteOffset(index_t idx, const vector2d &offset);
+
 		/**
 		 * @brief Removes all entries from the list.
 		 */
@@ -144,6 +173,9 @@ namespace wiesel {
 	public:
 		virtual bool hitBy(const vector2d &local) const;
 
+	protected:
+		virtual bool usesAffineTransform() const;
+
 	// TextureTarget
 	protected:
 		virtual void onTextureChanged(uint16_t index, video::Texture *old_texture, video::Texture *new_texture);
@@ -154,8 +186,23 @@ namespace wiesel {
 
 		virtual void rebuildVertexBuffer();
 
+		virtual void rebuildInstanceBuffer();
+
 		virtual void updateBounds();
 
+	private:
+		/// get the grid for hit detection, which will be created when there are enough entries.
+		const SpatialGrid *getHitGrid() const;
+
+		/// removes the grid for hit detection, so it will be rebuilt on the next hit test.
+		void invalidateHitGrid();
+
+		/// checks, if a sprite frame can be drawn as an instance of the unit quad.
+		bool isInstanceCompatible(const SpriteFrame *frame) const;
+
+		/// writes the instance data of a single entry.
+		void writeInstance(video::SpriteInstance *instance, const Entry &entry) const;
+
 	private:
 		SpriteHitDetection		hit_detection;
 
@@ -164,6 +211,16 @@ namespace wiesel {
 		video::IndexBuffer*		indices;
 		video::VertexBuffer*	vbo;
 		bool					vbo_dirty;
+		video::Shader*			default_shader;
+
+		bool					instancing_enabled;
+		video::TVertexBuffer<video::SpriteInstance>*
+								instances;
+		video::VertexBuffer*	unit_quad;
+		bool					instances_dirty;
+		bool					instances_compatible;
+
+		mutable SpatialGrid*	hit_grid;
 	};
 
 }
@@ -22,7 +22,9 @@
 #include "node2d.h"
 
 #include <wiesel/math/utils.h>
+#include <algorithm>
 #include <cmath>
+#include <typeinfo>
 
 using namespace wiesel;
 
@@ -48,6 +50,7 @@ Node2D::~Node2D() {
 
 void Node2D::setContentSize(const dimension &size) {
 	this->bounds.size = size;
+	setTransformDirty();
 	return;
 }
 
@@ -124,13 +127,13 @@ void Node2D::setScaleY(float sy) {
 }
 
 
-void Node2D::computeLocalTransform(matrix4x4 *transform) {
-	vector2d pivot_in_units = getPivotInUnits();
+affine2d Node2D::getLocalAffineTransform() const {
+	return affine2d::compose(getPivotInUnits(), scale_x, scale_y, deg2rad(rotation), position);
+}
 
-	transform->translate(-pivot_in_units.x, -pivot_in_units.y);
-	transform->scale(scale_x, scale_y, 1.0f);
-	transform->rotateZ(deg2rad(rotation));
-	transform->translate(position.x, position.y);
+
+void Node2D::computeLocalTransform(matrix4x4 *transform) {
+	(*transform) *= getLocalAffineTransform().toMatrix4x4();
 
 	Node::computeLocalTransform(transform);
 
@@ -138,6 +141,64 @@ void Node2D::computeLocalTransform(matrix4x4 *transform) {
 }
 
 
+void Node2D::computeWorldTransform(const matrix4x4 *parent_world, matrix4x4 *transform) {
+	if (usesAffineTransform() == false) {
+		Node::computeWorldTransform(parent_world, transform);
+		return;
+	}
+
+	affine2d local_transform = getLocalAffineTransform();
+
+	if (parent_world) {
+		*transform = local_transform * (*parent_world);
+	}
+	else {
+		*transform = local_transform.toMatrix4x4();
+	}
+
+	return;
+}
+
+
+bool Node2D::usesAffineTransform() const {
+	return typeid(*this) == typeid(Node2D);
+}
+
+
+Node::BoundsType Node2D::computeWorldBounds(rectangle *bounds) {
+	// plain Node2D objects don't draw anything, but subclasses may draw
+	// without setting a content size, so they can never be culled.
+	if (getBounds().size.width == 0.0f || getBounds().size.height == 0.0f) {
+		return typeid(*this) == typeid(Node2D) ? BoundsEmpty : BoundsInfinite;
+	}
+
+	vector2d corners[4] = {
+			vector2d(getBounds().getMinX(), getBounds().getMinY()),
+			vector2d(getBounds().getMaxX(), getBounds().getMinY()),
+			vector2d(getBounds().getMinX(), getBounds().getMaxY()),
+			vector2d(getBounds().getMaxX(), getBounds().getMaxY()),
+	};
+
+	getWorldTransform().transform(corners, corners, 4);
+
+	float min_x = corners[0].x;
+	float max_x = corners[0].x;
+	float min_y = corners[0].y;
+	float max_y = corners[0].y;
+
+	for(int i=1; i<4; i++) {
+		min_x = std::min(min_x, corners[i].x);
+		max_x = std::max(max_x, corners[i].x);
+		min_y = std::min(min_y, corners[i].y);
+		max_y = std::max(max_y, corners[i].y);
+	}
+
+	*bounds = rectangle(min_x, min_y, max_x - min_x, max_y - min_y);
+
+	return BoundsFinite;
+}
+
+
 bool Node2D::hitBy(const vector2d& local) const {
 	// when 'local' is already in local coordinate space,
 	// the pivot offset is already included in the 'local' coordinate
@@ -25,6 +25,7 @@
 #include <wiesel/wiesel-core.def>
 
 #include "wiesel/graph/node.h"
+#include "wiesel/math/affine2d.h"
 #include "wiesel/math/vector2d.h"
 #include "wiesel/geometry.h"
 
@@ -126,10 +127,32 @@ namespace wiesel {
 			return scale_x;
 		}
 
+		/// get the transformation of this node relative to it's parent
+		/// as computed from pivot, scale, rotation and position.
+		affine2d getLocalAffineTransform() const;
+
 	protected:
 		/// update the transform matrices
 		virtual void computeLocalTransform(matrix4x4 *transform);
 
+		/// computes the world transform from the node's 2D transformation
+		/// without building a 4x4 matrix of the local transform, when
+		/// usesAffineTransform returns true. Otherwise the implementation
+		/// of Node will be used, which calls computeLocalTransform.
+		virtual void computeWorldTransform(const matrix4x4 *parent_world, matrix4x4 *transform);
+
+		/// checks, if the world transform can be computed from the node's 2D transformation
+		/// without calling computeLocalTransform. This is only true for the exact Node2D class,
+		/// so subclasses overriding computeLocalTransform will never be skipped.
+		/// subclasses may opt in by overriding this function, if their local transform
+		/// is the same as Node2D's.
+		virtual bool usesAffineTransform() const;
+
+		/// computes the bounding rectangle of this node's bounds in world coordinates.
+		/// subclasses without a content size have unknown bounds and will never be culled,
+		/// while plain Node2D objects without a content size do not cover any area.
+		virtual BoundsType computeWorldBounds(rectangle *bounds);
+
 	public:
 		/// Tests, if a point is within this node.
 		/// The point should already be transformed into the node's coordinate system.
@@ -23,6 +23,7 @@
 
 #include <wiesel/video/render_context.h>
 #include <wiesel/video/shaders.h>
+#include <typeinfo>
 
 
 #define VERTEX_INDEX_TL		0
@@ -63,6 +64,11 @@ RectShapeNode::~RectShapeNode() {
 }
 
 
+bool RectShapeNode::usesAffineTransform() const {
+	return typeid(*this) == typeid(RectShapeNode);
+}
+
+
 
 void RectShapeNode::setRect(const rectangle& rect) {
 	setRect(rect.position.x, rect.position.y, rect.size.width, rect.size.height);
@@ -109,6 +115,8 @@ void RectShapeNode::setColor(float r, float g, float b, float a) {
 	vbo->setVertexColor(VERTEX_INDEX_TR, r, g, b, a);
 	vbo->setVertexColor(VERTEX_INDEX_BR, r, g, b, a);
 
+	setContentDirty();
+
 	return;
 }
 
@@ -121,6 +129,8 @@ void RectShapeNode::setColorTopLeft(float r, float g, float b, float a) {
 
 	vbo->setVertexColor(VERTEX_INDEX_TL, r, g, b, a);
 
+	setContentDirty();
+
 	return;
 }
 
@@ -133,6 +143,8 @@ void RectShapeNode::setColorTopRight(float r, float g, float b, float a) {
 
 	vbo->setVertexColor(VERTEX_INDEX_TR, r, g, b, a);
 
+	setContentDirty();
+
 	return;
 }
 
@@ -144,6 +156,8 @@ void RectShapeNode::setColorBottomLeft(float r, float g, float b, float a) {
 
 	vbo->setVertexColor(VERTEX_INDEX_BL, r, g, b, a);
 
+	setContentDirty();
+
 	return;
 }
 
@@ -156,6 +170,8 @@ void RectShapeNode::setColorBottomRight(float r, float g, float b, float a) {
 
 	vbo->setVertexColor(VERTEX_INDEX_BR, r, g, b, a);
 
+	setContentDirty();
+
 	return;
 }
 
@@ -163,9 +179,7 @@ void RectShapeNode::setColorBottomRight(float r, float g, float b, float a) {
 
 void RectShapeNode::onDraw(RenderContext* render_context) {
 	if (vbo) {
-		this->applyShaderConfigTo(render_context);
-		render_context->setModelviewMatrix(getWorldTransform());
-		render_context->draw(video::TriangleStrip, vbo);
+		render_context->submit(video::TriangleStrip, vbo, getWorldTransform(), this, NULL);
 	}
 
 	return;
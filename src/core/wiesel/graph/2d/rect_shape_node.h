@@ -125,6 +125,9 @@ namespace wiesel {
 	public:
 		virtual void onDraw(video::RenderContext *render_context);
 
+	protected:
+		virtual bool usesAffineTransform() const;
+
 	private:
 		/**
 		 * @brief Ensure a vertex buffer with four vertices exists.
@@ -26,6 +26,8 @@
 #include "wiesel/video/shaders.h"
 #include "wiesel/video/video_driver.h"
 
+#include <typeinfo>
+
 using namespace wiesel;
 using namespace wiesel::video;
 
@@ -92,6 +94,11 @@ SpriteNode::~SpriteNode() {
 }
 
 
+bool SpriteNode::usesAffineTransform() const {
+	return typeid(*this) == typeid(SpriteNode);
+}
+
+
 void SpriteNode::setSpriteFrame(SpriteFrame* sprite) {
 	if (this->sprite != sprite) {
 		if (this->sprite) {
@@ -160,6 +167,7 @@ void SpriteNode::onTextureChanged(uint16_t index, Texture *old_texture, Texture
 
 	// need to update the vertex buffer
 	vbo_dirty = true;
+	setContentDirty();
 
 	return;
 }
@@ -171,11 +179,7 @@ void SpriteNode::onDraw(video::RenderContext *render_context) {
 			rebuildVertexBuffer();
 		}
 
-		this->applyShaderConfigTo(render_context);
-		this->applyTextureConfigTo(render_context);
-
-		render_context->setModelviewMatrix(getWorldTransform());
-		render_context->draw(video::TriangleStrip, vbo);
+		render_context->submit(video::TriangleStrip, vbo, getWorldTransform(), this, this);
 	}
 
 	return;
@@ -184,7 +188,7 @@ void SpriteNode::onDraw(video::RenderContext *render_context) {
 
 void SpriteNode::rebuildVertexBuffer() {
 	if (vbo == NULL) {
-		vbo = keep(new VertexBuffer());
+		vbo = keep(new TVertexBuffer<VertexP2T2>());
 	}
 
 	if (vbo_dirty) {
@@ -200,18 +204,12 @@ void SpriteNode::rebuildVertexBuffer() {
 			float texture_w = getTexture()->getSize().width;
 			float texture_h = getTexture()->getSize().height;
 
-			vbo->clear();
-			vbo->setupVertexPositions(2);
-			vbo->setupTextureLayer(0);
-			vbo->addVertex(sprite_x,            sprite_y + sprite_h);
-			vbo->addVertex(sprite_x,            sprite_y           );
-			vbo->addVertex(sprite_x + sprite_w, sprite_y + sprite_h);
-			vbo->addVertex(sprite_x + sprite_w, sprite_y           );
-
-			vbo->setVertexTextureCoordinate(0, tex_coords.tl.u/texture_w, tex_coords.tl.v/texture_h);
-			vbo->setVertexTextureCoordinate(1, tex_coords.bl.u/texture_w, tex_coords.bl.v/texture_h);
-			vbo->setVertexTextureCoordinate(2, tex_coords.tr.u/texture_w, tex_coords.tr.v/texture_h);
-			vbo->setVertexTextureCoordinate(3, tex_coords.br.u/texture_w, tex_coords.br.v/texture_h);
+			vbo->reset();
+			VertexP2T2 *vertices = vbo->allocVertices(4);
+			vertices[0] = VertexP2T2(sprite_x,            sprite_y + sprite_h, tex_coords.tl.u/texture_w, tex_coords.tl.v/texture_h);
+			vertices[1] = VertexP2T2(sprite_x,            sprite_y,            tex_coords.bl.u/texture_w, tex_coords.bl.v/texture_h);
+			vertices[2] = VertexP2T2(sprite_x + sprite_w, sprite_y + sprite_h, tex_coords.tr.u/texture_w, tex_coords.tr.v/texture_h);
+			vertices[3] = VertexP2T2(sprite_x + sprite_w, sprite_y,            tex_coords.br.u/texture_w, tex_coords.br.v/texture_h);
 		}
 		else {
 			float sprite_x   = 0.0f;
@@ -225,18 +223,12 @@ void SpriteNode::rebuildVertexBuffer() {
 			float texcoord_r = texture_rect.getMaxX() / texture_w;
 			float texcoord_b = texture_rect.getMaxY() / texture_h;
 
-			vbo->clear();
-			vbo->setupVertexPositions(2);
-			vbo->setupTextureLayer(0);
-			vbo->addVertex(sprite_x, sprite_h);
-			vbo->addVertex(sprite_x, sprite_y);
-			vbo->addVertex(sprite_w, sprite_h);
-			vbo->addVertex(sprite_w, sprite_y);
-
-			vbo->setVertexTextureCoordinate(0, 0, texcoord_l, texcoord_t);
-			vbo->setVertexTextureCoordinate(1, 0, texcoord_l, texcoord_b);
-			vbo->setVertexTextureCoordinate(2, 0, texcoord_r, texcoord_t);
-			vbo->setVertexTextureCoordinate(3, 0, texcoord_r, texcoord_b);
+			vbo->reset();
+			VertexP2T2 *vertices = vbo->allocVertices(4);
+			vertices[0] = VertexP2T2(sprite_x, sprite_h, texcoord_l, texcoord_t);
+			vertices[1] = VertexP2T2(sprite_x, sprite_y, texcoord_l, texcoord_b);
+			vertices[2] = VertexP2T2(sprite_w, sprite_h, texcoord_r, texcoord_t);
+			vertices[3] = VertexP2T2(sprite_w, sprite_y, texcoord_r, texcoord_b);
 		}
 	}
 
@@ -29,7 +29,7 @@
 #include "wiesel/video/shader_target.h"
 #include "wiesel/video/texture.h"
 #include "wiesel/video/texture_target.h"
-#include "wiesel/video/vertexbuffer.h"
+#include "wiesel/video/typed_vertexbuffer.h"
 #include "wiesel/geometry.h"
 
 
@@ -138,6 +138,9 @@ namespace wiesel {
 	public:
 		virtual bool hitBy(const vector2d &local) const;
 
+	protected:
+		virtual bool usesAffineTransform() const;
+
 	// TextureTarget
 	protected:
 		virtual void onTextureChanged(uint16_t index, video::Texture *old_texture, video::Texture *new_texture);
@@ -154,8 +157,8 @@ namespace wiesel {
 		SpriteFrame*			sprite;
 		rectangle				texture_rect;
 
-		video::VertexBuffer*	vbo;
-		bool					vbo_dirty;
+		video::TVertexBuffer<video::VertexP2T2>*	vbo;
+		bool										vbo_dirty;
 	};
 
 }
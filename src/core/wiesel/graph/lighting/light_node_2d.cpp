@@ -21,6 +21,8 @@
  */
 #include "light_node_2d.h"
 
+#include <typeinfo>
+
 using namespace wiesel;
 
 
@@ -33,6 +35,11 @@ LightNode2D::~LightNode2D() {
 }
 
 
+bool LightNode2D::usesAffineTransform() const {
+	return typeid(*this) == typeid(LightNode2D);
+}
+
+
 void LightNode2D::setLightZPosition(float z) {
 	this->light_z = z;
 }
@@ -65,6 +65,8 @@ namespace wiesel {
 	protected:
 		virtual void onDraw(wiesel::video::RenderContext *render_context);
 
+		virtual bool usesAffineTransform() const;
+
 	private:
 		float		light_z;
 	};
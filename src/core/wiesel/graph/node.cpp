@@ -20,8 +20,11 @@
  * Boston, MA 02110-1301 USA
  */
 #include "node.h"
+#include "spatial_index.h"
+#include "transform_store.h"
 
 #include "wiesel/engine.h"
+#include "wiesel/video/render_context.h"
 #include "wiesel/video/video_driver.h"
 
 #include <assert.h>
@@ -31,14 +34,31 @@
 using namespace wiesel;
 
 
+uint32_t Node::transform_epoch = 1;
+
+
 
 Node::Node()
  :
-	local_transform(matrix4x4::identity),
 	world_transform(matrix4x4::identity),
 	transform_dirty(true),
+	world_transform_version(0),
+	parent_transform_version(0),
+	validated_transform_epoch(0),
+	transform_store(NULL),
+	transform_store_index(0),
 	visible(true),
-	parent(NULL)
+	parent(NULL),
+	order(0),
+	child_index(0),
+	removed_children(0),
+	subtree_bounds_type(BoundsEmpty),
+	subtree_bounds_dirty(true),
+	subtree_bounds_version(0),
+	spatial_index(NULL),
+	spatial_index_dirty(true),
+	spatial_index_version(0),
+	subtree_content_dirty(true)
 {
 	return;
 }
@@ -47,10 +67,19 @@ Node::Node()
 Node::~Node() {
 	assert(parent == NULL);
 
+	if (spatial_index) {
+		spatial_index->remove(this);
+	}
+
 	// release all remaining children
 	for(NodeList::iterator it=children.begin(); it!=children.end(); it++) {
 		Node *child = *it;
+		if (child == NULL) {
+			continue;
+		}
+
 		child->parent = NULL;
+		child->detachFromSpatialIndex();
 		release(child);
 	}
 
@@ -62,15 +91,38 @@ Node::~Node() {
 
 
 
+static bool SortChildrenPredicate(const Node *a, const Node *b) {
+	return a->getOrderKey() < b->getOrderKey();
+}
+
+
 bool Node::addChild(Node *child, NodeOrder order) {
-	bool added = addChildUnsorted(child);
-	if (!added) {
+	assert(child);
+	assert(child->parent == NULL);
+	if (child == NULL || child->parent) {
+		// the node was already added to a children list.
 		return false;
 	}
 
-	// sort the children
 	child->order = order;
-	sortChildren();
+
+	// appending needs neither a search nor moving any other children
+	if (children.empty() || children.back()->order <= order) {
+		child->child_index = children.size();
+		children.push_back(child);
+	}
+	else {
+		compactChildren();
+
+		// insert behind all children with the same order key
+		NodeList::iterator it = std::upper_bound(children.begin(), children.end(), child, SortChildrenPredicate);
+		size_t index = it - children.begin();
+		children.insert(it, child);
+		updateChildIndices(index);
+	}
+
+	onChildAdded(child);
+	invalidateSubtreeBounds();
 
 	return true;
 }
@@ -79,89 +131,429 @@ bool Node::addChild(Node *child, NodeOrder order) {
 bool Node::addChildUnsorted(Node* child) {
 	assert(child);
 	assert(child->parent == NULL);
-
-	NodeList::iterator it = std::find(children.begin(), children.end(), child);
-	assert(it == children.end());
-	if (child && it != children.end()) {
-		// the node was already added to the children list.
+	if (child == NULL || child->parent) {
+		// the node was already added to a children list.
 		return false;
 	}
 
-	children.push_back(keep(child));
-	child->parent = this;
+	child->child_index = children.size();
+	children.push_back(child);
+
+	onChildAdded(child);
+	invalidateSubtreeBounds();
 
 	return true;
 }
 
 
+bool Node::addChildren(const NodeList &nodes, NodeOrder order) {
+	NodeList added;
+	added.reserve(nodes.size());
+
+	for(NodeList::const_iterator it=nodes.begin(); it!=nodes.end(); it++) {
+		Node *child = *it;
+
+		assert(child);
+		assert(child->parent == NULL);
+		if (child == NULL || child->parent) {
+			continue;
+		}
+
+		child->order  = order;
+		child->parent = this;
+		added.push_back(child);
+	}
+
+	if (added.empty()) {
+		return added.size() == nodes.size();
+	}
+
+	compactChildren();
+
+	// all new children have the same order key, so they can be inserted at once
+	NodeList::iterator it = std::upper_bound(children.begin(), children.end(), added.front(), SortChildrenPredicate);
+	size_t index = it - children.begin();
+	children.insert(it, added.begin(), added.end());
+	updateChildIndices(index);
+
+	for(NodeList::iterator it=added.begin(); it!=added.end(); it++) {
+		onChildAdded(*it);
+	}
+
+	invalidateSubtreeBounds();
+
+	return added.size() == nodes.size();
+}
+
+
+void Node::onChildAdded(Node *child) {
+	keep(child);
+	child->parent = this;
+
+	if (transform_store) {
+		transform_store->invalidate();
+	}
+
+	// the child's world transform depends on it's new parent
+	child->setTransformDirty();
+
+	return;
+}
+
+
 void Node::removeChild(Node* child) {
-	NodeList::iterator it = std::find(children.begin(), children.end(), child);
-	if (it != children.end()) {
-		children.erase(it);
+	if (child == NULL || child->parent != this) {
+		return;
+	}
 
-		assert(child->parent == this);
-		child->parent = NULL;
-		release(child);
+	assert(child->child_index < children.size());
+	assert(children[child->child_index] == child);
+
+	if (child->child_index + 1 == children.size()) {
+		children.pop_back();
+
+		// don't keep removed children at the end of the list
+		while(children.empty() == false && children.back() == NULL) {
+			children.pop_back();
+			--removed_children;
+		}
+	}
+	else {
+		// keep the place of the removed child until the list will be compacted,
+		// so the other children don't need to be moved.
+		children[child->child_index] = NULL;
+		++removed_children;
+	}
+
+	child->parent = NULL;
+	child->child_index = 0;
+	child->detachFromSpatialIndex();
+
+	if (child->transform_store) {
+		child->transform_store->remove(child);
 	}
 
+	child->setTransformDirty();
+	release(child);
+
+	invalidateSubtreeBounds();
+
 	return;
 }
 
 
-static bool SortChildrenPredicate(const Node *a, const Node *b) {
-	return a->getOrderKey() < b->getOrderKey();
+const NodeList *Node::getChildren() {
+	compactChildren();
+	return &children;
 }
 
+
 void Node::sortChildren() {
-	std::sort(children.begin(), children.end(), SortChildrenPredicate);
+	compactChildren();
+	std::stable_sort(children.begin(), children.end(), SortChildrenPredicate);
+	updateChildIndices(0);
+
+	return;
+}
+
+
+void Node::compactChildren() {
+	if (removed_children == 0) {
+		return;
+	}
+
+	NodeList::iterator first_removed = std::find(children.begin(), children.end(), static_cast<Node*>(NULL));
+	size_t first = first_removed - children.begin();
+
+	children.erase(std::remove(first_removed, children.end(), static_cast<Node*>(NULL)), children.end());
+	removed_children = 0;
+
+	// only the children behind the first removed one have been moved
+	updateChildIndices(first);
+
+	return;
+}
+
+
+void Node::updateChildIndices(size_t first) {
+	for(size_t i=first; i<children.size(); i++) {
+		children[i]->child_index = i;
+	}
+
+	return;
 }
 
 
 void Node::setVisible(bool visible) {
-	this->visible = visible;
+	if (this->visible != visible) {
+		this->visible = visible;
+		invalidateSubtreeBounds();
+	}
+}
+
+
+void Node::setContentDirty() {
+	invalidateSubtreeBounds();
+	return;
+}
+
+
+void Node::clearSubtreeContentDirty() {
+	subtree_content_dirty = false;
+
+	for(NodeList::iterator it=children.begin(); it!=children.end(); it++) {
+		if (*it) {
+			(*it)->clearSubtreeContentDirty();
+		}
+	}
+
+	return;
 }
 
 
 void Node::setTransformDirty() {
+	if (transform_store && transform_dirty == false) {
+		transform_store->markDirty(transform_store_index);
+	}
+
 	transform_dirty = true;
+	invalidateSubtreeBounds();
 
-	// set all children "dirty", too
-	for(NodeList::iterator it=children.begin(); it!=children.end(); it++) {
-		(*it)->setTransformDirty();
+	// invalidates the validation of all nodes, but keeps their transforms
+	if (++transform_epoch == 0) {
+		transform_epoch = 1;
 	}
 
 	return;
 }
 
 
+bool Node::isTransformDirty() const {
+	if (transform_store) {
+		return transform_store->isDirty();
+	}
+
+	if (transform_dirty) {
+		return true;
+	}
+
+	// nothing has changed since the last validation
+	if (validated_transform_epoch == transform_epoch) {
+		return false;
+	}
+
+	if (parent) {
+		return
+				parent->isTransformDirty()
+			||	parent->world_transform_version != parent_transform_version
+		;
+	}
+
+	return false;
+}
+
+
 void Node::updateTransform() {
+	// the store updates all of it's nodes at once
+	if (transform_store) {
+		transform_store->update();
+		return;
+	}
+
+	// nothing has changed since the last validation
+	if (validated_transform_epoch == transform_epoch) {
+		return;
+	}
+
+	// changes made while computing the transform need another update
+	uint32_t epoch = transform_epoch;
+
 	// update the parent's transform first, if neccessary
-	if (getParent() && getParent()->isTransformDirty()) {
-		getParent()->updateTransform();
+	Node *parent = getParent();
+	if (parent) {
+		parent->updateTransform();
+	}
+
+	if (transform_dirty || (parent && parent->world_transform_version != parent_transform_version)) {
+		transform_dirty = false;
+
+		if (parent == NULL) {
+			computeWorldTransform(NULL, &world_transform);
+		}
+		else {
+			computeWorldTransform(&(parent->world_transform), &world_transform);
+			parent_transform_version = parent->world_transform_version;
+		}
+
+		// version 0 means the transform was never computed
+		if (++world_transform_version == 0) {
+			world_transform_version = 1;
+		}
+	}
+
+	validated_transform_epoch = epoch;
+
+	return;
+}
+
+
+void Node::updateSubtreeTransforms() {
+	updateTransform();
+
+	for(NodeList::iterator it=children.begin(); it!=children.end(); it++) {
+		if (*it) {
+			(*it)->updateSubtreeTransforms();
+		}
+	}
+
+	return;
+}
+
+
+matrix4x4 Node::getLocalTransform() const {
+	matrix4x4 local_transform = matrix4x4::identity;
+	const_cast<Node*>(this)->computeLocalTransform(&local_transform);
+
+	return local_transform;
+}
+
+
+void Node::computeLocalTransform(matrix4x4* transform) {
+	return;
+}
+
+
+bool Node::dependsOnParentTransform() const {
+	return false;
+}
+
+
+bool Node::hasParentDependentTransform(const Node *subtree) {
+	if (subtree->dependsOnParentTransform()) {
+		return true;
+	}
+
+	for(NodeList::const_iterator it=subtree->children.begin(); it!=subtree->children.end(); it++) {
+		if (*it && hasParentDependentTransform(*it)) {
+			return true;
+		}
 	}
 
-	// compute the local transform
-	local_transform = matrix4x4::identity;
+	return false;
+}
+
+
+void Node::computeWorldTransform(const matrix4x4 *parent_world, matrix4x4 *transform) {
+	matrix4x4 local_transform = matrix4x4::identity;
 	computeLocalTransform(&local_transform);
 
-	if (getParent() == NULL) {
-		world_transform = local_transform;
+	if (parent_world) {
+		*transform = local_transform * (*parent_world);
 	}
 	else {
-		world_transform = local_transform * getParent()->getWorldTransform();
+		*transform = local_transform;
 	}
 
-	transform_dirty = false;
+	return;
+}
+
+
+Node::BoundsType Node::computeWorldBounds(rectangle *bounds) {
+	return BoundsInfinite;
+}
+
+
+void Node::invalidateSubtreeBounds() {
+	// when a node is dirty, all of it's parents are already dirty, too
+	for(Node *node=this; node; node=node->parent) {
+		if (node->subtree_bounds_dirty && node->spatial_index_dirty && node->subtree_content_dirty) {
+			break;
+		}
+
+		node->subtree_bounds_dirty	= true;
+		node->spatial_index_dirty	= true;
+		node->subtree_content_dirty	= true;
+	}
 
 	return;
 }
 
 
-void Node::computeLocalTransform(matrix4x4* transform) {
+void Node::detachFromSpatialIndex() {
+	if (spatial_index) {
+		spatial_index->remove(this);
+	}
+
+	for(NodeList::iterator it=children.begin(); it!=children.end(); it++) {
+		if (*it) {
+			(*it)->detachFromSpatialIndex();
+		}
+	}
+
 	return;
 }
 
 
+Node::BoundsType Node::getWorldBounds(rectangle *bounds) {
+	updateTransform();
+
+	return computeWorldBounds(bounds);
+}
+
+
+Node::BoundsType Node::getSubtreeBounds(rectangle *bounds) {
+	updateTransform();
+
+	// the cached bounds are outdated, when this node or any of it's parents has moved
+	if (subtree_bounds_dirty || subtree_bounds_version != world_transform_version) {
+		subtree_bounds_type = computeWorldBounds(&subtree_bounds);
+
+		// all children need to be updated, even if the result is already infinite,
+		// otherwise they would not notify this node about further changes.
+		for(NodeList::iterator it=children.begin(); it!=children.end(); it++) {
+			if (*it == NULL) {
+				continue;
+			}
+
+			rectangle child_bounds;
+			BoundsType child_bounds_type = (*it)->getSubtreeBounds(&child_bounds);
+
+			switch(child_bounds_type) {
+				case BoundsEmpty: {
+					break;
+				}
+
+				case BoundsFinite: {
+					if (subtree_bounds_type == BoundsEmpty) {
+						subtree_bounds = child_bounds;
+						subtree_bounds_type = BoundsFinite;
+					}
+					else if (subtree_bounds_type == BoundsFinite) {
+						subtree_bounds = createUnion(subtree_bounds, child_bounds);
+					}
+
+					break;
+				}
+
+				case BoundsInfinite: {
+					subtree_bounds_type = BoundsInfinite;
+					break;
+				}
+			}
+		}
+
+		subtree_bounds_dirty   = false;
+		subtree_bounds_version = world_transform_version;
+	}
+
+	if (bounds && subtree_bounds_type == BoundsFinite) {
+		*bounds = subtree_bounds;
+	}
+
+	return subtree_bounds_type;
+}
+
+
 vector2d Node::convertWorldToLocal(const vector2d& world) const {
 	// use the modelview matrix to get the actual coordinate system
 	return world / this->getWorldTransform();
@@ -183,29 +575,77 @@ void Node::render(video::RenderContext *render_context) {
 		return;
 	}
 
-	for(NodeList::iterator it=children.begin(); it!=children.end(); it++) {
-		Node *child = *it;
+	// skip the whole subtree, when it's completely outside of the visible area
+	if (render_context->hasCullRectangle()) {
+		rectangle bounds;
+		if (
+				getSubtreeBounds(&bounds) == BoundsFinite
+			&&	render_context->getCullRectangle().intersects(bounds) == false
+		) {
+			return;
+		}
+	}
+
+	// when using the render queue, each group of children with the same order key
+	// gets it's own order key within the queue, so only draws within the same group
+	// may be reordered. Leaf nodes do not affect the order at all.
+	compactChildren();
+
+	video::RenderQueue *queue = NULL;
+	if (render_context->isRenderQueueEnabled() && !children.empty()) {
+		queue = render_context->getRenderQueue();
+		queue->nextOrderKey();
+	}
+
+	// children may be removed while rendering, which leaves an empty place in the list
+	bool		has_previous	= false;
+	NodeOrder	previous_order	= 0;
+
+	for(size_t i=0; i<children.size(); i++) {
+		Node *child = children[i];
+		if (child == NULL) {
+			continue;
+		}
 
 		if (!this_drawn && child->getOrderKey() >= 0) {
+			if (queue) {
+				queue->nextOrderKey();
+			}
+
 			render_this(render_context);
 			this_drawn = true;
+
+			if (queue) {
+				queue->nextOrderKey();
+			}
+		}
+		else if (queue && has_previous && previous_order != child->getOrderKey()) {
+			queue->nextOrderKey();
 		}
 
+		has_previous	= true;
+		previous_order	= child->getOrderKey();
 		child->render(render_context);
 	}
 
 	if (!this_drawn) {
+		if (queue) {
+			queue->nextOrderKey();
+		}
+
 		render_this(render_context);
 	}
 
+	if (queue) {
+		queue->nextOrderKey();
+	}
+
 	return;
 }
 
 
 void Node::render_this(video::RenderContext *render_context) {
-	if (transform_dirty) {
-		updateTransform();
-	}
+	updateTransform();
 
 	onDraw(render_context);
 
@@ -25,16 +25,20 @@
 #include <wiesel/wiesel-core.def>
 
 #include <wiesel/util/shared_object.h>
+#include <wiesel/geometry.h>
 #include <wiesel/math/matrix.h>
 #include <wiesel/math/vector2d.h>
 #include <wiesel/math/vector3d.h>
 
+#include <stdint.h>
 #include <vector>
 
 
 namespace wiesel {
 
 	class Node;
+	class SpatialIndex;
+	class TransformStore;
 
 	namespace video {
 		class VideoDevice;
@@ -62,6 +66,24 @@ namespace wiesel {
 	 */
 	class WIESEL_CORE_EXPORT Node : public virtual SharedObject
 	{
+	friend class SpatialIndex;
+	friend class TransformStore;
+
+	public:
+		/**
+		 * @brief Describes the area covered by a node or a subtree.
+		 */
+		enum BoundsType {
+			/// the node does not provide any bounds, so it does not affect the bounds of it's parent.
+			BoundsEmpty,
+
+			/// the content is covered by a rectangle in world coordinates.
+			BoundsFinite,
+
+			/// the covered area is unknown, so the node can never be culled.
+			BoundsInfinite,
+		};
+
 	public:
 		Node();
 		virtual ~Node();
@@ -74,10 +96,19 @@ namespace wiesel {
 	public:
 		/**
 		 * @brief Adds a new child.
+		 * The child will be inserted behind all children with the same or a lower order key.
 		 * @return \c true, when the node was added, \c false otherwise.
 		 */
 		bool addChild(Node *child, NodeOrder order=0);
 
+		/**
+		 * @brief Adds a list of new children with the same order key at once.
+		 * The children will be inserted behind all existing children with the same
+		 * or a lower order key, keeping the order of the given list.
+		 * @return \c true, when all nodes were added, \c false otherwise.
+		 */
+		bool addChildren(const NodeList &nodes, NodeOrder order=0);
+
 		/**
 		 * @brief Adds a new child without sorting the children list.
 		 * This can be useful, when adding a large amount of children at one.
@@ -95,9 +126,7 @@ namespace wiesel {
 		 * @brief Provides access to the children list.
 		 * @return A const-list of all children, which cannot be manipulated.
 		 */
-		inline const NodeList *getChildren() {
-			return &children;
-		}
+		const NodeList *getChildren();
 
 		/**
 		 * @brief Get the node's parent.
@@ -106,6 +135,13 @@ namespace wiesel {
 			return parent;
 		}
 
+		/**
+		 * @brief Get the position of this node within it's parent's children list.
+		 */
+		inline size_t getChildIndex() const {
+			return child_index;
+		}
+
 		/**
 		 * @brief Get the node's order key.
 		 */
@@ -138,38 +174,89 @@ namespace wiesel {
 		 * @brief Returns the local transformation matrix.
 		 * The local transform matrix stores all transformations
 		 * relative to it's parent.
+		 * The local transform will not be stored within the node,
+		 * so it will be computed on each call.
 		 */
-		inline const matrix4x4& getLocalTransform() const {
-			return local_transform;
-		}
+		matrix4x4 getLocalTransform() const;
 
 		/**
 		 * @brief Returns the world transformation matrix.
 		 * The world transform matrix stores all transformations
 		 * relative to the scene root.
+		 * The matrix will be updated before, when it's outdated.
 		 */
 		inline const matrix4x4& getWorldTransform() const {
+			if (validated_transform_epoch != transform_epoch) {
+				const_cast<Node*>(this)->updateTransform();
+			}
+
 			return world_transform;
 		}
 
 		/**
 		 * @brief Update the local and world transformation matrix, if necessary.
+		 * The transformation needs to be updated, when this node's own transformation
+		 * has changed, or when the world transform of any parent has changed
+		 * since the last update.
 		 */
 		void updateTransform();
 
 		/**
-		 * @brief Flags the transformation on this node and all it's children as dirty.
+		 * @brief Updates the transformation of this node and all of it's children.
+		 * The transformation of all parents needs to be up to date already.
+		 * Independent subtrees may be updated in parallel.
+		 */
+		void updateSubtreeTransforms();
+
+		/**
+		 * @brief Flags the transformation of this node as dirty.
 		 * This means, on the next update, the world transformation matrix will be updated.
+		 * The children of this node will notice the change by the generation
+		 * of their parent's world transform, so they don't need to be visited here.
 		 */
 		void setTransformDirty();
 
 		/**
 		 * @brief Check if the current transformation needs to be updated.
 		 */
-		bool isTransformDirty() const {
-			return transform_dirty;
+		bool isTransformDirty() const;
+
+		/**
+		 * @brief Get the version of the current world transform.
+		 * The version changes each time the world transform was computed,
+		 * so it can be used to detect changes of this node or any of it's parents.
+		 */
+		inline uint32_t getWorldTransformVersion() const {
+			getWorldTransform();
+			return world_transform_version;
 		}
 
+		/**
+		 * @brief Flags the content of this node as changed, without changing it's transformation.
+		 * This notifies all parents, which cache data of their subtree, like \ref StaticBatchNode.
+		 */
+		void setContentDirty();
+
+	// culling
+	public:
+		/**
+		 * @brief Get the bounding rectangle in world coordinates of this node and all it's children.
+		 * The result will be cached until the transformation of this node or any of it's
+		 * children will be flagged dirty.
+		 * When the render context provides a cull rectangle, subtrees with finite bounds
+		 * outside of this rectangle will be skipped while rendering.
+		 * @param bounds	Receives the bounding rectangle, when the bounds are finite.
+		 * @return The type of the subtree's bounds.
+		 */
+		BoundsType getSubtreeBounds(rectangle *bounds);
+
+		/**
+		 * @brief Get the bounding rectangle of this node's own content in world coordinates.
+		 * @param bounds	Receives the bounding rectangle, when the bounds are finite.
+		 * @return The type of the node's bounds.
+		 */
+		BoundsType getWorldBounds(rectangle *bounds);
+
 	// coordinate conversion
 	public:
 		/**
@@ -204,15 +291,71 @@ namespace wiesel {
 		/**
 		 * Compute the transformations relative to the node's parent.
 		 * Can be overridden in subclasses.
+		 * This may be called on a worker thread, so it must only compute the transformation
+		 * without modifying other objects, unless \ref dependsOnParentTransform returns \c true.
 		 */
 		virtual void computeLocalTransform(matrix4x4 *transform);
 
+		/**
+		 * @brief Computes the world transformation of this node.
+		 * The default implementation multiplies the result of \ref computeLocalTransform
+		 * with the parent's world transform. Subclasses may override this to use
+		 * a cheaper representation of their local transformation.
+		 * @param parent_world	The parent's world transform or \c NULL, if there's no parent.
+		 * @param transform		Receives the world transformation.
+		 */
+		virtual void computeWorldTransform(const matrix4x4 *parent_world, matrix4x4 *transform);
+
+		/**
+		 * @brief Checks, if the result of \ref computeLocalTransform depends on the parent's state,
+		 * so the local transform needs to be computed again, each time the parent has changed.
+		 * Subtrees containing such a node will always be updated on the main thread.
+		 * The default implementation returns \c false.
+		 */
+		virtual bool dependsOnParentTransform() const;
+
+		/**
+		 * @brief Checks, if any node within a subtree depends on it's parent's transform.
+		 * Those subtrees cannot be updated on a worker thread.
+		 */
+		static bool hasParentDependentTransform(const Node *subtree);
+
+		/**
+		 * @brief Get the current transform epoch, which changes each time
+		 * any node's transformation has changed.
+		 */
+		inline static uint32_t getTransformEpoch() {
+			return transform_epoch;
+		}
+
+		/**
+		 * @brief Computes the bounds of this node's own content in world coordinates.
+		 * The world transform is already up to date when this function will be called.
+		 * The default implementation returns \ref BoundsInfinite.
+		 */
+		virtual BoundsType computeWorldBounds(rectangle *bounds);
+
 		/**
 		 * @brief Called to render this node.
 		 * This function should be the only place to put rendering code.
 		 */
 		virtual void onDraw(video::RenderContext *render_context);
 
+	// subtree changes
+	protected:
+		/**
+		 * @brief Checks, if anything within this node's subtree has changed since
+		 * the last call of \ref clearSubtreeContentDirty.
+		 */
+		inline bool isSubtreeContentDirty() const {
+			return subtree_content_dirty;
+		}
+
+		/**
+		 * @brief Resets the content dirty flag of this node and all of it's children.
+		 */
+		void clearSubtreeContentDirty();
+
 	// private functions
 	private:
 		/**
@@ -220,11 +363,52 @@ namespace wiesel {
 		 */
 		void render_this(video::RenderContext *render_context);
 
+		/**
+		 * @brief Flags the cached subtree bounds of this node and all of it's parents as dirty.
+		 */
+		void invalidateSubtreeBounds();
+
+		/**
+		 * @brief Removes this node and all of it's children from their spatial index.
+		 */
+		void detachFromSpatialIndex();
+
+		/**
+		 * @brief Takes the ownership of a child, which was just inserted into the children list.
+		 */
+		void onChildAdded(Node *child);
+
+		/**
+		 * @brief Removes the places of all removed children from the children list.
+		 */
+		void compactChildren();
+
+		/**
+		 * @brief Updates the stored index of all children, starting at the given position.
+		 */
+		void updateChildIndices(size_t first);
+
 	// members available for subclasses
 	protected:
-		matrix4x4	local_transform;	//!< Local transformation, relative to it's parent.
 		matrix4x4	world_transform;	//!< World transformation, relative to the scene.
-		bool		transform_dirty;	//!< When true, the world transformation matrix has to be updated.
+		bool		transform_dirty;	//!< When true, the local transformation of this node has changed.
+
+	private:
+		/// incremented each time the world transform was computed
+		uint32_t	world_transform_version;
+
+		/// the parent's world transform version used for the current world transform
+		uint32_t	parent_transform_version;
+
+		/// the transform epoch, when the world transform was validated the last time
+		uint32_t	validated_transform_epoch;
+
+		/// incremented on each change of any node's transformation
+		static uint32_t	transform_epoch;
+
+		/// the transform store, which contains this node, if any.
+		TransformStore*	transform_store;
+		uint32_t		transform_store_index;
 
 	private:
 		bool		visible;
@@ -236,7 +420,28 @@ namespace wiesel {
 		NodeOrder	order;
 
 		/// the list containing all children of this node.
+		/// removed children leave a \c NULL entry, until the list will be compacted.
 		NodeList	children;
+
+		/// the position of this node within it's parent's children list.
+		size_t		child_index;
+
+		/// the number of removed children, which are still in the children list.
+		size_t		removed_children;
+
+		/// cached bounds of this node and all of it's children
+		rectangle	subtree_bounds;
+		BoundsType	subtree_bounds_type;
+		bool		subtree_bounds_dirty;
+		uint32_t	subtree_bounds_version;
+
+		/// the spatial index, which contains this node, if any.
+		SpatialIndex*	spatial_index;
+		bool			spatial_index_dirty;
+		uint32_t		spatial_index_version;
+
+		/// flags any change within this subtree
+		bool			subtree_content_dirty;
 	};
 
 }
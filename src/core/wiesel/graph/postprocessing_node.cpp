@@ -96,6 +96,9 @@ void PostProcessingNode::onViewportChanged(const rectangle& old_viewport, const
 void PostProcessingNode::updateVertexBuffer(const rectangle& size) {
 	if (vbo == NULL) {
 		vbo = new video::VertexBuffer();
+
+		// the vertex positions will be updated each frame
+		vbo->setUsage(video::BufferUsageDynamic);
 	}
 
 	size_t num_textures = getRenderBuffer()->getTargetTextureCount();
@@ -20,22 +20,77 @@
  * Boston, MA 02110-1301 USA
  */
 #include "scene.h"
+#include "spatial_index.h"
+#include "transform_store.h"
 #include "wiesel/video/screen.h"
 #include "wiesel/video/video_driver.h"
 
+#include <wiesel/util/job_system.h>
+#include <wiesel/util/profiler.h>
+
 using namespace wiesel;
 
 
+/**
+ * @brief Updates the transforms of a range of independent subtrees.
+ */
+struct SubtreeTransformRange
+{
+	const NodeList*		subtrees;
+
+	void operator()(size_t begin, size_t end) {
+		for(size_t i=begin; i<end; i++) {
+			(*subtrees)[i]->updateSubtreeTransforms();
+		}
+	}
+};
+
+
 Scene::Scene() {
+	this->spatial_index		= NULL;
+	this->transform_store	= NULL;
+	this->updated_transform_epoch	= 0;
 	return;
 }
 
 Scene::~Scene() {
+	setSpatialIndexEnabled(false);
+	setTransformStoreEnabled(false);
+	return;
+}
+
+
+void Scene::setSpatialIndexEnabled(bool enabled, float cell_size) {
+	if (spatial_index) {
+		delete spatial_index;
+		spatial_index = NULL;
+	}
+
+	if (enabled) {
+		spatial_index = new SpatialIndex(this, cell_size);
+	}
+
+	return;
+}
+
+
+void Scene::setTransformStoreEnabled(bool enabled) {
+	if (transform_store) {
+		delete transform_store;
+		transform_store = NULL;
+	}
+
+	if (enabled) {
+		transform_store = new TransformStore(this);
+	}
+
 	return;
 }
 
 
 void Scene::render(video::RenderContext* render_context) {
+	WIESEL_PROFILE_SCOPE("Scene::render");
+
 	rectangle resolution = rectangle(
 			vector2d::zero,
 			render_context->getScreen()->getVideoDeviceDriver()->getResolution()
@@ -47,7 +102,75 @@ void Scene::render(video::RenderContext* render_context) {
 		setTransformDirty();
 	}
 
-	Viewport::render(render_context);
+	// update all world transforms at once, before they will be requested by the nodes
+	if (transform_store) {
+		transform_store->update();
+	}
+
+	{
+		WIESEL_PROFILE_SCOPE("Node::render");
+		Viewport::render(render_context);
+	}
+
+	return;
+}
+
+
+void Scene::updateTransforms(JobSystem *jobs) {
+	// nothing has changed since the last update
+	if (updated_transform_epoch == getTransformEpoch()) {
+		return;
+	}
+
+	// changes made while updating need another update
+	uint32_t epoch = getTransformEpoch();
+
+	// the transform store updates all nodes in a single pass
+	if (transform_store) {
+		transform_store->update();
+	}
+	else if (jobs == NULL || jobs->getNumberOfWorkers() == 0) {
+		updateSubtreeTransforms();
+	}
+	else {
+		updateTransform();
+
+		// split the graph into independent subtrees, going one level deeper,
+		// when there are not enough children to keep all workers busy.
+		size_t min_subtrees = (jobs->getNumberOfWorkers() + 1) * 2;
+		NodeList candidates;
+
+		for(NodeList::const_iterator it=getChildren()->begin(); it!=getChildren()->end(); it++) {
+			Node *child = *it;
+
+			if (getChildren()->size() < min_subtrees && child->getChildren()->empty() == false) {
+				child->updateTransform();
+				candidates.insert(candidates.end(), child->getChildren()->begin(), child->getChildren()->end());
+			}
+			else {
+				candidates.push_back(child);
+			}
+		}
+
+		// nodes like viewports update other resources when their transform changes,
+		// so their subtrees will be updated on the main thread.
+		NodeList subtrees;
+		for(NodeList::iterator it=candidates.begin(); it!=candidates.end(); it++) {
+			if (hasParentDependentTransform(*it)) {
+				(*it)->updateSubtreeTransforms();
+			}
+			else {
+				subtrees.push_back(*it);
+			}
+		}
+
+		SubtreeTransformRange body;
+		body.subtrees = &subtrees;
+
+		jobs->parallelFor(0, subtrees.size(), 1, body);
+	}
+
+	updated_transform_epoch = epoch;
 
 	return;
 }
@@ -34,6 +34,9 @@ namespace wiesel {
 	}
 
 	class Scene;
+	class SpatialIndex;
+	class TransformStore;
+	class JobSystem;
 
 	/**
 	 * @brief Alias type for a list of scenes.
@@ -50,6 +53,56 @@ namespace wiesel {
 		Scene();
 		virtual ~Scene();
 
+	// spatial index
+	public:
+		/**
+		 * @brief Enables or disables a spatial index for all nodes of this scene.
+		 * The spatial index allows fast queries for nodes at a specific location
+		 * or within an area. When enabled, touch events will be dispatched only
+		 * to nodes, whose bounds contain the touch location.
+		 * @param enabled		\c true to create the index, \c false to remove it.
+		 * @param cell_size		The cell size of the index in world units.
+		 */
+		void setSpatialIndexEnabled(bool enabled, float cell_size=128.0f);
+
+		/**
+		 * @brief Get the spatial index of this scene.
+		 * @return The scene's spatial index or \c NULL, when not enabled.
+		 */
+		inline SpatialIndex* getSpatialIndex() {
+			return spatial_index;
+		}
+
+	// transform store
+	public:
+		/**
+		 * @brief Enables or disables a flat transform store for all nodes of this scene.
+		 * The store keeps the transformations of all nodes in contiguous arrays
+		 * and updates all changed world transforms in a single pass each frame,
+		 * which is faster for scenes with a large number of nodes.
+		 * @param enabled		\c true to create the store, \c false to remove it.
+		 */
+		void setTransformStoreEnabled(bool enabled);
+
+		/**
+		 * @brief Get the transform store of this scene.
+		 * @return The scene's transform store or \c NULL, when not enabled.
+		 */
+		inline TransformStore* getTransformStore() {
+			return transform_store;
+		}
+
+		/**
+		 * @brief Updates the world transforms of all nodes within this scene.
+		 * Independent subtrees will be updated in parallel on the given job system,
+		 * the function returns, when all transforms are up to date.
+		 * Subtrees containing nodes, which depend on their parent's transform,
+		 * will be updated on the calling thread.
+		 * This will be called by the engine each frame before the scene will be rendered.
+		 * @param jobs		The job system to be used or \c NULL to update on the calling thread.
+		 */
+		void updateTransforms(JobSystem *jobs);
+
 	// Node
 	public:
 		virtual void render(video::RenderContext *render_context);
@@ -60,6 +113,11 @@ namespace wiesel {
 
 	private:
 		rectangle		screen_size;
+		SpatialIndex*	spatial_index;
+		TransformStore*	transform_store;
+
+		/// the transform epoch of the last call to updateTransforms
+		uint32_t		updated_transform_epoch;
 	};
 }
 #endif	/* __WIESEL_GRAPH_SCENE_H__ */
@@ -0,0 +1,422 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+
+
+using namespace wiesel;
+
+
+
+SpatialGrid::SpatialGrid(float cell_size) {
+	assert(cell_size > 0.0f);
+
+	this->cell_size = cell_size > 0.0f ? cell_size : 1.0f;
+
+	return;
+}
+
+
+SpatialGrid::~SpatialGrid() {
+	return;
+}
+
+
+int SpatialGrid::getCell(float value) const {
+	// clamp to keep huge coordinates within the range of int
+	const float limit = static_cast<float>(1 << 30);
+	float cell = std::floor(value / cell_size);
+
+	if (cell < -limit) {
+		cell = -limit;
+	}
+
+	if (cell > limit) {
+		cell = limit;
+	}
+
+	return static_cast<int>(cell);
+}
+
+
+uint64_t SpatialGrid::getCellKey(int x, int y) {
+	return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
+
+
+void SpatialGrid::insert(item_t item, const rectangle &bounds) {
+	Entry entry;
+	entry.bounds	= bounds.normalized();
+	entry.min_x		= getCell(entry.bounds.getMinX());
+	entry.min_y		= getCell(entry.bounds.getMinY());
+	entry.max_x		= getCell(entry.bounds.getMaxX());
+	entry.max_y		= getCell(entry.bounds.getMaxY());
+	entry.large		= (
+							static_cast<int64_t>(entry.max_x - entry.min_x + 1)
+						*	static_cast<int64_t>(entry.max_y - entry.min_y + 1)
+					) > MAX_CELLS_PER_ITEM;
+
+	EntryMap::iterator it = entries.find(item);
+	if (it != entries.end()) {
+		// nothing to do, when the item is still in the same cells
+		if (
+				it->second.large == entry.large
+			&&	it->second.min_x == entry.min_x
+			&&	it->second.min_y == entry.min_y
+			&&	it->second.max_x == entry.max_x
+			&&	it->second.max_y == entry.max_y
+		) {
+			it->second.bounds = entry.bounds;
+			return;
+		}
+
+		unlink(item, it->second);
+		it->second = entry;
+	}
+	else {
+		entries[item] = entry;
+	}
+
+	if (entry.large) {
+		large_items.push_back(item);
+	}
+	else {
+		for(int y=entry.min_y; y<=entry.max_y; y++) {
+			for(int x=entry.min_x; x<=entry.max_x; x++) {
+				cells[getCellKey(x, y)].push_back(item);
+			}
+		}
+	}
+
+	return;
+}
+
+
+void SpatialGrid::unlink(item_t item, const Entry &entry) {
+	if (entry.large) {
+		ItemList::iterator it = std::find(large_items.begin(), large_items.end(), item);
+		if (it != large_items.end()) {
+			*it = large_items.back();
+			large_items.pop_back();
+		}
+	}
+	else {
+		for(int y=entry.min_y; y<=entry.max_y; y++) {
+			for(int x=entry.min_x; x<=entry.max_x; x++) {
+				CellMap::iterator cell = cells.find(getCellKey(x, y));
+				if (cell == cells.end()) {
+					continue;
+				}
+
+				ItemList::iterator it = std::find(cell->second.begin(), cell->second.end(), item);
+				if (it != cell->second.end()) {
+					*it = cell->second.back();
+					cell->second.pop_back();
+				}
+
+				if (cell->second.empty()) {
+					cells.erase(cell);
+				}
+			}
+		}
+	}
+
+	return;
+}
+
+
+void SpatialGrid::remove(item_t item) {
+	EntryMap::iterator it = entries.find(item);
+	if (it != entries.end()) {
+		unlink(item, it->second);
+		entries.erase(it);
+	}
+
+	return;
+}
+
+
+void SpatialGrid::clear() {
+	entries.clear();
+	cells.clear();
+	large_items.clear();
+
+	return;
+}
+
+
+bool SpatialGrid::contains(item_t item) const {
+	return entries.find(item) != entries.end();
+}
+
+
+void SpatialGrid::getItems(ItemList *result) const {
+	for(EntryMap::const_iterator it=entries.begin(); it!=entries.end(); it++) {
+		result->push_back(it->first);
+	}
+
+	return;
+}
+
+
+void SpatialGrid::findItemsAt(const vector2d &point, ItemList *result) const {
+	CellMap::const_iterator cell = cells.find(getCellKey(getCell(point.x), getCell(point.y)));
+	if (cell != cells.end()) {
+		for(ItemList::const_iterator it=cell->second.begin(); it!=cell->second.end(); it++) {
+			EntryMap::const_iterator entry = entries.find(*it);
+			if (entry != entries.end() && entry->second.bounds.contains(point)) {
+				result->push_back(*it);
+			}
+		}
+	}
+
+	for(ItemList::const_iterator it=large_items.begin(); it!=large_items.end(); it++) {
+		EntryMap::const_iterator entry = entries.find(*it);
+		if (entry != entries.end() && entry->second.bounds.contains(point)) {
+			result->push_back(*it);
+		}
+	}
+
+	return;
+}
+
+
+void SpatialGrid::findItemsIn(const rectangle &area, ItemList *result) const {
+	rectangle normalized_area = area.normalized();
+	size_t first = result->size();
+
+	int min_x = getCell(normalized_area.getMinX());
+	int min_y = getCell(normalized_area.getMinY());
+	int max_x = getCell(normalized_area.getMaxX());
+	int max_y = getCell(normalized_area.getMaxY());
+
+	int64_t num_cells = static_cast<int64_t>(max_x - min_x + 1) * static_cast<int64_t>(max_y - min_y + 1);
+
+	if (num_cells > static_cast<int64_t>(cells.size())) {
+		// when the area covers more cells than are in use, just test all items
+		for(EntryMap::const_iterator it=entries.begin(); it!=entries.end(); it++) {
+			if (it->second.large == false && it->second.bounds.intersects(normalized_area)) {
+				result->push_back(it->first);
+			}
+		}
+	}
+	else {
+		for(int y=min_y; y<=max_y; y++) {
+			for(int x=min_x; x<=max_x; x++) {
+				CellMap::const_iterator cell = cells.find(getCellKey(x, y));
+				if (cell == cells.end()) {
+					continue;
+				}
+
+				for(ItemList::const_iterator it=cell->second.begin(); it!=cell->second.end(); it++) {
+					EntryMap::const_iterator entry = entries.find(*it);
+					if (entry != entries.end() && entry->second.bounds.intersects(normalized_area)) {
+						result->push_back(*it);
+					}
+				}
+			}
+		}
+
+		// items covering multiple cells may be found more than once
+		std::sort(result->begin() + first, result->end());
+		result->erase(std::unique(result->begin() + first, result->end()), result->end());
+	}
+
+	for(ItemList::const_iterator it=large_items.begin(); it!=large_items.end(); it++) {
+		EntryMap::const_iterator entry = entries.find(*it);
+		if (entry != entries.end() && entry->second.bounds.intersects(normalized_area)) {
+			result->push_back(*it);
+		}
+	}
+
+	return;
+}
+
+
+
+
+
+/// computes a path of sort keys from the root to a node, which can be compared by their draw order.
+static void getDrawOrderPath(const Node *node, std::vector<int> *path) {
+	path->clear();
+
+	// the position of the node itself between it's children:
+	// children with a negative order key are drawn before their parent.
+	Node *current = const_cast<Node*>(node);
+	const NodeList *children = current->getChildren();
+	int negative_children = 0;
+
+	for(NodeList::const_iterator it=children->begin(); it!=children->end() && (*it)->getOrderKey() < 0; it++) {
+		++negative_children;
+	}
+
+	path->push_back(2 * negative_children + 1);
+
+	// the position of each node within it's parent
+	for(; current->getParent(); current=current->getParent()) {
+		// compacts the parent's children list, so the index of each child is final
+		current->getParent()->getChildren();
+		int index = static_cast<int>(current->getChildIndex());
+
+		if (current->getOrderKey() < 0) {
+			path->push_back(2 * index);
+		}
+		else {
+			path->push_back(2 * index + 2);
+		}
+	}
+
+	std::reverse(path->begin(), path->end());
+
+	return;
+}
+
+
+/// predicate to sort nodes by their draw order, starting with the frontmost.
+static bool SortFrontToBackPredicate(const std::pair<std::vector<int>, Node*> &a, const std::pair<std::vector<int>, Node*> &b) {
+	return std::lexicographical_compare(b.first.begin(), b.first.end(), a.first.begin(), a.first.end());
+}
+
+
+
+SpatialIndex::SpatialIndex(Node *root, float cell_size) : grid(cell_size) {
+	this->root = root;
+
+	// the initial update needs to visit all nodes
+	update(root, true);
+
+	return;
+}
+
+
+SpatialIndex::~SpatialIndex() {
+	SpatialGrid::ItemList items;
+	grid.getItems(&items);
+
+	for(SpatialGrid::ItemList::iterator it=items.begin(); it!=items.end(); it++) {
+		Node *node = reinterpret_cast<Node*>(*it);
+		node->spatial_index = NULL;
+	}
+
+	grid.clear();
+
+	return;
+}
+
+
+void SpatialIndex::update() {
+	update(root, false);
+}
+
+
+void SpatialIndex::update(Node *node, bool force) {
+	if (node->spatial_index_dirty == false && force == false) {
+		return;
+	}
+
+	node->spatial_index_dirty = false;
+
+	rectangle bounds;
+	if (node->getWorldBounds(&bounds) == Node::BoundsFinite) {
+		grid.insert(reinterpret_cast<SpatialGrid::item_t>(node), bounds);
+		node->spatial_index = this;
+	}
+	else if (node->spatial_index == this) {
+		remove(node);
+	}
+
+	// when the node has moved, all of it's children have moved as well
+	bool moved = (node->spatial_index_version != node->world_transform_version);
+	node->spatial_index_version = node->world_transform_version;
+
+	const NodeList *children = node->getChildren();
+	for(NodeList::const_iterator it=children->begin(); it!=children->end(); it++) {
+		update(*it, force || moved);
+	}
+
+	return;
+}
+
+
+void SpatialIndex::remove(Node *node) {
+	assert(node->spatial_index == this);
+
+	grid.remove(reinterpret_cast<SpatialGrid::item_t>(node));
+	node->spatial_index = NULL;
+
+	return;
+}
+
+
+void SpatialIndex::findNodesAt(const vector2d &location, NodeList *result) {
+	update();
+
+	SpatialGrid::ItemList items;
+	grid.findItemsAt(location, &items);
+	sortByDrawOrder(items, result);
+
+	return;
+}
+
+
+void SpatialIndex::findNodesIn(const rectangle &area, NodeList *result) {
+	update();
+
+	SpatialGrid::ItemList items;
+	grid.findItemsIn(area, &items);
+	sortByDrawOrder(items, result);
+
+	return;
+}
+
+
+void SpatialIndex::sortByDrawOrder(const SpatialGrid::ItemList &items, NodeList *result) const {
+	std::vector<std::pair<std::vector<int>, Node*> > sorted(items.size());
+
+	for(size_t i=0; i<items.size(); i++) {
+		sorted[i].second = reinterpret_cast<Node*>(items[i]);
+		getDrawOrderPath(sorted[i].second, &sorted[i].first);
+	}
+
+	std::sort(sorted.begin(), sorted.end(), SortFrontToBackPredicate);
+
+	for(size_t i=0; i<sorted.size(); i++) {
+		result->push_back(sorted[i].second);
+	}
+
+	return;
+}
+
+
+bool SpatialIndex::isInFrontOf(const Node *a, const Node *b) {
+	std::vector<int> path_a;
+	std::vector<int> path_b;
+
+	getDrawOrderPath(a, &path_a);
+	getDrawOrderPath(b, &path_b);
+
+	return std::lexicographical_compare(path_b.begin(), path_b.end(), path_a.begin(), path_a.end());
+}
+
@@ -0,0 +1,232 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#ifndef __WIESEL_GRAPH_SPATIAL_INDEX_H__
+#define	__WIESEL_GRAPH_SPATIAL_INDEX_H__
+
+#include <wiesel/wiesel-core.def>
+
+#include "node.h"
+
+#include <wiesel/geometry.h>
+#include <wiesel/math/vector2d.h>
+
+#include <map>
+#include <stdint.h>
+#include <vector>
+
+
+namespace wiesel {
+
+
+	/**
+	 * @brief A uniform grid, which stores items by their bounding rectangle
+	 * and allows fast queries for items at a specific point or within an area.
+	 * Items covering too many cells will be stored in a separate list,
+	 * which will be checked on each query.
+	 */
+	class WIESEL_CORE_EXPORT SpatialGrid
+	{
+	public:
+		/// type of the items stored in the grid.
+		typedef uintptr_t				item_t;
+
+		/// alias type for a list of items.
+		typedef std::vector<item_t>		ItemList;
+
+		/// the maximum number of cells a single item may be stored in.
+		static const int MAX_CELLS_PER_ITEM = 64;
+
+	public:
+		/**
+		 * @brief Creates a new grid.
+		 * @param cell_size		The width and height of a single grid cell.
+		 */
+		SpatialGrid(float cell_size);
+
+		~SpatialGrid();
+
+	public:
+		/**
+		 * @brief Inserts a new item or updates the bounds of an existing item.
+		 */
+		void insert(item_t item, const rectangle &bounds);
+
+		/**
+		 * @brief Removes an item from the grid.
+		 */
+		void remove(item_t item);
+
+		/**
+		 * @brief Removes all items from the grid.
+		 */
+		void clear();
+
+		/**
+		 * @brief Checks, if the grid contains the given item.
+		 */
+		bool contains(item_t item) const;
+
+		/**
+		 * @brief Appends all items stored in this grid to \c result.
+		 */
+		void getItems(ItemList *result) const;
+
+		/**
+		 * @brief Get the number of items stored in this grid.
+		 */
+		inline size_t size() const {
+			return entries.size();
+		}
+
+		/**
+		 * @brief Get the cell size of this grid.
+		 */
+		inline float getCellSize() const {
+			return cell_size;
+		}
+
+	// queries
+	public:
+		/**
+		 * @brief Finds all items, whose bounds contain the given point.
+		 * The items will be appended to \c result in no specific order.
+		 */
+		void findItemsAt(const vector2d &point, ItemList *result) const;
+
+		/**
+		 * @brief Finds all items, whose bounds intersect the given area.
+		 * The items will be appended to \c result in no specific order.
+		 */
+		void findItemsIn(const rectangle &area, ItemList *result) const;
+
+	private:
+		struct Entry {
+			rectangle	bounds;
+			int			min_x;
+			int			min_y;
+			int			max_x;
+			int			max_y;
+			bool		large;
+		};
+
+		typedef std::map<item_t, Entry>			EntryMap;
+		typedef std::map<uint64_t, ItemList>	CellMap;
+
+		/// get the cell coordinate of a position.
+		int getCell(float value) const;
+
+		/// get the key of a cell.
+		static uint64_t getCellKey(int x, int y);
+
+		/// removes an entry from all cells it was stored in.
+		void unlink(item_t item, const Entry &entry);
+
+	private:
+		float			cell_size;
+
+		EntryMap		entries;
+		CellMap			cells;
+		ItemList		large_items;
+	};
+
+
+
+
+	/**
+	 * @brief A spatial index over all nodes with finite bounds of a scene graph.
+	 * The index will be updated lazily before each query, by visiting only those
+	 * subtrees, which contain nodes with changed transformations or bounds since
+	 * the last update.
+	 * All query results are sorted by their draw order, starting with the
+	 * frontmost node.
+	 */
+	class WIESEL_CORE_EXPORT SpatialIndex
+	{
+	public:
+		/**
+		 * @brief Creates a new index for the given root node.
+		 * @param root			The root of the scene graph to be indexed.
+		 * @param cell_size		The cell size of the underlying grid in world units.
+		 */
+		SpatialIndex(Node *root, float cell_size);
+
+		~SpatialIndex();
+
+	public:
+		/**
+		 * @brief Finds all nodes, whose bounds contain the given location in world coordinates.
+		 * @param location		The location to search for, in world coordinates.
+		 * @param result		Receives all nodes found, starting with the frontmost node.
+		 */
+		void findNodesAt(const vector2d &location, NodeList *result);
+
+		/**
+		 * @brief Finds all nodes, whose bounds intersect the given area in world coordinates.
+		 * @param area			The area to search for, in world coordinates.
+		 * @param result		Receives all nodes found, starting with the frontmost node.
+		 */
+		void findNodesIn(const rectangle &area, NodeList *result);
+
+		/**
+		 * @brief Updates all nodes, which have changed since the last update.
+		 * This will be done automatically before each query.
+		 */
+		void update();
+
+		/**
+		 * @brief Removes a single node from this index.
+		 * This will be called automatically, when the node was removed from the scene graph.
+		 */
+		void remove(Node *node);
+
+		/**
+		 * @brief Get the number of nodes stored in this index.
+		 */
+		inline size_t size() const {
+			return grid.size();
+		}
+
+	// utilities
+	public:
+		/**
+		 * @brief Checks, if node \c a will be drawn after node \c b,
+		 * which means it appears in front of \c b.
+		 * Both nodes need to be part of the same scene graph.
+		 */
+		static bool isInFrontOf(const Node *a, const Node *b);
+
+	private:
+		/// updates a node and it's children.
+		void update(Node *node, bool force);
+
+		/// sorts a list of items by their draw order and stores them in the result list.
+		void sortByDrawOrder(const SpatialGrid::ItemList &items, NodeList *result) const;
+
+	private:
+		Node*			root;
+		SpatialGrid		grid;
+	};
+
+}
+
+#endif	/* __WIESEL_GRAPH_SPATIAL_INDEX_H__ */
+
@@ -0,0 +1,381 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "static_batch_node.h"
+
+#include "wiesel/video/render_context.h"
+#include "wiesel/video/vertexbuffer.h"
+
+#include <assert.h>
+#include <string.h>
+
+
+using namespace wiesel;
+using namespace wiesel::video;
+
+
+
+StaticBatchNode::StaticBatchNode() {
+	this->baking_enabled	= true;
+	this->baked				= false;
+	this->baked_transform_version	= 0;
+
+	return;
+}
+
+
+StaticBatchNode::~StaticBatchNode() {
+	clearMeshes();
+
+	return;
+}
+
+
+void StaticBatchNode::setBakingEnabled(bool enabled) {
+	if (this->baking_enabled != enabled) {
+		this->baking_enabled = enabled;
+		invalidate();
+	}
+
+	return;
+}
+
+
+void StaticBatchNode::invalidate() {
+	setContentDirty();
+	return;
+}
+
+
+void StaticBatchNode::clearMeshes() {
+	for(MeshList::iterator it=meshes.begin(); it!=meshes.end(); it++) {
+		release(*it);
+	}
+
+	meshes.clear();
+	baked = false;
+
+	return;
+}
+
+
+void StaticBatchNode::render(RenderContext *render_context) {
+	if (isVisible() == false) {
+		return;
+	}
+
+	if (baking_enabled == false) {
+		Node::render(render_context);
+		return;
+	}
+
+	// check, if any constant buffer of the baked geometry was changed
+	bool constant_buffers_changed = false;
+	for(MeshList::iterator it=meshes.begin(); it!=meshes.end(); it++) {
+		if ((*it)->hasConstantBuffersChanged()) {
+			constant_buffers_changed = true;
+			break;
+		}
+	}
+
+	// bake the subtree again, when anything inside has changed
+	// or any parent has moved this node
+	if (
+			isSubtreeContentDirty()
+		||	baked_transform_version != getWorldTransformVersion()
+		||	constant_buffers_changed
+	) {
+		baked = bake(render_context);
+		baked_transform_version = getWorldTransformVersion();
+		clearSubtreeContentDirty();
+
+		if (!baked) {
+			clearMeshes();
+		}
+	}
+
+	if (!baked) {
+		Node::render(render_context);
+		return;
+	}
+
+	// skip the meshes, when the whole subtree is outside of the visible area
+	if (render_context->hasCullRectangle()) {
+		rectangle bounds;
+		if (
+				getSubtreeBounds(&bounds) == BoundsFinite
+			&&	render_context->getCullRectangle().intersects(bounds) == false
+		) {
+			return;
+		}
+	}
+
+	for(MeshList::iterator it=meshes.begin(); it!=meshes.end(); it++) {
+		(*it)->draw(render_context);
+	}
+
+	return;
+}
+
+
+bool StaticBatchNode::bake(RenderContext *render_context) {
+	clearMeshes();
+
+	// all children need to be captured, even if they are currently not visible
+	bool      had_cull_rectangle	= render_context->hasCullRectangle();
+	rectangle cull_rectangle		= render_context->getCullRectangle();
+	render_context->clearCullRectangle();
+
+	// draw pending primitives first, so only draw calls of the subtree will be counted
+	render_context->flushBatch();
+	uint32_t draw_calls			= render_context->getCurrentFrameStatistics().draw_calls;
+	uint32_t target_switches	= render_context->getCapturedRenderTargetSwitches();
+
+	RenderQueue::DrawPacketList packets;
+	RenderQueue::DrawPacketList *previous_target = render_context->setCaptureTarget(&packets);
+
+	Node::render(render_context);
+
+	// primitives batched by the subtree are drawn directly as well
+	render_context->flushBatch();
+
+	render_context->setCaptureTarget(previous_target);
+
+	if (had_cull_rectangle) {
+		render_context->setCullRectangle(cull_rectangle);
+	}
+
+	// geometry drawn directly or into another render target was not captured,
+	// so the subtree needs to be rendered as usual
+	if (
+			render_context->getCurrentFrameStatistics().draw_calls != draw_calls
+		||	render_context->getCapturedRenderTargetSwitches() != target_switches
+	) {
+		return false;
+	}
+
+	// merge subsequent packets with the same configuration into a single mesh
+	for(RenderQueue::DrawPacketList::iterator it=packets.begin(); it!=packets.end(); it++) {
+		const RenderQueue::DrawPacket &packet = *it;
+		Mesh *mesh = meshes.empty() ? NULL : meshes.back();
+
+		if (packet.vertices == NULL || packet.vertices->getSize() == 0) {
+			continue;
+		}
+
+		if (packet.vertices->getSize() > SpriteBatch::MAX_VERTICES) {
+			return false;
+		}
+
+		if (
+				mesh == NULL
+			||	mesh->matches(packet) == false
+			||	mesh->batch.isCompatible(packet.vertices) == false
+			||	mesh->batch.hasSpaceFor(packet.vertices->getSize()) == false
+		) {
+			mesh = keep(new Mesh());
+			mesh->configure(packet);
+			meshes.push_back(mesh);
+		}
+
+		mesh->trackConstantBuffers(packet);
+
+		if (mesh->batch.canBatch(packet.vertices) == false) {
+			return false;
+		}
+
+		mesh->batch.add(packet.primitive, packet.vertices, packet.indices, packet.transform);
+	}
+
+	return true;
+}
+
+
+
+
+StaticBatchNode::Mesh::Mesh() :
+	batch(BufferUsageStatic)
+{
+	this->has_textures = false;
+
+	return;
+}
+
+
+StaticBatchNode::Mesh::~Mesh() {
+	for(std::vector<TrackedBuffer>::iterator it=tracked_buffers.begin(); it!=tracked_buffers.end(); it++) {
+		release(it->buffer);
+	}
+
+	setShader(NULL);
+
+	return;
+}
+
+
+uint16_t StaticBatchNode::Mesh::getTextureLayersMax() const {
+	return 8;
+}
+
+
+void StaticBatchNode::Mesh::configure(const RenderQueue::DrawPacket &packet) {
+	if (packet.shader_target && packet.shader_target->getShader()) {
+		Shader *shader = packet.shader_target->getShader();
+		setShader(shader);
+
+		// use the packet's buffers instead of the mesh's own, empty buffers
+		const Shader::ConstantBufferTplList *templates = shader->getConstantBufferTemplates();
+		for(Shader::ConstantBufferTplList::const_iterator it=templates->begin(); it!=templates->end(); it++) {
+			ShaderConstantBuffer *buffer = packet.shader_target->findAssignedShaderConstantBuffer(it->name);
+
+			if (buffer) {
+				assignShaderConstantBuffer(it->name, buffer);
+			}
+		}
+	}
+
+	if (packet.texture_target) {
+		for(uint16_t layer=0; layer<packet.texture_target->getTextureLayers(); layer++) {
+			setTexture(layer, packet.texture_target->getTexture(layer));
+		}
+
+		has_textures = true;
+	}
+
+	return;
+}
+
+
+bool StaticBatchNode::Mesh::matches(const RenderQueue::DrawPacket &packet) {
+	Shader *shader = packet.shader_target ? packet.shader_target->getShader() : NULL;
+	if (shader != getShader()) {
+		return false;
+	}
+
+	// all geometry will be drawn with the constants of the mesh,
+	// so each buffer needs to be the same or at least have the same content
+	if (shader) {
+		const Shader::ConstantBufferTplList *templates = shader->getConstantBufferTemplates();
+		for(Shader::ConstantBufferTplList::const_iterator it=templates->begin(); it!=templates->end(); it++) {
+			ShaderConstantBuffer *own_buffer    = findAssignedShaderConstantBuffer(it->name);
+			ShaderConstantBuffer *packet_buffer = packet.shader_target->findAssignedShaderConstantBuffer(it->name);
+
+			if (own_buffer == packet_buffer) {
+				continue;
+			}
+
+			if (
+					own_buffer == NULL
+				||	packet_buffer == NULL
+				||	own_buffer->getTemplate() != packet_buffer->getTemplate()
+				||	memcmp(own_buffer->getDataPtr(), packet_buffer->getDataPtr(), own_buffer->getTemplate()->getSize()) != 0
+			) {
+				return false;
+			}
+		}
+	}
+
+	if ((packet.texture_target != NULL) != has_textures) {
+		return false;
+	}
+
+	if (packet.texture_target) {
+		if (packet.texture_target->getTextureLayers() != getTextureLayers()) {
+			return false;
+		}
+
+		for(uint16_t layer=0; layer<getTextureLayers(); layer++) {
+			if (packet.texture_target->getTexture(layer) != getTexture(layer)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+void StaticBatchNode::Mesh::trackConstantBuffers(const RenderQueue::DrawPacket &packet) {
+	if (packet.shader_target == NULL || packet.shader_target->getShader() == NULL) {
+		return;
+	}
+
+	const Shader::ConstantBufferTplList *templates = packet.shader_target->getShader()->getConstantBufferTemplates();
+	for(Shader::ConstantBufferTplList::const_iterator it=templates->begin(); it!=templates->end(); it++) {
+		ShaderConstantBuffer *buffer = packet.shader_target->findAssignedShaderConstantBuffer(it->name);
+		if (buffer == NULL) {
+			continue;
+		}
+
+		bool tracked = false;
+		for(std::vector<TrackedBuffer>::iterator tb=tracked_buffers.begin(); tb!=tracked_buffers.end(); tb++) {
+			if (tb->buffer == buffer) {
+				tracked = true;
+				break;
+			}
+		}
+
+		if (tracked == false) {
+			TrackedBuffer entry;
+			entry.buffer	= keep(buffer);
+			entry.version	= buffer->getChangeVersion();
+			tracked_buffers.push_back(entry);
+		}
+	}
+
+	return;
+}
+
+
+bool StaticBatchNode::Mesh::hasConstantBuffersChanged() const {
+	for(std::vector<TrackedBuffer>::const_iterator it=tracked_buffers.begin(); it!=tracked_buffers.end(); it++) {
+		if (it->buffer->getChangeVersion() != it->version) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void StaticBatchNode::Mesh::draw(RenderContext *render_context) {
+	// when baking into another batch, the mesh is just another piece of geometry
+	if (render_context->isCapturing()) {
+		render_context->submit(
+				Triangles,
+				batch.getVertexBuffer(), batch.getIndexBuffer(),
+				matrix4x4::identity,
+				this, has_textures ? this : NULL
+		);
+
+		return;
+	}
+
+	applyShaderConfigTo(render_context);
+
+	if (has_textures) {
+		applyTextureConfigTo(render_context);
+	}
+
+	batch.draw(render_context);
+
+	return;
+}
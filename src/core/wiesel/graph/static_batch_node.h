@@ -0,0 +1,163 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#ifndef __WIESEL_GRAPH_STATIC_BATCH_NODE_H__
+#define __WIESEL_GRAPH_STATIC_BATCH_NODE_H__
+
+#include <wiesel/wiesel-core.def>
+
+#include "node.h"
+
+#include "wiesel/video/render_queue.h"
+#include "wiesel/video/shader_target.h"
+#include "wiesel/video/sprite_batch.h"
+#include "wiesel/video/texture_target.h"
+
+#include <vector>
+
+
+namespace wiesel {
+
+	/**
+	 * @brief A node which bakes the geometry of all of it's children into a few static meshes.
+	 * On the first rendering, and each time anything within the subtree was flagged dirty,
+	 * all children will be rendered once while the \ref video::RenderContext captures their
+	 * draw calls. Subsequent draw calls sharing the same shader and textures will be transformed
+	 * into world space and merged into a single mesh, so a static layer made of many sprites
+	 * can be drawn with a single draw call per texture.
+	 * Only geometry passed to \ref video::RenderContext::submit can be baked. When any captured
+	 * geometry cannot be baked, or the children draw directly or into another render target,
+	 * like \ref PostProcessingNode or \ref RenderBufferNode, the children will be rendered as usual.
+	 */
+	class WIESEL_CORE_EXPORT StaticBatchNode : public Node
+	{
+	public:
+		StaticBatchNode();
+		virtual ~StaticBatchNode();
+
+	public:
+		/**
+		 * @brief Enables or disables baking.
+		 * While disabled, the children will be rendered as usual.
+		 */
+		void setBakingEnabled(bool enabled);
+
+		/**
+		 * @brief Checks, if baking is enabled.
+		 */
+		inline bool isBakingEnabled() const {
+			return baking_enabled;
+		}
+
+		/**
+		 * @brief Checks, if the subtree is currently drawn from baked meshes.
+		 */
+		inline bool isBaked() const {
+			return baked;
+		}
+
+		/**
+		 * @brief Get the number of meshes, which will be drawn instead of the children.
+		 */
+		inline size_t getNumberOfMeshes() const {
+			return meshes.size();
+		}
+
+		/**
+		 * @brief Forces the subtree to be baked again on the next rendering.
+		 */
+		void invalidate();
+
+	// Node
+	public:
+		virtual void render(video::RenderContext *render_context);
+
+	protected:
+		/**
+		 * @brief Renders all children into a capture list and bakes the captured geometry.
+		 * @return \c true, when all captured geometry was baked successfully.
+		 */
+		virtual bool bake(video::RenderContext *render_context);
+
+	private:
+		/**
+		 * @brief A single baked mesh, containing geometry drawn with the same shader,
+		 * constant buffer contents and textures.
+		 */
+		class Mesh :
+				public video::ShaderTarget,
+				public video::MultiTextureTarget
+		{
+		public:
+			Mesh();
+			virtual ~Mesh();
+
+		public:
+			virtual uint16_t getTextureLayersMax() const;
+
+			/// takes the shader, constant buffers and textures of the first packet of this mesh.
+			void configure(const video::RenderQueue::DrawPacket &packet);
+
+			/// checks, if a captured packet uses the same configuration as this mesh.
+			/// constant buffers need to be either identical or have the same content.
+			bool matches(const video::RenderQueue::DrawPacket &packet);
+
+			/// remembers the constant buffers of a packet merged into this mesh,
+			/// so changes of their content can be detected later.
+			void trackConstantBuffers(const video::RenderQueue::DrawPacket &packet);
+
+			/// checks, if any constant buffer of the merged packets has changed since baking.
+			bool hasConstantBuffersChanged() const;
+
+			/// draws this mesh.
+			void draw(video::RenderContext *render_context);
+
+		public:
+			video::SpriteBatch		batch;
+			bool					has_textures;
+
+		private:
+			struct TrackedBuffer {
+				video::ShaderConstantBuffer*				buffer;
+				video::ShaderConstantBuffer::version_t		version;
+			};
+
+			std::vector<TrackedBuffer>	tracked_buffers;
+		};
+
+		typedef std::vector<Mesh*>	MeshList;
+
+		/// releases all baked meshes.
+		void clearMeshes();
+
+	private:
+		MeshList		meshes;
+
+		bool			baking_enabled;
+		bool			baked;
+
+		/// the world transform version of this node, when the meshes were baked
+		uint32_t		baked_transform_version;
+	};
+
+}
+
+#endif	/* __WIESEL_GRAPH_STATIC_BATCH_NODE_H__ */
@@ -0,0 +1,241 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "transform_store.h"
+
+#include <assert.h>
+#include <algorithm>
+
+
+using namespace wiesel;
+
+
+
+TransformStore::TransformStore(Node *root) {
+	this->root				= root;
+	this->validated_epoch	= 0;
+	this->structure_dirty	= true;
+	this->updating			= false;
+
+	return;
+}
+
+
+TransformStore::~TransformStore() {
+	remove(root);
+	return;
+}
+
+
+bool TransformStore::isDirty() const {
+	return validated_epoch != Node::transform_epoch;
+}
+
+
+void TransformStore::invalidate() {
+	structure_dirty = true;
+	return;
+}
+
+
+void TransformStore::markDirty(uint32_t index) {
+	dirty_entries.push_back(index);
+	return;
+}
+
+
+void TransformStore::remove(Node *node) {
+	if (node->transform_store == this) {
+		node->transform_store		= NULL;
+		node->transform_store_index	= 0;
+	}
+
+	for(NodeList::const_iterator it=node->children.begin(); it!=node->children.end(); it++) {
+		if (*it) {
+			remove(*it);
+		}
+	}
+
+	structure_dirty = true;
+
+	return;
+}
+
+
+void TransformStore::update() {
+	// nodes may request other transforms while computing their own
+	if (validated_epoch == Node::transform_epoch || updating) {
+		return;
+	}
+
+	updating = true;
+
+	// changes made while computing the transforms need another update
+	uint32_t epoch = Node::transform_epoch;
+
+	if (structure_dirty) {
+		rebuild();
+	}
+
+	// the root's world transform depends on it's parent, if any
+	Node *root_parent = root->getParent();
+	if (root_parent && root_parent->getWorldTransformVersion() != root->parent_transform_version) {
+		changed[0] = 1;
+	}
+
+	// only nodes which have changed their own transformation need to compute their local transform,
+	// parents first, because some nodes like viewports depend on their parent's state.
+	std::sort(dirty_entries.begin(), dirty_entries.end());
+
+	for(std::vector<uint32_t>::iterator it=dirty_entries.begin(); it!=dirty_entries.end(); it++) {
+		uint32_t index = *it;
+		Node *node = nodes[index];
+
+		node->transform_dirty = false;
+		local_transforms[index] = matrix4x4::identity;
+		node->computeLocalTransform(&local_transforms[index]);
+
+		changed[index] = 1;
+	}
+
+	bool any_changed = (dirty_entries.empty() == false) || (root_parent && changed[0]);
+	dirty_entries.clear();
+
+	if (any_changed) {
+		size_t count = nodes.size();
+
+		// each parent precedes it's children, so a single pass updates all world transforms
+		for(size_t i=0; i<count; i++) {
+			int32_t parent = parents[i];
+
+			if (parent >= 0 && changed[parent]) {
+				if (depends_on_parent[i] && !changed[i]) {
+					local_transforms[i] = matrix4x4::identity;
+					nodes[i]->computeLocalTransform(&local_transforms[i]);
+				}
+
+				changed[i] = 1;
+			}
+
+			if (changed[i]) {
+				if (parent >= 0) {
+					world_transforms[i] = local_transforms[i] * world_transforms[parent];
+				}
+				else if (root_parent) {
+					world_transforms[i] = local_transforms[i] * root_parent->getWorldTransform();
+				}
+				else {
+					world_transforms[i] = local_transforms[i];
+				}
+			}
+		}
+
+		// write the changed world transforms back into their nodes
+		for(size_t i=0; i<count; i++) {
+			if (changed[i] == 0) {
+				continue;
+			}
+
+			Node *node = nodes[i];
+			int32_t parent = parents[i];
+
+			node->world_transform = world_transforms[i];
+
+			if (++node->world_transform_version == 0) {
+				node->world_transform_version = 1;
+			}
+
+			if (parent >= 0) {
+				node->parent_transform_version = nodes[parent]->world_transform_version;
+			}
+			else if (root_parent) {
+				node->parent_transform_version = root_parent->getWorldTransformVersion();
+			}
+
+			changed[i] = 0;
+		}
+	}
+
+	validated_epoch = epoch;
+	updating = false;
+
+	return;
+}
+
+
+void TransformStore::rebuild() {
+	std::vector<matrix4x4> old_local_transforms;
+	std::vector<matrix4x4> old_world_transforms;
+	old_local_transforms.swap(local_transforms);
+	old_world_transforms.swap(world_transforms);
+
+	nodes.clear();
+	parents.clear();
+	depends_on_parent.clear();
+	changed.clear();
+	dirty_entries.clear();
+
+	collect(root, -1, old_local_transforms, old_world_transforms);
+
+	structure_dirty = false;
+
+	return;
+}
+
+
+void TransformStore::collect(
+		Node *node, int32_t parent,
+		const std::vector<matrix4x4> &old_local_transforms,
+		const std::vector<matrix4x4> &old_world_transforms
+) {
+	uint32_t index = static_cast<uint32_t>(nodes.size());
+
+	nodes.push_back(node);
+	parents.push_back(parent);
+	depends_on_parent.push_back(node->dependsOnParentTransform() ? 1 : 0);
+	changed.push_back(0);
+
+	// nodes already stored can keep their transforms, new nodes need to be computed
+	if (node->transform_store == this) {
+		assert(node->transform_store_index < old_local_transforms.size());
+		local_transforms.push_back(old_local_transforms[node->transform_store_index]);
+		world_transforms.push_back(old_world_transforms[node->transform_store_index]);
+
+		if (node->transform_dirty) {
+			dirty_entries.push_back(index);
+		}
+	}
+	else {
+		local_transforms.push_back(matrix4x4::identity);
+		world_transforms.push_back(matrix4x4::identity);
+		dirty_entries.push_back(index);
+	}
+
+	node->transform_store		= this;
+	node->transform_store_index	= index;
+
+	const NodeList *children = node->getChildren();
+	for(NodeList::const_iterator it=children->begin(); it!=children->end(); it++) {
+		collect(*it, static_cast<int32_t>(index), old_local_transforms, old_world_transforms);
+	}
+
+	return;
+}
@@ -0,0 +1,136 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#ifndef __WIESEL_GRAPH_TRANSFORM_STORE_H__
+#define	__WIESEL_GRAPH_TRANSFORM_STORE_H__
+
+#include <wiesel/wiesel-core.def>
+
+#include "node.h"
+
+#include <wiesel/math/matrix.h>
+
+#include <stdint.h>
+#include <vector>
+
+
+namespace wiesel {
+
+	/**
+	 * @brief Stores the transformations of all nodes of a scene graph in contiguous arrays.
+	 * Each node will be stored by an index, sorted, so each parent precedes all of it's children.
+	 * This allows to update all world transforms within a single linear pass over the arrays,
+	 * instead of visiting each node on it's own.
+	 * Only nodes, which have changed their own transformation, need to compute their
+	 * local transform again. The updated world transforms will be written back into the nodes.
+	 */
+	class WIESEL_CORE_EXPORT TransformStore
+	{
+	public:
+		/**
+		 * @brief Creates a new store for the given root node.
+		 * @param root			The root of the scene graph, which should not have any parent.
+		 */
+		TransformStore(Node *root);
+
+		~TransformStore();
+
+	public:
+		/**
+		 * @brief Updates all world transforms, which have changed since the last update.
+		 * This will be done automatically, when a world transform of any node of the store
+		 * will be requested.
+		 */
+		void update();
+
+		/**
+		 * @brief Checks, if any transform may have changed since the last update.
+		 */
+		bool isDirty() const;
+
+		/**
+		 * @brief Flags the structure of the scene graph as changed,
+		 * so the arrays will be rebuilt on the next update.
+		 * This will be called automatically, when nodes are added or removed.
+		 */
+		void invalidate();
+
+		/**
+		 * @brief Flags the local transform of a single node as changed.
+		 * This will be called automatically, when the node's transformation was changed.
+		 */
+		void markDirty(uint32_t index);
+
+		/**
+		 * @brief Removes a node and all of it's children from this store.
+		 * This will be called automatically, when the node was removed from the scene graph.
+		 */
+		void remove(Node *node);
+
+		/**
+		 * @brief Get the number of nodes stored.
+		 */
+		inline size_t size() const {
+			return nodes.size();
+		}
+
+	private:
+		/// rebuilds all arrays from the scene graph.
+		void rebuild();
+
+		/// adds a node and all of it's children to the new arrays,
+		/// keeping the transforms of nodes, which were already stored.
+		void collect(
+				Node *node, int32_t parent,
+				const std::vector<matrix4x4> &old_local_transforms,
+				const std::vector<matrix4x4> &old_world_transforms
+		);
+
+	private:
+		Node*					root;
+
+		std::vector<Node*>		nodes;
+		std::vector<int32_t>	parents;
+		std::vector<matrix4x4>	local_transforms;
+		std::vector<matrix4x4>	world_transforms;
+
+		/// flags each entry, which depends on the parent's transformation, like viewports.
+		std::vector<uint8_t>	depends_on_parent;
+
+		/// flags each entry, whose world transform needs to be updated.
+		std::vector<uint8_t>	changed;
+
+		/// all entries, whose local transforms have changed since the last update.
+		std::vector<uint32_t>	dirty_entries;
+
+		/// the transform epoch of the last update.
+		uint32_t				validated_epoch;
+
+		/// when true, the arrays need to be rebuilt.
+		bool					structure_dirty;
+
+		/// when true, the store is currently updating it's transforms.
+		bool					updating;
+	};
+
+}
+
+#endif	/* __WIESEL_GRAPH_TRANSFORM_STORE_H__ */
@@ -21,6 +21,8 @@
  */
 #include "viewport.h"
 
+#include <wiesel/video/render_context.h>
+
 using namespace wiesel;
 
 
@@ -67,8 +69,12 @@ void Viewport::setScaleMode(uint32_t flags, const dimension& dim, const vector2d
 }
 
 
+bool Viewport::dependsOnParentTransform() const {
+	return true;
+}
+
+
 void Viewport::computeLocalTransform(matrix4x4 *transform) {
-	local_transform = matrix4x4::identity;
 	rectangle parent_viewport = getParentViewport();
 	rectangle new_viewport(vector2d::zero, viewport_requested_dimension);
 
@@ -146,6 +152,40 @@ void Viewport::computeLocalTransform(matrix4x4 *transform) {
 }
 
 
+void Viewport::render(video::RenderContext *render_context) {
+	if (isTransformDirty()) {
+		updateTransform();
+	}
+
+	// get the viewport's area in world coordinates
+	rectangle area = rectangle(vector2d::zero * getWorldTransform(), dimension(0, 0));
+	area = createUnion(area, rectangle(vector2d(viewport.size.width, 0) * getWorldTransform(), dimension(0, 0)));
+	area = createUnion(area, rectangle(vector2d(0, viewport.size.height) * getWorldTransform(), dimension(0, 0)));
+	area = createUnion(area, rectangle(vector2d(viewport.size.width, viewport.size.height) * getWorldTransform(), dimension(0, 0)));
+
+	bool		had_cull_rectangle	= render_context->hasCullRectangle();
+	rectangle	old_cull_rectangle	= render_context->getCullRectangle();
+
+	// nested viewports cannot show more than their parents
+	if (had_cull_rectangle) {
+		area = createIntersection(old_cull_rectangle, area);
+	}
+
+	render_context->setCullRectangle(area);
+
+	Node2D::render(render_context);
+
+	if (had_cull_rectangle) {
+		render_context->setCullRectangle(old_cull_rectangle);
+	}
+	else {
+		render_context->clearCullRectangle();
+	}
+
+	return;
+}
+
+
 rectangle Viewport::getParentViewport() {
 	Viewport *parent = findFrom(getParent());
 	if (parent) {
@@ -136,9 +136,22 @@ namespace wiesel {
 			return viewport.size;
 		}
 
+	public:
+		/**
+		 * @brief Renders this viewport and all of it's children.
+		 * While rendering the children, the viewport's area will be used as the
+		 * render context's cull rectangle, so children outside this area will be skipped.
+		 */
+		virtual void render(video::RenderContext *render_context);
+
 	protected:
 		virtual void computeLocalTransform(matrix4x4 *transform);
 
+		/**
+		 * @brief The viewport's transformation depends on the size of it's parent viewport.
+		 */
+		virtual bool dependsOnParentTransform() const;
+
 		/**
 		 * @brief Get the parent's viewport.
 		 */
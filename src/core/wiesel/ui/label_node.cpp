@@ -22,6 +22,8 @@
 #include "label_node.h"
 #include "font.h"
 
+#include <typeinfo>
+
 using namespace wiesel;
 
 LabelNode::LabelNode() {
@@ -35,6 +37,11 @@ LabelNode::~LabelNode() {
 }
 
 
+bool LabelNode::usesAffineTransform() const {
+	return typeid(*this) == typeid(LabelNode);
+}
+
+
 
 void LabelNode::setFont(Font* font) {
 	if (this->font != font) {
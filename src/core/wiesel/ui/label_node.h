@@ -85,6 +85,10 @@ namespace wiesel {
 			return align;
 		}
 
+	// Node2D
+	protected:
+		virtual bool usesAffineTransform() const;
+
 	protected:
 		/**
 		 * @brief Update the label's content, if possible.
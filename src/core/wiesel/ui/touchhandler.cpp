@@ -21,6 +21,8 @@
  */
 #include "touchhandler.h"
 #include "wiesel/graph/node.h"
+#include "wiesel/graph/scene.h"
+#include "wiesel/graph/spatial_index.h"
 #include "wiesel/engine.h"
 
 using namespace wiesel;
@@ -69,6 +71,27 @@ static Node* recursive_findNode(Touch *touch, Node *node) {
 }
 
 
+static Node* indexed_findNode(Touch *touch, SpatialIndex *index) {
+	NodeList candidates;
+	index->findNodesAt(touch->getScreenLocation(), &candidates);
+
+	// ask all nodes at the touch location, starting with the frontmost
+	for(NodeList::iterator it=candidates.begin(); it!=candidates.end(); it++) {
+		TouchReceiver *receiver = dynamic_cast<TouchReceiver*>(*it);
+		if (receiver) {
+			receiver->onTouchStarted(touch);
+
+			// check, if the touch was claimed
+			if (touch->getOwner()) {
+				return *it;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+
 
 
 TouchHandler::TouchHandler() {
@@ -101,7 +124,12 @@ void TouchHandler::startTouch(TouchID id, float x, float y) {
 
 	// search for a node which claims the touch
 	for(SceneList::const_reverse_iterator it=app->getSceneStack()->rbegin(); it!=app->getSceneStack()->rend(); it++) {
-		node = recursive_findNode(touch, *it);
+		if ((*it)->getSpatialIndex()) {
+			node = indexed_findNode(touch, (*it)->getSpatialIndex());
+		}
+		else {
+			node = recursive_findNode(touch, *it);
+		}
 
 		if (node) {
 			break;
@@ -0,0 +1,83 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "profiler_output.h"
+#include "log.h"
+
+#include <wiesel/io/file.h>
+#include <wiesel/io/filesystem.h>
+#include <wiesel/util/profiler.h>
+
+#include <fstream>
+
+using namespace wiesel;
+
+
+/**
+ * @brief Opens a native file within a file system for writing.
+ */
+static bool openForWriting(FileSystem *fs, const std::string &filename, std::ofstream *out) {
+	if (fs == NULL) {
+		return false;
+	}
+
+	ref<File> file = fs->createFile(filename);
+	if (file == NULL) {
+		logmsg(LogLevel_Error, WIESEL_LOG_TAG, "cannot create profiler output %s", filename.c_str());
+		return false;
+	}
+
+	// only native files can be written
+	std::string path = file->getNativePath();
+	if (path.empty()) {
+		logmsg(LogLevel_Error, WIESEL_LOG_TAG, "cannot write profiler output %s", filename.c_str());
+		return false;
+	}
+
+	out->open(path.c_str(), std::ios::out | std::ios::trunc);
+
+	return out->is_open();
+}
+
+
+
+bool ProfilerOutput::writeChromeTrace(FileSystem *fs, const std::string &filename) {
+	std::ofstream out;
+	if (openForWriting(fs, filename, &out) == false) {
+		return false;
+	}
+
+	Profiler::getInstance()->writeChromeTrace(out);
+
+	return out.good();
+}
+
+
+bool ProfilerOutput::writeSummary(FileSystem *fs, const std::string &filename) {
+	std::ofstream out;
+	if (openForWriting(fs, filename, &out) == false) {
+		return false;
+	}
+
+	Profiler::getInstance()->writeSummary(out);
+
+	return out.good();
+}
@@ -0,0 +1,65 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#ifndef __WIESEL_UTIL_PROFILER_OUTPUT_H__
+#define __WIESEL_UTIL_PROFILER_OUTPUT_H__
+
+#include <wiesel/wiesel-core.def>
+
+#include <string>
+
+
+namespace wiesel {
+
+	class FileSystem;
+
+
+	/**
+	 * @brief Writes the results of the \ref Profiler into files.
+	 * Usually the results should be written into the application's
+	 * data file system, see \ref Engine::getDataFileSystem.
+	 */
+	class WIESEL_CORE_EXPORT ProfilerOutput
+	{
+	private:
+		ProfilerOutput() {}
+
+	public:
+		/**
+		 * @brief Writes all recorded frames as a Chrome trace_event JSON file.
+		 * @param fs		The file system to write into.
+		 * @param filename	The name of the file to be created or replaced.
+		 * @return \c true on success.
+		 */
+		static bool writeChromeTrace(FileSystem *fs, const std::string &filename);
+
+		/**
+		 * @brief Writes the average and maximum time of each phase into a text file.
+		 * @param fs		The file system to write into.
+		 * @param filename	The name of the file to be created or replaced.
+		 * @return \c true on success.
+		 */
+		static bool writeSummary(FileSystem *fs, const std::string &filename);
+	};
+
+}
+
+#endif /* __WIESEL_UTIL_PROFILER_OUTPUT_H__ */
@@ -23,6 +23,7 @@
 #include "screen.h"
 #include "video_driver.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <malloc.h>
 #include <string.h>
@@ -38,6 +39,9 @@ IndexBuffer::IndexBuffer() {
 	this->num_entries	= 0;
 	this->capacity		= 0;
 	this->data			= NULL;
+	this->usage			= BufferUsageStatic;
+	this->dirty_begin	= 0;
+	this->dirty_end		= 0;
 
 	setBytesPerElement(2);
 
@@ -49,6 +53,9 @@ IndexBuffer::IndexBuffer(int bytes) {
 	this->num_entries	= 0;
 	this->capacity		= 0;
 	this->data			= NULL;
+	this->usage			= BufferUsageStatic;
+	this->dirty_begin	= 0;
+	this->dirty_end		= 0;
 
 	setBytesPerElement(bytes);
 
@@ -131,13 +138,19 @@ IndexBuffer::index_t IndexBuffer::setCapacity(index_t capacity) {
 
 IndexBuffer::index_t IndexBuffer::ensureCapacity(index_t capacity) {
 	if (this->capacity < capacity) {
-		return setCapacity(capacity);
+		// grow geometrically, so adding single indices doesn't reallocate each time
+		return setCapacity(std::max(capacity, this->capacity * 2));
 	}
 
 	return this->capacity;
 }
 
 
+IndexBuffer::index_t IndexBuffer::reserve(index_t count) {
+	return ensureCapacity(num_entries + count);
+}
+
+
 IndexBuffer::index_t IndexBuffer::getCapacity() const {
 	return this->capacity;
 }
@@ -148,6 +161,24 @@ IndexBuffer::index_t IndexBuffer::getSize() const {
 }
 
 
+void IndexBuffer::setUsage(BufferUsage usage) {
+	if (this->usage != usage) {
+		this->usage = usage;
+
+		// the hardware buffer needs to be re-created with the new usage
+		invalidateHardwareData();
+	}
+
+	return;
+}
+
+
+void IndexBuffer::reset() {
+	num_entries = 0;
+	return;
+}
+
+
 void IndexBuffer::clear() {
 	if (data) {
 		free(data);
@@ -180,6 +211,87 @@ IndexBuffer::index_t IndexBuffer::addIndex(VertexBuffer::index_t entry) {
 }
 
 
+/// writes a list of index values with an offset into a typed index array.
+template <typename T>
+static void writeIndices(IndexBuffer::data_t data, const VertexBuffer::index_t *values, IndexBuffer::index_t count, VertexBuffer::index_t base) {
+	T *target = reinterpret_cast<T*>(data);
+
+	for(IndexBuffer::index_t i=0; i<count; i++) {
+		target[i] = static_cast<T>(values[i] + base);
+	}
+
+	return;
+}
+
+
+/// writes the indices of two triangles for each quad into a typed index array.
+template <typename T>
+static void writeQuads(IndexBuffer::data_t data, VertexBuffer::index_t first_vertex, IndexBuffer::index_t num_quads) {
+	T *target = reinterpret_cast<T*>(data);
+
+	for(IndexBuffer::index_t q=0; q<num_quads; q++) {
+		T v = static_cast<T>(first_vertex + q * 4);
+
+		*(target++) = v + 0;
+		*(target++) = v + 1;
+		*(target++) = v + 2;
+		*(target++) = v + 1;
+		*(target++) = v + 3;
+		*(target++) = v + 2;
+	}
+
+	return;
+}
+
+
+IndexBuffer::index_t IndexBuffer::addIndices(const VertexBuffer::index_t *values, index_t count, VertexBuffer::index_t base) {
+	index_t first        = num_entries;
+	index_t new_capacity = ensureCapacity(first + count);
+	assert(new_capacity >= first + count);
+
+	if (new_capacity >= first + count) {
+		data_t target = data + (bytes_per_entry * first);
+
+		switch(bytes_per_entry) {
+			case 1:		writeIndices<uint8_t>( target, values, count, base);		break;
+			case 2:		writeIndices<uint16_t>(target, values, count, base);		break;
+			case 4:		writeIndices<uint32_t>(target, values, count, base);		break;
+		}
+
+		num_entries += count;
+		markDirty(bytes_per_entry * first, bytes_per_entry * num_entries);
+	}
+
+	return first;
+}
+
+
+IndexBuffer::index_t IndexBuffer::addQuads(VertexBuffer::index_t first_vertex, index_t num_quads) {
+	index_t first        = num_entries;
+	index_t count        = num_quads * 6;
+	index_t new_capacity = ensureCapacity(first + count);
+	assert(new_capacity >= first + count);
+
+	// check, if all vertices are addressable
+	assert(bytes_per_entry == 4 || (first_vertex + num_quads * 4) <= (1u << (bytes_per_entry * 8)));
+
+	if (new_capacity >= first + count) {
+		data_t target = data + (bytes_per_entry * first);
+
+		switch(bytes_per_entry) {
+			case 1:		writeQuads<uint8_t>( target, first_vertex, num_quads);		break;
+			case 2:		writeQuads<uint16_t>(target, first_vertex, num_quads);		break;
+			case 4:		writeQuads<uint32_t>(target, first_vertex, num_quads);		break;
+		}
+
+		num_entries += count;
+		markDirty(bytes_per_entry * first, bytes_per_entry * num_entries);
+	}
+
+	return first;
+}
+
+
 void IndexBuffer::setIndex(index_t index, VertexBuffer::index_t value) {
 	assert(index < num_entries);
 
@@ -203,14 +315,64 @@ void IndexBuffer::setIndex(index_t index, VertexBuffer::index_t value) {
 				break;
 			}
 		}
+
+		markDirty(bytes_per_entry * index, bytes_per_entry * (index + 1));
 	}
 
 	return;
 }
 
 
-void IndexBuffer::invalidateHardwareData() const {
-	// TODO: invalidate hardware data
+VertexBuffer::index_t IndexBuffer::getIndex(index_t index) const {
+	assert(index < num_entries);
+
+	if (index < num_entries) {
+		switch(bytes_per_entry) {
+			case 1: {
+				return (reinterpret_cast<const uint8_t*>(data))[index];
+			}
+
+			case 2: {
+				return (reinterpret_cast<const uint16_t*>(data))[index];
+			}
+
+			case 4: {
+				return (reinterpret_cast<const uint32_t*>(data))[index];
+			}
+		}
+	}
+
+	return 0;
+}
+
+
+void IndexBuffer::invalidateHardwareData() {
+	// the whole buffer needs to be uploaded again
+	dirty_begin = 0;
+	dirty_end   = bytes_per_entry * capacity;
+
+	return;
+}
+
+
+void IndexBuffer::markDirty(size_t begin, size_t end) {
+	if (isDirty()) {
+		dirty_begin = std::min(dirty_begin, begin);
+		dirty_end   = std::max(dirty_end,   end);
+	}
+	else {
+		dirty_begin = begin;
+		dirty_end   = end;
+	}
+
+	return;
+}
+
+
+void IndexBuffer::clearDirtyRange() {
+	dirty_begin = 0;
+	dirty_end   = 0;
+
 	return;
 }
 
@@ -27,6 +27,7 @@
 #include <wiesel/device_resource.h>
 
 #include "shader.h"
+#include "types.h"
 #include "vertexbuffer.h"
 
 #include <vector>
@@ -100,6 +101,26 @@ namespace video {
 		 */
 		index_t getSize() const;
 
+		/**
+		 * @brief ensures this index buffer can store the given amount of additional indices.
+		 * @return the new capacity.
+		 */
+		index_t reserve(index_t count);
+
+		/**
+		 * @brief set the usage hint of this buffer.
+		 * The hint tells the backend how often the content of this buffer will change,
+		 * so it can choose the best strategy to update the hardware buffer.
+		 */
+		void setUsage(BufferUsage usage);
+
+		/**
+		 * @brief get the usage hint of this buffer.
+		 */
+		inline BufferUsage getUsage() const {
+			return usage;
+		}
+
 
 
 		/**
@@ -115,6 +136,38 @@ namespace video {
 		 */
 		void setIndex(index_t index, VertexBuffer::index_t value);
 
+		/**
+		 * @brief get the value at a specific index.
+		 * @param index		The index of the IndexBuffer value to be read.
+		 * @return The index-value stored at the given index.
+		 */
+		VertexBuffer::index_t getIndex(index_t index) const;
+
+		/**
+		 * @brief adds a range of indices to this buffer.
+		 * The buffer's memory will be allocated only once for all indices.
+		 * @param values	The list of index values to be added.
+		 * @param count		The number of index values.
+		 * @param base		An offset which will be added to each index value.
+		 * @return The index of the first new index.
+		 */
+		index_t addIndices(const VertexBuffer::index_t *values, index_t count, VertexBuffer::index_t base=0);
+
+		/**
+		 * @brief adds the indices of two triangles for each quad of a list of quads.
+		 * Each quad consists of four consecutive vertices, ordered like a triangle strip
+		 * (top-left, bottom-left, top-right, bottom-right).
+		 * @param first_vertex	The index of the first vertex of the first quad.
+		 * @param num_quads		The number of quads to be added.
+		 * @return The index of the first new index.
+		 */
+		index_t addQuads(VertexBuffer::index_t first_vertex, index_t num_quads);
+
+		/**
+		 * @brief removes all indices, but keeps the allocated memory for new indices.
+		 */
+		void reset();
+
 		/**
 		 * @brief clears the content of this vertex buffer.
 		 */
@@ -131,6 +184,35 @@ namespace video {
 			return data;
 		}
 
+	// dirty range
+	public:
+		/**
+		 * @brief Checks, if any data was modified since the hardware buffer was updated.
+		 */
+		inline bool isDirty() const {
+			return dirty_begin < dirty_end;
+		}
+
+		/**
+		 * @brief Get the offset in bytes of the first modified byte.
+		 */
+		inline size_t getDirtyRangeBegin() const {
+			return dirty_begin;
+		}
+
+		/**
+		 * @brief Get the offset in bytes behind the last modified byte.
+		 */
+		inline size_t getDirtyRangeEnd() const {
+			return dirty_end;
+		}
+
+		/**
+		 * @brief Resets the dirty range.
+		 * This should be called by the backend after the hardware buffer was updated.
+		 */
+		void clearDirtyRange();
+
 	// DeviceResource implementation
 	protected:
 		virtual bool doLoadContent();
@@ -140,7 +222,12 @@ namespace video {
 		/**
 		 * @brief Invalidates the hardware buffer, so the buffer needs to be re-created next time.
 		 */
-		void invalidateHardwareData() const;
+		void invalidateHardwareData();
+
+		/**
+		 * @brief Marks a range of bytes as modified.
+		 */
+		void markDirty(size_t begin, size_t end);
 
 	private:
 		int						bytes_per_entry;
@@ -149,6 +236,10 @@ namespace video {
 		index_t					capacity;
 
 		data_t					data;
+
+		BufferUsage				usage;
+		size_t					dirty_begin;
+		size_t					dirty_end;
 	};
 
 
@@ -20,8 +20,15 @@
  * Boston, MA 02110-1301 USA
  */
 #include "render_context.h"
+#include "indexbuffer.h"
 #include "render_buffer.h"
+#include "shader_target.h"
 #include "shaders.h"
+#include "texture_target.h"
+#include "vertexbuffer.h"
+
+#include "wiesel/application.h"
+#include "wiesel/engine.h"
 
 using namespace wiesel;
 using namespace wiesel::video;
@@ -29,13 +36,23 @@ using namespace wiesel::video;
 
 
 RenderContext::RenderContext() {
-	this->screen = NULL;
+	this->screen					= NULL;
+	this->batching_enabled			= true;
+	this->render_queue_enabled		= false;
+	this->cull_rectangle_enabled	= false;
+	this->capture_target			= NULL;
+	this->captured_render_target_switches	= 0;
 	return;
 }
 
 
 RenderContext::RenderContext(Screen *screen) {
-	this->screen = screen;
+	this->screen					= screen;
+	this->batching_enabled			= true;
+	this->render_queue_enabled		= false;
+	this->cull_rectangle_enabled	= false;
+	this->capture_target			= NULL;
+	this->captured_render_target_switches	= 0;
 
 	return;
 }
@@ -46,7 +63,31 @@ RenderContext::~RenderContext() {
 }
 
 
+void RenderContext::finishFrameStatistics() {
+	statistics = frame_statistics;
+	statistics.addProfilerCounters();
+
+	// publish the completed frame to the running application
+	Application *app = Engine::getInstance()->getApplication();
+	if (app) {
+		app->setRenderStatistics(statistics);
+	}
+
+	frame_statistics.reset();
+
+	return;
+}
+
+
 bool RenderContext::pushRenderBuffer(RenderBuffer* render_buffer) {
+	// pending primitives belong to the current render target
+	flushBatch();
+
+	// captured geometry can't follow the switch to another render target
+	if (capture_target) {
+		++captured_render_target_switches;
+	}
+
 	if (renderbuffer_stack.empty() || renderbuffer_stack.top() != render_buffer) {
 		if (render_buffer->getContent() && render_buffer->getContent()->enableRenderBuffer(this)) {
 			render_buffer->getContent()->preRender(this);
@@ -61,6 +102,9 @@ bool RenderContext::pushRenderBuffer(RenderBuffer* render_buffer) {
 
 
 void RenderContext::popRenderBuffer(RenderBuffer* render_buffer) {
+	// pending primitives belong to the current render target
+	flushBatch();
+
 	if (renderbuffer_stack.empty() == false) {
 		assert(renderbuffer_stack.top() == render_buffer);
 
@@ -88,3 +132,153 @@ void RenderContext::popRenderBuffer(RenderBuffer* render_buffer) {
 
 	return;
 }
+
+
+
+void RenderContext::setBatchingEnabled(bool enabled) {
+	if (this->batching_enabled != enabled) {
+		flushBatch();
+		this->batching_enabled = enabled;
+	}
+
+	return;
+}
+
+
+void RenderContext::drawBatched(Primitive primitive, const VertexBuffer *vertices, const matrix4x4 &transform) {
+	drawBatched(primitive, vertices, NULL, transform);
+}
+
+
+void RenderContext::drawBatched(Primitive primitive, const VertexBuffer *vertices, const IndexBuffer *indices, const matrix4x4 &transform) {
+	if (
+			isBatchingEnabled()
+		&&	sprite_batch.canBatch(vertices)
+		&&	vertices->getSize() <= SpriteBatch::MAX_VERTICES
+	) {
+		// draw the current batch, when the new vertices doesn't fit into it
+		if (
+				sprite_batch.isCompatible(vertices) == false
+			||	sprite_batch.hasSpaceFor(vertices->getSize()) == false
+		) {
+			flushBatch();
+		}
+
+		if (sprite_batch.add(primitive, vertices, indices, transform)) {
+			return;
+		}
+	}
+
+	// not batched, so draw immediately
+	setModelviewMatrix(transform);
+
+	if (indices) {
+		draw(primitive, vertices, indices);
+	}
+	else {
+		draw(primitive, vertices);
+	}
+
+	return;
+}
+
+
+void RenderContext::flushBatch() {
+	// queued packets need to be drawn before anything else
+	if (render_queue.isEmpty() == false && render_queue.isFlushing() == false) {
+		render_queue.flush(this);
+	}
+
+	if (sprite_batch.isEmpty() == false && sprite_batch.isFlushing() == false) {
+		sprite_batch.flush(this);
+	}
+
+	return;
+}
+
+
+
+void RenderContext::setCullRectangle(const rectangle &area) {
+	this->cull_rectangle			= area;
+	this->cull_rectangle_enabled	= true;
+	return;
+}
+
+
+void RenderContext::clearCullRectangle() {
+	this->cull_rectangle_enabled	= false;
+	return;
+}
+
+
+
+RenderQueue::DrawPacketList *RenderContext::setCaptureTarget(RenderQueue::DrawPacketList *packets) {
+	RenderQueue::DrawPacketList *previous = capture_target;
+	capture_target = packets;
+
+	return previous;
+}
+
+
+
+void RenderContext::setRenderQueueEnabled(bool enabled) {
+	if (this->render_queue_enabled != enabled) {
+		flushBatch();
+		this->render_queue_enabled = enabled;
+	}
+
+	return;
+}
+
+
+void RenderContext::submit(
+				Primitive primitive, const VertexBuffer *vertices, const matrix4x4 &transform,
+				ShaderTarget *shader_target, TextureTarget *texture_target
+) {
+	submit(primitive, vertices, NULL, transform, shader_target, texture_target);
+}
+
+
+void RenderContext::submit(
+				Primitive primitive, const VertexBuffer *vertices, const IndexBuffer *indices,
+				const matrix4x4 &transform,
+				ShaderTarget *shader_target, TextureTarget *texture_target
+) {
+	if (capture_target) {
+		RenderQueue::DrawPacket packet;
+		packet.primitive		= primitive;
+		packet.vertices			= vertices;
+		packet.indices			= indices;
+		packet.shader_target	= shader_target;
+		packet.texture_target	= texture_target;
+		packet.transform		= transform;
+
+		capture_target->push_back(packet);
+
+		return;
+	}
+
+	if (isRenderQueueEnabled() && render_queue.isFlushing() == false) {
+		// draw all packets so far, when the queue cannot store any further packets
+		if (render_queue.isFull()) {
+			flushBatch();
+		}
+
+		render_queue.submit(primitive, vertices, indices, transform, shader_target, texture_target, 0.0f);
+
+		return;
+	}
+
+	if (shader_target) {
+		shader_target->applyShaderConfigTo(this);
+	}
+
+	if (texture_target) {
+		texture_target->applyTextureConfigTo(this);
+	}
+
+	drawBatched(primitive, vertices, indices, transform);
+
+	return;
+}
+
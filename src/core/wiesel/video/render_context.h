@@ -23,8 +23,11 @@
 #define	__WIESEL_VIDEO_RENDER_CONTEXT_H__
 
 #include "wiesel/wiesel-core.def"
+#include "render_queue.h"
+#include "render_statistics.h"
 #include "screen.h"
 #include "shader.h"
+#include "sprite_batch.h"
 #include "types.h"
 
 #include <wiesel/device.h>
@@ -42,7 +45,9 @@ namespace video {
 	class IndexBuffer;
 	class Shader;
 	class RenderBuffer;
+	class ShaderTarget;
 	class Texture;
+	class TextureTarget;
 	class VertexBuffer;
 
 
@@ -177,6 +182,207 @@ namespace video {
 		 */
 		virtual void draw(Primitive primitive, const VertexBuffer *vertices, const IndexBuffer *indices) = 0;
 
+		/**
+		 * @brief Checks, if this context is able to draw instanced primitives via \ref drawInstanced.
+		 */
+		virtual bool isInstancingSupported() const = 0;
+
+		/**
+		 * @brief Draws the primitives of the given vertex buffer once for each instance.
+		 * The attributes of the instance buffer will advance once per instance instead of once per vertex.
+		 * The active shader needs to read the instance attributes, like the shader
+		 * created by \ref Shaders::getSpriteInstanceShader.
+		 * @param primitive		The type of primitive which should be drawn using the vertex data.
+		 * @param vertices		A vertex buffer containing the vertex data to be drawn.
+		 * @param instances		A vertex buffer containing one entry for each instance to be drawn.
+		 */
+		virtual void drawInstanced(Primitive primitive, const VertexBuffer *vertices, const VertexBuffer *instances) = 0;
+
+	// batching
+	public:
+		/**
+		 * @brief Enables or disables batching of draw calls made via \ref drawBatched.
+		 * When disabled, each call of \ref drawBatched will be drawn immediately.
+		 * Batching is enabled by default.
+		 */
+		void setBatchingEnabled(bool enabled);
+
+		/**
+		 * @brief Checks, if batching of draw calls is enabled.
+		 */
+		inline bool isBatchingEnabled() const {
+			return batching_enabled;
+		}
+
+		/**
+		 * @brief Draws some primitives, which may be merged with other primitives into a single draw call.
+		 * Consecutive calls using the same shader, textures and vertex format will be collected
+		 * and transformed on the CPU, until any render state changes or the batch will be flushed
+		 * explicitly. Vertex buffers, which cannot be batched, will be drawn immediately.
+		 * @param primitive		The type of primitive which should be drawn using the vertex data.
+		 * @param vertices		A vertex buffer containing the vertex data to be drawn.
+		 * @param transform		The modelview matrix for the given vertices.
+		 */
+		void drawBatched(Primitive primitive, const VertexBuffer *vertices, const matrix4x4 &transform);
+
+		/**
+		 * @brief Draws some primitives, which may be merged with other primitives into a single draw call.
+		 * @see drawBatched(Primitive,const VertexBuffer*,const matrix4x4&)
+		 * @param primitive		The type of primitive which should be drawn using the vertex data.
+		 * @param vertices		A vertex buffer containing the vertex data to be drawn.
+		 * @param indices		An index buffer containing the indices of the vertices, which should be drawn.
+		 * @param transform		The modelview matrix for the given vertices.
+		 */
+		void drawBatched(Primitive primitive, const VertexBuffer *vertices, const IndexBuffer *indices, const matrix4x4 &transform);
+
+		/**
+		 * @brief Draws all primitives, which are currently pending in the batch.
+		 * When the render queue is enabled, all queued packets will be drawn first.
+		 * This needs to be called by implementations before any render state will be changed.
+		 * Applications only need to call this before they're issuing graphics calls
+		 * without using the render context.
+		 */
+		void flushBatch();
+
+	// culling
+	public:
+		/**
+		 * @brief Set the visible area in world coordinates.
+		 * While a cull rectangle is set, nodes outside of this area will be skipped while rendering.
+		 * Usually this will be set by the active \ref wiesel::Viewport.
+		 */
+		void setCullRectangle(const rectangle &area);
+
+		/**
+		 * @brief Removes the current cull rectangle, so no nodes will be culled.
+		 */
+		void clearCullRectangle();
+
+		/**
+		 * @brief Checks, if a cull rectangle was set.
+		 */
+		inline bool hasCullRectangle() const {
+			return cull_rectangle_enabled;
+		}
+
+		/**
+		 * @brief Get the current cull rectangle in world coordinates.
+		 */
+		inline const rectangle& getCullRectangle() const {
+			return cull_rectangle;
+		}
+
+	// render queue
+	public:
+		/**
+		 * @brief Enables or disables the render queue.
+		 * When enabled, draw calls made via \ref submit will be collected and drawn sorted
+		 * by their render state, when the queue will be flushed. The queue will be flushed
+		 * automatically each time the render target or the projection changes, or any
+		 * other draw call will be made.
+		 * The render queue is disabled by default.
+		 */
+		void setRenderQueueEnabled(bool enabled);
+
+		/**
+		 * @brief Checks, if the render queue is enabled.
+		 */
+		inline bool isRenderQueueEnabled() const {
+			return render_queue_enabled;
+		}
+
+		/**
+		 * @brief Get the render queue of this context.
+		 */
+		inline RenderQueue *getRenderQueue() {
+			return &render_queue;
+		}
+
+		/**
+		 * @brief Draws some primitives using the shader and texture configuration of the given objects.
+		 * When the render queue is enabled, the draw call will be stored in the queue,
+		 * otherwise the configuration will be applied and the primitives will be drawn
+		 * via \ref drawBatched immediately.
+		 * @param primitive			The type of primitive which should be drawn using the vertex data.
+		 * @param vertices			A vertex buffer containing the vertex data to be drawn.
+		 * @param transform			The modelview matrix for the given vertices.
+		 * @param shader_target		The object providing the shader configuration. May be \c NULL.
+		 * @param texture_target	The object providing the texture configuration. May be \c NULL.
+		 */
+		void submit(
+						Primitive primitive, const VertexBuffer *vertices, const matrix4x4 &transform,
+						ShaderTarget *shader_target, TextureTarget *texture_target
+		);
+
+		/**
+		 * @brief Draws some primitives using the shader and texture configuration of the given objects.
+		 * @see submit(Primitive,const VertexBuffer*,const matrix4x4&,ShaderTarget*,TextureTarget*)
+		 * @param primitive			The type of primitive which should be drawn using the vertex data.
+		 * @param vertices			A vertex buffer containing the vertex data to be drawn.
+		 * @param indices			An index buffer containing the indices of the vertices, which should be drawn.
+		 * @param transform			The modelview matrix for the given vertices.
+		 * @param shader_target		The object providing the shader configuration. May be \c NULL.
+		 * @param texture_target	The object providing the texture configuration. May be \c NULL.
+		 */
+		void submit(
+						Primitive primitive, const VertexBuffer *vertices, const IndexBuffer *indices,
+						const matrix4x4 &transform,
+						ShaderTarget *shader_target, TextureTarget *texture_target
+		);
+
+	// capturing
+	public:
+		/**
+		 * @brief Redirects all draw calls made via \ref submit into the given list, instead of drawing them.
+		 * This allows to collect the geometry of a subtree, for example to bake it into a single mesh.
+		 * Draw calls made directly via \ref draw will not be captured, they are still counted
+		 * in \ref getCurrentFrameStatistics. Render targets pushed via \ref pushRenderBuffer
+		 * while capturing are counted in \ref getCapturedRenderTargetSwitches.
+		 * @param packets	The list to receive the packets, or \c NULL to stop capturing.
+		 * @return The previous capture target, which should be restored after capturing.
+		 */
+		RenderQueue::DrawPacketList *setCaptureTarget(RenderQueue::DrawPacketList *packets);
+
+		/**
+		 * @brief Checks, if draw calls made via \ref submit are currently captured.
+		 */
+		inline bool isCapturing() const {
+			return capture_target != NULL;
+		}
+
+		/**
+		 * @brief Get the number of render buffers pushed while capturing.
+		 * Geometry captured after such a switch belongs to another render target,
+		 * so the capturing code can compare this value before and after capturing
+		 * to detect captures, which cannot be drawn into the current target.
+		 */
+		inline uint32_t getCapturedRenderTargetSwitches() const {
+			return captured_render_target_switches;
+		}
+
+	// statistics
+	public:
+		/**
+		 * @brief Get the statistics of the last frame, which was completely rendered.
+		 */
+		inline const RenderStatistics& getStatistics() const {
+			return statistics;
+		}
+
+		/**
+		 * @brief Get the statistics collected so far within the current frame.
+		 */
+		inline const RenderStatistics& getCurrentFrameStatistics() const {
+			return frame_statistics;
+		}
+
+	protected:
+		/**
+		 * @brief Completes the statistics of the current frame and starts collecting the next frame.
+		 * To be called by implementations at the end of \ref postRender.
+		 */
+		void finishFrameStatistics();
+
 	// pre/post-rendering
 	public:
 		virtual void preRender() = 0;
@@ -192,6 +398,24 @@ namespace video {
 
 		std::stack<RenderBuffer*>		renderbuffer_stack;
 		RenderBuffer*					active_renderbuffer;
+
+		/// the statistics of the frame currently rendered, to be updated by implementations.
+		RenderStatistics				frame_statistics;
+
+	private:
+		SpriteBatch						sprite_batch;
+		bool							batching_enabled;
+
+		RenderQueue						render_queue;
+		bool							render_queue_enabled;
+
+		RenderQueue::DrawPacketList*	capture_target;
+		uint32_t						captured_render_target_switches;
+
+		rectangle						cull_rectangle;
+		bool							cull_rectangle_enabled;
+
+		RenderStatistics				statistics;
 	};
 
 }
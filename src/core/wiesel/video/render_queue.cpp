@@ -0,0 +1,255 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "render_queue.h"
+#include "render_context.h"
+#include "shader_target.h"
+#include "texture_target.h"
+
+#include <assert.h>
+#include <string.h>
+
+
+using namespace wiesel;
+using namespace wiesel::video;
+
+
+
+RenderQueue::RenderQueue() {
+	this->layer			= 0;
+	this->order			= 0;
+	this->order_pending	= false;
+	this->flushing		= false;
+
+	return;
+}
+
+
+RenderQueue::~RenderQueue() {
+	return;
+}
+
+
+void RenderQueue::setLayer(uint8_t layer) {
+	this->layer = layer;
+	return;
+}
+
+
+void RenderQueue::nextOrderKey() {
+	this->order_pending = true;
+	return;
+}
+
+
+bool RenderQueue::isFull() const {
+	return order >= ((1u << ORDER_BITS) - 1);
+}
+
+
+uint32_t RenderQueue::getStateId(const void *object) {
+	if (object == NULL) {
+		return 0;
+	}
+
+	StateIdMap::iterator it = state_ids.find(object);
+	if (it != state_ids.end()) {
+		return it->second;
+	}
+
+	// ids are assigned in the order of their first use
+	uint32_t id = static_cast<uint32_t>(state_ids.size() + 1);
+	state_ids[object] = id;
+
+	return id;
+}
+
+
+void RenderQueue::submit(
+				Primitive primitive, const VertexBuffer *vertices, const IndexBuffer *indices,
+				const matrix4x4 &transform,
+				ShaderTarget *shader_target, TextureTarget *texture_target,
+				float depth
+) {
+	assert(isFlushing() == false);
+	assert(isFull() == false);
+
+	if (order_pending) {
+		order_pending = false;
+
+		if (packets.empty() == false) {
+			++order;
+		}
+	}
+
+	const Shader *shader = NULL;
+	if (shader_target) {
+		shader = shader_target->getShader();
+	}
+
+	const Texture *texture = NULL;
+	if (texture_target && texture_target->getTextureLayers() > 0) {
+		texture = texture_target->getTexture(0);
+	}
+
+	if (depth < 0.0f) {
+		depth = 0.0f;
+	}
+
+	if (depth > 1.0f) {
+		depth = 1.0f;
+	}
+
+	SortItem item;
+	item.key	= createSortKey(
+						layer,
+						order,
+						getStateId(shader),
+						getStateId(texture),
+						static_cast<uint32_t>(depth * ((1u << DEPTH_BITS) - 1))
+				);
+	item.index	= static_cast<uint32_t>(packets.size());
+	items.push_back(item);
+
+	DrawPacket packet;
+	packet.primitive		= primitive;
+	packet.vertices			= vertices;
+	packet.indices			= indices;
+	packet.shader_target	= shader_target;
+	packet.texture_target	= texture_target;
+	packet.transform		= transform;
+	packets.push_back(packet);
+
+	return;
+}
+
+
+void RenderQueue::flush(RenderContext *render_context) {
+	if (flushing || packets.empty()) {
+		return;
+	}
+
+	flushing = true;
+
+	scratch.resize(items.size());
+	radixSort(&items[0], &scratch[0], items.size());
+
+	ShaderTarget*	last_shader_target	= NULL;
+	TextureTarget*	last_texture_target	= NULL;
+
+	for(std::vector<SortItem>::const_iterator it=items.begin(); it!=items.end(); it++) {
+		const DrawPacket &packet = packets[it->index];
+
+		// only re-apply the configuration, when it comes from another object
+		if (packet.shader_target && packet.shader_target != last_shader_target) {
+			packet.shader_target->applyShaderConfigTo(render_context);
+			last_shader_target = packet.shader_target;
+		}
+
+		if (packet.texture_target && packet.texture_target != last_texture_target) {
+			packet.texture_target->applyTextureConfigTo(render_context);
+			last_texture_target = packet.texture_target;
+		}
+
+		render_context->drawBatched(packet.primitive, packet.vertices, packet.indices, packet.transform);
+	}
+
+	flushing = false;
+
+	clear();
+
+	return;
+}
+
+
+void RenderQueue::clear() {
+	packets.clear();
+	items.clear();
+	state_ids.clear();
+
+	order			= 0;
+	order_pending	= false;
+
+	return;
+}
+
+
+uint64_t RenderQueue::createSortKey(uint8_t layer, uint32_t order, uint32_t shader, uint32_t texture, uint32_t depth) {
+	const uint32_t max_order	= (1u << ORDER_BITS)   - 1;
+	const uint32_t max_shader	= (1u << SHADER_BITS)  - 1;
+	const uint32_t max_texture	= (1u << TEXTURE_BITS) - 1;
+	const uint32_t max_depth	= (1u << DEPTH_BITS)   - 1;
+
+	uint64_t key = layer;
+	key = (key << ORDER_BITS)	| (order   < max_order   ? order   : max_order);
+	key = (key << SHADER_BITS)	| (shader  < max_shader  ? shader  : max_shader);
+	key = (key << TEXTURE_BITS)	| (texture < max_texture ? texture : max_texture);
+	key = (key << DEPTH_BITS)	| (depth   < max_depth   ? depth   : max_depth);
+
+	return key;
+}
+
+
+void RenderQueue::radixSort(SortItem *items, SortItem *scratch, size_t count) {
+	if (count == 0) {
+		return;
+	}
+
+	SortItem *src = items;
+	SortItem *dst = scratch;
+
+	for(unsigned int shift=0; shift<64; shift+=8) {
+		size_t histogram[256];
+		memset(histogram, 0, sizeof(histogram));
+
+		for(size_t i=0; i<count; i++) {
+			++histogram[(src[i].key >> shift) & 0xff];
+		}
+
+		// skip this pass, when all keys share the same byte
+		if (histogram[(src[0].key >> shift) & 0xff] == count) {
+			continue;
+		}
+
+		size_t offset = 0;
+		for(unsigned int b=0; b<256; b++) {
+			size_t n = histogram[b];
+			histogram[b] = offset;
+			offset += n;
+		}
+
+		for(size_t i=0; i<count; i++) {
+			dst[histogram[(src[i].key >> shift) & 0xff]++] = src[i];
+		}
+
+		SortItem *tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+
+	// copy back, when the result was stored in the scratch buffer
+	if (src != items) {
+		memcpy(items, src, count * sizeof(SortItem));
+	}
+
+	return;
+}
+
@@ -0,0 +1,215 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#ifndef __WIESEL_VIDEO_RENDER_QUEUE_H__
+#define	__WIESEL_VIDEO_RENDER_QUEUE_H__
+
+#include <wiesel/wiesel-core.def>
+
+#include "types.h"
+
+#include <wiesel/math/matrix.h>
+
+#include <map>
+#include <stdint.h>
+#include <vector>
+
+
+namespace wiesel {
+namespace video {
+
+
+	class IndexBuffer;
+	class RenderContext;
+	class ShaderTarget;
+	class TextureTarget;
+	class VertexBuffer;
+
+
+
+	/**
+	 * @brief Collects draw packets of a render pass and submits them sorted by their render state.
+	 * Each packet gets a 64 bit sort key, which contains (from the highest to the lowest bits)
+	 * the layer, the order key, the shader, the texture and the depth of the draw call.
+	 * The order key will be increased by the scene graph, each time the ordering constraints
+	 * given by \ref wiesel::NodeOrder require the following packets to be drawn after the
+	 * previous ones. Packets sharing the same layer and order key may be reordered to
+	 * minimize shader and texture changes.
+	 * The packets only store references to their vertex data and render configuration,
+	 * so all objects need to stay valid until the queue was flushed.
+	 */
+	class WIESEL_CORE_EXPORT RenderQueue
+	{
+	public:
+		/// number of bits used for each part of the sort key
+		static const unsigned int LAYER_BITS	= 8;
+		static const unsigned int ORDER_BITS	= 20;
+		static const unsigned int SHADER_BITS	= 12;
+		static const unsigned int TEXTURE_BITS	= 12;
+		static const unsigned int DEPTH_BITS	= 12;
+
+		/**
+		 * @brief A single draw call stored in the queue.
+		 */
+		struct DrawPacket {
+			Primitive				primitive;
+			const VertexBuffer*		vertices;
+			const IndexBuffer*		indices;
+			ShaderTarget*			shader_target;
+			TextureTarget*			texture_target;
+			matrix4x4				transform;
+		};
+
+		/// Alias type for a list of draw packets.
+		typedef std::vector<DrawPacket>		DrawPacketList;
+
+		/**
+		 * @brief An entry of the list to be sorted, referencing a packet by it's index.
+		 */
+		struct SortItem {
+			uint64_t				key;
+			uint32_t				index;
+		};
+
+	public:
+		RenderQueue();
+		~RenderQueue();
+
+	public:
+		/**
+		 * @brief Set the layer for all upcoming packets.
+		 * Packets on a lower layer will always be drawn before packets on higher layers.
+		 */
+		void setLayer(uint8_t layer);
+
+		/**
+		 * @brief Get the layer of upcoming packets.
+		 */
+		inline uint8_t getLayer() const {
+			return layer;
+		}
+
+		/**
+		 * @brief Requests all upcoming packets to be drawn after all packets stored so far
+		 * on the same layer. The order key will be increased with the next packet submitted,
+		 * so multiple calls without any packets in between share the same order key.
+		 */
+		void nextOrderKey();
+
+		/**
+		 * @brief Checks, if the queue ran out of order keys.
+		 * In this case, the queue needs to be flushed before submitting more packets.
+		 */
+		bool isFull() const;
+
+		/**
+		 * @brief Stores a new draw packet in this queue.
+		 * @param primitive			The type of primitive which should be drawn using the vertex data.
+		 * @param vertices			A vertex buffer containing the vertex data to be drawn.
+		 * @param indices			An optional index buffer. May be \c NULL.
+		 * @param transform			The modelview matrix for the given vertices.
+		 * @param shader_target		The object providing the shader configuration. May be \c NULL.
+		 * @param texture_target	The object providing the texture configuration. May be \c NULL.
+		 * @param depth				The depth of this packet within the range of 0.0 and 1.0,
+		 *							used to sort packets with the same render state.
+		 */
+		void submit(
+						Primitive primitive, const VertexBuffer *vertices, const IndexBuffer *indices,
+						const matrix4x4 &transform,
+						ShaderTarget *shader_target, TextureTarget *texture_target,
+						float depth
+		);
+
+		/**
+		 * @brief Sorts all stored packets and draws them using the given render context.
+		 * The queue will be empty afterwards.
+		 */
+		void flush(RenderContext *render_context);
+
+		/**
+		 * @brief Removes all stored packets without drawing them.
+		 */
+		void clear();
+
+	// getter
+	public:
+		/**
+		 * @brief Checks, if there are no packets stored in this queue.
+		 */
+		inline bool isEmpty() const {
+			return packets.empty();
+		}
+
+		/**
+		 * @brief Get the number of packets stored in this queue.
+		 */
+		inline size_t size() const {
+			return packets.size();
+		}
+
+		/**
+		 * @brief Checks, if this queue is currently drawing it's content.
+		 */
+		inline bool isFlushing() const {
+			return flushing;
+		}
+
+	// utilities
+	public:
+		/**
+		 * @brief Creates a sort key from it's single parts.
+		 * Each value will be clamped to the number of bits available for it's part.
+		 */
+		static uint64_t createSortKey(uint8_t layer, uint32_t order, uint32_t shader, uint32_t texture, uint32_t depth);
+
+		/**
+		 * @brief Sorts a list of items by their keys using a stable LSD radix sort.
+		 * Passes on bytes, which are equal for all keys, will be skipped.
+		 * @param items		The items to be sorted.
+		 * @param scratch	A buffer of the same size as \c items, used as temporary storage.
+		 * @param count		The number of items.
+		 */
+		static void radixSort(SortItem *items, SortItem *scratch, size_t count);
+
+	private:
+		/// get a small id for a state object, which is unique until the queue will be cleared.
+		uint32_t getStateId(const void *object);
+
+	private:
+		typedef std::map<const void*, uint32_t>	StateIdMap;
+
+		DrawPacketList				packets;
+		std::vector<SortItem>		items;
+		std::vector<SortItem>		scratch;
+
+		StateIdMap					state_ids;
+
+		uint8_t						layer;
+		uint32_t					order;
+		bool						order_pending;
+		bool						flushing;
+	};
+
+}
+}
+
+#endif	// __WIESEL_VIDEO_RENDER_QUEUE_H__
+
@@ -0,0 +1,102 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "render_statistics.h"
+
+#include <wiesel/util/profiler.h>
+
+using namespace wiesel;
+using namespace wiesel::video;
+
+
+RenderStatistics::RenderStatistics() {
+	reset();
+	return;
+}
+
+
+void RenderStatistics::reset() {
+	draw_calls				= 0;
+	primitives				= 0;
+	vertices				= 0;
+	shader_switches			= 0;
+	texture_binds			= 0;
+	uniform_uploads			= 0;
+	buffer_upload_bytes		= 0;
+	render_target_switches	= 0;
+	error_checks			= 0;
+
+	return;
+}
+
+
+RenderStatistics& RenderStatistics::operator+=(const RenderStatistics &other) {
+	draw_calls				+= other.draw_calls;
+	primitives				+= other.primitives;
+	vertices				+= other.vertices;
+	shader_switches			+= other.shader_switches;
+	texture_binds			+= other.texture_binds;
+	uniform_uploads			+= other.uniform_uploads;
+	buffer_upload_bytes		+= other.buffer_upload_bytes;
+	render_target_switches	+= other.render_target_switches;
+	error_checks			+= other.error_checks;
+
+	return *this;
+}
+
+
+void RenderStatistics::countDrawCall(Primitive primitive, uint32_t vertices, uint32_t instances) {
+	uint32_t primitives_per_instance = 0;
+
+	switch(primitive) {
+		case Triangles: {
+			primitives_per_instance = vertices / 3;
+			break;
+		}
+
+		case TriangleStrip:
+		case TriangleFan: {
+			primitives_per_instance = vertices > 2 ? vertices - 2 : 0;
+			break;
+		}
+	}
+
+	this->draw_calls	+= 1;
+	this->primitives	+= primitives_per_instance * instances;
+	this->vertices		+= vertices * instances;
+
+	return;
+}
+
+
+void RenderStatistics::addProfilerCounters() const {
+	WIESEL_PROFILE_COUNTER("draw calls",				draw_calls);
+	WIESEL_PROFILE_COUNTER("primitives",				primitives);
+	WIESEL_PROFILE_COUNTER("vertices",					vertices);
+	WIESEL_PROFILE_COUNTER("shader switches",			shader_switches);
+	WIESEL_PROFILE_COUNTER("texture binds",				texture_binds);
+	WIESEL_PROFILE_COUNTER("uniform uploads",			uniform_uploads);
+	WIESEL_PROFILE_COUNTER("buffer upload bytes",		buffer_upload_bytes);
+	WIESEL_PROFILE_COUNTER("render target switches",	render_target_switches);
+	WIESEL_PROFILE_COUNTER("error checks",				error_checks);
+
+	return;
+}
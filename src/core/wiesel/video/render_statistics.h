@@ -0,0 +1,99 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#ifndef __WIESEL_VIDEO_RENDER_STATISTICS_H__
+#define	__WIESEL_VIDEO_RENDER_STATISTICS_H__
+
+#include <wiesel/wiesel-core.def>
+
+#include "types.h"
+
+#include <stdint.h>
+
+
+namespace wiesel {
+namespace video {
+
+	/**
+	 * @brief Counts the work done by a \ref RenderContext within a single frame.
+	 * State changes will only be counted, when they were actually passed
+	 * to the graphics API.
+	 */
+	struct WIESEL_CORE_EXPORT RenderStatistics
+	{
+		RenderStatistics();
+
+		/**
+		 * @brief Sets all counters to zero.
+		 */
+		void reset();
+
+		/**
+		 * @brief Adds the counters of another statistics object.
+		 */
+		RenderStatistics& operator+=(const RenderStatistics &other);
+
+		/**
+		 * @brief Counts a single draw call.
+		 * @param primitive		The type of primitives drawn.
+		 * @param vertices		The number of vertices drawn per instance.
+		 * @param instances		The number of instances drawn.
+		 */
+		void countDrawCall(Primitive primitive, uint32_t vertices, uint32_t instances=1);
+
+		/**
+		 * @brief Adds each counter to the current frame of the \ref Profiler.
+		 * Does nothing, when the profiler was disabled.
+		 */
+		void addProfilerCounters() const;
+
+		/// the number of draw calls issued.
+		uint32_t		draw_calls;
+
+		/// the number of primitives drawn, like triangles.
+		uint32_t		primitives;
+
+		/// the number of vertices drawn.
+		uint32_t		vertices;
+
+		/// the number of shader programs activated.
+		uint32_t		shader_switches;
+
+		/// the number of textures bound.
+		uint32_t		texture_binds;
+
+		/// the number of uniform values or uniform buffers uploaded.
+		uint32_t		uniform_uploads;
+
+		/// the number of bytes uploaded into vertex, index and uniform buffers.
+		uint64_t		buffer_upload_bytes;
+
+		/// the number of render target changes.
+		uint32_t		render_target_switches;
+
+		/// the number of times the graphics API was asked for errors.
+		uint32_t		error_checks;
+	};
+
+}
+}
+
+#endif	// __WIESEL_VIDEO_RENDER_STATISTICS_H__
@@ -73,6 +73,10 @@ namespace video {
 			VertexTextureCoordinate,
 
 			Texture,
+
+			InstancePosition,			//!< per-instance position, advanced once per instance.
+			InstanceColor,				//!< per-instance color, advanced once per instance.
+			InstanceData,				//!< indexed generic per-instance data, advanced once per instance.
 		};
 
 
@@ -183,6 +183,34 @@ bool ShaderBuilder::setDefaultAttributeName(Attribute attr, uint8_t index) {
 
 			return setAttributeName(attr, index, attr_name.str());
 		}
+
+		case InstancePosition: {
+			assert(index == 0);
+
+			if (index == 0) {
+				return setAttributeName(attr, index, Shaders::ATTRIBUTE_INSTANCE_POSITION);
+			}
+
+			break;
+		}
+
+		case InstanceColor: {
+			assert(index == 0);
+
+			if (index == 0) {
+				return setAttributeName(attr, index, Shaders::ATTRIBUTE_INSTANCE_COLOR);
+			}
+
+			break;
+		}
+
+		case InstanceData: {
+			std::stringstream attr_name;
+			attr_name << Shaders::ATTRIBUTE_INSTANCE_DATA;
+			attr_name << static_cast<int>(index);
+
+			return setAttributeName(attr, index, attr_name.str());
+		}
 	}
 
 	return false;
@@ -22,6 +22,7 @@
 #include "shader_constantbuffer.h"
 #include "video_driver.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <malloc.h>
 #include <string.h>
@@ -155,6 +156,9 @@ ShaderConstantBuffer::ShaderConstantBuffer(const ShaderConstantBufferTemplate *b
 
 		// zero memory
 		memset(this->data, '\0', buffer_size);
+
+		// each entry starts with the buffer's initial version
+		this->entry_versions.resize(this->buffer_template->getEntries()->size(), this->change_ver);
 	}
 
 	return;
@@ -198,7 +202,8 @@ bool ShaderConstantBuffer::setShaderValueAt(index_t index, ValueType type, size_
 		const ShaderConstantBufferTemplate::EntryList* entries = getTemplate()->getEntries();
 		assert(index < static_cast<index_t>(entries->size()));
 
-		return writeDataAtOffset(
+		return writeData(
+					index,
 					(*entries)[index].offset,
 					pValue,
 					elements * getTypeSize(type)
@@ -248,12 +253,39 @@ const ShaderConstantBuffer::data_t ShaderConstantBuffer::getShaderDataPointerAt(
 
 
 bool ShaderConstantBuffer::writeDataAtOffset(size_t offset, const void *pValue, size_t size) {
+	return writeData(-1, offset, pValue, size);
+}
+
+
+bool ShaderConstantBuffer::writeData(ShaderConstantBufferTemplate::index_t index, size_t offset, const void *pValue, size_t size) {
 	if (
 			getTemplate()
 		&&	((offset + size) <= getTemplate()->getSize())
 	) {
+		// nothing to do, if the content doesn't change
+		if (memcmp(data + offset, pValue, size) == 0) {
+			return true;
+		}
+
 		memcpy(data + offset, pValue, size);
 		incrementChangeVersion();
+
+		if (index >= 0) {
+			entry_versions[index] = change_ver;
+		}
+		else {
+			// mark each entry overlapping the written range
+			const ShaderConstantBufferTemplate::EntryList *entries = getTemplate()->getEntries();
+			for(size_t i=0; i<entries->size(); i++) {
+				const ShaderConstantBufferTemplate::Entry &entry = (*entries)[i];
+				size_t entry_size = entry.elements * getTypeSize(entry.type);
+
+				if (entry.offset < offset + size && offset < entry.offset + entry_size) {
+					entry_versions[i] = change_ver;
+				}
+			}
+		}
+
 		return true;
 	}
 
@@ -271,7 +303,7 @@ bool ShaderConstantBuffer::doSetShaderValue(const std::string &name, ValueType t
 		) {
 			if (it->name == name) {
 				size_t size = elements * getTypeSize(type);
-				return writeDataAtOffset(it->offset, pValue, size);
+				return writeData(it - getTemplate()->getEntries()->begin(), it->offset, pValue, size);
 			}
 		}
 	}
@@ -283,6 +315,9 @@ bool ShaderConstantBuffer::doSetShaderValue(const std::string &name, ValueType t
 void ShaderConstantBuffer::incrementChangeVersion() {
 	if (change_ver == std::numeric_limits<version_t>::max()) {
 		change_ver = 1;
+
+		// older versions are no longer comparable, so each entry counts as changed
+		std::fill(entry_versions.begin(), entry_versions.end(), change_ver);
 	}
 	else {
 		++change_ver;
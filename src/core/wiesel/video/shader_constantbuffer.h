@@ -336,6 +336,24 @@ namespace video {
 			return change_ver;
 		}
 
+		/**
+		 * @brief Get the change version of the last write to a single entry.
+		 */
+		inline version_t getEntryChangeVersion(ShaderConstantBufferTemplate::index_t index) const {
+			return entry_versions[index];
+		}
+
+		/**
+		 * @brief Checks, if an entry was written since the buffer had the given change version.
+		 * This allows shaders to update only the modified entries of a buffer
+		 * when it was changed after the last time they were assigned to it.
+		 * When the change version has wrapped in the meantime, each entry is
+		 * considered to be changed.
+		 */
+		inline bool hasEntryChangedSince(ShaderConstantBufferTemplate::index_t index, version_t version) const {
+			return entry_versions[index] > version || change_ver < version;
+		}
+
 	// ShaderConstantBufferWriter
 	public:
 		/**
@@ -357,6 +375,13 @@ namespace video {
 		virtual bool doUnloadContent();
 
 	private:
+		/**
+		 * @brief Writes the data of a single entry or, when \c index is \c -1,
+		 * any data overlapping one or more entries.
+		 * Writing data equal to the buffer's current content won't change the buffer's version.
+		 */
+		bool writeData(ShaderConstantBufferTemplate::index_t index, size_t offset, const void *pValue, size_t size);
+
 		/**
 		 * @brief Increments the change version so other objects can check if this buffer was changed.
 		 */
@@ -366,6 +391,7 @@ namespace video {
 		const ShaderConstantBufferTemplate*	buffer_template;
 		data_t								data;
 		version_t							change_ver;
+		std::vector<version_t>				entry_versions;
 	};
 
 
@@ -23,6 +23,7 @@
 #include "shader_constantbuffer_builder.h"
 #include "wiesel/util/log.h"
 #include "shader_builder.h"
+#include "typed_vertexbuffer.h"
 
 #include <sstream>
 #include <string>
@@ -39,6 +40,10 @@ const char *Shaders::ATTRIBUTE_VERTEX_NORMAL					= "vNormal";
 const char *Shaders::ATTRIBUTE_VERTEX_COLOR						= "vColor";
 const char *Shaders::ATTRIBUTE_VERTEX_TEXTURE_COORDINATE		= "vTexCoord";
 
+const char *Shaders::ATTRIBUTE_INSTANCE_POSITION				= "iPosition";
+const char *Shaders::ATTRIBUTE_INSTANCE_COLOR					= "iColor";
+const char *Shaders::ATTRIBUTE_INSTANCE_DATA					= "iData";
+
 const char *Shaders::VARYING_COLOR								= "my_color";
 const char *Shaders::VARYING_NORMAL								= "my_normal";
 const char *Shaders::VARYING_TEXTURE_COORDINATE					= "my_texcoord";
@@ -115,6 +120,48 @@ Shader *Shaders::getShaderFor(VertexBuffer* vbo) {
 }
 
 
+Shader *Shaders::getSpriteInstanceShader() {
+	string key = "SpriteInstance";
+
+	// check, if there's already an shader in the vertex shader cache
+	Shader *shader = getShaderCache()->get(key);
+	if (shader == NULL) {
+		// the fragment shader matches the one of a colored vertex with a single texture
+		ref<VertexBuffer> fragment_layout = new VertexBuffer();
+		fragment_layout->setupVertexPositions(2);
+		fragment_layout->setupVertexColors(4);
+		fragment_layout->setupTextureLayer(0);
+
+		ShaderBuilder shader_builder;
+		DataSource *src_vert_glsl = getGlslSpriteInstanceVertexShaderSource(&shader_builder);
+		DataSource *src_frag_glsl = getGlslFragmentShaderSourceFor(&shader_builder, fragment_layout);
+		DataSource *src_vert_hlsl = getHlslSpriteInstanceVertexShaderSource(&shader_builder);
+		DataSource *src_pixl_hlsl = getHlslFragmentShaderSourceFor(&shader_builder, fragment_layout);
+
+		if (src_vert_glsl) {
+			shader_builder.setSource(Shader::GLSL_VERTEX_SHADER,   src_vert_glsl);
+		}
+
+		if (src_frag_glsl) {
+			shader_builder.setSource(Shader::GLSL_FRAGMENT_SHADER, src_frag_glsl);
+		}
+
+		if (src_vert_hlsl) {
+			shader_builder.setSource(Shader::HLSL_VERTEX_SHADER,   src_vert_hlsl);
+		}
+
+		if (src_pixl_hlsl) {
+			shader_builder.setSource(Shader::HLSL_FRAGMENT_SHADER, src_pixl_hlsl);
+		}
+
+		shader = shader_builder.create();
+		getShaderCache()->add(key, shader);
+	}
+
+	return shader;
+}
+
+
 ShaderConstantBufferTemplate *Shaders::getProjectionMatrixBufferTemplate() {
 	ShaderConstantBufferTemplate *projection_template = NULL;
 
@@ -149,6 +196,26 @@ ShaderConstantBufferTemplate *Shaders::getModelviewMatrixBufferTemplate() {
 }
 
 
+/**
+ * @brief Declares the modelview and projection matrix of a GLSL vertex shader.
+ * When uniform buffers are available, the projection matrix is declared within a uniform
+ * block named like it's constant buffer, so it can be shared by all shaders. The modelview
+ * matrix changes with almost every draw call, so it stays a plain uniform, which is cheaper
+ * to update than a buffer the GPU may still be reading from.
+ */
+static void writeGlslMatrixUniforms(stringstream &ss) {
+	ss << "#ifdef GL_ARB_uniform_buffer_object" << endl;
+	ss << "#extension GL_ARB_uniform_buffer_object : enable" << endl;
+	ss << "layout(std140) uniform " << Shaders::CONSTANTBUFFER_PROJECTION_MATRIX << " { mat4 " << Shaders::UNIFORM_PROJECTION_MATRIX << "; };" << endl;
+	ss << "#else" << endl;
+	ss << "uniform mat4 " << Shaders::UNIFORM_PROJECTION_MATRIX << ';' << endl;
+	ss << "#endif" << endl;
+	ss << "uniform mat4 " << Shaders::UNIFORM_MODELVIEW_MATRIX << ';' << endl;
+
+	return;
+}
+
+
 DataSource *Shaders::getGlslVertexShaderSourceFor(ShaderBuilder *shader_builder, VertexBuffer* vbo) {
 	string key = vbo->getDefaultShaderName();
 
@@ -158,10 +225,11 @@ DataSource *Shaders::getGlslVertexShaderSourceFor(ShaderBuilder *shader_builder,
 		stringstream ss;
 
 		// modelview & projection matrix
-		ss << "uniform mat4 " << UNIFORM_PROJECTION_MATRIX << ';' << endl;
-		ss << "uniform mat4 " << UNIFORM_MODELVIEW_MATRIX << ';' << endl;
+		writeGlslMatrixUniforms(ss);
 
 		// vertex position attribute
+		// all attributes are declared as float, compact data types of
+		// the vertex buffer will be converted by OpenGL before
 		ss << "attribute vec4 " << ATTRIBUTE_VERTEX_POSITION << ';' << endl;
 
 		// color attribute and varying
@@ -356,8 +424,13 @@ DataSource *Shaders::getHlslVertexShaderSourceFor(ShaderBuilder *shader_builder,
 		{
 			ss << "struct VertexInputStruct {" << endl;
 
-			// vertex position attribute
-			ss << "    float4 " << ATTRIBUTE_VERTEX_POSITION << " : POSITION;" << endl;
+			// vertex position attribute; integer formats are not converted into float by the input assembler
+			if (vbo->getPositionDescription().type == VertexDataInt16) {
+				ss << "    int4 "   << ATTRIBUTE_VERTEX_POSITION << " : POSITION;" << endl;
+			}
+			else {
+				ss << "    float4 " << ATTRIBUTE_VERTEX_POSITION << " : POSITION;" << endl;
+			}
 
 			// color attribute
 			if (vbo->hasColors()) {
@@ -394,9 +467,10 @@ DataSource *Shaders::getHlslVertexShaderSourceFor(ShaderBuilder *shader_builder,
 
 		// start the main func
 		ss << "PixelInputStruct VertexShaderMain(VertexInputStruct input) {" << endl;
-		ss << "    input." << ATTRIBUTE_VERTEX_POSITION << ".w = 1.0f;" << endl;
+		ss << "    float4 position = float4(input." << ATTRIBUTE_VERTEX_POSITION << ");" << endl;
+		ss << "    position.w = 1.0f;" << endl;
 		ss << "    PixelInputStruct output;" << endl;
-		ss << "    output." << ATTRIBUTE_VERTEX_POSITION << " = mul(input." << ATTRIBUTE_VERTEX_POSITION << ", " << UNIFORM_MODELVIEW_MATRIX << ");" << endl;
+		ss << "    output." << ATTRIBUTE_VERTEX_POSITION << " = mul(position, " << UNIFORM_MODELVIEW_MATRIX << ");" << endl;
 		ss << "    output." << ATTRIBUTE_VERTEX_POSITION << " = mul(output." << ATTRIBUTE_VERTEX_POSITION << ", " << UNIFORM_PROJECTION_MATRIX << ");" << endl;
 
 		// color value will be assigned to the color varying
@@ -528,11 +602,11 @@ DataSource *Shaders::getHlslFragmentShaderSourceFor(ShaderBuilder *shader_builde
 
 			// multiple color sources will be multiplied
 			default: {
-				ss << "    float color = float4(1, 1, 1, 1);" << endl;
+				ss << "    float4 color = float4(1, 1, 1, 1);" << endl;
 
 				// apply the vertex color
 				if (vbo->hasColors()) {
-					ss << "    color = mul(color, input." << VARYING_COLOR << ");" << endl;
+					ss << "    color *= input." << VARYING_COLOR << ';' << endl;
 				}
 
 				// apply all texture colors
@@ -570,3 +644,158 @@ DataSource *Shaders::getHlslFragmentShaderSourceFor(ShaderBuilder *shader_builde
 
 	return data_source;
 }
+
+
+
+
+/// configures the attributes and constant buffers of the sprite instance vertex shader
+static void setupSpriteInstanceShaderAttributes(ShaderBuilder *shader_builder) {
+	shader_builder->setDefaultAttributeName(Shader::VertexPosition,   0);
+	shader_builder->setDefaultAttributeName(Shader::InstancePosition, 0);
+	shader_builder->setDefaultAttributeName(Shader::InstanceColor,    0);
+
+	for(int i=0; i<SpriteInstance::texture_layers; i++) {
+		shader_builder->setDefaultAttributeName(Shader::InstanceData, i);
+	}
+
+	shader_builder->addDefaultModelviewMatrixConstantBuffer();
+	shader_builder->addDefaultProjectionMatrixConstantBuffer();
+
+	return;
+}
+
+
+DataSource *Shaders::getGlslSpriteInstanceVertexShaderSource(ShaderBuilder *shader_builder) {
+	string key = "SpriteInstance";
+
+	// check, if there's already an shader in the vertex shader cache
+	DataSource *data_source = getGlslVertexShaderCache()->get(key);
+	if (data_source == NULL) {
+		stringstream ss;
+
+		// modelview & projection matrix
+		writeGlslMatrixUniforms(ss);
+
+		// the corner of the unit quad
+		ss << "attribute vec4 " << ATTRIBUTE_VERTEX_POSITION << ';' << endl;
+
+		// per-instance attributes: position, color, size and the texture rectangle
+		ss << "attribute vec2 " << ATTRIBUTE_INSTANCE_POSITION << ';' << endl;
+		ss << "attribute vec4 " << ATTRIBUTE_INSTANCE_COLOR << ';' << endl;
+
+		for(int i=0; i<SpriteInstance::texture_layers; i++) {
+			ss << "attribute vec2 " << ATTRIBUTE_INSTANCE_DATA << i << ';' << endl;
+		}
+
+		ss << "varying   vec4 " << VARYING_COLOR << ';' << endl;
+		ss << "varying   vec2 " << VARYING_TEXTURE_COORDINATE << '0' << ';' << endl;
+
+		// start the main func
+		ss << "void main() {" << endl;
+		ss << "    vec4 position = vec4(";
+		ss << ATTRIBUTE_INSTANCE_POSITION << " + " << ATTRIBUTE_VERTEX_POSITION << ".xy * " << ATTRIBUTE_INSTANCE_DATA << '0';
+		ss << ", 0.0, 1.0);" << endl;
+		ss << "    gl_Position = position";
+		ss << " * " << UNIFORM_MODELVIEW_MATRIX;
+		ss << " * " << UNIFORM_PROJECTION_MATRIX;
+		ss << ';' << endl;
+
+		// pass the instance color and interpolate the texture coordinate between both corners
+		ss << "    " << VARYING_COLOR << " = " << ATTRIBUTE_INSTANCE_COLOR << ';' << endl;
+		ss << "    " << VARYING_TEXTURE_COORDINATE << '0' << " = mix(";
+		ss << ATTRIBUTE_INSTANCE_DATA << '1' << ", ";
+		ss << ATTRIBUTE_INSTANCE_DATA << '2' << ", ";
+		ss << ATTRIBUTE_VERTEX_POSITION << ".xy);" << endl;
+
+		// end the main func
+		ss << "}" << endl;
+
+		// create the data source
+		DataBuffer *buffer = ExclusiveDataBuffer::createCopyOf(ss.str());
+		data_source = new BufferDataSource(buffer);
+
+		// cache this object
+		getGlslVertexShaderCache()->add(key, data_source);
+	}
+
+	if (shader_builder) {
+		setupSpriteInstanceShaderAttributes(shader_builder);
+	}
+
+	return data_source;
+}
+
+
+DataSource *Shaders::getHlslSpriteInstanceVertexShaderSource(ShaderBuilder *shader_builder) {
+	string key = "SpriteInstance";
+
+	// check, if there's already an shader in the vertex shader cache
+	DataSource *data_source = getHlslVertexShaderCache()->get(key);
+	if (data_source == NULL) {
+		stringstream ss;
+
+		// modelview matrix buffer
+		ss << "cbuffer " << CONSTANTBUFFER_MODELVIEW_MATRIX << " {" << endl;
+		ss << "  matrix " << UNIFORM_MODELVIEW_MATRIX << ';' << endl;
+		ss << "};" << endl << endl;
+
+		// projection matrix buffer
+		ss << "cbuffer " << CONSTANTBUFFER_PROJECTION_MATRIX << " {" << endl;
+		ss << "  matrix " << UNIFORM_PROJECTION_MATRIX << ';' << endl;
+		ss << "};" << endl << endl;
+
+		// vertex shader input, the instance attributes are read from the second input slot
+		{
+			ss << "struct VertexInputStruct {" << endl;
+			ss << "    float4 " << ATTRIBUTE_VERTEX_POSITION << " : POSITION;" << endl;
+			ss << "    float2 " << ATTRIBUTE_INSTANCE_POSITION << " : INSTPOSITION;" << endl;
+			ss << "    float4 " << ATTRIBUTE_INSTANCE_COLOR << " : INSTCOLOR;" << endl;
+
+			for(int i=0; i<SpriteInstance::texture_layers; i++) {
+				ss << "    float2 " << ATTRIBUTE_INSTANCE_DATA << i << " : INSTDATA" << i << ';' << endl;
+			}
+
+			ss << "};" << endl << endl;
+		}
+
+		// pixel shader input
+		{
+			ss << "struct PixelInputStruct {" << endl;
+			ss << "    float4 " << ATTRIBUTE_VERTEX_POSITION << " : SV_POSITION;" << endl;
+			ss << "    float4 " << VARYING_COLOR << " : COLOR;" << endl;
+			ss << "    float2 " << VARYING_TEXTURE_COORDINATE << '0' << " : TEXCOORD0;" << endl;
+			ss << "};" << endl << endl;
+		}
+
+		// start the main func
+		ss << "PixelInputStruct VertexShaderMain(VertexInputStruct input) {" << endl;
+		ss << "    float4 position = float4(input." << ATTRIBUTE_INSTANCE_POSITION;
+		ss << " + input." << ATTRIBUTE_VERTEX_POSITION << ".xy * input." << ATTRIBUTE_INSTANCE_DATA << '0';
+		ss << ", 0.0f, 1.0f);" << endl;
+		ss << "    PixelInputStruct output;" << endl;
+		ss << "    output." << ATTRIBUTE_VERTEX_POSITION << " = mul(position, " << UNIFORM_MODELVIEW_MATRIX << ");" << endl;
+		ss << "    output." << ATTRIBUTE_VERTEX_POSITION << " = mul(output." << ATTRIBUTE_VERTEX_POSITION << ", " << UNIFORM_PROJECTION_MATRIX << ");" << endl;
+		ss << "    output." << VARYING_COLOR << " = input." << ATTRIBUTE_INSTANCE_COLOR << ';' << endl;
+		ss << "    output." << VARYING_TEXTURE_COORDINATE << '0' << " = lerp(";
+		ss << "input." << ATTRIBUTE_INSTANCE_DATA << '1' << ", ";
+		ss << "input." << ATTRIBUTE_INSTANCE_DATA << '2' << ", ";
+		ss << "input." << ATTRIBUTE_VERTEX_POSITION << ".xy);" << endl;
+
+		// end the main func
+		ss << "    return output;" << endl;
+		ss << "}" << endl;
+
+		// create the data source
+		DataBuffer *buffer = ExclusiveDataBuffer::createCopyOf(ss.str());
+		data_source = new BufferDataSource(buffer);
+
+		// cache this object
+		getHlslVertexShaderCache()->add(key, data_source);
+	}
+
+	if (shader_builder) {
+		setupSpriteInstanceShaderAttributes(shader_builder);
+	}
+
+	return data_source;
+}
@@ -57,6 +57,10 @@ namespace video {
 		static const char *ATTRIBUTE_VERTEX_COLOR;
 		static const char *ATTRIBUTE_VERTEX_TEXTURE_COORDINATE;
 
+		static const char *ATTRIBUTE_INSTANCE_POSITION;
+		static const char *ATTRIBUTE_INSTANCE_COLOR;
+		static const char *ATTRIBUTE_INSTANCE_DATA;
+
 		static const char *VARYING_COLOR;
 		static const char *VARYING_NORMAL;
 		static const char *VARYING_TEXTURE_COORDINATE;
@@ -118,6 +122,13 @@ namespace video {
 		/// get a suitable shader for a given \ref VertexBuffer.
 		Shader *getShaderFor(VertexBuffer *vbo);
 
+		/**
+		 * @brief get the shader for drawing instanced sprites.
+		 * The shader expects a unit quad as vertex buffer and a
+		 * buffer of \ref SpriteInstance as instance buffer.
+		 */
+		Shader *getSpriteInstanceShader();
+
 	public:
 		/// get a constant buffer template for the current object's modelview matrix
 		ShaderConstantBufferTemplate *getModelviewMatrixBufferTemplate();
@@ -138,6 +149,12 @@ namespace video {
 		/// get a suitable fragment shader source for a given \ref VertexBuffer.
 		DataSource *getHlslFragmentShaderSourceFor(ShaderBuilder *shader_builder, VertexBuffer *vbo);
 
+		/// get the vertex shader source for instanced sprites.
+		DataSource *getGlslSpriteInstanceVertexShaderSource(ShaderBuilder *shader_builder);
+
+		/// get the vertex shader source for instanced sprites.
+		DataSource *getHlslSpriteInstanceVertexShaderSource(ShaderBuilder *shader_builder);
+
 	private:
 		DataSourceCache			cached_glsl_vertex_shaders;
 		DataSourceCache			cached_glsl_fragment_shaders;
@@ -0,0 +1,304 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "sprite_batch.h"
+#include "indexbuffer.h"
+#include "render_context.h"
+#include "vertexbuffer.h"
+
+#include <wiesel/math/vector3d.h>
+
+#include <assert.h>
+
+
+using namespace wiesel;
+using namespace wiesel::video;
+
+
+
+SpriteBatch::SpriteBatch(BufferUsage usage) {
+	this->vbo			= new VertexBuffer();
+	this->ibo			= new IndexBuffer(2);
+	this->batched_calls	= 0;
+	this->flushing		= false;
+
+	keep(vbo);
+	keep(ibo);
+
+	vbo->setUsage(usage);
+	ibo->setUsage(usage);
+
+	return;
+}
+
+
+SpriteBatch::~SpriteBatch() {
+	clear_ref(vbo);
+	clear_ref(ibo);
+
+	return;
+}
+
+
+
+bool SpriteBatch::canBatch(const VertexBuffer *vertices) const {
+	if (vertices == NULL || vertices->getDataPtr() == NULL) {
+		return false;
+	}
+
+	// normals would need to be transformed too
+	if (vertices->hasNormals()) {
+		return false;
+	}
+
+	return vertices->hasPositions();
+}
+
+
+bool SpriteBatch::isCompatible(const VertexBuffer *vertices) const {
+	if (isEmpty()) {
+		return true;
+	}
+
+	if (vbo->getVertexColorComponents() != vertices->getVertexColorComponents()) {
+		return false;
+	}
+
+	if (vbo->getNumberOfTextureLayers() != vertices->getNumberOfTextureLayers()) {
+		return false;
+	}
+
+	return true;
+}
+
+
+bool SpriteBatch::hasSpaceFor(unsigned int num_vertices) const {
+	return (vbo->getSize() + num_vertices) <= MAX_VERTICES;
+}
+
+
+bool SpriteBatch::isEmpty() const {
+	return ibo->getSize() == 0;
+}
+
+
+
+void SpriteBatch::setupFormatFor(const VertexBuffer *vertices) {
+	// keep the allocated memory, when the format doesn't change
+	if (
+			vbo->getPositionDescription().fields == 3
+		&&	vbo->getVertexColorComponents() == vertices->getVertexColorComponents()
+		&&	vbo->getNumberOfTextureLayers() == vertices->getNumberOfTextureLayers()
+	) {
+		vbo->reset();
+		ibo->reset();
+		return;
+	}
+
+	// the buffers needs to be empty to change their format
+	vbo->clear();
+	ibo->clear();
+
+	// positions are always stored in 3D, because the transformation may produce a z-value
+	vbo->setupVertexPositions(3);
+
+	if (vertices->hasColors()) {
+		vbo->setupVertexColors(vertices->getVertexColorComponents());
+	}
+	else {
+		vbo->disableVertexColors();
+	}
+
+	while(vbo->getNumberOfTextureLayers() > vertices->getNumberOfTextureLayers()) {
+		vbo->disableTextureLayer(vbo->getNumberOfTextureLayers() - 1);
+	}
+
+	for(int layer=0; layer<vertices->getNumberOfTextureLayers(); layer++) {
+		vbo->setupTextureLayer(layer);
+	}
+
+	return;
+}
+
+
+bool SpriteBatch::add(Primitive primitive, const VertexBuffer *vertices, const IndexBuffer *indices, const matrix4x4 &transform) {
+	assert(canBatch(vertices));
+	assert(isCompatible(vertices));
+	assert(hasSpaceFor(vertices->getSize()));
+
+	if (!canBatch(vertices) || !isCompatible(vertices) || !hasSpaceFor(vertices->getSize())) {
+		return false;
+	}
+
+	if (isEmpty()) {
+		setupFormatFor(vertices);
+	}
+
+	const VertexBuffer::data_t			src_data		= vertices->getDataPtr();
+	const VertexBuffer::component&		src_positions	= vertices->getPositionDescription();
+	const VertexBuffer::component&		src_colors		= vertices->getColorDescription();
+	unsigned short						src_size		= vertices->getVertexSize();
+	int									src_layers		= vertices->getNumberOfTextureLayers();
+	VertexBuffer::index_t				first			= vbo->getSize();
+	VertexBuffer::index_t				num_vertices	= vertices->getSize();
+
+	VertexBuffer::Cursor cursor = vbo->addVertices(num_vertices);
+
+	// read all positions as float, the source may use compact data types
+	positions.resize(num_vertices);
+
+	for(VertexBuffer::index_t i=0; i<num_vertices; i++) {
+		float pos[3] = { 0.0f, 0.0f, 0.0f };
+		VertexBuffer::readComponent(src_data + (src_size * i), src_positions, pos);
+		positions[i] = vector3d(pos[0], pos[1], pos[2]);
+	}
+
+	// transform all positions into world space at once
+	if (num_vertices != 0) {
+		transform.transform(&positions[0], &positions[0], num_vertices);
+	}
+
+	// copy all vertices
+	for(VertexBuffer::index_t i=0; i<num_vertices; i++) {
+		const unsigned char *src_vertex = src_data + (src_size * i);
+
+		cursor.position(positions[i]);
+
+		if (src_colors.fields) {
+			float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+			VertexBuffer::readComponent(src_vertex, src_colors, color);
+			cursor.color(color[0], color[1], color[2], color[3]);
+		}
+
+		for(int layer=0; layer<src_layers; layer++) {
+			float texcoord[2];
+			VertexBuffer::readComponent(src_vertex, vertices->getTextureDescription(layer), texcoord);
+			cursor.texcoord(layer, texcoord[0], texcoord[1]);
+		}
+
+		cursor.next();
+	}
+
+	// convert the primitives into a list of triangles
+	unsigned int num_indices = indices ? indices->getSize() : num_vertices;
+
+	// fast path for the most common case: a single quad, drawn as triangle strip
+	if (primitive == TriangleStrip && indices == NULL && num_vertices == 4) {
+		ibo->addQuads(first, 1);
+		++batched_calls;
+
+		return true;
+	}
+
+	switch(primitive) {
+		case Triangles: {
+			ibo->reserve(num_indices);
+
+			for(unsigned int i=0; i+2<num_indices; i+=3) {
+				ibo->addIndex(first + (indices ? indices->getIndex(i + 0) : i + 0));
+				ibo->addIndex(first + (indices ? indices->getIndex(i + 1) : i + 1));
+				ibo->addIndex(first + (indices ? indices->getIndex(i + 2) : i + 2));
+			}
+
+			break;
+		}
+
+		case TriangleStrip: {
+			if (num_indices >= 3) {
+				ibo->reserve((num_indices - 2) * 3);
+			}
+
+			for(unsigned int i=2; i<num_indices; i++) {
+				VertexBuffer::index_t a = indices ? indices->getIndex(i - 2) : i - 2;
+				VertexBuffer::index_t b = indices ? indices->getIndex(i - 1) : i - 1;
+				VertexBuffer::index_t c = indices ? indices->getIndex(i - 0) : i - 0;
+
+				// keep the winding order of each second triangle
+				if (i % 2) {
+					ibo->addIndex(first + b);
+					ibo->addIndex(first + a);
+				}
+				else {
+					ibo->addIndex(first + a);
+					ibo->addIndex(first + b);
+				}
+
+				ibo->addIndex(first + c);
+			}
+
+			break;
+		}
+
+		case TriangleFan: {
+			if (num_indices >= 3) {
+				ibo->reserve((num_indices - 2) * 3);
+			}
+
+			for(unsigned int i=2; i<num_indices; i++) {
+				ibo->addIndex(first + (indices ? indices->getIndex(0)     : 0));
+				ibo->addIndex(first + (indices ? indices->getIndex(i - 1) : i - 1));
+				ibo->addIndex(first + (indices ? indices->getIndex(i - 0) : i - 0));
+			}
+
+			break;
+		}
+	}
+
+	++batched_calls;
+
+	return true;
+}
+
+
+void SpriteBatch::flush(RenderContext *render_context) {
+	draw(render_context);
+	clear();
+
+	return;
+}
+
+
+void SpriteBatch::draw(RenderContext *render_context) {
+	assert(flushing == false);
+
+	if (isEmpty() == false && flushing == false) {
+		flushing = true;
+
+		// all vertices are already transformed into world space
+		render_context->setModelviewMatrix(matrix4x4::identity);
+		render_context->draw(Triangles, vbo, ibo);
+
+		flushing = false;
+	}
+
+	return;
+}
+
+
+void SpriteBatch::clear() {
+	// keep the memory for the next batch
+	vbo->reset();
+	ibo->reset();
+
+	batched_calls = 0;
+
+	return;
+}
@@ -0,0 +1,171 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#ifndef __WIESEL_VIDEO_SPRITE_BATCH_H__
+#define	__WIESEL_VIDEO_SPRITE_BATCH_H__
+
+#include <wiesel/wiesel-core.def>
+
+#include "types.h"
+
+#include <wiesel/math/matrix.h>
+#include <wiesel/math/vector3d.h>
+
+#include <vector>
+
+
+namespace wiesel {
+namespace video {
+
+
+	class IndexBuffer;
+	class RenderContext;
+	class VertexBuffer;
+
+
+
+	/**
+	 * @brief Collects geometry of multiple draw calls into a single vertex and index buffer.
+	 * Each geometry added to the batch will be transformed into world space on the CPU,
+	 * so all collected primitives can be drawn with a single draw call and an identity
+	 * modelview matrix.
+	 * The batch does not track any render state itself. The \ref RenderContext which owns
+	 * the batch is responsible to flush it, before any state like the shader or textures
+	 * will be changed.
+	 */
+	class WIESEL_CORE_EXPORT SpriteBatch
+	{
+	public:
+		/// the maximum number of vertices within a single batch, limited by 16 bit indices.
+		static const unsigned int MAX_VERTICES = 0xffff;
+
+	public:
+		/**
+		 * @brief Creates a new, empty batch.
+		 * @param usage		The usage hint for the batch buffers. Batches which are rebuilt
+		 *					each frame should use \ref BufferUsageStream, batches which
+		 *					keep their content should use \ref BufferUsageStatic.
+		 */
+		SpriteBatch(BufferUsage usage=BufferUsageStream);
+		~SpriteBatch();
+
+	public:
+		/**
+		 * @brief Checks, if the given vertex buffer can be stored in this batch.
+		 * Vertex buffers containing normals cannot be batched, because their
+		 * normals would need to be transformed as well.
+		 */
+		bool canBatch(const VertexBuffer *vertices) const;
+
+		/**
+		 * @brief Checks, if the given vertex buffer is compatible to the data already
+		 * stored in this batch. Always returns \c true, when the batch is empty.
+		 */
+		bool isCompatible(const VertexBuffer *vertices) const;
+
+		/**
+		 * @brief Checks, if the given amount of vertices fits into the batch.
+		 */
+		bool hasSpaceFor(unsigned int num_vertices) const;
+
+		/**
+		 * @brief Adds the primitives of a vertex buffer to this batch.
+		 * The caller needs to ensure the vertex buffer is compatible and the batch
+		 * has enough space left to store all vertices.
+		 * @param primitive		The type of primitives described by the vertex data.
+		 * @param vertices		The vertex buffer containing the vertex data.
+		 * @param indices		An optional index buffer. May be \c NULL.
+		 * @param transform		The modelview matrix, which would be used to draw these vertices.
+		 * @return \c true, when the vertices were added successfully.
+		 */
+		bool add(Primitive primitive, const VertexBuffer *vertices, const IndexBuffer *indices, const matrix4x4 &transform);
+
+		/**
+		 * @brief Draws all collected primitives using the given render context
+		 * and clears the batch afterwards.
+		 */
+		void flush(RenderContext *render_context);
+
+		/**
+		 * @brief Draws all collected primitives using the given render context,
+		 * but keeps them within the batch.
+		 */
+		void draw(RenderContext *render_context);
+
+		/**
+		 * @brief Removes all collected primitives without drawing them.
+		 */
+		void clear();
+
+	// getter
+	public:
+		/**
+		 * @brief Checks, if there are no primitives stored in this batch.
+		 */
+		bool isEmpty() const;
+
+		/**
+		 * @brief Checks, if this batch is currently drawing it's content.
+		 */
+		inline bool isFlushing() const {
+			return flushing;
+		}
+
+		/**
+		 * @brief Get the number of draw calls, which were merged into the current batch.
+		 */
+		inline unsigned int getNumberOfBatchedCalls() const {
+			return batched_calls;
+		}
+
+		/**
+		 * @brief Get the vertex buffer containing the transformed vertices of this batch.
+		 */
+		inline const VertexBuffer *getVertexBuffer() const {
+			return vbo;
+		}
+
+		/**
+		 * @brief Get the index buffer containing the triangles of this batch.
+		 */
+		inline const IndexBuffer *getIndexBuffer() const {
+			return ibo;
+		}
+
+	private:
+		/// configures the batch buffers to store vertices in the format of the given buffer.
+		void setupFormatFor(const VertexBuffer *vertices);
+
+	private:
+		VertexBuffer*		vbo;
+		IndexBuffer*		ibo;
+
+		unsigned int		batched_calls;
+		bool				flushing;
+
+		/// positions of the vertices currently added, reused to avoid allocations
+		std::vector<vector3d>	positions;
+	};
+
+}
+}
+
+#endif	// __WIESEL_VIDEO_SPRITE_BATCH_H__
@@ -0,0 +1,265 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#ifndef __WIESEL_VIDEO_TYPED_VERTEXBUFFER_H__
+#define __WIESEL_VIDEO_TYPED_VERTEXBUFFER_H__
+
+#include <wiesel/wiesel-core.def>
+
+#include "vertexbuffer.h"
+
+#include <assert.h>
+
+
+namespace wiesel {
+namespace video {
+
+
+	/**
+	 * @brief A vertex with a 2D position and a single texture coordinate.
+	 * The static members describe the layout of the vertex for \ref TVertexBuffer.
+	 */
+	struct VertexP2T2
+	{
+		enum {
+			position_dimensions		= 2,
+			position_type			= VertexDataFloat,
+			has_normals				= 0,
+			color_components		= 0,
+			color_type				= VertexDataFloat,
+			texture_layers			= 1,
+			texture_type			= VertexDataFloat
+		};
+
+		VertexP2T2() {}
+
+		VertexP2T2(float x, float y, float u, float v) :
+			x(x), y(y), u(u), v(v)
+		{}
+
+		float	x, y;
+		float	u, v;
+	};
+
+
+	/**
+	 * @brief A vertex with a 2D position, a RGBA color and a single texture coordinate.
+	 * The static members describe the layout of the vertex for \ref TVertexBuffer.
+	 */
+	struct VertexP2C4T2
+	{
+		enum {
+			position_dimensions		= 2,
+			position_type			= VertexDataFloat,
+			has_normals				= 0,
+			color_components		= 4,
+			color_type				= VertexDataFloat,
+			texture_layers			= 1,
+			texture_type			= VertexDataFloat
+		};
+
+		VertexP2C4T2() {}
+
+		VertexP2C4T2(float x, float y, float r, float g, float b, float a, float u, float v) :
+			x(x), y(y), r(r), g(g), b(b), a(a), u(u), v(v)
+		{}
+
+		float	x, y;
+		float	r, g, b, a;
+		float	u, v;
+	};
+
+
+	/**
+	 * @brief A compact vertex with a 2D position, a RGBA color and a single texture coordinate.
+	 * The color is stored as normalized bytes and the texture coordinate as normalized
+	 * unsigned shorts, so each vertex takes 16 instead of 32 bytes.
+	 * The static members describe the layout of the vertex for \ref TVertexBuffer.
+	 */
+	struct VertexP2C4T2Packed
+	{
+		enum {
+			position_dimensions		= 2,
+			position_type			= VertexDataFloat,
+			has_normals				= 0,
+			color_components		= 4,
+			color_type				= VertexDataUInt8Normalized,
+			texture_layers			= 1,
+			texture_type			= VertexDataUInt16Normalized
+		};
+
+		VertexP2C4T2Packed() {}
+
+		VertexP2C4T2Packed(float x, float y, float r, float g, float b, float a, float u, float v) :
+			x(x), y(y),
+			r(toByte(r)), g(toByte(g)), b(toByte(b)), a(toByte(a)),
+			u(toShort(u)), v(toShort(v))
+		{}
+
+		/// converts a value within [0..1] into a normalized byte.
+		static inline unsigned char toByte(float value) {
+			return static_cast<unsigned char>((value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value)) * 255.0f + 0.5f);
+		}
+
+		/// converts a value within [0..1] into a normalized unsigned short.
+		static inline unsigned short toShort(float value) {
+			return static_cast<unsigned short>((value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value)) * 65535.0f + 0.5f);
+		}
+
+		float			x, y;
+		unsigned char	r, g, b, a;
+		unsigned short	u, v;
+	};
+
+
+	/**
+	 * @brief Per-instance data of a sprite for instanced rendering.
+	 * Each instance places a unit quad at the position \c x, \c y and scales it by \c w, \c h.
+	 * The texture layers are used as generic instance attributes: layer 0 contains
+	 * the size, layers 1 and 2 the texture coordinates of the bottom-left
+	 * and top-right corner of the sprite's frame.
+	 * The static members describe the layout of the instance for \ref TVertexBuffer.
+	 */
+	struct SpriteInstance
+	{
+		enum {
+			position_dimensions		= 2,
+			position_type			= VertexDataFloat,
+			has_normals				= 0,
+			color_components		= 4,
+			color_type				= VertexDataUInt8Normalized,
+			texture_layers			= 3,
+			texture_type			= VertexDataFloat
+		};
+
+		float			x, y;
+		unsigned char	r, g, b, a;
+		float			w, h;
+		float			u0, v0;
+		float			u1, v1;
+	};
+
+
+
+	/**
+	 * @brief A vertex buffer with a layout defined by a vertex structure.
+	 * The buffer will be configured by the layout description of the
+	 * vertex structure, so its memory layout is identical with an array
+	 * of \c VertexStruct. This allows to write whole vertices at once,
+	 * instead of setting each component separately.
+	 * The members of the structure needs to be ordered like the components
+	 * of the \ref VertexBuffer: position, normal, color, texture layers.
+	 * The setup of this buffer must not be changed.
+	 */
+	template <class VertexStruct>
+	class TVertexBuffer : public VertexBuffer
+	{
+	public:
+		/// the type of each vertex
+		typedef VertexStruct vertex_t;
+
+	public:
+		TVertexBuffer() {
+			setupVertexPositions(
+					VertexStruct::position_dimensions,
+					static_cast<VertexDataType>(VertexStruct::position_type)
+			);
+
+			if (VertexStruct::has_normals != 0) {
+				setupVertexNormals();
+			}
+
+			if (VertexStruct::color_components > 0) {
+				setupVertexColors(
+						VertexStruct::color_components,
+						static_cast<VertexDataType>(VertexStruct::color_type)
+				);
+			}
+
+			for(unsigned int layer=0; layer<VertexStruct::texture_layers; layer++) {
+				setupTextureLayer(
+						layer,
+						static_cast<VertexDataType>(VertexStruct::texture_type)
+				);
+			}
+
+			// the vertex structure needs to match the buffer's layout
+			assert(getVertexSize() == sizeof(VertexStruct));
+
+			return;
+		}
+
+		virtual ~TVertexBuffer() {
+			return;
+		}
+
+	public:
+		using VertexBuffer::addVertex;
+		using VertexBuffer::addVertices;
+
+		/**
+		 * @brief adds a single vertex.
+		 * @return the index of the new vertex.
+		 */
+		inline index_t addVertex(const VertexStruct &vertex) {
+			return VertexBuffer::addVertices(&vertex, 1);
+		}
+
+		/**
+		 * @brief adds a list of vertices.
+		 * @return the index of the first new vertex.
+		 */
+		inline index_t addVertices(const VertexStruct *vertices, index_t count) {
+			return VertexBuffer::addVertices(static_cast<const void*>(vertices), count);
+		}
+
+		/**
+		 * @brief adds a number of vertices and returns a pointer to write their data.
+		 * The pointer is valid until the capacity of this buffer changes.
+		 * @param count		The number of vertices to be added.
+		 * @return A pointer to the first new vertex.
+		 */
+		inline VertexStruct *allocVertices(index_t count) {
+			return reinterpret_cast<VertexStruct*>(VertexBuffer::addVertices(count).getPtr());
+		}
+
+		/**
+		 * @brief get a pointer to modify a range of existing vertices.
+		 * @param first		The index of the first vertex to change.
+		 * @param count		The number of vertices which will be changed.
+		 * @return A pointer to the first vertex of the range.
+		 */
+		inline VertexStruct *editVertexRange(index_t first, index_t count) {
+			return reinterpret_cast<VertexStruct*>(VertexBuffer::editVertices(first, count).getPtr());
+		}
+
+		/**
+		 * @brief get read access to a single vertex.
+		 */
+		inline const VertexStruct& getVertex(index_t index) const {
+			assert(index < getSize());
+			return reinterpret_cast<const VertexStruct*>(getDataPtr())[index];
+		}
+	};
+
+} /* namespace video */
+} /* namespace wiesel */
+#endif /* __WIESEL_VIDEO_TYPED_VERTEXBUFFER_H__ */
@@ -24,6 +24,27 @@
 using namespace wiesel::video;
 
 
+size_t wiesel::video::getVertexDataTypeSize(VertexDataType type) {
+	switch(type) {
+		case VertexDataFloat: {
+			return 4;
+		}
+
+		case VertexDataHalfFloat:
+		case VertexDataInt16:
+		case VertexDataUInt16Normalized: {
+			return 2;
+		}
+
+		case VertexDataUInt8Normalized: {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+
 size_t wiesel::video::getTypeSize(ValueType type) {
 	switch(type) {
 		case TypeInt32: {
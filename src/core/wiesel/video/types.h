@@ -39,6 +39,54 @@ namespace wiesel {
 
 
 
+		/**
+		 * @brief Describes how often the content of a buffer is expected to change.
+		 * The hint may be used by the backend to choose an appropriate memory
+		 * location and update strategy for the hardware buffer.
+		 */
+		enum BufferUsage {
+			/// The content will be written once and drawn many times.
+			BufferUsageStatic,
+
+			/// The content will be modified repeatedly and drawn many times.
+			BufferUsageDynamic,
+
+			/// The content will be rewritten each frame and drawn only a few times.
+			BufferUsageStream,
+		};
+
+
+
+		/**
+		 * @brief The data type of each field of a vertex component.
+		 * Values are always written and read as float, the vertex buffer
+		 * converts them into the component's data type.
+		 */
+		enum VertexDataType {
+			/// 32 bit floating point value.
+			VertexDataFloat,
+
+			/// 16 bit floating point value.
+			VertexDataHalfFloat,
+
+			/// signed 16 bit integer, which will be converted to float without normalization.
+			VertexDataInt16,
+
+			/// unsigned 16 bit integer, normalized into the range [0..1].
+			VertexDataUInt16Normalized,
+
+			/// unsigned 8 bit integer, normalized into the range [0..1].
+			VertexDataUInt8Normalized,
+		};
+
+
+		/**
+		 * @brief Determine the size of a single vertex field in bytes.
+		 */
+		size_t WIESEL_CORE_EXPORT getVertexDataTypeSize(VertexDataType type);
+
+
+
 		/**
 		 * @brief A list of valid types for various graphics operations.
 		 */
@@ -24,9 +24,11 @@
 #include "screen.h"
 #include "video_driver.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <malloc.h>
 #include <string.h>
+#include <stdint.h>
 #include <sstream>
 
 
@@ -36,9 +38,13 @@ using namespace std;
 
 
 VertexBuffer::VertexBuffer() {
-	this->num_vertices	= 0;
-	this->capacity		= 0;
-	this->data			= NULL;
+	this->num_vertices		= 0;
+	this->capacity			= 0;
+	this->data				= NULL;
+	this->layout_version	= 0;
+	this->usage				= BufferUsageStatic;
+	this->dirty_begin		= 0;
+	this->dirty_end			= 0;
 
 	setupVertexPositions(3);
 	disableVertexNormals();
@@ -70,16 +76,31 @@ bool VertexBuffer::checkIfSetupPossible() const {
 
 
 
-bool VertexBuffer::setupVertexPositions(int dimensions) {
+void VertexBuffer::setupComponent(component *comp, int fields, VertexDataType type) {
+	comp->fields = fields;
+	comp->type   = type;
+
+	// keep each component aligned to 4 bytes
+	comp->size   = (fields * getVertexDataTypeSize(type) + 3) & ~3;
+
+	return;
+}
+
+
+bool VertexBuffer::setupVertexPositions(int dimensions, VertexDataType type) {
 	if (checkIfSetupPossible()) {
 		assert(dimensions == 2 || dimensions == 3);
+		assert(type == VertexDataFloat || type == VertexDataHalfFloat || type == VertexDataInt16);
 
 		if (dimensions != 2 && dimensions != 3) {
 			return false;
 		}
 
-		positions.fields = dimensions;
-		positions.size   = dimensions * sizeof(float);
+		if (type != VertexDataFloat && type != VertexDataHalfFloat && type != VertexDataInt16) {
+			return false;
+		}
+
+		setupComponent(&positions, dimensions, type);
 
 		updateOffsets();
 
@@ -92,8 +113,7 @@ bool VertexBuffer::setupVertexPositions(int dimensions) {
 
 bool VertexBuffer::setupVertexNormals() {
 	if (checkIfSetupPossible()) {
-		normals.fields = 3;
-		normals.size   = 3 * sizeof(float);
+		setupComponent(&normals, 3, VertexDataFloat);
 		updateOffsets();
 		return true;
 	}
@@ -102,16 +122,27 @@ bool VertexBuffer::setupVertexNormals() {
 }
 
 
-bool VertexBuffer::setupVertexColors(int fields) {
+bool VertexBuffer::setupVertexColors(int fields, VertexDataType type) {
 	if (checkIfSetupPossible()) {
 		assert(fields == 3 || fields == 4);
+		assert(type == VertexDataFloat || type == VertexDataUInt8Normalized);
+
+		// byte colors are always stored as RGBA, so the padding byte won't be read as alpha
+		assert(type != VertexDataUInt8Normalized || fields == 4);
 
 		if (fields != 3 && fields != 4) {
 			return false;
 		}
 
-		colors.fields = fields;
-		colors.size   = fields * sizeof(float);
+		if (type != VertexDataFloat && type != VertexDataUInt8Normalized) {
+			return false;
+		}
+
+		if (type == VertexDataUInt8Normalized && fields != 4) {
+			return false;
+		}
+
+		setupComponent(&colors, fields, type);
 
 		updateOffsets();
 
@@ -122,19 +153,23 @@ bool VertexBuffer::setupVertexColors(int fields) {
 }
 
 
-bool VertexBuffer::setupTextureLayer(unsigned int layer) {
+bool VertexBuffer::setupTextureLayer(unsigned int layer, VertexDataType type) {
 	if (checkIfSetupPossible()) {
 		assert(layer <= textures.size());
 		assert(layer >= 0);
+		assert(type == VertexDataFloat || type == VertexDataHalfFloat || type == VertexDataUInt16Normalized);
 
 		// illegal texture layer.
 		if (layer > textures.size()) {
 			return false;
 		}
 
+		if (type != VertexDataFloat && type != VertexDataHalfFloat && type != VertexDataUInt16Normalized) {
+			return false;
+		}
+
 		component texture;
-		texture.fields = 2;
-		texture.size   = 2 * sizeof(float);
+		setupComponent(&texture, 2, type);
 
 		if (layer == textures.size()) {
 			textures.push_back(texture);
@@ -155,8 +190,7 @@ bool VertexBuffer::setupTextureLayer(unsigned int layer) {
 
 void VertexBuffer::disableVertexNormals() {
 	if (checkIfSetupPossible()) {
-		normals.size   = 0;
-		normals.fields = 0;
+		setupComponent(&normals, 0, VertexDataFloat);
 		updateOffsets();
 	}
 
@@ -166,8 +200,7 @@ void VertexBuffer::disableVertexNormals() {
 
 void VertexBuffer::disableVertexColors() {
 	if (checkIfSetupPossible()) {
-		colors.size   = 0;
-		colors.fields = 0;
+		setupComponent(&colors, 0, VertexDataFloat);
 		updateOffsets();
 	}
 
@@ -238,13 +271,246 @@ string VertexBuffer::getDefaultShaderName() const {
 		ss << "_t" << textures.size();
 	}
 
+	// integer positions need a conversion within the HLSL shader
+	if (positions.type == VertexDataInt16) {
+		ss << "_pi";
+	}
+
+	return ss.str();
+}
+
+
+/// get a short name of a component's data type.
+static char getVertexDataTypeCode(unsigned char type) {
+	switch(type) {
+		case VertexDataFloat:				return 'f';
+		case VertexDataHalfFloat:			return 'h';
+		case VertexDataInt16:				return 's';
+		case VertexDataUInt16Normalized:	return 'w';
+		case VertexDataUInt8Normalized:		return 'b';
+	}
+
+	return '?';
+}
+
+
+string VertexBuffer::getVertexLayoutName() const {
+	stringstream ss;
+
+	ss << 'p' << static_cast<int>(positions.fields) << getVertexDataTypeCode(positions.type);
+
+	if (this->hasNormals()) {
+		ss << 'n' << static_cast<int>(normals.fields) << getVertexDataTypeCode(normals.type);
+	}
+
+	if (this->hasColors()) {
+		ss << 'c' << static_cast<int>(colors.fields) << getVertexDataTypeCode(colors.type);
+	}
+
+	for(std::vector<component>::const_iterator it=textures.begin(); it!=textures.end(); it++) {
+		ss << 't' << static_cast<int>(it->fields) << getVertexDataTypeCode(it->type);
+	}
+
 	return ss.str();
 }
 
 
 
+/// converts a float into a 16 bit floating point value.
+static uint16_t floatToHalf(float value) {
+	union { float f; uint32_t u; } bits;
+	bits.f = value;
+
+	uint32_t sign     = (bits.u >> 16) & 0x8000;
+	int32_t  exponent = static_cast<int32_t>((bits.u >> 23) & 0xff) - 127 + 15;
+	uint32_t mantissa = bits.u & 0x007fffff;
+
+	// NaN and infinity
+	if (((bits.u >> 23) & 0xff) == 0xff) {
+		return static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+	}
+
+	// overflow, clamp to infinity
+	if (exponent >= 31) {
+		return static_cast<uint16_t>(sign | 0x7c00);
+	}
+
+	// underflow, create a denormalized value or zero
+	if (exponent <= 0) {
+		if (exponent < -10) {
+			return static_cast<uint16_t>(sign);
+		}
+
+		// rounding may carry into the exponent, which results in the smallest normalized value
+		mantissa = (mantissa | 0x00800000) >> (1 - exponent);
+		return static_cast<uint16_t>(sign + ((mantissa + 0x1000) >> 13));
+	}
+
+	// add the rounded mantissa, so a carry increments the exponent
+	uint32_t half = (static_cast<uint32_t>(exponent) << 10) + ((mantissa + 0x1000) >> 13);
+
+	// rounding overflowed the largest finite value
+	if (half >= 0x7c00) {
+		half = 0x7c00;
+	}
+
+	return static_cast<uint16_t>(sign | half);
+}
+
+
+/// converts a 16 bit floating point value into a float.
+static float halfToFloat(uint16_t value) {
+	union { float f; uint32_t u; } bits;
+
+	uint32_t sign     = (value & 0x8000) << 16;
+	uint32_t exponent = (value >> 10) & 0x1f;
+	uint32_t mantissa = value & 0x03ff;
+
+	if (exponent == 0) {
+		// zero or denormalized value
+		if (mantissa == 0) {
+			bits.u = sign;
+			return bits.f;
+		}
+
+		while((mantissa & 0x0400) == 0) {
+			mantissa <<= 1;
+			exponent--;
+		}
+
+		exponent++;
+		mantissa &= 0x03ff;
+	}
+	else if (exponent == 31) {
+		// NaN and infinity
+		bits.u = sign | 0x7f800000 | (mantissa << 13);
+		return bits.f;
+	}
+
+	bits.u = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+	return bits.f;
+}
+
+
+/// clamps a value into the range [0..1].
+static float clampNormalized(float value) {
+	return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+}
+
+
+void VertexBuffer::writeComponent(data_t vertex, const component &comp, const float *values) {
+	data_t ptr = vertex + comp.offset;
+
+	switch(comp.type) {
+		case VertexDataFloat: {
+			float *target = reinterpret_cast<float*>(ptr);
+			for(int i=0; i<comp.fields; i++) {
+				target[i] = values[i];
+			}
+
+			break;
+		}
+
+		case VertexDataHalfFloat: {
+			uint16_t *target = reinterpret_cast<uint16_t*>(ptr);
+			for(int i=0; i<comp.fields; i++) {
+				target[i] = floatToHalf(values[i]);
+			}
+
+			break;
+		}
+
+		case VertexDataInt16: {
+			int16_t *target = reinterpret_cast<int16_t*>(ptr);
+			for(int i=0; i<comp.fields; i++) {
+				float value = std::max(-32768.0f, std::min(32767.0f, values[i]));
+				target[i] = static_cast<int16_t>(value < 0.0f ? value - 0.5f : value + 0.5f);
+			}
+
+			break;
+		}
+
+		case VertexDataUInt16Normalized: {
+			uint16_t *target = reinterpret_cast<uint16_t*>(ptr);
+			for(int i=0; i<comp.fields; i++) {
+				target[i] = static_cast<uint16_t>(clampNormalized(values[i]) * 65535.0f + 0.5f);
+			}
+
+			break;
+		}
+
+		case VertexDataUInt8Normalized: {
+			uint8_t *target = reinterpret_cast<uint8_t*>(ptr);
+			for(int i=0; i<comp.fields; i++) {
+				target[i] = static_cast<uint8_t>(clampNormalized(values[i]) * 255.0f + 0.5f);
+			}
+
+			break;
+		}
+	}
+
+	return;
+}
+
+
+void VertexBuffer::readComponent(const unsigned char *vertex, const component &comp, float *values) {
+	const unsigned char *ptr = vertex + comp.offset;
+
+	switch(comp.type) {
+		case VertexDataFloat: {
+			const float *source = reinterpret_cast<const float*>(ptr);
+			for(int i=0; i<comp.fields; i++) {
+				values[i] = source[i];
+			}
+
+			break;
+		}
+
+		case VertexDataHalfFloat: {
+			const uint16_t *source = reinterpret_cast<const uint16_t*>(ptr);
+			for(int i=0; i<comp.fields; i++) {
+				values[i] = halfToFloat(source[i]);
+			}
+
+			break;
+		}
+
+		case VertexDataInt16: {
+			const int16_t *source = reinterpret_cast<const int16_t*>(ptr);
+			for(int i=0; i<comp.fields; i++) {
+				values[i] = static_cast<float>(source[i]);
+			}
+
+			break;
+		}
+
+		case VertexDataUInt16Normalized: {
+			const uint16_t *source = reinterpret_cast<const uint16_t*>(ptr);
+			for(int i=0; i<comp.fields; i++) {
+				values[i] = source[i] / 65535.0f;
+			}
+
+			break;
+		}
+
+		case VertexDataUInt8Normalized: {
+			const uint8_t *source = reinterpret_cast<const uint8_t*>(ptr);
+			for(int i=0; i<comp.fields; i++) {
+				values[i] = source[i] / 255.0f;
+			}
+
+			break;
+		}
+	}
+
+	return;
+}
+
+
+
 void VertexBuffer::updateOffsets() {
 	vertex_size = 0;
+	++layout_version;
 
 	positions.offset = vertex_size;
 	vertex_size += positions.size;
@@ -324,13 +590,19 @@ VertexBuffer::index_t VertexBuffer::setCapacity(index_t capacity) {
 
 VertexBuffer::index_t VertexBuffer::ensureCapacity(index_t capacity) {
 	if (this->capacity < capacity) {
-		return setCapacity(capacity);
+		// grow geometrically, so adding single vertices doesn't reallocate each time
+		return setCapacity(std::max(capacity, this->capacity * 2));
 	}
 
 	return this->capacity;
 }
 
 
+VertexBuffer::index_t VertexBuffer::reserve(index_t count) {
+	return ensureCapacity(num_vertices + count);
+}
+
+
 VertexBuffer::index_t VertexBuffer::getCapacity() const {
 	return this->capacity;
 }
@@ -341,6 +613,24 @@ VertexBuffer::index_t VertexBuffer::getSize() const {
 }
 
 
+void VertexBuffer::setUsage(BufferUsage usage) {
+	if (this->usage != usage) {
+		this->usage = usage;
+
+		// the hardware buffer needs to be re-created with the new usage
+		invalidateHardwareData();
+	}
+
+	return;
+}
+
+
+void VertexBuffer::reset() {
+	num_vertices = 0;
+	return;
+}
+
+
 void VertexBuffer::clear() {
 	if (data) {
 		free(data);
@@ -383,23 +673,52 @@ VertexBuffer::index_t VertexBuffer::addVertex(float x, float y, float z) {
 }
 
 
+VertexBuffer::Cursor VertexBuffer::addVertices(index_t count) {
+	index_t first        = num_vertices;
+	index_t new_capacity = ensureCapacity(first + count);
+	assert(new_capacity >= first + count);
+
+	if (new_capacity >= first + count) {
+		num_vertices += count;
+		markDirty(vertex_size * first, vertex_size * num_vertices);
+	}
+
+	return Cursor(this, data + (vertex_size * first));
+}
+
+
+VertexBuffer::index_t VertexBuffer::addVertices(const void *vertex_data, index_t count) {
+	index_t first        = num_vertices;
+	index_t new_capacity = ensureCapacity(first + count);
+	assert(new_capacity >= first + count);
+
+	if (new_capacity >= first + count) {
+		memcpy(data + (vertex_size * first), vertex_data, vertex_size * count);
+
+		num_vertices += count;
+		markDirty(vertex_size * first, vertex_size * num_vertices);
+	}
+
+	return first;
+}
+
+
+VertexBuffer::Cursor VertexBuffer::editVertices(index_t first, index_t count) {
+	assert(first + count <= num_vertices);
+	markDirty(vertex_size * first, vertex_size * (first + count));
+
+	return Cursor(this, data + (vertex_size * first));
+}
+
+
 void VertexBuffer::setVertexPosition(index_t index, float x, float y, float z) {
 	data_t ptr = getVertexPtr(index, positions);
-	int field_size = sizeof(float);
 	assert(ptr);
 
 	if (ptr) {
-		if (positions.fields >= 1) {
-			setValue(ptr, field_size * 0, x);
-		}
-
-		if (positions.fields >= 2) {
-			setValue(ptr, field_size * 1, y);
-		}
-
-		if (positions.fields >= 3) {
-			setValue(ptr, field_size * 2, z);
-		}
+		float values[3] = { x, y, z };
+		writeComponent(ptr - positions.offset, positions, values);
+		markDirty(ptr - data, ptr - data + positions.size);
 	}
 
 	return;
@@ -408,21 +727,12 @@ void VertexBuffer::setVertexPosition(index_t index, float x, float y, float z) {
 
 void VertexBuffer::setVertexNormal(index_t index, float x, float y, float z) {
 	data_t ptr = getVertexPtr(index, normals);
-	int field_size = sizeof(float);
 	assert(ptr);
 
 	if (ptr) {
-		if (normals.fields >= 1) {
-			setValue(ptr, field_size * 0, x);
-		}
-
-		if (normals.fields >= 2) {
-			setValue(ptr, field_size * 1, y);
-		}
-
-		if (normals.fields >= 3) {
-			setValue(ptr, field_size * 2, z);
-		}
+		float values[3] = { x, y, z };
+		writeComponent(ptr - normals.offset, normals, values);
+		markDirty(ptr - data, ptr - data + normals.size);
 	}
 
 	return;
@@ -431,25 +741,12 @@ void VertexBuffer::setVertexNormal(index_t index, float x, float y, float z) {
 
 void VertexBuffer::setVertexColor(index_t index, float r, float g, float b, float a) {
 	data_t ptr = getVertexPtr(index, colors);
-	int field_size = sizeof(float);
 	assert(ptr);
 
 	if (ptr) {
-		if (colors.fields >= 1) {
-			setValue(ptr, field_size * 0, r);
-		}
-
-		if (colors.fields >= 2) {
-			setValue(ptr, field_size * 1, g);
-		}
-
-		if (colors.fields >= 3) {
-			setValue(ptr, field_size * 2, b);
-		}
-
-		if (colors.fields >= 4) {
-			setValue(ptr, field_size * 3, a);
-		}
+		float values[4] = { r, g, b, a };
+		writeComponent(ptr - colors.offset, colors, values);
+		markDirty(ptr - data, ptr - data + colors.size);
 	}
 
 	return;
@@ -475,17 +772,12 @@ void VertexBuffer::setVertexTextureCoordinate(index_t index, unsigned int layer,
 	assert(layer < textures.size());
 	if (layer < textures.size()) {
 		data_t ptr = getVertexPtr(index, textures[layer]);
-		int field_size = sizeof(float);
 		assert(ptr);
 
 		if (ptr) {
-			if (textures[layer].fields >= 1) {
-				setValue(ptr, field_size * 0, u);
-			}
-
-			if (textures[layer].fields >= 2) {
-				setValue(ptr, field_size * 1, v);
-			}
+			float values[2] = { u, v };
+			writeComponent(ptr - textures[layer].offset, textures[layer], values);
+			markDirty(ptr - data, ptr - data + textures[layer].size);
 		}
 	}
 
@@ -498,7 +790,33 @@ unsigned short VertexBuffer::getVertexSize() const {
 }
 
 
-void VertexBuffer::invalidateHardwareData() const {
+void VertexBuffer::invalidateHardwareData() {
+	// the whole buffer needs to be uploaded again
+	dirty_begin = 0;
+	dirty_end   = vertex_size * capacity;
+
+	return;
+}
+
+
+void VertexBuffer::markDirty(size_t begin, size_t end) {
+	if (isDirty()) {
+		dirty_begin = std::min(dirty_begin, begin);
+		dirty_end   = std::max(dirty_end,   end);
+	}
+	else {
+		dirty_begin = begin;
+		dirty_end   = end;
+	}
+
+	return;
+}
+
+
+void VertexBuffer::clearDirtyRange() {
+	dirty_begin = 0;
+	dirty_end   = 0;
+
 	return;
 }
 
@@ -26,6 +26,7 @@
 
 #include "texture.h"
 #include "shader.h"
+#include "types.h"
 
 #include <wiesel/math/vector2d.h>
 #include <wiesel/math/vector3d.h>
@@ -71,8 +72,117 @@ namespace video {
 
 			/// the start offset of this component relative to the vertex beginning
 			unsigned char	offset;
+
+			/// the data type of each field, see \ref VertexDataType
+			unsigned char	type;
+		};
+
+		/**
+		 * @brief Provides fast sequential write access to a range of vertices.
+		 * The cursor writes directly into the buffer's memory without any range checks,
+		 * so it must not be moved beyond the range it was created for.
+		 * Any operation which changes the buffer's capacity invalidates the cursor.
+		 */
+		class Cursor {
+		friend class VertexBuffer;
+		private:
+			Cursor(const VertexBuffer *buffer, data_t ptr) : buffer(buffer), ptr(ptr) {}
+
+		public:
+			/// set the position of the current vertex.
+			inline Cursor& position(float x, float y, float z=0.0f) {
+				if (buffer->positions.type == VertexDataFloat) {
+					float *p = reinterpret_cast<float*>(ptr + buffer->positions.offset);
+					p[0] = x;
+					p[1] = y;
+
+					if (buffer->positions.fields >= 3) {
+						p[2] = z;
+					}
+				}
+				else {
+					float values[3] = { x, y, z };
+					writeComponent(ptr, buffer->positions, values);
+				}
+
+				return *this;
+			}
+
+			/// set the position of the current vertex.
+			inline Cursor& position(const vector2d &v) {
+				return position(v.x, v.y);
+			}
+
+			/// set the position of the current vertex.
+			inline Cursor& position(const vector3d &v) {
+				return position(v.x, v.y, v.z);
+			}
+
+			/// set the normal of the current vertex.
+			inline Cursor& normal(float x, float y, float z) {
+				float values[3] = { x, y, z };
+				writeComponent(ptr, buffer->normals, values);
+				return *this;
+			}
+
+			/// set the RGB(A) color of the current vertex.
+			inline Cursor& color(float r, float g, float b, float a=1.0f) {
+				if (buffer->colors.type == VertexDataFloat) {
+					float *p = reinterpret_cast<float*>(ptr + buffer->colors.offset);
+					p[0] = r;
+					p[1] = g;
+					p[2] = b;
+
+					if (buffer->colors.fields >= 4) {
+						p[3] = a;
+					}
+				}
+				else {
+					float values[4] = { r, g, b, a };
+					writeComponent(ptr, buffer->colors, values);
+				}
+
+				return *this;
+			}
+
+			/// set the first texture layer's coordinate of the current vertex.
+			inline Cursor& texcoord(float u, float v) {
+				return texcoord(0, u, v);
+			}
+
+			/// set the texture coordinate of the current vertex.
+			inline Cursor& texcoord(unsigned int layer, float u, float v) {
+				if (buffer->textures[layer].type == VertexDataFloat) {
+					float *p = reinterpret_cast<float*>(ptr + buffer->textures[layer].offset);
+					p[0] = u;
+					p[1] = v;
+				}
+				else {
+					float values[2] = { u, v };
+					writeComponent(ptr, buffer->textures[layer], values);
+				}
+
+				return *this;
+			}
+
+			/// move the cursor to the next vertex.
+			inline Cursor& next() {
+				ptr += buffer->vertex_size;
+				return *this;
+			}
+
+			/// get the pointer to the current vertex.
+			inline data_t getPtr() const {
+				return ptr;
+			}
+
+		private:
+			const VertexBuffer*		buffer;
+			data_t					ptr;
 		};
 
+		friend class Cursor;
+
 	public:
 		VertexBuffer();
 		virtual ~VertexBuffer();
@@ -81,8 +191,11 @@ namespace video {
 		 * @brief configure the vertex position member of the vertices.
 		 * @param dimensions	The number of dimensions of each vertex.
 		 * 						This must be either 2 or 3 dimensions.
+		 * @param type			The data type of each field.
+		 * 						Supported are \ref VertexDataFloat, \ref VertexDataHalfFloat
+		 * 						and \ref VertexDataInt16.
 		 */
-		bool setupVertexPositions(int dimensions=3);
+		bool setupVertexPositions(int dimensions=3, VertexDataType type=VertexDataFloat);
 
 		/**
 		 * @brief configure the normals member of the vertices.
@@ -93,14 +206,20 @@ namespace video {
 		 * @brief configure the colors member of the vertices.
 		 * @param fields	The number of color components for each color.
 		 * 					3 for RGB, 4 for RGBA.
+		 * @param type		The data type of each field.
+		 * 					Supported are \ref VertexDataFloat and \ref VertexDataUInt8Normalized,
+		 * 					which requires 4 fields.
 		 */
-		bool setupVertexColors(int fields=4);
+		bool setupVertexColors(int fields=4, VertexDataType type=VertexDataFloat);
 
 		/**
 		 * @brief configure a texture layer of the vertices.
 		 * @param layer		The layer to be configured.
+		 * @param type		The data type of each field.
+		 * 					Supported are \ref VertexDataFloat, \ref VertexDataHalfFloat
+		 * 					and \ref VertexDataUInt16Normalized.
 		 */
-		bool setupTextureLayer(unsigned int layer);
+		bool setupTextureLayer(unsigned int layer, VertexDataType type=VertexDataFloat);
 
 		/**
 		 * @brief disables vertex normals.
@@ -189,6 +308,38 @@ namespace video {
 		 */
 		std::string getDefaultShaderName() const;
 
+		/**
+		 * @brief get a name describing the memory layout of the vertices.
+		 * Two vertex buffers with the same layout name can be bound
+		 * with the same vertex attribute configuration.
+		 */
+		std::string getVertexLayoutName() const;
+
+		/**
+		 * @brief get a number which changes each time the layout of the vertices was changed.
+		 * This allows backends to detect whether cached vertex attribute setups are still valid.
+		 */
+		inline unsigned int getLayoutVersion() const {
+			return layout_version;
+		}
+
+		/**
+		 * @brief writes a number of float values into a component,
+		 * converting them into the component's data type.
+		 * @param vertex	Pointer to the beginning of the vertex.
+		 * @param comp		The component to be written.
+		 * @param values	The values to be written, one for each field of the component.
+		 */
+		static void writeComponent(data_t vertex, const component &comp, const float *values);
+
+		/**
+		 * @brief reads the values of a component as float values.
+		 * @param vertex	Pointer to the beginning of the vertex.
+		 * @param comp		The component to be read.
+		 * @param values	Receives the values, one for each field of the component.
+		 */
+		static void readComponent(const unsigned char *vertex, const component &comp, float *values);
+
 
 		/**
 		 * @brief set the capacity of this vertex buffer to store the given amount of vertices.
@@ -214,6 +365,26 @@ namespace video {
 		 */
 		index_t getSize() const;
 
+		/**
+		 * @brief ensures this vertex buffer can store the given amount of additional vertices.
+		 * @return the new capacity.
+		 */
+		index_t reserve(index_t count);
+
+		/**
+		 * @brief set the usage hint of this buffer.
+		 * The hint tells the backend how often the content of this buffer will change,
+		 * so it can choose the best strategy to update the hardware buffer.
+		 */
+		void setUsage(BufferUsage usage);
+
+		/**
+		 * @brief get the usage hint of this buffer.
+		 */
+		inline BufferUsage getUsage() const {
+			return usage;
+		}
+
 
 
 		/**
@@ -278,6 +449,38 @@ namespace video {
 		 */
 		void setVertexTextureCoordinate(index_t index, unsigned int layer, float u, float v);
 
+		/**
+		 * @brief adds a number of vertices and returns a cursor to write their data.
+		 * The buffer's memory will be allocated only once for all vertices.
+		 * The content of the new vertices is undefined until written by the cursor.
+		 * @param count		The number of vertices to be added.
+		 * @return A cursor pointing to the first new vertex.
+		 */
+		Cursor addVertices(index_t count);
+
+		/**
+		 * @brief adds a number of vertices by copying their raw data.
+		 * The data needs to match the layout of this vertex buffer.
+		 * @param vertex_data	The data of all vertices, each \ref getVertexSize bytes.
+		 * @param count			The number of vertices to be added.
+		 * @return The index of the first new vertex.
+		 */
+		index_t addVertices(const void *vertex_data, index_t count);
+
+		/**
+		 * @brief get a cursor to modify a range of existing vertices.
+		 * @param first		The index of the first vertex to change.
+		 * @param count		The number of vertices which will be changed.
+		 * @return A cursor pointing to the first vertex of the range.
+		 */
+		Cursor editVertices(index_t first, index_t count);
+
+		/**
+		 * @brief removes all vertices, but keeps the allocated memory for new vertices.
+		 * Unlike \ref clear, the setup of this buffer cannot be changed afterwards.
+		 */
+		void reset();
+
 		/**
 		 * @brief clears the content of this vertex buffer.
 		 */
@@ -299,6 +502,35 @@ namespace video {
 		 */
 		unsigned short getVertexSize() const;
 
+	// dirty range
+	public:
+		/**
+		 * @brief Checks, if any data was modified since the hardware buffer was updated.
+		 */
+		inline bool isDirty() const {
+			return dirty_begin < dirty_end;
+		}
+
+		/**
+		 * @brief Get the offset in bytes of the first modified byte.
+		 */
+		inline size_t getDirtyRangeBegin() const {
+			return dirty_begin;
+		}
+
+		/**
+		 * @brief Get the offset in bytes behind the last modified byte.
+		 */
+		inline size_t getDirtyRangeEnd() const {
+			return dirty_end;
+		}
+
+		/**
+		 * @brief Resets the dirty range.
+		 * This should be called by the backend after the hardware buffer was updated.
+		 */
+		void clearDirtyRange();
+
 	protected:
 		/// checks, if the setup of this vertex buffer can be changed.
 		bool checkIfSetupPossible() const;
@@ -315,14 +547,14 @@ namespace video {
 		/// get the pointer of a specific
 		data_t getVertexPtr(index_t index, const component &comp) const;
 
-		/// writes a single value into the buffer
-		template <typename T>
-		void setValue(data_t ptr, size_t offset, T value) {
-			*(reinterpret_cast<T*>(ptr + offset)) = value;
-		}
+		/// configures the size and data type of a component.
+		static void setupComponent(component *comp, int fields, VertexDataType type);
 
 		/// Invalidates the hardware buffer, so the buffer needs to be re-created next time.
-		void invalidateHardwareData() const;
+		void invalidateHardwareData();
+
+		/// marks a range of bytes as modified.
+		void markDirty(size_t begin, size_t end);
 
 	private:
 		component				positions;
@@ -330,11 +562,16 @@ namespace video {
 		component				colors;
 		std::vector<component>	textures;
 		unsigned short			vertex_size;
+		unsigned int			layout_version;
 
 		index_t					num_vertices;
 		index_t					capacity;
 
 		data_t					data;
+
+		BufferUsage				usage;
+		size_t					dirty_begin;
+		size_t					dirty_end;
 	};
 
 
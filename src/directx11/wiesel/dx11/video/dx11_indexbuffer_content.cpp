@@ -22,13 +22,18 @@
 #include "dx11_indexbuffer_content.h"
 #include "dx11_render_context.h"
 
+#include <algorithm>
+#include <string.h>
+
 using namespace wiesel;
 using namespace wiesel::video;
 using namespace wiesel::dx11::video;
 
 
 Dx11IndexBufferContent::Dx11IndexBufferContent(IndexBuffer *ib) : IndexBufferContent(ib) {
-	this->buffer = NULL;
+	this->buffer       = NULL;
+	this->buffer_size  = 0;
+	this->buffer_usage = BufferUsageStatic;
 	return;
 }
 
@@ -57,7 +62,7 @@ bool Dx11IndexBufferContent::initializeIndexBuffer(DirectX11RenderContext *conte
 		HRESULT result;
 
 		buffer_desc.Usage = D3D11_USAGE_DEFAULT;
-		buffer_desc.ByteWidth				= getIndexBuffer()->getBytesPerElement() * getIndexBuffer()->getSize();
+		buffer_desc.ByteWidth				= getIndexBuffer()->getBytesPerElement() * getIndexBuffer()->getCapacity();
 		buffer_desc.BindFlags				= D3D11_BIND_INDEX_BUFFER;
 		buffer_desc.CPUAccessFlags			= 0;
 		buffer_desc.MiscFlags				= 0;
@@ -67,10 +72,69 @@ bool Dx11IndexBufferContent::initializeIndexBuffer(DirectX11RenderContext *conte
 		buffer_data.SysMemPitch				= 0;
 		buffer_data.SysMemSlicePitch		= 0;
 
+		// streaming buffers will be rewritten each frame via Map
+		if (getIndexBuffer()->getUsage() == BufferUsageStream) {
+			buffer_desc.Usage				= D3D11_USAGE_DYNAMIC;
+			buffer_desc.CPUAccessFlags		= D3D11_CPU_ACCESS_WRITE;
+		}
+
 		result = context->getD3DDevice()->CreateBuffer(&buffer_desc, &buffer_data, &buffer);
 		if (FAILED(result)) {
 			return false;
 		}
+
+		buffer_size  = buffer_desc.ByteWidth;
+		buffer_usage = getIndexBuffer()->getUsage();
+		getIndexBuffer()->clearDirtyRange();
+	}
+
+	return true;
+}
+
+
+bool Dx11IndexBufferContent::updateIndexBuffer(DirectX11RenderContext *context) {
+	IndexBuffer *index_buffer = getIndexBuffer();
+
+	if (index_buffer->isDirty()) {
+		UINT size = index_buffer->getBytesPerElement() * index_buffer->getCapacity();
+
+		// the buffer was resized or got another usage hint, so the hardware buffer needs to be re-created
+		if (buffer == NULL || size != buffer_size || index_buffer->getUsage() != buffer_usage) {
+			releaseIndexBuffer();
+			return initializeIndexBuffer(context);
+		}
+
+		if (index_buffer->getUsage() == BufferUsageStream) {
+			// discard the old content and write the whole buffer
+			D3D11_MAPPED_SUBRESOURCE mapped;
+			HRESULT result = context->getD3DDeviceContext()->Map(buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+			if (FAILED(result)) {
+				return false;
+			}
+
+			memcpy(mapped.pData, index_buffer->getDataPtr(), index_buffer->getBytesPerElement() * index_buffer->getSize());
+			context->getD3DDeviceContext()->Unmap(buffer, 0);
+		}
+		else {
+			// upload only the modified range
+			D3D11_BOX box;
+			box.left	= index_buffer->getDirtyRangeBegin();
+			box.right	= std::min<UINT>(index_buffer->getDirtyRangeEnd(), size);
+			box.top		= 0;
+			box.bottom	= 1;
+			box.front	= 0;
+			box.back	= 1;
+
+			if (box.right > box.left) {
+				context->getD3DDeviceContext()->UpdateSubresource(
+							buffer, 0, &box,
+							index_buffer->getDataPtr() + box.left,
+							0, 0
+				);
+			}
+		}
+
+		index_buffer->clearDirtyRange();
 	}
 
 	return true;
@@ -80,7 +144,8 @@ bool Dx11IndexBufferContent::initializeIndexBuffer(DirectX11RenderContext *conte
 void Dx11IndexBufferContent::releaseIndexBuffer() {
 	if (buffer) {
 		buffer->Release();
-		buffer = NULL;
+		buffer      = NULL;
+		buffer_size = 0;
 	}
 
 	return;
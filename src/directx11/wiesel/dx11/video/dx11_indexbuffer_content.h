@@ -53,6 +53,12 @@ namespace video {
 		 */
 		bool initializeIndexBuffer(DirectX11RenderContext *context);
 
+		/**
+		 * @brief Uploads all modified data of the index buffer to the graphics hardware.
+		 * The hardware buffer will be re-created, when the buffer's size has changed.
+		 */
+		bool updateIndexBuffer(DirectX11RenderContext *context);
+
 		/**
 		 * @brief Releases the index buffer object on the graphics hardware.
 		 */
@@ -66,7 +72,9 @@ namespace video {
 		}
 
 	private:
-		ID3D11Buffer*	buffer;
+		ID3D11Buffer*					buffer;
+		UINT							buffer_size;
+		wiesel::video::BufferUsage		buffer_usage;
 	};
 
 } /* namespace video */
@@ -441,6 +441,7 @@ void DirectX11RenderContext::initContext() {
 
 
 void DirectX11RenderContext::releaseContext() {
+	flushBatch();
 	setShader(NULL);
 	clearTextures();
 
@@ -500,6 +501,8 @@ void DirectX11RenderContext::releaseContext() {
 
 
 void DirectX11RenderContext::onSizeChanged(const dimension& size) {
+	flushBatch();
+
 	// setup viewport
 	if (d3d_device_context) {
 		D3D11_VIEWPORT vp;
@@ -537,6 +540,9 @@ void DirectX11RenderContext::preRender() {
 
 
 void DirectX11RenderContext::postRender() {
+	// draw all pending primitives
+	flushBatch();
+
 	// reset all gl objects
 	setShader(NULL);
 	clearTextures();
@@ -549,18 +555,26 @@ void DirectX11RenderContext::postRender() {
 		swap_chain->Present(0, 0);
 	}
 
+	finishFrameStatistics();
+
 	return;
 }
 
 
 
 void DirectX11RenderContext::setProjectionMatrix(const matrix4x4& matrix) {
+	if (this->projection != matrix) {
+		flushBatch();
+	}
+
 	this->projection = matrix;
 	return;
 }
 
 
 void DirectX11RenderContext::setModelviewMatrix(const matrix4x4& matrix) {
+	flushBatch();
+
 	if (active_shader && active_shader_content) {
 
 		// get the active shader's matrix buffer template
@@ -596,6 +610,9 @@ void DirectX11RenderContext::setModelviewMatrix(const matrix4x4& matrix) {
 
 void DirectX11RenderContext::setShader(Shader* shader) {
 	if (this->active_shader != shader) {
+		// draw pending primitives using the old shader
+		flushBatch();
+
 		// clear the old shader
 		clear_ref(this->active_shader);
 
@@ -677,6 +694,9 @@ bool DirectX11RenderContext::assignShaderConstantBuffer(const wiesel::video::Sha
 			}
 		}
 
+		// pending primitives need to be drawn with the old buffer content
+		flushBatch();
+
 		active_shader_content->assignShaderConstantBuffer(buffer_template, buffer->getContent());
 	}
 
@@ -691,6 +711,9 @@ void DirectX11RenderContext::setTexture(uint16_t index, Texture* texture) {
 
 	Texture *active_texture = this->active_textures[index];
 	if (active_texture != texture) {
+		// draw pending primitives using the old texture
+		flushBatch();
+
 		Dx11TextureContent *active_texture_content = this->active_textures_content[index];
 
 		// clear the old texture
@@ -740,6 +763,8 @@ void DirectX11RenderContext::clearTextures() {
 
 
 void DirectX11RenderContext::draw(Primitive primitive, const VertexBuffer *vertices) {
+	flushBatch();
+
 	if (bind(vertices)) {
 		D3D_PRIMITIVE_TOPOLOGY topology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
 
@@ -763,6 +788,53 @@ void DirectX11RenderContext::draw(Primitive primitive, const VertexBuffer *verti
 		if (topology != D3D_PRIMITIVE_TOPOLOGY_UNDEFINED) {
 			getD3DDeviceContext()->IASetPrimitiveTopology(topology);
 			getD3DDeviceContext()->Draw(vertices->getSize(), 0);
+			frame_statistics.countDrawCall(primitive, vertices->getSize());
+		}
+
+		unbind(vertices);
+	}
+
+	return;
+}
+
+
+bool DirectX11RenderContext::isInstancingSupported() const {
+	// instancing is available on all Direct3D 11 feature levels
+	return true;
+}
+
+
+void DirectX11RenderContext::drawInstanced(Primitive primitive, const VertexBuffer *vertices, const VertexBuffer *instances) {
+	flushBatch();
+
+	if (instances == NULL || instances->getSize() == 0) {
+		return;
+	}
+
+	if (bind(vertices, instances)) {
+		D3D_PRIMITIVE_TOPOLOGY topology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+
+		switch(primitive) {
+			case Triangles: {
+				topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+				break;
+			}
+
+			case TriangleStrip: {
+				topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
+				break;
+			}
+
+			default: {
+				topology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+				break;
+			}
+		}
+
+		if (topology != D3D_PRIMITIVE_TOPOLOGY_UNDEFINED) {
+			getD3DDeviceContext()->IASetPrimitiveTopology(topology);
+			getD3DDeviceContext()->DrawInstanced(vertices->getSize(), instances->getSize(), 0, 0);
+			frame_statistics.countDrawCall(primitive, vertices->getSize(), instances->getSize());
 		}
 
 		unbind(vertices);
@@ -773,6 +845,8 @@ void DirectX11RenderContext::draw(Primitive primitive, const VertexBuffer *verti
 
 
 void DirectX11RenderContext::draw(Primitive primitive, const VertexBuffer *vertices, const IndexBuffer *indices) {
+	flushBatch();
+
 	if (
 			bind(vertices)
 		&&	bind(indices)
@@ -799,6 +873,7 @@ void DirectX11RenderContext::draw(Primitive primitive, const VertexBuffer *verti
 		if (topology != D3D_PRIMITIVE_TOPOLOGY_UNDEFINED) {
 			getD3DDeviceContext()->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 			getD3DDeviceContext()->DrawIndexed(indices->getSize(), 0, 0);
+			frame_statistics.countDrawCall(primitive, indices->getSize());
 		}
 
 		unbind(indices);
@@ -816,8 +891,13 @@ bool DirectX11RenderContext::bind(const IndexBuffer* index_buffer) {
 			const_cast<IndexBuffer*>(index_buffer)->loadContentFrom(getScreen());
 		}
 
-		const Dx11IndexBufferContent *dx11_index_buffer;
-		dx11_index_buffer = dynamic_cast<const Dx11IndexBufferContent*>(index_buffer->getContent());
+		Dx11IndexBufferContent *dx11_index_buffer;
+		dx11_index_buffer = dynamic_cast<Dx11IndexBufferContent*>(const_cast<IndexBuffer*>(index_buffer)->getContent());
+
+		// upload any modified data
+		if (dx11_index_buffer) {
+			dx11_index_buffer->updateIndexBuffer(this);
+		}
 
 		if (dx11_index_buffer) {
 			DXGI_FORMAT format;
@@ -870,20 +950,53 @@ void DirectX11RenderContext::unbind(const IndexBuffer *index_buffer) {
 }
 
 
-bool DirectX11RenderContext::bind(const VertexBuffer* vertex_buffer) {
+bool DirectX11RenderContext::bind(const VertexBuffer* vertex_buffer, const VertexBuffer *instance_buffer) {
 	if (vertex_buffer && active_shader_content) {
 		// try to bind this vertex buffer to the current shader
-		if (active_shader_content->bind(this, vertex_buffer, active_textures_content) == false) {
+		if (active_shader_content->bind(this, vertex_buffer, active_textures_content, instance_buffer) == false) {
 			return false;
 		}
 
+		// the instance buffer will be read from the second input slot
+		if (instance_buffer) {
+			if(!instance_buffer->isLoaded()) {
+				const_cast<VertexBuffer*>(instance_buffer)->loadContentFrom(getScreen());
+			}
+
+			Dx11VertexBufferContent *dx11_instance_buffer;
+			dx11_instance_buffer = dynamic_cast<Dx11VertexBufferContent*>(const_cast<VertexBuffer*>(instance_buffer)->getContent());
+
+			if (dx11_instance_buffer == NULL) {
+				return false;
+			}
+
+			dx11_instance_buffer->updateVertexBuffer(this);
+
+			ID3D11Buffer *buffer = dx11_instance_buffer->getDx11Buffer();
+			unsigned int stride  = instance_buffer->getVertexSize();
+			unsigned int offset  = 0;
+
+			getD3DDeviceContext()->IASetVertexBuffers(
+										1,
+										1,
+										&buffer,
+										&stride,
+										&offset
+			);
+		}
+
 		// create the hardware buffer on demand
 		if(!vertex_buffer->isLoaded()) {
 			const_cast<VertexBuffer*>(vertex_buffer)->loadContentFrom(getScreen());
 		}
 
-		const Dx11VertexBufferContent *dx11_vertex_buffer;
-		dx11_vertex_buffer = dynamic_cast<const Dx11VertexBufferContent*>(vertex_buffer->getContent());
+		Dx11VertexBufferContent *dx11_vertex_buffer;
+		dx11_vertex_buffer = dynamic_cast<Dx11VertexBufferContent*>(const_cast<VertexBuffer*>(vertex_buffer)->getContent());
+
+		// upload any modified data
+		if (dx11_vertex_buffer) {
+			dx11_vertex_buffer->updateVertexBuffer(this);
+		}
 
 		if (dx11_vertex_buffer) {
 			ID3D11Buffer *buffer = dx11_vertex_buffer->getDx11Buffer();
@@ -909,6 +1022,7 @@ bool DirectX11RenderContext::bind(const VertexBuffer* vertex_buffer) {
 void DirectX11RenderContext::unbind(const VertexBuffer* vertex_buffer) {
 	if (vertex_buffer) {
 		getD3DDeviceContext()->IASetVertexBuffers(0, 0, NULL, NULL, NULL);
+		getD3DDeviceContext()->IASetVertexBuffers(1, 0, NULL, NULL, NULL);
 	}
 
 	return;
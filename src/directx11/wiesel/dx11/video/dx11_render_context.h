@@ -88,9 +88,12 @@ namespace video {
 		virtual void draw(wiesel::video::Primitive primitive, const wiesel::video::VertexBuffer *vertices);
 		virtual void draw(wiesel::video::Primitive primitive, const wiesel::video::VertexBuffer *vertices, const wiesel::video::IndexBuffer *indices);
 
+		virtual bool isInstancingSupported() const;
+		virtual void drawInstanced(wiesel::video::Primitive primitive, const wiesel::video::VertexBuffer *vertices, const wiesel::video::VertexBuffer *instances);
+
 	protected:
 		bool bind(const wiesel::video::IndexBuffer *index_buffer);
-		bool bind(const wiesel::video::VertexBuffer *vertex_buffer);
+		bool bind(const wiesel::video::VertexBuffer *vertex_buffer, const wiesel::video::VertexBuffer *instance_buffer=NULL);
 
 		void unbind(const wiesel::video::IndexBuffer *index_buffer);
 		void unbind(const wiesel::video::VertexBuffer *vertex_buffer);
@@ -321,6 +321,54 @@ bool Dx11ShaderContent::bind(DirectX11RenderContext *render_context) {
 static bool configureInputElement(D3D11_INPUT_ELEMENT_DESC *layout, size_t *size, const VertexBuffer::component &comp) {
 	(*size) = comp.size;
 
+	// compact data types; there are no three-component formats for them,
+	// so the four-component format will read the component's padding
+	switch(comp.type) {
+		case VertexDataHalfFloat: {
+			switch(comp.fields) {
+				case 1:		layout->Format = DXGI_FORMAT_R16_FLOAT;				return true;
+				case 2:		layout->Format = DXGI_FORMAT_R16G16_FLOAT;			return true;
+				case 3:
+				case 4:		layout->Format = DXGI_FORMAT_R16G16B16A16_FLOAT;	return true;
+				default:	return false;
+			}
+		}
+
+		case VertexDataInt16: {
+			switch(comp.fields) {
+				case 1:		layout->Format = DXGI_FORMAT_R16_SINT;				return true;
+				case 2:		layout->Format = DXGI_FORMAT_R16G16_SINT;			return true;
+				case 3:
+				case 4:		layout->Format = DXGI_FORMAT_R16G16B16A16_SINT;		return true;
+				default:	return false;
+			}
+		}
+
+		case VertexDataUInt16Normalized: {
+			switch(comp.fields) {
+				case 1:		layout->Format = DXGI_FORMAT_R16_UNORM;				return true;
+				case 2:		layout->Format = DXGI_FORMAT_R16G16_UNORM;			return true;
+				case 3:
+				case 4:		layout->Format = DXGI_FORMAT_R16G16B16A16_UNORM;	return true;
+				default:	return false;
+			}
+		}
+
+		case VertexDataUInt8Normalized: {
+			switch(comp.fields) {
+				case 1:		layout->Format = DXGI_FORMAT_R8_UNORM;				return true;
+				case 2:		layout->Format = DXGI_FORMAT_R8G8_UNORM;			return true;
+				case 3:
+				case 4:		layout->Format = DXGI_FORMAT_R8G8B8A8_UNORM;		return true;
+				default:	return false;
+			}
+		}
+
+		default: {
+			break;
+		}
+	}
+
 	switch(comp.fields) {
 		case 1: {
 			layout->Format = DXGI_FORMAT_R32_FLOAT;
@@ -351,13 +399,18 @@ static bool configureInputElement(D3D11_INPUT_ELEMENT_DESC *layout, size_t *size
 }
 
 
-bool Dx11ShaderContent::bind(DirectX11RenderContext *render_context, const VertexBuffer *vertex_buffer, const std::vector<Dx11TextureContent*> &textures) {
-	std::string vertex_buffer_key = vertex_buffer->getDefaultShaderName();
+bool Dx11ShaderContent::bind(DirectX11RenderContext *render_context, const VertexBuffer *vertex_buffer, const std::vector<Dx11TextureContent*> &textures, const VertexBuffer *instance_buffer) {
+	std::string vertex_buffer_key = vertex_buffer->getVertexLayoutName();
+	if (instance_buffer) {
+		vertex_buffer_key += "|" + instance_buffer->getVertexLayoutName();
+	}
+
 	PolygonLayoutMap::iterator layout_it = polygon_layouts.find(vertex_buffer_key);
 
 	if (layout_it == polygon_layouts.end()) {
 		std::vector<D3D11_INPUT_ELEMENT_DESC> polygon_layout;
 		size_t current_offset = 0;
+		size_t instance_offset = 0;
 
 		const Shader::AttributeList *attributes = getShader()->getAttributes();
 		for(unsigned int attrib=0; attrib<attributes->size(); attrib++) {
@@ -366,6 +419,7 @@ bool Dx11ShaderContent::bind(DirectX11RenderContext *render_context, const Verte
 			for(unsigned int index=0; index<attribute_names->size(); index++) {
 				D3D11_INPUT_ELEMENT_DESC layout;
 				bool valid_element = true;
+				bool per_instance = false;
 				size_t current_size = 0;
 
 				switch(static_cast<Shader::Attribute>(attrib)) {
@@ -433,6 +487,60 @@ bool Dx11ShaderContent::bind(DirectX11RenderContext *render_context, const Verte
 						break;
 					}
 
+					case Shader::InstancePosition: {
+						layout.SemanticName		= "INSTPOSITION";
+						per_instance			= true;
+
+						if (instance_buffer == NULL || instance_buffer->hasPositions() == false || index > 0) {
+							valid_element = false;
+							break;
+						}
+
+						valid_element &= configureInputElement(
+													&layout,
+													&current_size,
+													instance_buffer->getPositionDescription()
+						);
+
+						break;
+					}
+
+					case Shader::InstanceColor: {
+						layout.SemanticName		= "INSTCOLOR";
+						per_instance			= true;
+
+						if (instance_buffer == NULL || instance_buffer->hasColors() == false || index > 0) {
+							valid_element = false;
+							break;
+						}
+
+						valid_element &= configureInputElement(
+													&layout,
+													&current_size,
+													instance_buffer->getColorDescription()
+						);
+
+						break;
+					}
+
+					case Shader::InstanceData: {
+						layout.SemanticName		= "INSTDATA";
+						per_instance			= true;
+
+						if (instance_buffer == NULL || instance_buffer->getNumberOfTextureLayers() <= index) {
+							valid_element = false;
+							break;
+						}
+
+						valid_element &= configureInputElement(
+													&layout,
+													&current_size,
+													instance_buffer->getTextureDescription(index)
+						);
+
+						break;
+					}
+
 					default: {
 						valid_element = false;
 						break;
@@ -444,13 +552,25 @@ bool Dx11ShaderContent::bind(DirectX11RenderContext *render_context, const Verte
 				}
 
 				layout.SemanticIndex		= index;
-				layout.InputSlot			= 0;
-				layout.AlignedByteOffset	= current_offset;
-				layout.InputSlotClass		= D3D11_INPUT_PER_VERTEX_DATA;
-				layout.InstanceDataStepRate	= 0;
 
-				// compute the offset for the next component
-				current_offset += current_size;
+				if (per_instance) {
+					layout.InputSlot			= 1;
+					layout.AlignedByteOffset	= instance_offset;
+					layout.InputSlotClass		= D3D11_INPUT_PER_INSTANCE_DATA;
+					layout.InstanceDataStepRate	= 1;
+
+					// compute the offset for the next component
+					instance_offset += current_size;
+				}
+				else {
+					layout.InputSlot			= 0;
+					layout.AlignedByteOffset	= current_offset;
+					layout.InputSlotClass		= D3D11_INPUT_PER_VERTEX_DATA;
+					layout.InstanceDataStepRate	= 0;
+
+					// compute the offset for the next component
+					current_offset += current_size;
+				}
 
 				polygon_layout.push_back(layout);
 			}
@@ -479,8 +599,13 @@ bool Dx11ShaderContent::bind(DirectX11RenderContext *render_context, const Verte
 	// set the according input layout
 	render_context->getD3DDeviceContext()->IASetInputLayout(layout_it->second);
 
-	// configure all texture layers
-	for(unsigned int i=0; i<vertex_buffer->getNumberOfTextureLayers(); i++) {
+	// configure all texture layers; instanced vertices carry no texture coordinates, so use all textures
+	unsigned int texture_layers = vertex_buffer->getNumberOfTextureLayers();
+	if (instance_buffer) {
+		texture_layers = textures.size();
+	}
+
+	for(unsigned int i=0; i<texture_layers; i++) {
 		assert(i < textures.size());
 
 		if (i < textures.size() && (textures.at(i) != NULL)) {
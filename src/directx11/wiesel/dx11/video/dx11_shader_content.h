@@ -81,8 +81,17 @@ namespace video {
 		/// bind this shader to the context
 		bool bind(DirectX11RenderContext *render_context);
 
-		/// bind the given vertex_buffer to this shader
-		bool bind(DirectX11RenderContext *render_context, const wiesel::video::VertexBuffer *vertex_buffer, const std::vector<Dx11TextureContent*> &textures);
+		/**
+		 * @brief bind the given vertex_buffer to this shader.
+		 * When an instance buffer is given, its components are read from the
+		 * second input slot and will advance once per instance.
+		 */
+		bool bind(
+				DirectX11RenderContext *render_context,
+				const wiesel::video::VertexBuffer *vertex_buffer,
+				const std::vector<Dx11TextureContent*> &textures,
+				const wiesel::video::VertexBuffer *instance_buffer=NULL
+		);
 
 	private:
 		struct ShaderConstantBufferEntry {
@@ -27,6 +27,7 @@
 #include <wiesel/resources/graphics/imageutils.h>
 #include <wiesel/resources/graphics/image_loader.h>
 #include <wiesel/module_registry.h>
+#include <wiesel/util/profiler.h>
 
 
 using namespace wiesel;
@@ -62,6 +63,7 @@ Dx11TextureContent *Dx11TextureContent::createContentFor(DirectX11RenderContext
 
 
 bool Dx11TextureContent::initializeTexture(DirectX11RenderContext *context) {
+	WIESEL_PROFILE_SCOPE("Texture::load");
 	assert(texture == NULL);
 
 	// release the previous texture
@@ -144,6 +146,7 @@ bool Dx11TextureContent::initializeTexture(DirectX11RenderContext *context) {
 	}
 
 	// create the hardware texture
+	WIESEL_PROFILE_SCOPE("Texture::upload");
 	result = context->getD3DDevice()->CreateTexture2D(
 											&texture_desc,
 											&subresource_data,
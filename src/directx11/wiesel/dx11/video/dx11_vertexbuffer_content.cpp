@@ -22,13 +22,18 @@
 #include "dx11_vertexbuffer_content.h"
 #include "dx11_render_context.h"
 
+#include <algorithm>
+#include <string.h>
+
 using namespace wiesel;
 using namespace wiesel::video;
 using namespace wiesel::dx11::video;
 
 
 Dx11VertexBufferContent::Dx11VertexBufferContent(VertexBuffer *vb) : VertexBufferContent(vb) {
-	this->buffer = NULL;
+	this->buffer       = NULL;
+	this->buffer_size  = 0;
+	this->buffer_usage = BufferUsageStatic;
 	return;
 }
 
@@ -57,7 +62,7 @@ bool Dx11VertexBufferContent::initializeVertexBuffer(DirectX11RenderContext *con
 		HRESULT result;
 
 		buffer_desc.Usage					= D3D11_USAGE_DEFAULT;
-		buffer_desc.ByteWidth				= getVertexBuffer()->getVertexSize() * getVertexBuffer()->getSize();
+		buffer_desc.ByteWidth				= getVertexBuffer()->getVertexSize() * getVertexBuffer()->getCapacity();
 		buffer_desc.BindFlags				= D3D11_BIND_VERTEX_BUFFER;
 		buffer_desc.CPUAccessFlags			= 0;
 		buffer_desc.MiscFlags				= 0;
@@ -67,10 +72,69 @@ bool Dx11VertexBufferContent::initializeVertexBuffer(DirectX11RenderContext *con
 		buffer_data.SysMemPitch				= 0;
 		buffer_data.SysMemSlicePitch		= 0;
 
+		// streaming buffers will be rewritten each frame via Map
+		if (getVertexBuffer()->getUsage() == BufferUsageStream) {
+			buffer_desc.Usage				= D3D11_USAGE_DYNAMIC;
+			buffer_desc.CPUAccessFlags		= D3D11_CPU_ACCESS_WRITE;
+		}
+
 		result = context->getD3DDevice()->CreateBuffer(&buffer_desc, &buffer_data, &buffer);
 		if (FAILED(result)) {
 			return false;
 		}
+
+		buffer_size  = buffer_desc.ByteWidth;
+		buffer_usage = getVertexBuffer()->getUsage();
+		getVertexBuffer()->clearDirtyRange();
+	}
+
+	return true;
+}
+
+
+bool Dx11VertexBufferContent::updateVertexBuffer(DirectX11RenderContext *context) {
+	VertexBuffer *vertex_buffer = getVertexBuffer();
+
+	if (vertex_buffer->isDirty()) {
+		UINT size = vertex_buffer->getVertexSize() * vertex_buffer->getCapacity();
+
+		// the buffer was resized or got another usage hint, so the hardware buffer needs to be re-created
+		if (buffer == NULL || size != buffer_size || vertex_buffer->getUsage() != buffer_usage) {
+			releaseVertexBuffer();
+			return initializeVertexBuffer(context);
+		}
+
+		if (vertex_buffer->getUsage() == BufferUsageStream) {
+			// discard the old content and write the whole buffer
+			D3D11_MAPPED_SUBRESOURCE mapped;
+			HRESULT result = context->getD3DDeviceContext()->Map(buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+			if (FAILED(result)) {
+				return false;
+			}
+
+			memcpy(mapped.pData, vertex_buffer->getDataPtr(), vertex_buffer->getVertexSize() * vertex_buffer->getSize());
+			context->getD3DDeviceContext()->Unmap(buffer, 0);
+		}
+		else {
+			// upload only the modified range
+			D3D11_BOX box;
+			box.left	= vertex_buffer->getDirtyRangeBegin();
+			box.right	= std::min<UINT>(vertex_buffer->getDirtyRangeEnd(), size);
+			box.top		= 0;
+			box.bottom	= 1;
+			box.front	= 0;
+			box.back	= 1;
+
+			if (box.right > box.left) {
+				context->getD3DDeviceContext()->UpdateSubresource(
+							buffer, 0, &box,
+							vertex_buffer->getDataPtr() + box.left,
+							0, 0
+				);
+			}
+		}
+
+		vertex_buffer->clearDirtyRange();
 	}
 
 	return true;
@@ -80,7 +144,8 @@ bool Dx11VertexBufferContent::initializeVertexBuffer(DirectX11RenderContext *con
 void Dx11VertexBufferContent::releaseVertexBuffer() {
 	if (buffer) {
 		buffer->Release();
-		buffer = NULL;
+		buffer      = NULL;
+		buffer_size = 0;
 	}
 
 	return;
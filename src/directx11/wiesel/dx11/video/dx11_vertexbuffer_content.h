@@ -54,6 +54,12 @@ namespace video {
 		 */
 		bool initializeVertexBuffer(DirectX11RenderContext *context);
 
+		/**
+		 * @brief Uploads all modified data of the vertex buffer to the graphics hardware.
+		 * The hardware buffer will be re-created, when the buffer's size has changed.
+		 */
+		bool updateVertexBuffer(DirectX11RenderContext *context);
+
 		/**
 		 * @brief Releases the vertex buffer object on the graphics hardware.
 		 */
@@ -67,7 +73,9 @@ namespace video {
 		}
 
 	private:
-		ID3D11Buffer*	buffer;
+		ID3D11Buffer*					buffer;
+		UINT							buffer_size;
+		wiesel::video::BufferUsage		buffer_usage;
 	};
 
 } /* namespace video */
@@ -20,13 +20,42 @@
  * Boston, MA 02110-1301 USA
  */
 #include "gl.h"
+#include "gl_state_cache.h"
+
 #include <wiesel/util/log.h>
 
+#include <string.h>
+
+
+#if !WIESEL_PLATFORM_ANDROID
+	// GLee 5.4 predates OpenGL 3.1, so the uniform buffer functions need to be loaded manually
+	typedef GLuint (APIENTRYP PFNWIESELGETUNIFORMBLOCKINDEXPROC)(GLuint program, const GLchar *name);
+	typedef void   (APIENTRYP PFNWIESELUNIFORMBLOCKBINDINGPROC)(GLuint program, GLuint block_index, GLuint binding);
+	typedef void   (APIENTRYP PFNWIESELBINDBUFFERBASEPROC)(GLenum target, GLuint index, GLuint buffer);
+
+	static PFNWIESELGETUNIFORMBLOCKINDEXPROC	pfnGetUniformBlockIndex		= NULL;
+	static PFNWIESELUNIFORMBLOCKBINDINGPROC		pfnUniformBlockBinding		= NULL;
+	static PFNWIESELBINDBUFFERBASEPROC			pfnBindBufferBase			= NULL;
+
+	static void *getGlProcAddress(const char *name) {
+		#if WIESEL_PLATFORM_WINDOWS
+			return reinterpret_cast<void*>(wglGetProcAddress(name));
+		#else
+			return reinterpret_cast<void*>(glXGetProcAddressARB(reinterpret_cast<const GLubyte*>(name)));
+		#endif
+	}
+#endif
+
 
 void wiesel::video::gl::checkGlError(const char *file, int line) {
+    GlStateCache *state = GlStateCache::instance();
+    state->countErrorCheck();
+
     for (GLint error=glGetError(); error; error=glGetError()) {
     	const char *message = NULL;
 
+    	state->countErrorCheck();
+
     	switch(error) {
 			case GL_INVALID_ENUM:			message = "GL_INVALID_ENUM";			break;
 			case GL_INVALID_VALUE:			message = "GL_INVALID_VALUE";			break;
@@ -42,3 +71,199 @@ void wiesel::video::gl::checkGlError(const char *file, int line) {
 }
 
 
+GLenum wiesel::video::gl::getGlBufferUsage(BufferUsage usage) {
+	switch(usage) {
+		case BufferUsageStatic:			return GL_STATIC_DRAW;
+		case BufferUsageDynamic:		return GL_DYNAMIC_DRAW;
+		case BufferUsageStream:			return GL_STREAM_DRAW;
+	}
+
+	return GL_STATIC_DRAW;
+}
+
+
+GLenum wiesel::video::gl::getGlVertexDataType(VertexDataType type) {
+	switch(type) {
+		case VertexDataFloat:				return GL_FLOAT;
+		case VertexDataInt16:				return GL_SHORT;
+		case VertexDataUInt16Normalized:	return GL_UNSIGNED_SHORT;
+		case VertexDataUInt8Normalized:		return GL_UNSIGNED_BYTE;
+
+		case VertexDataHalfFloat: {
+			#if defined(GL_HALF_FLOAT)
+				return GL_HALF_FLOAT;
+			#else
+				// GL_HALF_FLOAT_OES from the OES_vertex_half_float extension
+				return 0x8D61;
+			#endif
+		}
+	}
+
+	return GL_FLOAT;
+}
+
+
+bool wiesel::video::gl::isVertexArrayObjectSupported() {
+	#if WIESEL_PLATFORM_ANDROID
+		// OpenGL ES 2.0 provides them only via extension
+		return false;
+	#elif defined(GLEE_VERSION_3_0)
+		return GLEE_VERSION_3_0 || GLEE_ARB_vertex_array_object;
+	#else
+		return false;
+	#endif
+}
+
+
+GLuint wiesel::video::gl::createVertexArray() {
+	GLuint handle = 0;
+
+	#if !WIESEL_PLATFORM_ANDROID
+		if (isVertexArrayObjectSupported()) {
+			glGenVertexArrays(1, &handle);
+		}
+	#endif
+
+	return handle;
+}
+
+
+void wiesel::video::gl::bindVertexArray(GLuint handle) {
+	#if !WIESEL_PLATFORM_ANDROID
+		if (isVertexArrayObjectSupported()) {
+			glBindVertexArray(handle);
+		}
+	#endif
+
+	return;
+}
+
+
+void wiesel::video::gl::deleteVertexArray(GLuint handle) {
+	#if !WIESEL_PLATFORM_ANDROID
+		if (handle) {
+			glDeleteVertexArrays(1, &handle);
+		}
+	#endif
+
+	return;
+}
+
+
+bool wiesel::video::gl::isInstancingSupported() {
+	#if WIESEL_PLATFORM_ANDROID
+		// OpenGL ES 2.0 provides no instanced drawing
+		return false;
+	#elif defined(GLEE_ARB_instanced_arrays)
+		return GLEE_ARB_draw_instanced && GLEE_ARB_instanced_arrays;
+	#else
+		return false;
+	#endif
+}
+
+
+void wiesel::video::gl::vertexAttribDivisor(GLuint index, GLuint divisor) {
+	#if !WIESEL_PLATFORM_ANDROID
+		if (isInstancingSupported()) {
+			glVertexAttribDivisor(index, divisor);
+		}
+	#endif
+
+	return;
+}
+
+
+void wiesel::video::gl::drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances) {
+	#if !WIESEL_PLATFORM_ANDROID
+		if (isInstancingSupported()) {
+			glDrawArraysInstancedARB(mode, first, count, instances);
+		}
+	#endif
+
+	return;
+}
+
+
+bool wiesel::video::gl::isUniformBufferSupported() {
+	#if WIESEL_PLATFORM_ANDROID
+		// OpenGL ES 2.0 provides no uniform buffers
+		return false;
+	#else
+		static int supported = -1;
+
+		if (supported == -1) {
+			const char *extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+			supported = 0;
+
+			if (extensions && strstr(extensions, "GL_ARB_uniform_buffer_object")) {
+				pfnGetUniformBlockIndex = reinterpret_cast<PFNWIESELGETUNIFORMBLOCKINDEXPROC>(getGlProcAddress("glGetUniformBlockIndex"));
+				pfnUniformBlockBinding  = reinterpret_cast<PFNWIESELUNIFORMBLOCKBINDINGPROC>(getGlProcAddress("glUniformBlockBinding"));
+				pfnBindBufferBase       = reinterpret_cast<PFNWIESELBINDBUFFERBASEPROC>(getGlProcAddress("glBindBufferBase"));
+
+				if (pfnGetUniformBlockIndex && pfnUniformBlockBinding && pfnBindBufferBase) {
+					supported = 1;
+				}
+			}
+		}
+
+		return supported == 1;
+	#endif
+}
+
+
+GLuint wiesel::video::gl::getMaxUniformBufferBindings() {
+	GLint bindings = 0;
+
+	if (isUniformBufferSupported()) {
+		glGetIntegerv(GL_MAX_UNIFORM_BUFFER_BINDINGS, &bindings);
+	}
+
+	return static_cast<GLuint>(bindings);
+}
+
+
+GLuint wiesel::video::gl::getUniformBlockIndex(GLuint program, const char *name) {
+	#if !WIESEL_PLATFORM_ANDROID
+		if (isUniformBufferSupported()) {
+			return pfnGetUniformBlockIndex(program, name);
+		}
+	#endif
+
+	return GL_INVALID_INDEX;
+}
+
+
+void wiesel::video::gl::uniformBlockBinding(GLuint program, GLuint block_index, GLuint binding) {
+	#if !WIESEL_PLATFORM_ANDROID
+		if (isUniformBufferSupported()) {
+			pfnUniformBlockBinding(program, block_index, binding);
+		}
+	#endif
+
+	return;
+}
+
+
+void wiesel::video::gl::bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+	#if !WIESEL_PLATFORM_ANDROID
+		if (isUniformBufferSupported()) {
+			pfnBindBufferBase(target, index, buffer);
+		}
+	#endif
+
+	return;
+}
+
+
+GLboolean wiesel::video::gl::isGlVertexDataNormalized(VertexDataType type) {
+	switch(type) {
+		case VertexDataUInt16Normalized:
+		case VertexDataUInt8Normalized: {
+			return GL_TRUE;
+		}
+
+		default: {
+			return GL_FALSE;
+		}
+	}
+}
@@ -27,9 +27,24 @@
 // include platform specific OpenGL headers
 #include "gl_import.h"
 
+#include <wiesel/video/types.h>
+
 #define WIESEL_GL_LOG_TAG	"GL"
 #define CHECK_GL_ERROR		wiesel::video::gl::checkGlError(__FILE__,__LINE__)
 
+// uniform buffer constants, which are missing in the headers of older OpenGL versions
+#ifndef GL_UNIFORM_BUFFER
+#define GL_UNIFORM_BUFFER				0x8A11
+#endif
+
+#ifndef GL_MAX_UNIFORM_BUFFER_BINDINGS
+#define GL_MAX_UNIFORM_BUFFER_BINDINGS	0x8A2F
+#endif
+
+#ifndef GL_INVALID_INDEX
+#define GL_INVALID_INDEX				0xFFFFFFFFu
+#endif
+
 
 namespace wiesel {
 namespace video {
@@ -42,6 +57,85 @@ namespace gl {
 	 */
 	WIESEL_OPENGL_EXPORT void checkGlError(const char *file, int line);
 
+	/**
+	 * @brief get the OpenGL buffer usage flag matching a buffer's usage hint.
+	 */
+	WIESEL_OPENGL_EXPORT GLenum getGlBufferUsage(BufferUsage usage);
+
+	/**
+	 * @brief get the OpenGL data type matching the data type of a vertex component.
+	 */
+	WIESEL_OPENGL_EXPORT GLenum getGlVertexDataType(VertexDataType type);
+
+	/**
+	 * @brief checks, if a vertex component's data type needs to be normalized by OpenGL.
+	 */
+	WIESEL_OPENGL_EXPORT GLboolean isGlVertexDataNormalized(VertexDataType type);
+
+	/**
+	 * @brief checks, if vertex array objects are supported by the current OpenGL implementation.
+	 */
+	WIESEL_OPENGL_EXPORT bool isVertexArrayObjectSupported();
+
+	/**
+	 * @brief creates a new vertex array object.
+	 * @return the handle of the new object or \c 0, when not supported.
+	 */
+	WIESEL_OPENGL_EXPORT GLuint createVertexArray();
+
+	/**
+	 * @brief binds a vertex array object, or \c 0 to use no vertex array object.
+	 */
+	WIESEL_OPENGL_EXPORT void bindVertexArray(GLuint handle);
+
+	/**
+	 * @brief deletes a vertex array object.
+	 */
+	WIESEL_OPENGL_EXPORT void deleteVertexArray(GLuint handle);
+
+	/**
+	 * @brief checks, if instanced drawing with per-instance attributes is supported
+	 * by the current OpenGL implementation.
+	 */
+	WIESEL_OPENGL_EXPORT bool isInstancingSupported();
+
+	/**
+	 * @brief sets the number of instances after which a vertex attribute advances,
+	 * or \c 0 to advance once per vertex.
+	 */
+	WIESEL_OPENGL_EXPORT void vertexAttribDivisor(GLuint index, GLuint divisor);
+
+	/**
+	 * @brief draws multiple instances of a range of vertices.
+	 */
+	WIESEL_OPENGL_EXPORT void drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances);
+
+	/**
+	 * @brief checks, if uniform buffer objects are supported by the current OpenGL implementation.
+	 */
+	WIESEL_OPENGL_EXPORT bool isUniformBufferSupported();
+
+	/**
+	 * @brief get the number of available uniform buffer binding points.
+	 */
+	WIESEL_OPENGL_EXPORT GLuint getMaxUniformBufferBindings();
+
+	/**
+	 * @brief get the index of a named uniform block within a shader program.
+	 * @return the block's index or \c GL_INVALID_INDEX, when the program has no such block.
+	 */
+	WIESEL_OPENGL_EXPORT GLuint getUniformBlockIndex(GLuint program, const char *name);
+
+	/**
+	 * @brief assigns a uniform block of a shader program to a uniform buffer binding point.
+	 */
+	WIESEL_OPENGL_EXPORT void uniformBlockBinding(GLuint program, GLuint block_index, GLuint binding);
+
+	/**
+	 * @brief binds a buffer to an indexed binding point of the given target.
+	 */
+	WIESEL_OPENGL_EXPORT void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
 }
 }
 }
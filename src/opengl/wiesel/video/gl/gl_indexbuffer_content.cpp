@@ -20,6 +20,9 @@
  * Boston, MA 02110-1301 USA
  */
 #include "gl_indexbuffer_content.h"
+#include "gl_state_cache.h"
+
+#include <algorithm>
 
 using namespace wiesel;
 using namespace wiesel::video;
@@ -28,6 +31,8 @@ using namespace wiesel::video::gl;
 
 GlIndexBufferContent::GlIndexBufferContent(IndexBuffer *ib) : IndexBufferContent(ib) {
 	this->handle		= 0;
+	this->buffer_size	= 0;
+	this->buffer_usage	= 0;
 	return;
 }
 
@@ -47,7 +52,7 @@ GlIndexBufferContent *GlIndexBufferContent::createContentFor(IndexBuffer* ib) {
 void GlIndexBufferContent::initializeIndexBuffer() {
 	if (handle == 0) {
 		int							bytes_per_entry	= getIndexBuffer()->getBytesPerElement();
-		IndexBuffer::index_t		num_entries		= getIndexBuffer()->getSize();
+		IndexBuffer::index_t		capacity		= getIndexBuffer()->getCapacity();
 		const IndexBuffer::data_t	data			= getIndexBuffer()->getDataPtr();
 
 		// create the buffer first
@@ -55,9 +60,63 @@ void GlIndexBufferContent::initializeIndexBuffer() {
 		CHECK_GL_ERROR;
 
 		// bind the buffer and put the data into it
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, handle);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, bytes_per_entry * num_entries, data, GL_STATIC_DRAW);
+		buffer_size  = bytes_per_entry * capacity;
+		buffer_usage = getGlBufferUsage(getIndexBuffer()->getUsage());
+		GlStateCache::instance()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, handle);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, buffer_size, data, buffer_usage);
+		GlStateCache::instance()->countBufferUpload(buffer_size);
+		CHECK_GL_ERROR;
+
+		getIndexBuffer()->clearDirtyRange();
+	}
+
+	return;
+}
+
+
+void GlIndexBufferContent::updateIndexBuffer() {
+	IndexBuffer *index_buffer = getIndexBuffer();
+
+	if (handle == 0) {
+		initializeIndexBuffer();
+		return;
+	}
+
+	if (index_buffer->isDirty()) {
+		GLsizeiptr					size	= index_buffer->getBytesPerElement() * index_buffer->getCapacity();
+		GLsizeiptr					used	= index_buffer->getBytesPerElement() * index_buffer->getSize();
+		const IndexBuffer::data_t	data	= index_buffer->getDataPtr();
+		GLenum						usage	= getGlBufferUsage(index_buffer->getUsage());
+
+		GlStateCache::instance()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, handle);
+
+		if (size != buffer_size || usage != buffer_usage) {
+			// the buffer was resized or got another usage hint, so the hardware buffer needs to be re-created
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, usage);
+			GlStateCache::instance()->countBufferUpload(size);
+			buffer_size  = size;
+			buffer_usage = usage;
+		}
+		else if (index_buffer->getUsage() == BufferUsageStream) {
+			// orphan the old storage, so we don't need to wait for pending draw calls using it
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, NULL, usage);
+			glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, used, data);
+			GlStateCache::instance()->countBufferUpload(used);
+		}
+		else {
+			// upload only the modified range
+			GLintptr   begin = index_buffer->getDirtyRangeBegin();
+			GLsizeiptr end   = std::min<GLsizeiptr>(index_buffer->getDirtyRangeEnd(), size);
+
+			if (end > begin) {
+				glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, begin, end - begin, data + begin);
+				GlStateCache::instance()->countBufferUpload(end - begin);
+			}
+		}
+
 		CHECK_GL_ERROR;
+
+		index_buffer->clearDirtyRange();
 	}
 
 	return;
@@ -66,8 +125,10 @@ void GlIndexBufferContent::initializeIndexBuffer() {
 
 void GlIndexBufferContent::releaseIndexBuffer() {
 	if (handle) {
-		glDeleteBuffers(1, &handle);
-		handle = 0;
+		GlStateCache::instance()->deleteBuffer(handle);
+		handle       = 0;
+		buffer_size  = 0;
+		buffer_usage = 0;
 	}
 
 	return;
@@ -53,6 +53,12 @@ namespace gl {
 		 */
 		void initializeIndexBuffer();
 
+		/**
+		 * @brief Uploads all modified data of the index buffer to the graphics hardware.
+		 * Creates the hardware buffer, if not already done.
+		 */
+		void updateIndexBuffer();
+
 		/**
 		 * @brief Releases the index buffer object on the graphics hardware.
 		 */
@@ -67,6 +73,8 @@ namespace gl {
 
 	private:
 		GLuint		handle;
+		GLsizeiptr	buffer_size;
+		GLenum		buffer_usage;
 	};
 
 } /* namespace gl */
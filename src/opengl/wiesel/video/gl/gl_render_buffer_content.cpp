@@ -20,6 +20,7 @@
  * Boston, MA 02110-1301 USA
  */
 #include "gl_render_buffer_content.h"
+#include "gl_state_cache.h"
 #include "gl_texture_content.h"
 #include "wiesel/util/log.h"
 #include "wiesel/video/render_context.h"
@@ -73,7 +74,7 @@ bool GlRenderBufferContent::initializeBuffers() {
 	*/
 
 	glGenFramebuffers(1, &gl_frame_buffer);
-	glBindFramebuffer(GL_FRAMEBUFFER, gl_frame_buffer);
+	GlStateCache::instance()->bindFramebuffer(gl_frame_buffer);
 	CHECK_GL_ERROR;
 
 	const RenderBuffer::TextureList *textures = getRenderBuffer()->getTargetTextures();
@@ -118,8 +119,8 @@ bool GlRenderBufferContent::initializeBuffers() {
 		assert(false);
 	}
 
-	glBindRenderbuffer(GL_RENDERBUFFER, 0);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GlStateCache::instance()->bindRenderbuffer(0);
+	GlStateCache::instance()->bindFramebuffer(0);
 
 	return success;
 }
@@ -127,12 +128,12 @@ bool GlRenderBufferContent::initializeBuffers() {
 
 void GlRenderBufferContent::releaseBuffers() {
 	if (gl_render_buffer) {
-		glDeleteRenderbuffers(1, &gl_render_buffer);
+		GlStateCache::instance()->deleteRenderbuffer(gl_render_buffer);
 		gl_render_buffer = 0;
 	}
 
 	if (gl_frame_buffer) {
-		glDeleteFramebuffers(1, &gl_frame_buffer);
+		GlStateCache::instance()->deleteFramebuffer(gl_frame_buffer);
 		gl_frame_buffer = 0;
 	}
 
@@ -141,12 +142,12 @@ void GlRenderBufferContent::releaseBuffers() {
 
 
 bool GlRenderBufferContent::enableRenderBuffer(RenderContext* render_context) {
-	glBindRenderbuffer(GL_RENDERBUFFER, gl_render_buffer);
-	glBindFramebuffer(GL_FRAMEBUFFER,   gl_frame_buffer);
+	GlStateCache::instance()->bindRenderbuffer(gl_render_buffer);
+	GlStateCache::instance()->bindFramebuffer(gl_frame_buffer);
 
 //	glDrawBuffers(gl_draw_buffers.size(), gl_draw_buffers.data());
 
-	glViewport(
+	GlStateCache::instance()->setViewport(
 			getRenderBuffer()->getViewport().position.x,
 			getRenderBuffer()->getViewport().position.y,
 			getRenderBuffer()->getViewport().size.width,
@@ -162,8 +163,8 @@ bool GlRenderBufferContent::enableRenderBuffer(RenderContext* render_context) {
 
 
 void GlRenderBufferContent::disableRenderBuffer(RenderContext *render_context) {
-	glBindRenderbuffer(GL_RENDERBUFFER, 0);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GlStateCache::instance()->bindRenderbuffer(0);
+	GlStateCache::instance()->bindFramebuffer(0);
 
 	dimension screen_size = render_context
 			->getScreen()
@@ -171,7 +172,7 @@ void GlRenderBufferContent::disableRenderBuffer(RenderContext *render_context) {
 			->getResolution()
 	;
 
-	glViewport(
+	GlStateCache::instance()->setViewport(
 			0,
 			0,
 			screen_size.width,
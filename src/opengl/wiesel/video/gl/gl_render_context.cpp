@@ -22,6 +22,7 @@
 #include "gl_render_context.h"
 #include "gl_vertexbuffer_content.h"
 #include "gl_indexbuffer_content.h"
+#include "gl_state_cache.h"
 #include "gl_video_driver.h"
 #include "wiesel/video/shaders.h"
 #include "wiesel/video/video_driver.h"
@@ -40,6 +41,11 @@ using namespace wiesel::video::gl;
 OpenGlRenderContext::OpenGlRenderContext(Screen *screen) : RenderContext(screen) {
 	this->active_shader				= NULL;
 	this->active_shader_content		= NULL;
+	this->active_vertex_array		= 0;
+
+	this->modelview_buffer_template	= NULL;
+	this->modelview_buffer			= NULL;
+	this->modelview_buffer_content	= NULL;
 
 	return;
 }
@@ -54,27 +60,37 @@ OpenGlRenderContext::~OpenGlRenderContext() {
 
 
 void OpenGlRenderContext::initContext() {
+	GlStateCache *state = GlStateCache::instance();
+
+	// the state of a new context is unknown
+	state->invalidate();
+	active_vertex_array = 0;
+
 	// Initialize GL state.
-	glDisable(GL_CULL_FACE);
-	glDisable(GL_DEPTH_TEST);
+	state->setEnabled(GL_CULL_FACE, false);
+	state->setEnabled(GL_DEPTH_TEST, false);
 
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	state->setEnabled(GL_BLEND, true);
+	state->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	return;
 }
 
 
 void OpenGlRenderContext::releaseContext() {
+	flushBatch();
 	setShader(NULL);
 	clearTextures();
+	resetVertexArray();
 	return;
 }
 
 
 void OpenGlRenderContext::onSizeChanged(const dimension& size) {
+	flushBatch();
+
 	// setup viewport
-	glViewport(0, 0, size.width, size.height);
+	GlStateCache::instance()->setViewport(0, 0, size.width, size.height);
 	return;
 }
 
@@ -90,9 +106,15 @@ void OpenGlRenderContext::preRender() {
 
 
 void OpenGlRenderContext::postRender() {
-	// reset all gl objects
-	setShader(NULL);
-	clearTextures();
+	// draw all pending primitives
+	flushBatch();
+
+	// the active shader and textures stay bound, so the next frame
+	// doesn't need to bind them again, when starting with the same objects.
+
+	// collect the state changes counted by the state cache
+	GlStateCache::instance()->takeStatistics(&frame_statistics);
+	finishFrameStatistics();
 
 	return;
 }
@@ -100,36 +122,49 @@ void OpenGlRenderContext::postRender() {
 
 
 void OpenGlRenderContext::setProjectionMatrix(const matrix4x4& matrix) {
-	this->projection = matrix;
+	if (this->projection != matrix) {
+		flushBatch();
+
+		this->projection = matrix;
+
+		// the active shader stays bound, so it needs the new matrix now
+		applyProjectionMatrix();
+	}
+
+	return;
 }
 
 
-void OpenGlRenderContext::setModelviewMatrix(const matrix4x4& matrix) {
+void OpenGlRenderContext::applyProjectionMatrix() {
 	if (active_shader && active_shader_content) {
+		// get the shader's projection matrix buffer template
+		ShaderConstantBufferTemplate *projection_buffer_template;
+		projection_buffer_template = active_shader->getProjectionMatrixConstantBufferTemplate();
 
-		// get the active shader's matrix buffer template
-		ShaderConstantBufferTemplate *modelview_buffer_template = NULL;
-		modelview_buffer_template = active_shader->getModelviewMatrixConstantBufferTemplate();
-
-		if (modelview_buffer_template) {
+		if (projection_buffer_template) {
 			// get the template's shared buffer
-			ShaderConstantBuffer *modelview_buffer = modelview_buffer_template->getSharedBuffer();
+			ShaderConstantBuffer *projection_buffer = projection_buffer_template->getSharedBuffer();
+
+			// get the data pointer
+			ShaderConstantBuffer::data_t projection_data_ptr = projection_buffer->getShaderDataPointerAt(0);
 
-			// update the modelview value
-			bool was_set = modelview_buffer->setShaderValueAt(0, matrix);
-			assert(was_set);
+			// check if the projection matrix has changed
+			if (this->projection != *(reinterpret_cast<const matrix4x4*>(projection_data_ptr))) {
+				projection_buffer->setShaderValueAt(0, this->projection);
+			}
 
 			// get the buffer's content
-			ShaderConstantBufferContent *modelview_buffer_content = modelview_buffer->getContent();
-			if (modelview_buffer_content == NULL) {
-				modelview_buffer->loadContentFrom(getScreen());
-				modelview_buffer_content = modelview_buffer->getContent();
-				assert(modelview_buffer_content);
+			ShaderConstantBufferContent *projection_buffer_content = projection_buffer->getContent();
+			if (projection_buffer_content == NULL) {
+				projection_buffer->loadContentFrom(getScreen());
+				projection_buffer_content = projection_buffer->getContent();
+				assert(projection_buffer_content);
 			}
 
+			// update projection matrix for the current shader
 			active_shader_content->assignShaderConstantBuffer(
-										modelview_buffer_template,
-										modelview_buffer_content
+										projection_buffer_template,
+										projection_buffer_content
 			);
 		}
 	}
@@ -138,8 +173,68 @@ void OpenGlRenderContext::setModelviewMatrix(const matrix4x4& matrix) {
 }
 
 
+void OpenGlRenderContext::setModelviewMatrix(const matrix4x4& matrix) {
+	// pending primitives need to be drawn with the old matrix,
+	// unless the active shader already uses the same matrix
+	if (
+			modelview_buffer == NULL
+		||	*(reinterpret_cast<const matrix4x4*>(modelview_buffer->getDataPtr())) != matrix
+		||	active_shader_content->isShaderConstantBufferUpToDate(modelview_buffer_template, modelview_buffer_content) == false
+	) {
+		flushBatch();
+	}
+
+	// flushing may have changed the shader, so the buffer needs to be checked again
+	if (modelview_buffer) {
+		// writing the same matrix again won't change the buffer's version
+		bool was_set = modelview_buffer->setShaderValueAt(0, matrix);
+		assert(was_set);
+
+		active_shader_content->assignShaderConstantBuffer(
+									modelview_buffer_template,
+									modelview_buffer_content
+		);
+	}
+
+	return;
+}
+
+
+void OpenGlRenderContext::resolveModelviewBuffer() {
+	modelview_buffer_template	= NULL;
+	modelview_buffer			= NULL;
+	modelview_buffer_content	= NULL;
+
+	if (active_shader && active_shader_content) {
+		// get the active shader's matrix buffer template
+		ShaderConstantBufferTemplate *buffer_template = active_shader->getModelviewMatrixConstantBufferTemplate();
+
+		if (buffer_template) {
+			// get the template's shared buffer
+			ShaderConstantBuffer *buffer = buffer_template->getSharedBuffer();
+
+			// get the buffer's content
+			if (buffer->getContent() == NULL) {
+				buffer->loadContentFrom(getScreen());
+			}
+
+			if (buffer->getContent()) {
+				modelview_buffer_template	= buffer_template;
+				modelview_buffer			= buffer;
+				modelview_buffer_content	= buffer->getContent();
+			}
+		}
+	}
+
+	return;
+}
+
+
 void OpenGlRenderContext::setShader(Shader* shader) {
 	if (this->active_shader != shader) {
+		// draw pending primitives using the old shader
+		flushBatch();
+
 		// clear the old shader
 		clear_ref(this->active_shader);
 
@@ -161,43 +256,19 @@ void OpenGlRenderContext::setShader(Shader* shader) {
 			}
 		}
 
+		// the modelview matrix is updated before each draw call,
+		// so the active shader's buffer will be looked up only once
+		resolveModelviewBuffer();
+
 		// tell OpenGL about the new shader, if any
 		if (active_shader_content) {
-			glUseProgram(active_shader_content->getGlHandle());
-
-			// get the shader's projection matrix buffer template
-			ShaderConstantBufferTemplate *projection_buffer_template;
-			projection_buffer_template = active_shader->getProjectionMatrixConstantBufferTemplate();
-
-			if (projection_buffer_template) {
-				// get the template's shared buffer
-				ShaderConstantBuffer *projection_buffer = projection_buffer_template->getSharedBuffer();
-
-				// get the data pointer
-				ShaderConstantBuffer::data_t projection_data_ptr = projection_buffer->getShaderDataPointerAt(0);
-
-				// check if the projection matrix has changed
-				if (this->projection != *(reinterpret_cast<const matrix4x4*>(projection_data_ptr))) {
-					projection_buffer->setShaderValueAt(0, this->projection);
-				}
-
-				// get the buffer's content
-				ShaderConstantBufferContent *projection_buffer_content = projection_buffer->getContent();
-				if (projection_buffer_content == NULL) {
-					projection_buffer->loadContentFrom(getScreen());
-					projection_buffer_content = projection_buffer->getContent();
-					assert(projection_buffer_content);
-				}
-
-				// update projection matrix for the current shader
-				active_shader_content->assignShaderConstantBuffer(
-											projection_buffer_template,
-											projection_buffer_content
-				);
-			}
+			GlStateCache::instance()->useProgram(active_shader_content->getGlHandle());
+
+			// update projection matrix for the current shader
+			applyProjectionMatrix();
 		}
 		else {
-			glUseProgram(0);
+			GlStateCache::instance()->useProgram(0);
 		}
 
 		CHECK_GL_ERROR;
@@ -219,6 +290,11 @@ bool OpenGlRenderContext::assignShaderConstantBuffer(const ShaderConstantBufferT
 			}
 		}
 
+		// pending primitives need to be drawn with the old buffer content
+		if (active_shader_content->isShaderConstantBufferUpToDate(buffer_template, buffer->getContent()) == false) {
+			flushBatch();
+		}
+
 		return active_shader_content->assignShaderConstantBuffer(buffer_template, buffer->getContent());
 	}
 
@@ -234,6 +310,9 @@ void OpenGlRenderContext::setTexture(uint16_t index, Texture* texture) {
 
 	Texture *active_texture = this->active_textures[index];
 	if (active_texture != texture) {
+		// draw pending primitives using the old texture
+		flushBatch();
+
 		GlTextureContent *active_texture_content = this->active_textures_content[index];
 
 		// clear the old texture
@@ -252,12 +331,10 @@ void OpenGlRenderContext::setTexture(uint16_t index, Texture* texture) {
 		if (active_texture_content) {
 			keep(active_texture_content);
 
-			glActiveTexture(GL_TEXTURE0 + index);
-			glBindTexture(GL_TEXTURE_2D, active_texture_content->getGlHandle());
+			GlStateCache::instance()->bindTexture(index, active_texture_content->getGlHandle());
 		}
 		else {
-			glActiveTexture(GL_TEXTURE0 + index);
-			glBindTexture(GL_TEXTURE_2D, 0);
+			GlStateCache::instance()->bindTexture(index, 0);
 		}
 
 		// write active textures into the texture list
@@ -291,6 +368,8 @@ void OpenGlRenderContext::clearTextures() {
 
 
 void OpenGlRenderContext::draw(Primitive primitive, const VertexBuffer *vertices) {
+	flushBatch();
+
 	if (bind(vertices)) {
 		GLenum mode;
 
@@ -312,8 +391,59 @@ void OpenGlRenderContext::draw(Primitive primitive, const VertexBuffer *vertices
 		}
 
 		glDrawArrays(mode, 0, vertices->getSize());
+		frame_statistics.countDrawCall(primitive, vertices->getSize());
+		CHECK_GL_ERROR;
+
+		unbind(vertices);
+		CHECK_GL_ERROR;
+	}
+
+	return;
+}
+
+
+bool OpenGlRenderContext::isInstancingSupported() const {
+	return gl::isInstancingSupported();
+}
+
+
+void OpenGlRenderContext::drawInstanced(Primitive primitive, const VertexBuffer *vertices, const VertexBuffer *instances) {
+	flushBatch();
+
+	if (instances == NULL || instances->getSize() == 0) {
+		return;
+	}
+
+	assert(isInstancingSupported());
+
+	if (isInstancingSupported() && bind(vertices)) {
+		GLenum mode;
+
+		switch(primitive) {
+			case Triangles: {
+				mode = GL_TRIANGLES;
+				break;
+			}
+
+			case TriangleStrip: {
+				mode = GL_TRIANGLE_STRIP;
+				break;
+			}
+
+			case TriangleFan: {
+				mode = GL_TRIANGLE_FAN;
+				break;
+			}
+		}
+
+		setupInstanceAttributes(instances, true);
+
+		gl::drawArraysInstanced(mode, 0, vertices->getSize(), instances->getSize());
+		frame_statistics.countDrawCall(primitive, vertices->getSize(), instances->getSize());
 		CHECK_GL_ERROR;
 
+		setupInstanceAttributes(instances, false);
+
 		unbind(vertices);
 		CHECK_GL_ERROR;
 	}
@@ -323,6 +453,8 @@ void OpenGlRenderContext::draw(Primitive primitive, const VertexBuffer *vertices
 
 
 void OpenGlRenderContext::draw(Primitive primitive, const VertexBuffer *vertices, const IndexBuffer *indices) {
+	flushBatch();
+
 	if (bind(vertices)) {
 		GLenum mode;
 		GLenum size;
@@ -369,6 +501,7 @@ void OpenGlRenderContext::draw(Primitive primitive, const VertexBuffer *vertices
 			glDrawElements(mode, indices->getSize(), size, indices->getDataPtr());
 		}
 
+		frame_statistics.countDrawCall(primitive, indices->getSize());
 		CHECK_GL_ERROR;
 
 		unbind(vertices);
@@ -381,11 +514,14 @@ void OpenGlRenderContext::draw(Primitive primitive, const VertexBuffer *vertices
 
 bool OpenGlRenderContext::bind(const IndexBuffer* index_buffer) {
 	if (index_buffer && index_buffer->getContent()) {
-		const GlIndexBufferContent *gl_index_buffer;
-		gl_index_buffer = dynamic_cast<const GlIndexBufferContent*>(index_buffer->getContent());
+		GlIndexBufferContent *gl_index_buffer;
+		gl_index_buffer = dynamic_cast<GlIndexBufferContent*>(const_cast<IndexBuffer*>(index_buffer)->getContent());
 
 		if (gl_index_buffer) {
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl_index_buffer->getGlHandle());
+			// upload any modified data
+			gl_index_buffer->updateIndexBuffer();
+
+			GlStateCache::instance()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl_index_buffer->getGlHandle());
 
 			return true;
 		}
@@ -398,7 +534,7 @@ bool OpenGlRenderContext::bind(const IndexBuffer* index_buffer) {
 void OpenGlRenderContext::unbind(const IndexBuffer *index_buffer) {
 	if (index_buffer && index_buffer->getContent()) {
 		// just reset the buffer binding
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		GlStateCache::instance()->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	}
 
 	return;
@@ -407,122 +543,244 @@ void OpenGlRenderContext::unbind(const IndexBuffer *index_buffer) {
 
 bool OpenGlRenderContext::bind(const VertexBuffer* vertex_buffer) {
 	if (vertex_buffer && active_shader_content) {
-		unsigned short				vertex_size		= vertex_buffer->getVertexSize();
-		const VertexBuffer::data_t	data			= vertex_buffer->getDataPtr();
-
 		// get the gl vertex buffer
-		const GlVertexBufferContent *gl_vertex_buffer;
-		gl_vertex_buffer = dynamic_cast<const GlVertexBufferContent*>(vertex_buffer->getContent());
+		GlVertexBufferContent *gl_vertex_buffer;
+		gl_vertex_buffer = dynamic_cast<GlVertexBufferContent*>(const_cast<VertexBuffer*>(vertex_buffer)->getContent());
+
+		// upload any modified data
+		if (gl_vertex_buffer) {
+			gl_vertex_buffer->updateVertexBuffer();
+		}
+
+		// buffers on the graphics hardware can use a cached vertex array object
+		if (gl_vertex_buffer && gl_vertex_buffer->getGlHandle()) {
+			GLuint vertex_array = gl_vertex_buffer->getVertexArray(active_shader_content);
+
+			if (vertex_array) {
+				GlStateCache::instance()->bindVertexArray(vertex_array);
+				active_vertex_array = vertex_array;
+
+				return true;
+			}
+
+			// record the attribute setup into a new vertex array object
+			vertex_array = gl_vertex_buffer->createVertexArray(active_shader_content);
+
+			if (vertex_array) {
+				GlStateCache::instance()->bindVertexArray(vertex_array);
+				active_vertex_array = vertex_array;
+
+				GlStateCache::instance()->bindBuffer(GL_ARRAY_BUFFER, gl_vertex_buffer->getGlHandle());
+				setupVertexAttributes(vertex_buffer, NULL);
+
+				return true;
+			}
+		}
+
+		// leave any vertex array object, before using the default attribute state
+		resetVertexArray();
 
 		// data pointer when using no GL buffer, NULL with buffer
 		const unsigned char* buffer_offset = NULL;
 		if (gl_vertex_buffer && gl_vertex_buffer->getGlHandle()) {
-			glBindBuffer(GL_ARRAY_BUFFER, gl_vertex_buffer->getGlHandle());
+			GlStateCache::instance()->bindBuffer(GL_ARRAY_BUFFER, gl_vertex_buffer->getGlHandle());
 		}
 		else {
-			buffer_offset = data;
+			// client side arrays must not be read from any bound buffer
+			GlStateCache::instance()->bindBuffer(GL_ARRAY_BUFFER, 0);
+			buffer_offset = vertex_buffer->getDataPtr();
 		}
 
-		// assign vertex positions
-		if (vertex_buffer->hasPositions()) {
-			GLint  attr_vertex_position = active_shader_content->getAttribHandle(Shader::VertexPosition, 0);
-
-			if (attr_vertex_position != -1) {
-				glVertexAttribPointer(
-							attr_vertex_position,
-							vertex_buffer->getPositionDescription().fields,
-							GL_FLOAT,
-							GL_FALSE,
-							vertex_size,
-							buffer_offset + vertex_buffer->getPositionDescription().offset
-				);
-
-				glEnableVertexAttribArray(attr_vertex_position);
-				CHECK_GL_ERROR;
-			}
-		}
+		setupVertexAttributes(vertex_buffer, buffer_offset);
 
-		// assign vertex normals
-		if (vertex_buffer->hasNormals()) {
-			GLint  attr_vertex_normals = active_shader_content->getAttribHandle(Shader::VertexNormal, 0);
-
-			if (attr_vertex_normals != -1) {
-				glVertexAttribPointer(
-							attr_vertex_normals,
-							vertex_buffer->getNormalDescription().fields,
-							GL_FLOAT,
-							GL_FALSE,
-							vertex_size,
-							buffer_offset + vertex_buffer->getNormalDescription().offset
-				);
-
-				glEnableVertexAttribArray(attr_vertex_normals);
-				CHECK_GL_ERROR;
-			}
+		return true;
+	}
+
+	return false;
+}
+
+
+void OpenGlRenderContext::resetVertexArray() {
+	if (active_vertex_array) {
+		GlStateCache::instance()->bindVertexArray(0);
+		active_vertex_array = 0;
+	}
+
+	return;
+}
+
+
+void OpenGlRenderContext::setupVertexAttributes(const VertexBuffer *vertex_buffer, const unsigned char *buffer_offset) {
+	unsigned short vertex_size = vertex_buffer->getVertexSize();
+
+	// assign vertex positions
+	if (vertex_buffer->hasPositions()) {
+		GLint  attr_vertex_position = active_shader_content->getAttribHandle(Shader::VertexPosition, 0);
+
+		if (attr_vertex_position != -1) {
+			glVertexAttribPointer(
+						attr_vertex_position,
+						vertex_buffer->getPositionDescription().fields,
+						getGlVertexDataType(static_cast<VertexDataType>(vertex_buffer->getPositionDescription().type)),
+						isGlVertexDataNormalized(static_cast<VertexDataType>(vertex_buffer->getPositionDescription().type)),
+						vertex_size,
+						buffer_offset + vertex_buffer->getPositionDescription().offset
+			);
+
+			glEnableVertexAttribArray(attr_vertex_position);
+			CHECK_GL_ERROR;
 		}
+	}
 
-		// assign vertex colors
-		if (vertex_buffer->hasColors()) {
-			GLint  attr_vertex_colors = active_shader_content->getAttribHandle(Shader::VertexColor, 0);
-
-			if (attr_vertex_colors != -1) {
-				glVertexAttribPointer(
-							attr_vertex_colors,
-							vertex_buffer->getColorDescription().fields,
-							GL_FLOAT,
-							GL_FALSE,
-							vertex_size,
-							buffer_offset + vertex_buffer->getColorDescription().offset
-				);
-
-				glEnableVertexAttribArray(attr_vertex_colors);
-				CHECK_GL_ERROR;
-			}
+	// assign vertex normals
+	if (vertex_buffer->hasNormals()) {
+		GLint  attr_vertex_normals = active_shader_content->getAttribHandle(Shader::VertexNormal, 0);
+
+		if (attr_vertex_normals != -1) {
+			glVertexAttribPointer(
+						attr_vertex_normals,
+						vertex_buffer->getNormalDescription().fields,
+						getGlVertexDataType(static_cast<VertexDataType>(vertex_buffer->getNormalDescription().type)),
+						isGlVertexDataNormalized(static_cast<VertexDataType>(vertex_buffer->getNormalDescription().type)),
+						vertex_size,
+						buffer_offset + vertex_buffer->getNormalDescription().offset
+			);
+
+			glEnableVertexAttribArray(attr_vertex_normals);
+			CHECK_GL_ERROR;
 		}
+	}
 
-		// assign textures
-		int num_textures_in_vbo = vertex_buffer->getNumberOfTextureLayers();
-		int num_textures_active = active_textures.size();
-		int num_textures        = std::max(num_textures_in_vbo, num_textures_active);
+	// assign vertex colors
+	if (vertex_buffer->hasColors()) {
+		GLint  attr_vertex_colors = active_shader_content->getAttribHandle(Shader::VertexColor, 0);
 
-		for(int i=0; i<num_textures; i++) {
-			GLint  attr_vertex_texcoord = active_shader_content->getAttribHandle(Shader::VertexTextureCoordinate, i);
-			GLint  attr_vertex_texture  = active_shader_content->getAttribHandle(Shader::Texture, i);
-
-			if (attr_vertex_texcoord != -1 && i < num_textures_in_vbo) {
-				glVertexAttribPointer(
-						attr_vertex_texcoord,
-						vertex_buffer->getTextureDescription(i).fields,
-						GL_FLOAT,
-						GL_FALSE,
+		if (attr_vertex_colors != -1) {
+			glVertexAttribPointer(
+						attr_vertex_colors,
+						vertex_buffer->getColorDescription().fields,
+						getGlVertexDataType(static_cast<VertexDataType>(vertex_buffer->getColorDescription().type)),
+						isGlVertexDataNormalized(static_cast<VertexDataType>(vertex_buffer->getColorDescription().type)),
 						vertex_size,
-						buffer_offset + vertex_buffer->getTextureDescription(i).offset
-				);
+						buffer_offset + vertex_buffer->getColorDescription().offset
+			);
 
-				glEnableVertexAttribArray(attr_vertex_texcoord);
-				CHECK_GL_ERROR;
-			}
+			glEnableVertexAttribArray(attr_vertex_colors);
+			CHECK_GL_ERROR;
+		}
+	}
 
-			if (attr_vertex_texture != -1) {
-				GlTextureContent *texture_content = active_textures_content[i];
+	// assign texture coordinates; the texture samplers were assigned by the shader itself
+	int num_textures = vertex_buffer->getNumberOfTextureLayers();
 
-				if (texture_content) {
-				//	glActiveTexture(GL_TEXTURE0 + i);
-				//	glBindTexture(GL_TEXTURE_2D, texture_content->getGlHandle());
-					glUniform1i(attr_vertex_texture, i);
-					CHECK_GL_ERROR;
-				}
-			}
+	for(int i=0; i<num_textures; i++) {
+		GLint  attr_vertex_texcoord = active_shader_content->getAttribHandle(Shader::VertexTextureCoordinate, i);
+
+		if (attr_vertex_texcoord != -1) {
+			glVertexAttribPointer(
+					attr_vertex_texcoord,
+					vertex_buffer->getTextureDescription(i).fields,
+					getGlVertexDataType(static_cast<VertexDataType>(vertex_buffer->getTextureDescription(i).type)),
+					isGlVertexDataNormalized(static_cast<VertexDataType>(vertex_buffer->getTextureDescription(i).type)),
+					vertex_size,
+					buffer_offset + vertex_buffer->getTextureDescription(i).offset
+			);
+
+			glEnableVertexAttribArray(attr_vertex_texcoord);
+			CHECK_GL_ERROR;
 		}
+	}
 
-		return true;
+	return;
+}
+
+
+void OpenGlRenderContext::setupInstanceAttributes(const VertexBuffer *instance_buffer, bool enable) {
+	// collect the attribute handles of all components within the instance buffer
+	std::vector<std::pair<GLint,const VertexBuffer::component*> > attributes;
+
+	if (instance_buffer->hasPositions()) {
+		attributes.push_back(std::make_pair(
+				active_shader_content->getAttribHandle(Shader::InstancePosition, 0),
+				&(instance_buffer->getPositionDescription())
+		));
 	}
 
-	return false;
+	if (instance_buffer->hasColors()) {
+		attributes.push_back(std::make_pair(
+				active_shader_content->getAttribHandle(Shader::InstanceColor, 0),
+				&(instance_buffer->getColorDescription())
+		));
+	}
+
+	for(int i=0; i<instance_buffer->getNumberOfTextureLayers(); i++) {
+		attributes.push_back(std::make_pair(
+				active_shader_content->getAttribHandle(Shader::InstanceData, i),
+				&(instance_buffer->getTextureDescription(i))
+		));
+	}
+
+	// data pointer when using no GL buffer, NULL with buffer
+	const unsigned char* buffer_offset = NULL;
+
+	if (enable) {
+		GlVertexBufferContent *gl_instance_buffer;
+		gl_instance_buffer = dynamic_cast<GlVertexBufferContent*>(const_cast<VertexBuffer*>(instance_buffer)->getContent());
+
+		if (gl_instance_buffer) {
+			gl_instance_buffer->updateVertexBuffer();
+		}
+
+		if (gl_instance_buffer && gl_instance_buffer->getGlHandle()) {
+			GlStateCache::instance()->bindBuffer(GL_ARRAY_BUFFER, gl_instance_buffer->getGlHandle());
+		}
+		else {
+			GlStateCache::instance()->bindBuffer(GL_ARRAY_BUFFER, 0);
+			buffer_offset = instance_buffer->getDataPtr();
+		}
+	}
+
+	for(std::vector<std::pair<GLint,const VertexBuffer::component*> >::iterator it=attributes.begin(); it!=attributes.end(); it++) {
+		GLint handle = it->first;
+
+		if (handle == -1) {
+			continue;
+		}
+
+		if (enable) {
+			const VertexBuffer::component *description = it->second;
+
+			glVertexAttribPointer(
+					handle,
+					description->fields,
+					getGlVertexDataType(static_cast<VertexDataType>(description->type)),
+					isGlVertexDataNormalized(static_cast<VertexDataType>(description->type)),
+					instance_buffer->getVertexSize(),
+					buffer_offset + description->offset
+			);
+
+			glEnableVertexAttribArray(handle);
+			gl::vertexAttribDivisor(handle, 1);
+		}
+		else {
+			// restore the default state, so a bound vertex array object remains unchanged
+			gl::vertexAttribDivisor(handle, 0);
+			glDisableVertexAttribArray(handle);
+		}
+
+		CHECK_GL_ERROR;
+	}
+
+	return;
 }
 
 
 void OpenGlRenderContext::unbind(const VertexBuffer* vertex_buffer) {
+	// a vertex array object keeps it's attribute state, so it just stays bound
+	if (active_vertex_array) {
+		return;
+	}
+
 	if (vertex_buffer && active_shader_content) {
 		if (vertex_buffer->hasPositions()) {
 			GLint attr_vertex_position = active_shader_content->getAttribHandle(Shader::VertexPosition, 0);
@@ -541,11 +799,11 @@ void OpenGlRenderContext::unbind(const VertexBuffer* vertex_buffer) {
 
 		int num_textures = vertex_buffer->getNumberOfTextureLayers();
 		for(int i=0; i<num_textures; i++) {
-			GLint attr_vertex_texcoord = active_shader_content->getAttribHandle(Shader::VertexTextureCoordinate, 0);
+			GLint attr_vertex_texcoord = active_shader_content->getAttribHandle(Shader::VertexTextureCoordinate, i);
 			glDisableVertexAttribArray(attr_vertex_texcoord);
 		}
 
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		GlStateCache::instance()->bindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
 	return;
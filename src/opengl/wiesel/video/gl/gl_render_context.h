@@ -32,6 +32,7 @@
 
 #include "gl_shader_content.h"
 #include "gl_shader_constantbuffer_content.h"
+#include "gl_state_cache.h"
 #include "gl_texture_content.h"
 
 
@@ -72,6 +73,18 @@ namespace gl {
 		virtual void draw(Primitive primitive, const VertexBuffer *vertices);
 		virtual void draw(Primitive primitive, const VertexBuffer *vertices, const IndexBuffer *indices);
 
+		virtual bool isInstancingSupported() const;
+		virtual void drawInstanced(Primitive primitive, const VertexBuffer *vertices, const VertexBuffer *instances);
+
+	public:
+		/**
+		 * @brief Get the cache of the OpenGL state used by this context.
+		 * The cache provides statistics about issued and skipped state changes.
+		 */
+		inline GlStateCache *getStateCache() const {
+			return GlStateCache::instance();
+		}
+
 	protected:
 		bool bind(const IndexBuffer *index_buffer);
 		bool bind(const VertexBuffer *vertex_buffer);
@@ -79,9 +92,31 @@ namespace gl {
 		void unbind(const IndexBuffer *index_buffer);
 		void unbind(const VertexBuffer *vertex_buffer);
 
+	private:
+		/// assigns the current projection matrix to the active shader.
+		void applyProjectionMatrix();
+
+		/// looks up the modelview matrix buffer of the active shader, which is updated before each draw call.
+		void resolveModelviewBuffer();
+
+		/// configures all vertex attributes of the active shader for the given vertex buffer.
+		void setupVertexAttributes(const VertexBuffer *vertex_buffer, const unsigned char *buffer_offset);
+
+		/// configures the per-instance attributes of the active shader for the given instance buffer.
+		void setupInstanceAttributes(const VertexBuffer *instance_buffer, bool enable);
+
+		/// leaves the currently bound vertex array object, if any.
+		void resetVertexArray();
+
 	private:
 		Shader*								active_shader;
 		GlShaderContent*					active_shader_content;
+		GLuint								active_vertex_array;
+
+		ShaderConstantBufferTemplate*		modelview_buffer_template;
+		ShaderConstantBuffer*				modelview_buffer;
+		ShaderConstantBufferContent*		modelview_buffer_content;
+
 		std::vector<Texture*>				active_textures;
 		std::vector<GlTextureContent*>		active_textures_content;
 	};
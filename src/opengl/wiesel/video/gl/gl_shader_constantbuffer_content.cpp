@@ -20,6 +20,13 @@
  * Boston, MA 02110-1301 USA
  */
 #include "gl_shader_constantbuffer_content.h"
+#include "gl_state_cache.h"
+
+#include <wiesel/util/log.h>
+
+#include <algorithm>
+#include <map>
+#include <string.h>
 
 using namespace wiesel;
 using namespace wiesel::video;
@@ -29,13 +36,188 @@ using namespace wiesel::video::gl;
 GlShaderConstantBufferContent::GlShaderConstantBufferContent(ShaderConstantBuffer *constant_buffer)
 		: ShaderConstantBufferContent(constant_buffer)
 {
+	this->handle			= 0;
+	this->uploaded_version	= 0;
+
 	return;
 }
 
 GlShaderConstantBufferContent::~GlShaderConstantBufferContent() {
+	releaseUniformBuffer();
 	return;
 }
 
 GlShaderConstantBufferContent* GlShaderConstantBufferContent::createContentFor(ShaderConstantBuffer *constant_buffer) {
 	return new GlShaderConstantBufferContent(constant_buffer);
 }
+
+
+GLuint GlShaderConstantBufferContent::getBindingPointFor(const ShaderConstantBufferTemplate *buffer_template) {
+	typedef std::map<const ShaderConstantBufferTemplate*, GLuint> BindingPointMap;
+	static BindingPointMap binding_points;
+
+	BindingPointMap::iterator it = binding_points.find(buffer_template);
+	if (it != binding_points.end()) {
+		return it->second;
+	}
+
+	GLuint binding = static_cast<GLuint>(binding_points.size());
+	if (binding >= getMaxUniformBufferBindings()) {
+		Log::warn << "No uniform buffer binding point left for constant buffer template." << std::endl;
+		return GL_INVALID_INDEX;
+	}
+
+	binding_points[buffer_template] = binding;
+
+	return binding;
+}
+
+
+size_t GlShaderConstantBufferContent::getStd140Layout(const ShaderConstantBufferTemplate *buffer_template, std::vector<size_t> *offsets) {
+	const ShaderConstantBufferTemplate::EntryList *entries = buffer_template->getEntries();
+	size_t offset = 0;
+
+	if (offsets) {
+		offsets->clear();
+	}
+
+	for(ShaderConstantBufferTemplate::EntryList::const_iterator it=entries->begin(); it!=entries->end(); it++) {
+		size_t alignment;
+		size_t size;
+
+		switch(it->type) {
+			case TypeVector2f: {
+				alignment	= 8;
+				size		= 8;
+				break;
+			}
+
+			case TypeVector3f: {
+				alignment	= 16;
+				size		= 12;
+				break;
+			}
+
+			case TypeVector4f: {
+				alignment	= 16;
+				size		= 16;
+				break;
+			}
+
+			case TypeMatrix4x4f: {
+				alignment	= 16;
+				size		= 64;
+				break;
+			}
+
+			default: {
+				alignment	= 4;
+				size		= 4;
+				break;
+			}
+		}
+
+		// elements of arrays are always aligned to vec4
+		if (it->elements > 1) {
+			alignment	= 16;
+			size		= (size + 15) & ~15;
+		}
+
+		offset = (offset + alignment - 1) & ~(alignment - 1);
+
+		if (offsets) {
+			offsets->push_back(offset);
+		}
+
+		offset += size * it->elements;
+	}
+
+	// the size of a uniform block is a multiple of vec4
+	return (offset + 15) & ~15;
+}
+
+
+void GlShaderConstantBufferContent::bindUniformBuffer(GLuint binding) {
+	updateUniformBuffer();
+
+	if (handle) {
+		GlStateCache::instance()->bindUniformBuffer(binding, handle);
+	}
+
+	return;
+}
+
+
+void GlShaderConstantBufferContent::updateUniformBuffer() {
+	ShaderConstantBuffer *buffer = getShaderConstantBuffer();
+	const ShaderConstantBufferTemplate *buffer_template = buffer->getTemplate();
+
+	if (handle == 0) {
+		std140_data.resize(getStd140Layout(buffer_template, &std140_offsets), 0);
+
+		glGenBuffers(1, &handle);
+		CHECK_GL_ERROR;
+
+		GlStateCache::instance()->bindBuffer(GL_UNIFORM_BUFFER, handle);
+		glBufferData(GL_UNIFORM_BUFFER, std140_data.size(), NULL, GL_DYNAMIC_DRAW);
+		CHECK_GL_ERROR;
+
+		uploaded_version = 0;
+	}
+
+	if (uploaded_version != buffer->getChangeVersion()) {
+		const ShaderConstantBufferTemplate::EntryList *entries = buffer_template->getEntries();
+		const ShaderConstantBuffer::data_t data = buffer->getDataPtr();
+		size_t dirty_begin = std140_data.size();
+		size_t dirty_end   = 0;
+		int index = 0;
+
+		// copy each entry written since the last upload into it's std140 location
+		for(ShaderConstantBufferTemplate::EntryList::const_iterator it=entries->begin(); it!=entries->end(); it++, index++) {
+			if (buffer->hasEntryChangedSince(index, uploaded_version) == false) {
+				continue;
+			}
+
+			size_t type_size = getTypeSize(it->type);
+			size_t stride    = it->elements > 1 ? ((type_size + 15) & ~15) : type_size;
+			size_t offset    = std140_offsets[index];
+
+			for(size_t element=0; element<it->elements; element++) {
+				memcpy(
+						&std140_data[offset + element * stride],
+						data + it->offset + element * type_size,
+						type_size
+				);
+			}
+
+			dirty_begin = std::min(dirty_begin, offset);
+			dirty_end   = std::max(dirty_end,   offset + stride * it->elements);
+		}
+
+		// upload only the modified range
+		if (dirty_end > dirty_begin) {
+			GlStateCache::instance()->bindBuffer(GL_UNIFORM_BUFFER, handle);
+			glBufferSubData(GL_UNIFORM_BUFFER, dirty_begin, dirty_end - dirty_begin, &std140_data[dirty_begin]);
+			GlStateCache::instance()->countBufferUpload(dirty_end - dirty_begin);
+			GlStateCache::instance()->countUniformUpload();
+			CHECK_GL_ERROR;
+		}
+
+		uploaded_version = buffer->getChangeVersion();
+	}
+
+	return;
+}
+
+
+void GlShaderConstantBufferContent::releaseUniformBuffer() {
+	if (handle) {
+		GlStateCache::instance()->deleteBuffer(handle);
+		handle = 0;
+	}
+
+	std140_offsets.clear();
+	std140_data.clear();
+
+	return;
+}
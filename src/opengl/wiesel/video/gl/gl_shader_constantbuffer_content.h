@@ -25,13 +25,24 @@
 #include <wiesel/wiesel-opengl.def>
 #include <wiesel/video/shader_constantbuffer.h>
 
+#include "gl.h"
+
+#include <vector>
+
 
 namespace wiesel {
 namespace video {
 namespace gl {
 
 	/**
-	 * @brief Handles the device specific part of a index buffer.
+	 * @brief Handles the device specific part of a shader constant buffer.
+	 * When uniform buffer objects are supported, the buffer's data will be uploaded
+	 * once per change into a buffer object, which is shared by all shaders declaring
+	 * a matching uniform block. Shaders without such a block read the data directly
+	 * from the \ref ShaderConstantBuffer and set each uniform separately.
+	 * Uniform blocks suit buffers changing rarely, like the projection matrix or lights.
+	 * Data changing with each draw call, like the modelview matrix, should be declared
+	 * as plain uniforms, because updating a buffer still in use may stall the pipeline.
 	 */
 	class WIESEL_OPENGL_EXPORT GlShaderConstantBufferContent : public ShaderConstantBufferContent
 	{
@@ -41,6 +52,50 @@ namespace gl {
 
 	public:
 		static GlShaderConstantBufferContent* createContentFor(ShaderConstantBuffer *shader_constant_buffer);
+
+	public:
+		/**
+		 * @brief Get the uniform buffer binding point, which is used for all buffers of the given template.
+		 * @return the binding point or \c GL_INVALID_INDEX, when no binding point is available.
+		 */
+		static GLuint getBindingPointFor(const ShaderConstantBufferTemplate *buffer_template);
+
+		/**
+		 * @brief Get the size of the given template's data within a \c std140 uniform block.
+		 * @param offsets	When not \c NULL, receives the offset of each entry within the block.
+		 */
+		static size_t getStd140Layout(const ShaderConstantBufferTemplate *buffer_template, std::vector<size_t> *offsets);
+
+		/**
+		 * @brief Uploads the buffer's data, if it has changed since the last upload,
+		 * and binds the uniform buffer to the given binding point.
+		 */
+		void bindUniformBuffer(GLuint binding);
+
+		/**
+		 * @brief Releases the uniform buffer object on the graphics hardware.
+		 */
+		void releaseUniformBuffer();
+
+		/**
+		 * @brief Get the OpenGL handle of the uniform buffer object, if already created.
+		 */
+		inline GLuint getGlHandle() const {
+			return handle;
+		}
+
+	private:
+		/**
+		 * @brief Uploads the buffer's data, if it has changed since the last upload.
+		 */
+		void updateUniformBuffer();
+
+	private:
+		GLuint								handle;
+		ShaderConstantBuffer::version_t		uploaded_version;
+
+		std::vector<size_t>					std140_offsets;
+		std::vector<unsigned char>			std140_data;
 	};
 
 } /* namespace gl */
@@ -20,6 +20,8 @@
  * Boston, MA 02110-1301 USA
  */
 #include "gl_shader_content.h"
+#include "gl_shader_constantbuffer_content.h"
+#include "gl_state_cache.h"
 #include "gl_vertexbuffer_content.h"
 
 #include <wiesel/util/log.h>
@@ -32,7 +34,13 @@ using namespace wiesel::video::gl;
 
 
 GlShaderContent::GlShaderContent(Shader *shader) : ShaderContent(shader) {
-	this->program_handle = 0;
+	static unsigned int next_program_id = 0;
+
+	this->program_handle		= 0;
+	this->program_id			= ++next_program_id;
+	this->modelview_template	= NULL;
+	this->modelview_entry		= NULL;
+
 	return;
 }
 
@@ -288,8 +296,9 @@ void GlShaderContent::initializeShader() {
 
 
 void GlShaderContent::releaseShader() {
-	if (program_handle == 0) {
-		glDeleteProgram(program_handle);
+	if (program_handle != 0) {
+		GlStateCache::instance()->deleteProgram(program_handle);
+		program_handle = 0;
 	}
 
 	return;
@@ -302,9 +311,15 @@ void GlShaderContent::bindAttributes() {
 
 	// prepare the lists
 	uniform_attributes.clear();
+	uniform_block_bindings.clear();
+	buffer_entries.clear();
 	attribute_handles.clear();
 	attribute_handles.resize(attributes->size());
 
+	// the modelview matrix entry will be stored on it's first use
+	modelview_template	= getShader()->getModelviewMatrixConstantBufferTemplate();
+	modelview_entry		= NULL;
+
 	// get all attribute handles
 	for(int attr=attributes->size(); --attr>=0;) {
 		const Shader::AttributeNamesByIndex *attr_names = &(attributes->at(attr));
@@ -326,7 +341,10 @@ void GlShaderContent::bindAttributes() {
 				case Shader::VertexPosition:
 				case Shader::VertexNormal:
 				case Shader::VertexColor:
-				case Shader::VertexTextureCoordinate: {
+				case Shader::VertexTextureCoordinate:
+				case Shader::InstancePosition:
+				case Shader::InstanceColor:
+				case Shader::InstanceData: {
 					handle = glGetAttribLocation(program_handle, name.c_str());
 					break;
 				}
@@ -342,6 +360,25 @@ void GlShaderContent::bindAttributes() {
 		}
 	}
 
+	// each texture sampler always reads from the texture unit matching it's index,
+	// so the sampler uniforms only need to be assigned once
+	if (Shader::Texture < attribute_handles.size() && attribute_handles[Shader::Texture].empty() == false) {
+		GLint current_program = 0;
+		glGetIntegerv(GL_CURRENT_PROGRAM, &current_program);
+		GlStateCache::instance()->useProgram(program_handle);
+
+		for(unsigned int index=0; index<attribute_handles[Shader::Texture].size(); index++) {
+			GLint handle = attribute_handles[Shader::Texture][index];
+
+			if (handle != -1) {
+				glUniform1i(handle, index);
+			}
+		}
+
+		GlStateCache::instance()->useProgram(current_program);
+		CHECK_GL_ERROR;
+	}
+
 	// get uniform handles from all constant buffers
 	for(Shader::ConstantBufferTplList::const_iterator
 			tpl_it  = buffer_templates->begin();
@@ -351,6 +388,22 @@ void GlShaderContent::bindAttributes() {
 		const ShaderConstantBufferTemplate *buffer_template = tpl_it->buffer_template;
 		const ShaderConstantBufferTemplate::EntryList *buffer_template_entries = buffer_template->getEntries();
 
+		// when the shader declares a uniform block for this buffer, it will be read from a uniform buffer object
+		GLuint block_index = getUniformBlockIndex(program_handle, tpl_it->name.c_str());
+		CHECK_GL_ERROR;
+
+		if (block_index != GL_INVALID_INDEX) {
+			GLuint binding = GlShaderConstantBufferContent::getBindingPointFor(buffer_template);
+
+			if (binding != GL_INVALID_INDEX) {
+				uniformBlockBinding(program_handle, block_index, binding);
+				CHECK_GL_ERROR;
+
+				uniform_block_bindings[buffer_template] = binding;
+				continue;
+			}
+		}
+
 		for(ShaderConstantBufferTemplate::EntryList::const_iterator
 				e_it  = buffer_template_entries->begin();
 				e_it != buffer_template_entries->end();
@@ -383,49 +436,93 @@ GLint GlShaderContent::getAttribHandle(Shader::Attribute attr, uint8_t index) co
 }
 
 
+GlShaderContent::BufferEntry *GlShaderContent::getBufferEntry(const ShaderConstantBufferTemplate *buffer_template) {
+	// the modelview matrix is assigned before each draw call, so it skips the map lookup
+	if (buffer_template == modelview_template && modelview_entry) {
+		return modelview_entry;
+	}
+
+	BufferEntryMap::iterator entry = buffer_entries.find(buffer_template);
+
+	// create a new entry, if not available
+	if (entry == buffer_entries.end()) {
+		BufferEntry buffer_entry;
+		buffer_entry.buffer  = NULL;
+		buffer_entry.version = 0;
+		buffer_entry.binding = GL_INVALID_INDEX;
+
+		UniformBlockBindingMap::iterator it_binding = uniform_block_bindings.find(buffer_template);
+		if (it_binding != uniform_block_bindings.end()) {
+			buffer_entry.binding = it_binding->second;
+		}
+
+		// store uniform informations for each uniform, which belongs to this buffer
+		const ShaderConstantBufferTemplate::EntryList *entries = buffer_template->getEntries();
+		for(ShaderConstantBufferTemplate::EntryList::const_iterator it_unif=entries->begin(); it_unif!=entries->end(); it_unif++) {
+			std::map<std::string,GLint>::iterator it_handle = uniform_attributes.find(it_unif->name);
+
+			if (it_handle != uniform_attributes.end()) {
+				UniformEntry uniform_entry;
+				uniform_entry.entry  = &(*it_unif);
+				uniform_entry.index  = it_unif - entries->begin();
+				uniform_entry.handle = it_handle->second;
+				buffer_entry.buffer_uniforms.push_back(uniform_entry);
+			}
+		}
+
+		buffer_entries[buffer_template] = buffer_entry;
+
+		entry = buffer_entries.find(buffer_template);
+		assert(entry != buffer_entries.end());
+	}
+
+	// map entries keep their address, so the modelview entry can be stored
+	if (buffer_template == modelview_template) {
+		modelview_entry = &(entry->second);
+	}
+
+	return &(entry->second);
+}
+
+
 bool GlShaderContent::assignShaderConstantBuffer(const ShaderConstantBufferTemplate *buffer_template, ShaderConstantBufferContent* buffer_content) {
 	if (buffer_template) {
-		ShaderConstantBuffer::version_t new_version = buffer_content->getShaderConstantBuffer()->getChangeVersion();
-		BufferEntryMap::iterator entry = buffer_entries.find(buffer_template);
-
-		// create a new entry, if not available
-		if (entry == buffer_entries.end()) {
-			BufferEntry buffer_entry;
-			buffer_entry.buffer  = buffer_content->getShaderConstantBuffer();
-			buffer_entry.version = 0;
-
-			// store uniform informations for each uniform, which belongs to this buffer
-			const ShaderConstantBufferTemplate::EntryList *entries = buffer_template->getEntries();
-			for(ShaderConstantBufferTemplate::EntryList::const_iterator it_unif=entries->begin(); it_unif!=entries->end(); it_unif++) {
-				std::map<std::string,GLint>::iterator it_handle = uniform_attributes.find(it_unif->name);
-
-				if (it_handle != uniform_attributes.end()) {
-					UniformEntry uniform_entry;
-					uniform_entry.entry  = &(*it_unif);
-					uniform_entry.handle = it_handle->second;
-					buffer_entry.buffer_uniforms.push_back(uniform_entry);
-				}
+		ShaderConstantBuffer *buffer = buffer_content->getShaderConstantBuffer();
+		BufferEntry *entry = getBufferEntry(buffer_template);
+
+		// uniform blocks read from the buffer currently bound to their binding point,
+		// which may have been changed by another shader in the meantime
+		if (entry->binding != GL_INVALID_INDEX) {
+			GlShaderConstantBufferContent *gl_buffer_content = dynamic_cast<GlShaderConstantBufferContent*>(buffer_content);
+			assert(gl_buffer_content);
+
+			if (gl_buffer_content) {
+				gl_buffer_content->bindUniformBuffer(entry->binding);
 			}
 
-			buffer_entries[buffer_template] = buffer_entry;
+			entry->version = buffer->getChangeVersion();
+			entry->buffer  = buffer;
 
-			entry = buffer_entries.find(buffer_template);
-			assert(entry != buffer_entries.end());
+			return true;
 		}
 
 		// check if the content has changed
 		if (
-				entry->second.version != new_version
-			||	entry->second.buffer  != buffer_content->getShaderConstantBuffer()
+				entry->version != buffer->getChangeVersion()
+			||	entry->buffer  != buffer
 		) {
-			entry->second.version = new_version;
-			entry->second.buffer  = buffer_content->getShaderConstantBuffer();
+			// after switching to another buffer, each value needs to be updated,
+			// otherwise only the entries written since the last update
+			bool update_all = (entry->buffer != buffer);
 
-			const UniformEntryList *uniform_entries = &(entry->second.buffer_uniforms);
-			const ShaderConstantBuffer::data_t data_ptr = buffer_content->getShaderConstantBuffer()->getDataPtr();
+			const UniformEntryList *uniform_entries = &(entry->buffer_uniforms);
+			const ShaderConstantBuffer::data_t data_ptr = buffer->getDataPtr();
 
 			for(UniformEntryList::const_iterator it=uniform_entries->begin(); it!=uniform_entries->end(); it++) {
-				if (it->handle != -1) {
+				if (
+						it->handle != -1
+					&&	(update_all || buffer->hasEntryChangedSince(it->index, entry->version))
+				) {
 					bool success = setShaderValue(
 										it->handle,
 										it->entry->type,
@@ -436,6 +533,9 @@ bool GlShaderContent::assignShaderConstantBuffer(const ShaderConstantBufferTempl
 					assert(success);
 				}
 			}
+
+			entry->version = buffer->getChangeVersion();
+			entry->buffer  = buffer;
 		}
 
 		return true;
@@ -445,6 +545,35 @@ bool GlShaderContent::assignShaderConstantBuffer(const ShaderConstantBufferTempl
 }
 
 
+bool GlShaderContent::isShaderConstantBufferUpToDate(const ShaderConstantBufferTemplate *buffer_template, ShaderConstantBufferContent *buffer_content) const {
+	const BufferEntry *entry = NULL;
+
+	if (buffer_template == modelview_template && modelview_entry) {
+		entry = modelview_entry;
+	}
+	else {
+		BufferEntryMap::const_iterator it = buffer_entries.find(buffer_template);
+
+		if (it != buffer_entries.end()) {
+			entry = &(it->second);
+		}
+	}
+
+	if (entry) {
+		const ShaderConstantBuffer *buffer = buffer_content->getShaderConstantBuffer();
+
+		if (
+				entry->buffer  == buffer
+			&&	entry->version == buffer->getChangeVersion()
+		) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
 bool GlShaderContent::setShaderValue(const std::string &name, ValueType type, size_t elements, void *pValue) {
 	std::map<std::string,GLint>::iterator it = uniform_attributes.find(name);
 	if (it != uniform_attributes.end()) {
@@ -505,6 +634,7 @@ bool GlShaderContent::setShaderValue(GLint attrib_handle, ValueType type, size_t
 			}
 		}
 
+		GlStateCache::instance()->countUniformUpload();
 		CHECK_GL_ERROR;
 
 		return true;
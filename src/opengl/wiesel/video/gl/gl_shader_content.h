@@ -76,6 +76,14 @@ namespace gl {
 			return program_handle;
 		}
 
+		/**
+		 * @brief Get a number which identifies this shader content.
+		 * Unlike the OpenGL handle, this number won't be reused for another shader.
+		 */
+		inline unsigned int getProgramId() const {
+			return program_id;
+		}
+
 	public:
 		/**
 		 * @brief Get the OpenGL handle of a specific shader attribute.
@@ -91,6 +99,13 @@ namespace gl {
 		/// assigns a constant buffer to the current shader instance.
 		virtual bool assignShaderConstantBuffer(const ShaderConstantBufferTemplate *buffer_template, ShaderConstantBufferContent *buffer_content);
 
+		/**
+		 * @brief Checks, if the given constant buffer was already assigned to this shader
+		 * and it's content has not changed since then.
+		 * In this case, assigning the buffer again would have no effect.
+		 */
+		bool isShaderConstantBufferUpToDate(const ShaderConstantBufferTemplate *buffer_template, ShaderConstantBufferContent *buffer_content) const;
+
 	protected:
 		/// set a uniform shader value
 		bool setShaderValue(const std::string &name, ValueType type, size_t elements, void *pValue);
@@ -101,6 +116,7 @@ namespace gl {
 	private:
 		struct UniformEntry {
 			const ShaderConstantBufferTemplate::Entry*	entry;
+			ShaderConstantBufferTemplate::index_t		index;
 			GLint										handle;
 		};
 
@@ -111,6 +127,9 @@ namespace gl {
 			ShaderConstantBuffer*						buffer;
 			ShaderConstantBuffer::version_t				version;
 
+			/// the uniform buffer binding point or \c GL_INVALID_INDEX, when setting each uniform separately
+			GLuint										binding;
+
 			UniformEntryList							buffer_uniforms;
 		};
 
@@ -125,12 +144,26 @@ namespace gl {
 					BufferEntry
 		>												BufferEntryMap;
 
-		GLuint		program_handle;
+		typedef std::map<
+					const ShaderConstantBufferTemplate*,
+					GLuint
+		>												UniformBlockBindingMap;
+
+		/// get the entry of a constant buffer template or create it on the first use.
+		BufferEntry *getBufferEntry(const ShaderConstantBufferTemplate *buffer_template);
+
+	private:
+		GLuint						program_handle;
+		unsigned int				program_id;
 
 		AttributeHandleList			attribute_handles;
 		BufferEntryMap				buffer_entries;
 
 		std::map<std::string,GLint>	uniform_attributes;
+		UniformBlockBindingMap		uniform_block_bindings;
+
+		const ShaderConstantBufferTemplate*	modelview_template;
+		BufferEntry*						modelview_entry;
 	};
 
 }
@@ -0,0 +1,395 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "gl_state_cache.h"
+
+using namespace wiesel;
+using namespace wiesel::video;
+using namespace wiesel::video::gl;
+
+
+/// marks a cached handle as unknown
+#define UNKNOWN_HANDLE		0xffffffff
+
+/// marks a cached enum as unknown
+#define UNKNOWN_ENUM		0xffffffff
+
+
+
+GlStateCache::GlStateCache() {
+	invalidate();
+	resetCounters();
+
+	return;
+}
+
+
+GlStateCache::~GlStateCache() {
+	return;
+}
+
+
+GlStateCache *GlStateCache::instance() {
+	static GlStateCache singleton;
+	return &singleton;
+}
+
+
+void GlStateCache::invalidate() {
+	program					= UNKNOWN_HANDLE;
+	array_buffer			= UNKNOWN_HANDLE;
+	element_array_buffer	= UNKNOWN_HANDLE;
+	vertex_array			= UNKNOWN_HANDLE;
+	active_texture_unit		= UNKNOWN_HANDLE;
+	framebuffer				= UNKNOWN_HANDLE;
+	renderbuffer			= UNKNOWN_HANDLE;
+	blend_sfactor			= UNKNOWN_ENUM;
+	blend_dfactor			= UNKNOWN_ENUM;
+
+	textures.clear();
+	uniform_buffers.clear();
+
+	for(int i=0; i<NumCachedCapabilities; i++) {
+		capabilities[i] = -1;
+	}
+
+	viewport.x				= 0;
+	viewport.y				= 0;
+	viewport.width			= -1;
+	viewport.height			= -1;
+	scissor					= viewport;
+
+	return;
+}
+
+
+void GlStateCache::resetCounters() {
+	issued_calls	= 0;
+	skipped_calls	= 0;
+
+	return;
+}
+
+
+void GlStateCache::takeStatistics(RenderStatistics *target) {
+	*target += statistics;
+	statistics.reset();
+
+	return;
+}
+
+
+
+void GlStateCache::useProgram(GLuint program) {
+	if (update(&this->program, program)) {
+		++statistics.shader_switches;
+		glUseProgram(program);
+	}
+
+	return;
+}
+
+
+void GlStateCache::bindBuffer(GLenum target, GLuint buffer) {
+	switch(target) {
+		case GL_ARRAY_BUFFER: {
+			if (update(&array_buffer, buffer)) {
+				glBindBuffer(target, buffer);
+			}
+
+			break;
+		}
+
+		case GL_ELEMENT_ARRAY_BUFFER: {
+			if (update(&element_array_buffer, buffer)) {
+				glBindBuffer(target, buffer);
+			}
+
+			break;
+		}
+
+		default: {
+			++issued_calls;
+			glBindBuffer(target, buffer);
+			break;
+		}
+	}
+
+	return;
+}
+
+
+void GlStateCache::bindUniformBuffer(GLuint binding, GLuint buffer) {
+	if (uniform_buffers.size() <= binding) {
+		uniform_buffers.resize(binding + 1, UNKNOWN_HANDLE);
+	}
+
+	if (update(&uniform_buffers[binding], buffer)) {
+		gl::bindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+	}
+
+	return;
+}
+
+
+void GlStateCache::bindVertexArray(GLuint vertex_array) {
+	if (update(&this->vertex_array, vertex_array)) {
+		gl::bindVertexArray(vertex_array);
+
+		// the element array binding is part of the vertex array's state
+		element_array_buffer = UNKNOWN_HANDLE;
+	}
+
+	return;
+}
+
+
+void GlStateCache::activeTexture(GLuint unit) {
+	if (update(&active_texture_unit, unit)) {
+		glActiveTexture(GL_TEXTURE0 + unit);
+	}
+
+	return;
+}
+
+
+void GlStateCache::bindTexture(GLuint texture) {
+	// without knowing the active unit, the binding can't be cached
+	if (active_texture_unit == UNKNOWN_HANDLE) {
+		activeTexture(0);
+	}
+
+	bindTexture(active_texture_unit, texture);
+
+	return;
+}
+
+
+void GlStateCache::bindTexture(GLuint unit, GLuint texture) {
+	if (textures.size() <= unit) {
+		textures.resize(unit + 1, UNKNOWN_HANDLE);
+	}
+
+	if (textures[unit] == texture) {
+		++skipped_calls;
+		return;
+	}
+
+	activeTexture(unit);
+
+	textures[unit] = texture;
+	++issued_calls;
+	++statistics.texture_binds;
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	return;
+}
+
+
+void GlStateCache::bindFramebuffer(GLuint framebuffer) {
+	if (update(&this->framebuffer, framebuffer)) {
+		++statistics.render_target_switches;
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	}
+
+	return;
+}
+
+
+void GlStateCache::bindRenderbuffer(GLuint renderbuffer) {
+	if (update(&this->renderbuffer, renderbuffer)) {
+		glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+	}
+
+	return;
+}
+
+
+
+int GlStateCache::getCapabilityIndex(GLenum capability) {
+	switch(capability) {
+		case GL_BLEND:				return 0;
+		case GL_SCISSOR_TEST:		return 1;
+		case GL_DEPTH_TEST:			return 2;
+		case GL_CULL_FACE:			return 3;
+	}
+
+	return -1;
+}
+
+
+void GlStateCache::setEnabled(GLenum capability, bool enabled) {
+	int index = getCapabilityIndex(capability);
+
+	if (index == -1 || update(&capabilities[index], enabled ? 1 : 0)) {
+		if (index == -1) {
+			++issued_calls;
+		}
+
+		if (enabled) {
+			glEnable(capability);
+		}
+		else {
+			glDisable(capability);
+		}
+	}
+
+	return;
+}
+
+
+void GlStateCache::setBlendFunc(GLenum sfactor, GLenum dfactor) {
+	if (blend_sfactor == sfactor && blend_dfactor == dfactor) {
+		++skipped_calls;
+		return;
+	}
+
+	blend_sfactor = sfactor;
+	blend_dfactor = dfactor;
+	++issued_calls;
+	glBlendFunc(sfactor, dfactor);
+
+	return;
+}
+
+
+void GlStateCache::setViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+	Rect rect;
+	rect.x		= x;
+	rect.y		= y;
+	rect.width	= width;
+	rect.height	= height;
+
+	if (update(&viewport, rect)) {
+		glViewport(x, y, width, height);
+	}
+
+	return;
+}
+
+
+void GlStateCache::setScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+	Rect rect;
+	rect.x		= x;
+	rect.y		= y;
+	rect.width	= width;
+	rect.height	= height;
+
+	if (update(&scissor, rect)) {
+		glScissor(x, y, width, height);
+	}
+
+	return;
+}
+
+
+
+void GlStateCache::deleteProgram(GLuint program) {
+	if (program) {
+		glDeleteProgram(program);
+
+		// a program in use will be deleted when it's no longer in use
+		if (this->program == program) {
+			this->program = UNKNOWN_HANDLE;
+		}
+	}
+
+	return;
+}
+
+
+void GlStateCache::deleteBuffer(GLuint buffer) {
+	if (buffer) {
+		glDeleteBuffers(1, &buffer);
+
+		// deleted buffers will be unbound by OpenGL
+		if (array_buffer == buffer) {
+			array_buffer = 0;
+		}
+
+		if (element_array_buffer == buffer) {
+			element_array_buffer = 0;
+		}
+
+		for(std::vector<GLuint>::iterator it=uniform_buffers.begin(); it!=uniform_buffers.end(); it++) {
+			if (*it == buffer) {
+				*it = 0;
+			}
+		}
+	}
+
+	return;
+}
+
+
+void GlStateCache::deleteVertexArray(GLuint vertex_array) {
+	if (vertex_array) {
+		gl::deleteVertexArray(vertex_array);
+
+		if (this->vertex_array == vertex_array) {
+			this->vertex_array   = 0;
+			element_array_buffer = UNKNOWN_HANDLE;
+		}
+	}
+
+	return;
+}
+
+
+void GlStateCache::deleteTexture(GLuint texture) {
+	if (texture) {
+		glDeleteTextures(1, &texture);
+
+		for(std::vector<GLuint>::iterator it=textures.begin(); it!=textures.end(); it++) {
+			if (*it == texture) {
+				*it = 0;
+			}
+		}
+	}
+
+	return;
+}
+
+
+void GlStateCache::deleteFramebuffer(GLuint framebuffer) {
+	if (framebuffer) {
+		glDeleteFramebuffers(1, &framebuffer);
+
+		if (this->framebuffer == framebuffer) {
+			this->framebuffer = 0;
+		}
+	}
+
+	return;
+}
+
+
+void GlStateCache::deleteRenderbuffer(GLuint renderbuffer) {
+	if (renderbuffer) {
+		glDeleteRenderbuffers(1, &renderbuffer);
+
+		if (this->renderbuffer == renderbuffer) {
+			this->renderbuffer = 0;
+		}
+	}
+
+	return;
+}
@@ -0,0 +1,221 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#ifndef __WIESEL_VIDEO_GL_STATE_CACHE_H__
+#define __WIESEL_VIDEO_GL_STATE_CACHE_H__
+
+#include <wiesel/wiesel-opengl.def>
+
+#include "gl.h"
+
+#include <wiesel/video/render_statistics.h>
+
+#include <vector>
+
+
+namespace wiesel {
+namespace video {
+namespace gl {
+
+
+	/**
+	 * @brief A shadow copy of the OpenGL state, which skips all calls
+	 * which wouldn't change the current state.
+	 * All OpenGL code of the engine runs on the same context, so there's
+	 * a single instance, which needs to be used for each state change.
+	 * Bypassing the cache requires to call \ref invalidate afterwards.
+	 */
+	class WIESEL_OPENGL_EXPORT GlStateCache
+	{
+	private:
+		GlStateCache();
+		~GlStateCache();
+
+	public:
+		/**
+		 * @brief Get the state cache of the current OpenGL context.
+		 */
+		static GlStateCache *instance();
+
+		/**
+		 * @brief Forgets all known state, so each following call will be issued.
+		 * This needs to be called when the OpenGL context was (re-)created.
+		 */
+		void invalidate();
+
+	// bindings
+	public:
+		/// set the active shader program
+		void useProgram(GLuint program);
+
+		/// bind a buffer to \c GL_ARRAY_BUFFER or \c GL_ELEMENT_ARRAY_BUFFER
+		void bindBuffer(GLenum target, GLuint buffer);
+
+		/// bind a buffer to an indexed \c GL_UNIFORM_BUFFER binding point
+		void bindUniformBuffer(GLuint binding, GLuint buffer);
+
+		/// bind a vertex array object
+		void bindVertexArray(GLuint vertex_array);
+
+		/// select the active texture unit
+		void activeTexture(GLuint unit);
+
+		/// bind a 2D texture to the currently active texture unit
+		void bindTexture(GLuint texture);
+
+		/// bind a 2D texture to the given texture unit
+		void bindTexture(GLuint unit, GLuint texture);
+
+		/// bind a framebuffer object
+		void bindFramebuffer(GLuint framebuffer);
+
+		/// bind a renderbuffer object
+		void bindRenderbuffer(GLuint renderbuffer);
+
+	// pipeline state
+	public:
+		/// enables or disables a capability like \c GL_BLEND or \c GL_SCISSOR_TEST
+		void setEnabled(GLenum capability, bool enabled);
+
+		/// set the blend function
+		void setBlendFunc(GLenum sfactor, GLenum dfactor);
+
+		/// set the viewport
+		void setViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+		/// set the scissor rectangle
+		void setScissor(GLint x, GLint y, GLsizei width, GLsizei height);
+
+	// object deletion
+	public:
+		/// deletes a program and removes it from the cached state.
+		void deleteProgram(GLuint program);
+
+		/// deletes a buffer and removes it from the cached state.
+		void deleteBuffer(GLuint buffer);
+
+		/// deletes a vertex array object and removes it from the cached state.
+		void deleteVertexArray(GLuint vertex_array);
+
+		/// deletes a texture and removes it from the cached state.
+		void deleteTexture(GLuint texture);
+
+		/// deletes a framebuffer and removes it from the cached state.
+		void deleteFramebuffer(GLuint framebuffer);
+
+		/// deletes a renderbuffer and removes it from the cached state.
+		void deleteRenderbuffer(GLuint renderbuffer);
+
+	// statistics
+	public:
+		/// get the number of calls which were passed to OpenGL.
+		inline unsigned int getIssuedCalls() const {
+			return issued_calls;
+		}
+
+		/// get the number of calls which were skipped, because they wouldn't change anything.
+		inline unsigned int getSkippedCalls() const {
+			return skipped_calls;
+		}
+
+		/// resets the call counters.
+		void resetCounters();
+
+		/// counts data uploaded into a buffer object.
+		inline void countBufferUpload(size_t bytes) {
+			statistics.buffer_upload_bytes += bytes;
+		}
+
+		/// counts uniform values or a uniform buffer uploaded into a shader.
+		inline void countUniformUpload() {
+			++statistics.uniform_uploads;
+		}
+
+		/// counts a single call of \c glGetError.
+		inline void countErrorCheck() {
+			++statistics.error_checks;
+		}
+
+		/// adds all render statistics collected since the last call to \c target.
+		void takeStatistics(RenderStatistics *target);
+
+	private:
+		/// compares a cached value with a new value and updates the cache.
+		/// @return \c true, when the value has changed and the call needs to be issued.
+		template <typename T>
+		inline bool update(T *cached, T value) {
+			if (*cached == value) {
+				++skipped_calls;
+				return false;
+			}
+
+			*cached = value;
+			++issued_calls;
+
+			return true;
+		}
+
+		/// get the index of a capability within the capability cache, or -1 if not cached.
+		static int getCapabilityIndex(GLenum capability);
+
+	private:
+		struct Rect {
+			GLint		x;
+			GLint		y;
+			GLsizei		width;
+			GLsizei		height;
+
+			inline bool operator==(const Rect &other) const {
+				return x == other.x && y == other.y && width == other.width && height == other.height;
+			}
+		};
+
+		enum {
+			NumCachedCapabilities = 4
+		};
+
+		GLuint					program;
+		GLuint					array_buffer;
+		GLuint					element_array_buffer;
+		std::vector<GLuint>		uniform_buffers;
+		GLuint					vertex_array;
+		GLuint					active_texture_unit;
+		std::vector<GLuint>		textures;
+		GLuint					framebuffer;
+		GLuint					renderbuffer;
+
+		int						capabilities[NumCachedCapabilities];
+		GLenum					blend_sfactor;
+		GLenum					blend_dfactor;
+		Rect					viewport;
+		Rect					scissor;
+
+		unsigned int			issued_calls;
+		unsigned int			skipped_calls;
+
+		RenderStatistics		statistics;
+	};
+
+}
+}
+}
+
+#endif /* __WIESEL_VIDEO_GL_STATE_CACHE_H__ */
@@ -20,12 +20,14 @@
  * Boston, MA 02110-1301 USA
  */
 #include "gl_texture_content.h"
+#include "gl_state_cache.h"
 
 #include <wiesel.h>
 #include <wiesel/resources/graphics/image.h>
 #include <wiesel/resources/graphics/imageutils.h>
 #include <wiesel/resources/graphics/image_loader.h>
 #include <wiesel/module_registry.h>
+#include <wiesel/util/profiler.h>
 
 #include <string.h>
 
@@ -108,6 +110,8 @@ bool GlTextureContent::loadEmptyTexture(PixelFormat format, const dimension& siz
 
 
 bool GlTextureContent::loadTextureFromSource(DataSource *data) {
+	WIESEL_PROFILE_SCOPE("Texture::load");
+
 	ref<Image> image = NULL;
 	dimension new_original_size;
 
@@ -172,8 +176,9 @@ bool GlTextureContent::createHardwareTexture(PixelFormat format, const dimension
 	}
 
 	// create the hardware texture
+	WIESEL_PROFILE_SCOPE("Texture::upload");
 	glGenTextures(1, &handle);
-	glBindTexture(GL_TEXTURE_2D, handle);
+	GlStateCache::instance()->bindTexture(handle);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 	
@@ -194,7 +199,7 @@ bool GlTextureContent::createHardwareTexture(PixelFormat format, const dimension
 
 void GlTextureContent::releaseTexture() {
 	if (handle) {
-		glDeleteTextures(1, &handle);
+		GlStateCache::instance()->deleteTexture(handle);
 		handle = 0;
 	}
 
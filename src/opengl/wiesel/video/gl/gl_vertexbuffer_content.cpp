@@ -20,6 +20,10 @@
  * Boston, MA 02110-1301 USA
  */
 #include "gl_vertexbuffer_content.h"
+#include "gl_shader_content.h"
+#include "gl_state_cache.h"
+
+#include <algorithm>
 
 using namespace wiesel;
 using namespace wiesel::video;
@@ -28,6 +32,8 @@ using namespace wiesel::video::gl;
 
 GlVertexBufferContent::GlVertexBufferContent(VertexBuffer *vb) : VertexBufferContent(vb) {
 	this->handle		= 0;
+	this->buffer_size	= 0;
+	this->buffer_usage	= 0;
 	return;
 }
 
@@ -47,7 +53,7 @@ GlVertexBufferContent *GlVertexBufferContent::createContentFor(VertexBuffer* vb)
 void GlVertexBufferContent::initializeVertexBuffer() {
 	if (handle == 0) {
 		unsigned short				vertex_size		= getVertexBuffer()->getVertexSize();
-		VertexBuffer::index_t		num_vertices	= getVertexBuffer()->getSize();
+		VertexBuffer::index_t		capacity		= getVertexBuffer()->getCapacity();
 		const VertexBuffer::data_t	data			= getVertexBuffer()->getDataPtr();
 
 		// create the buffer first
@@ -55,9 +61,63 @@ void GlVertexBufferContent::initializeVertexBuffer() {
 		CHECK_GL_ERROR;
 
 		// bind the buffer and put the data into it
-		glBindBuffer(GL_ARRAY_BUFFER, handle);
-		glBufferData(GL_ARRAY_BUFFER, vertex_size * num_vertices, data, GL_STATIC_DRAW);
+		buffer_size  = vertex_size * capacity;
+		buffer_usage = getGlBufferUsage(getVertexBuffer()->getUsage());
+		GlStateCache::instance()->bindBuffer(GL_ARRAY_BUFFER, handle);
+		glBufferData(GL_ARRAY_BUFFER, buffer_size, data, buffer_usage);
+		GlStateCache::instance()->countBufferUpload(buffer_size);
+		CHECK_GL_ERROR;
+
+		getVertexBuffer()->clearDirtyRange();
+	}
+
+	return;
+}
+
+
+void GlVertexBufferContent::updateVertexBuffer() {
+	VertexBuffer *vertex_buffer = getVertexBuffer();
+
+	if (handle == 0) {
+		initializeVertexBuffer();
+		return;
+	}
+
+	if (vertex_buffer->isDirty()) {
+		GLsizeiptr					size	= vertex_buffer->getVertexSize() * vertex_buffer->getCapacity();
+		GLsizeiptr					used	= vertex_buffer->getVertexSize() * vertex_buffer->getSize();
+		const VertexBuffer::data_t	data	= vertex_buffer->getDataPtr();
+		GLenum						usage	= getGlBufferUsage(vertex_buffer->getUsage());
+
+		GlStateCache::instance()->bindBuffer(GL_ARRAY_BUFFER, handle);
+
+		if (size != buffer_size || usage != buffer_usage) {
+			// the buffer was resized or got another usage hint, so the hardware buffer needs to be re-created
+			glBufferData(GL_ARRAY_BUFFER, size, data, usage);
+			GlStateCache::instance()->countBufferUpload(size);
+			buffer_size  = size;
+			buffer_usage = usage;
+		}
+		else if (vertex_buffer->getUsage() == BufferUsageStream) {
+			// orphan the old storage, so we don't need to wait for pending draw calls using it
+			glBufferData(GL_ARRAY_BUFFER, size, NULL, usage);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, used, data);
+			GlStateCache::instance()->countBufferUpload(used);
+		}
+		else {
+			// upload only the modified range
+			GLintptr   begin = vertex_buffer->getDirtyRangeBegin();
+			GLsizeiptr end   = std::min<GLsizeiptr>(vertex_buffer->getDirtyRangeEnd(), size);
+
+			if (end > begin) {
+				glBufferSubData(GL_ARRAY_BUFFER, begin, end - begin, data + begin);
+				GlStateCache::instance()->countBufferUpload(end - begin);
+			}
+		}
+
 		CHECK_GL_ERROR;
+
+		vertex_buffer->clearDirtyRange();
 	}
 
 	return;
@@ -65,11 +125,68 @@ void GlVertexBufferContent::initializeVertexBuffer() {
 
 
 void GlVertexBufferContent::releaseVertexBuffer() {
+	// vertex arrays are referring the buffer object
+	releaseVertexArrays();
+
 	if (handle) {
-		glDeleteBuffers(1, &handle);
-		handle = 0;
+		GlStateCache::instance()->deleteBuffer(handle);
+		handle       = 0;
+		buffer_size  = 0;
+		buffer_usage = 0;
 	}
 
 	return;
 }
 
+
+
+GLuint GlVertexBufferContent::getVertexArray(const GlShaderContent *shader_content) {
+	unsigned int layout_version = getVertexBuffer()->getLayoutVersion();
+
+	for(VertexArrayList::const_iterator it=vertex_arrays.begin(); it!=vertex_arrays.end(); it++) {
+		if (it->program_id == shader_content->getProgramId() && it->layout_version == layout_version) {
+			return it->handle;
+		}
+	}
+
+	return 0;
+}
+
+
+GLuint GlVertexBufferContent::createVertexArray(const GlShaderContent *shader_content) {
+	unsigned int layout_version = getVertexBuffer()->getLayoutVersion();
+
+	// remove any outdated object for this shader
+	for(VertexArrayList::iterator it=vertex_arrays.begin(); it!=vertex_arrays.end();) {
+		if (it->program_id == shader_content->getProgramId() || it->layout_version != layout_version) {
+			GlStateCache::instance()->deleteVertexArray(it->handle);
+			it = vertex_arrays.erase(it);
+		}
+		else {
+			it++;
+		}
+	}
+
+	VertexArrayEntry entry;
+	entry.program_id		= shader_content->getProgramId();
+	entry.layout_version	= layout_version;
+	entry.handle			= gl::createVertexArray();
+
+	if (entry.handle) {
+		vertex_arrays.push_back(entry);
+	}
+
+	return entry.handle;
+}
+
+
+void GlVertexBufferContent::releaseVertexArrays() {
+	for(VertexArrayList::iterator it=vertex_arrays.begin(); it!=vertex_arrays.end(); it++) {
+		GlStateCache::instance()->deleteVertexArray(it->handle);
+	}
+
+	vertex_arrays.clear();
+
+	return;
+}
+
@@ -28,11 +28,15 @@
 
 #include "gl.h"
 
+#include <vector>
+
 
 namespace wiesel {
 namespace video {
 namespace gl {
 
+	class GlShaderContent;
+
 
 	/**
 	 * @brief OpenGL backend for vertexbuffer objects.
@@ -53,6 +57,12 @@ namespace gl {
 		 */
 		void initializeVertexBuffer();
 
+		/**
+		 * @brief Uploads all modified data of the vertex buffer to the graphics hardware.
+		 * Creates the hardware buffer, if not already done.
+		 */
+		void updateVertexBuffer();
+
 		/**
 		 * @brief Releases the vertex buffer object on the graphics hardware.
 		 */
@@ -65,8 +75,41 @@ namespace gl {
 			return handle;
 		}
 
+	// vertex array objects
+	public:
+		/**
+		 * @brief Get the cached vertex array object for this buffer used with the given shader.
+		 * The cached object is only valid while the vertex layout has not changed.
+		 * @return the handle of the vertex array object or \c 0, when none was created yet.
+		 */
+		GLuint getVertexArray(const GlShaderContent *shader_content);
+
+		/**
+		 * @brief Creates a new vertex array object for this buffer used with the given shader.
+		 * The caller needs to bind the object and configure the vertex attributes.
+		 * @return the handle of the vertex array object or \c 0, when not supported.
+		 */
+		GLuint createVertexArray(const GlShaderContent *shader_content);
+
+		/**
+		 * @brief Deletes all cached vertex array objects of this buffer.
+		 */
+		void releaseVertexArrays();
+
 	private:
-		GLuint		handle;
+		struct VertexArrayEntry {
+			unsigned int	program_id;
+			unsigned int	layout_version;
+			GLuint			handle;
+		};
+
+		typedef std::vector<VertexArrayEntry>	VertexArrayList;
+
+		GLuint			handle;
+		GLsizeiptr		buffer_size;
+		GLenum			buffer_usage;
+
+		VertexArrayList	vertex_arrays;
 	};
 
 } /* namespace gl */
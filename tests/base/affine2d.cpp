@@ -0,0 +1,95 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "gtest/gtest.h"
+#include "test_utils.h"
+
+#include <wiesel/math/affine2d.h>
+#include <wiesel/math/matrix.h>
+#include <wiesel/math/vector2d.h>
+#include <wiesel/math/utils.h>
+
+
+using namespace wiesel;
+
+
+
+/**
+ * Checks if the affine transformation has the exact size we expect -> 6 * sizeof(float)
+ */
+TEST(Affine2D, Sizeof) {
+	EXPECT_EQ((6 * sizeof(float)), sizeof(affine2d));
+}
+
+
+/**
+ * Checks if the composed transformation matches the same
+ * transformations applied on a 4x4 matrix.
+ */
+TEST(Affine2D, ComposeMatchesMatrix) {
+	const vector2d pivot(5.0f, -3.0f);
+	const vector2d position(100.0f, 25.0f);
+	const float rotation = deg2rad(30);
+
+	matrix4x4 m = matrix4x4::identity;
+	m.translate(-pivot.x, -pivot.y);
+	m.scale(2.0f, 0.5f, 1.0f);
+	m.rotateZ(rotation);
+	m.translate(position.x, position.y);
+
+	affine2d t = affine2d::compose(pivot, 2.0f, 0.5f, rotation, position);
+
+	EXPECT_MATRIX_EQ(m, t.toMatrix4x4());
+
+	vector2d v(7.0f, 11.0f);
+	EXPECT_VECTOR_EQ(v * m, v * t);
+}
+
+
+/**
+ * Checks the concatenation of two transformations against the 4x4 matrix multiplication.
+ */
+TEST(Affine2D, Multiplication) {
+	affine2d a = affine2d::compose(vector2d(1.0f, 2.0f), 1.5f, 3.0f, deg2rad(45), vector2d(-4.0f, 8.0f));
+	affine2d b = affine2d::compose(vector2d(-2.0f, 0.5f), 0.5f, 2.0f, deg2rad(-60), vector2d(10.0f, 3.0f));
+
+	EXPECT_MATRIX_EQ(a.toMatrix4x4() * b.toMatrix4x4(), (a * b).toMatrix4x4());
+
+	// multiply with a arbitrary 4x4 matrix
+	matrix4x4 m;
+	for(int i=0; i<16; i++) {
+		m.m[i] = static_cast<float>(i * i) * 0.25f - static_cast<float>(i);
+	}
+
+	EXPECT_MATRIX_EQ(a.toMatrix4x4() * m, a * m);
+}
+
+
+/**
+ * Checks inverting a transformation.
+ */
+TEST(Affine2D, Inverted) {
+	affine2d t = affine2d::compose(vector2d(1.0f, 2.0f), 1.5f, 3.0f, deg2rad(45), vector2d(-4.0f, 8.0f));
+	affine2d i = t * t.inverted();
+
+	EXPECT_MATRIX_IDENTITY(i.toMatrix4x4());
+	EXPECT_MATRIX_EQ(t.toMatrix4x4().inverted(), t.inverted().toMatrix4x4());
+}
@@ -0,0 +1,60 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "gtest/gtest.h"
+
+#include <wiesel/util/clock.h>
+
+
+using namespace wiesel;
+
+
+
+/**
+ * Checks if the clock never goes backwards.
+ */
+TEST(Clock, Monotonic) {
+	double last = Clock::getTime();
+
+	for(int i=0; i<10000; i++) {
+		double now = Clock::getTime();
+		EXPECT_GE(now, last);
+		last = now;
+	}
+}
+
+
+/**
+ * Checks if sleepUntil does not return before the requested time.
+ */
+TEST(Clock, SleepUntil) {
+	double start = Clock::getTime();
+
+	for(int i=1; i<=5; i++) {
+		double target = start + i * 0.005;
+		Clock::sleepUntil(target);
+		EXPECT_GE(Clock::getTime(), target);
+	}
+
+	// a time in the past returns immediately
+	Clock::sleepUntil(start);
+	EXPECT_LT(Clock::getTime() - start, 1.0);
+}
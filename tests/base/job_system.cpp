@@ -0,0 +1,206 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "gtest/gtest.h"
+
+#include <wiesel/util/job_system.h>
+
+#include <vector>
+
+
+using namespace wiesel;
+
+
+
+class CountingTask : public IRunnable
+{
+public:
+	CountingTask() : count(0) {}
+
+	virtual void run() {
+		for(int i=0; i<1000; i++) {
+			count++;
+		}
+	}
+
+	int count;
+};
+
+
+class SequenceJob : public Job
+{
+public:
+	SequenceJob(std::vector<int> *sequence, int value) : sequence(sequence), value(value) {}
+
+	virtual void run() {
+		sequence->push_back(value);
+	}
+
+	std::vector<int>*	sequence;
+	int					value;
+};
+
+
+struct SquareRange
+{
+	std::vector<int>*	values;
+
+	void operator()(size_t begin, size_t end) {
+		for(size_t i=begin; i<end; i++) {
+			(*values)[i] = static_cast<int>(i * i);
+		}
+	}
+};
+
+
+class RecordingDispatcher : public IMainThreadDispatcher
+{
+public:
+	virtual void dispatchToMainThread(IRunnable *runnable) {
+		dispatched.push_back(keep(runnable));
+	}
+
+	std::vector<IRunnable*>	dispatched;
+};
+
+
+
+/**
+ * Checks if all tasks of a batch have been executed exactly once when run returns.
+ */
+TEST(JobSystem, RunAllTasks) {
+	for(unsigned int num_workers=0; num_workers<4; num_workers++) {
+		JobSystem jobs(num_workers);
+		EXPECT_EQ(num_workers, jobs.getNumberOfWorkers());
+
+		std::vector<CountingTask*> counters;
+		std::vector<IRunnable*> tasks;
+		for(int i=0; i<64; i++) {
+			CountingTask *task = keep(new CountingTask());
+			counters.push_back(task);
+			tasks.push_back(task);
+		}
+
+		// the job system can be used for multiple batches
+		jobs.run(tasks);
+		jobs.run(tasks);
+
+		for(std::vector<CountingTask*>::iterator it=counters.begin(); it!=counters.end(); it++) {
+			EXPECT_EQ(2000, (*it)->count);
+			release(*it);
+		}
+	}
+}
+
+
+
+/**
+ * Checks if jobs start not before all of their dependencies have been finished.
+ */
+TEST(JobSystem, Dependencies) {
+	for(unsigned int num_workers=0; num_workers<4; num_workers++) {
+		JobSystem jobs(num_workers);
+		std::vector<int> sequence;
+
+		// a -> b -> c, submitted in reverse order
+		SequenceJob *a = keep(new SequenceJob(&sequence, 1));
+		SequenceJob *b = keep(new SequenceJob(&sequence, 2));
+		SequenceJob *c = keep(new SequenceJob(&sequence, 3));
+
+		jobs.submit(c, b);
+		jobs.submit(b, a);
+		EXPECT_FALSE(c->isFinished());
+
+		jobs.submit(a);
+		jobs.wait(c);
+
+		EXPECT_TRUE(a->isFinished());
+		EXPECT_TRUE(b->isFinished());
+		EXPECT_TRUE(c->isFinished());
+
+		ASSERT_EQ(3u, sequence.size());
+		EXPECT_EQ(1, sequence[0]);
+		EXPECT_EQ(2, sequence[1]);
+		EXPECT_EQ(3, sequence[2]);
+
+		// finished jobs can be submitted again
+		std::vector<Job*> dependencies;
+		dependencies.push_back(a);
+		dependencies.push_back(b);
+		jobs.submit(c, dependencies);
+		jobs.wait(c);
+		EXPECT_EQ(4u, sequence.size());
+
+		release(a);
+		release(b);
+		release(c);
+	}
+}
+
+
+/**
+ * Checks if parallelFor covers each index exactly once.
+ */
+TEST(JobSystem, ParallelFor) {
+	for(unsigned int num_workers=0; num_workers<4; num_workers++) {
+		JobSystem jobs(num_workers);
+		std::vector<int> values(1000, -1);
+
+		SquareRange body;
+		body.values = &values;
+		jobs.parallelFor(0, values.size(), 7, body);
+
+		for(size_t i=0; i<values.size(); i++) {
+			EXPECT_EQ(static_cast<int>(i * i), values[i]);
+		}
+	}
+}
+
+
+/**
+ * Checks if tasks will be handed over to the main thread after a job has been finished.
+ */
+TEST(JobSystem, RunOnMainThreadAfter) {
+	RecordingDispatcher dispatcher;
+	JobSystem jobs(2);
+	jobs.setMainThreadDispatcher(&dispatcher);
+
+	std::vector<int> sequence;
+	SequenceJob *job = keep(new SequenceJob(&sequence, 1));
+	CountingTask *task = keep(new CountingTask());
+
+	jobs.runOnMainThreadAfter(job, task);
+	jobs.submit(job);
+	jobs.wait(job);
+
+	// the dispatching job runs after the job has been finished
+	while(dispatcher.dispatched.empty()) {
+		Thread::sleep(1);
+	}
+
+	ASSERT_EQ(1u, dispatcher.dispatched.size());
+	EXPECT_EQ(task, dispatcher.dispatched[0]);
+	EXPECT_EQ(1u, sequence.size());
+
+	release(dispatcher.dispatched[0]);
+	release(task);
+	release(job);
+}
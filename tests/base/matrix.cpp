@@ -23,6 +23,7 @@
 #include "test_utils.h"
 
 #include <wiesel/math/matrix.h>
+#include <wiesel/math/vector2d.h>
 #include <wiesel/math/vector3d.h>
 #include <wiesel/math/utils.h>
 
@@ -345,3 +346,103 @@ TEST(Matrix, TransformationRotateNegativeZ) {
 	EXPECT_VECTOR_EQ(vector3d(0, -10, 0), vector3d(10, 0, 0) * rotated);
 }
 
+
+
+/**
+ * Creates a matrix with distinct values in each cell.
+ */
+static matrix4x4 createTestMatrix(float offset) {
+	matrix4x4 m;
+	for(int i=0; i<16; i++) {
+		m.m[i] = offset + static_cast<float>(i * i) * 0.25f - static_cast<float>(i);
+	}
+
+	return m;
+}
+
+
+/**
+ * Checks the multiplication of two arbitrary matrices against the cell-by-cell definition.
+ */
+TEST(Matrix, Multiplication) {
+	matrix4x4 a = createTestMatrix(1.5f);
+	matrix4x4 b = createTestMatrix(-3.0f);
+	matrix4x4 result = a * b;
+
+	for(unsigned int c=0; c<4; c++) {
+		for(unsigned int r=0; r<4; r++) {
+			float expected =
+					(a.get(c, 0) * b.get(0, r))
+				+	(a.get(c, 1) * b.get(1, r))
+				+	(a.get(c, 2) * b.get(2, r))
+				+	(a.get(c, 3) * b.get(3, r))
+			;
+
+			EXPECT_EQ(expected, result.get(c, r));
+		}
+	}
+}
+
+
+/**
+ * Checks if the transformation functions match a multiplication with their transformation matrix.
+ */
+TEST(Matrix, TransformationsMatchMultiplication) {
+	const matrix4x4 original = createTestMatrix(2.0f);
+	const float a = deg2rad(30);
+	matrix4x4 m;
+
+	m = original;
+	m.translate(1, 2, 3);
+	EXPECT_EQ(original * matrix4x4(1, 0, 0, 1,  0, 1, 0, 2,  0, 0, 1, 3,  0, 0, 0, 1), m);
+
+	m = original;
+	m.scale(2, 3, 4);
+	EXPECT_EQ(original * matrix4x4(2, 0, 0, 0,  0, 3, 0, 0,  0, 0, 4, 0,  0, 0, 0, 1), m);
+
+	m = original;
+	m.rotateX(a);
+	EXPECT_EQ(original * matrix4x4(1, 0, 0, 0,  0, cosf(a), -sinf(a), 0,  0, sinf(a), cosf(a), 0,  0, 0, 0, 1), m);
+
+	m = original;
+	m.rotateY(a);
+	EXPECT_EQ(original * matrix4x4(cosf(a), 0, sinf(a), 0,  0, 1, 0, 0,  -sinf(a), 0, cosf(a), 0,  0, 0, 0, 1), m);
+
+	m = original;
+	m.rotateZ(a);
+	EXPECT_EQ(original * matrix4x4(cosf(a), -sinf(a), 0, 0,  sinf(a), cosf(a), 0, 0,  0, 0, 1, 0,  0, 0, 0, 1), m);
+}
+
+
+/**
+ * Checks if transforming an array of vectors matches transforming each single vector.
+ */
+TEST(Matrix, BatchTransform) {
+	matrix4x4 m = matrix4x4::identity;
+	m.scale(2, 3, 4);
+	m.rotateZ(deg2rad(45));
+	m.translate(5, 6, 7);
+
+	vector3d src3d[3] = { vector3d(1, 2, 3), vector3d(-4, 5, -6), vector3d::zero };
+	vector3d dst3d[3];
+	m.transform(src3d, dst3d, 3);
+
+	for(int i=0; i<3; i++) {
+		EXPECT_VECTOR_EQ(src3d[i] * m, dst3d[i]);
+	}
+
+	vector2d src2d[3] = { vector2d(1, 2), vector2d(-4, 5), vector2d::zero };
+	vector2d dst2d[3];
+	m.transform(src2d, dst2d, 3);
+
+	for(int i=0; i<3; i++) {
+		EXPECT_VECTOR_EQ(src2d[i] * m, dst2d[i]);
+	}
+
+	// transform in place
+	m.transform(src3d, src3d, 3);
+
+	for(int i=0; i<3; i++) {
+		EXPECT_VECTOR_EQ(dst3d[i], src3d[i]);
+	}
+}
@@ -0,0 +1,148 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "gtest/gtest.h"
+
+#include <wiesel/util/profiler.h>
+
+#include <sstream>
+#include <string>
+
+
+using namespace wiesel;
+
+
+
+/**
+ * Checks if nested phases will be recorded within the current frame.
+ */
+TEST(Profiler, NestedPhases) {
+	Profiler *profiler = Profiler::getInstance();
+	profiler->setCapacity(4);
+	EXPECT_EQ(4u, profiler->getCapacity());
+	EXPECT_EQ(0u, profiler->getNumberOfFrames());
+
+	profiler->begin("outer");
+	profiler->begin("inner");
+	profiler->end();
+	profiler->end();
+	profiler->nextFrame();
+
+	ASSERT_EQ(1u, profiler->getNumberOfFrames());
+
+	const Profiler::Frame *frame = profiler->getFrame(0);
+	ASSERT_EQ(2u, frame->events.size());
+
+	// phases are recorded when they end, so the inner phase comes first
+	EXPECT_STREQ("inner", frame->events[0].name);
+	EXPECT_EQ(1u, frame->events[0].depth);
+	EXPECT_STREQ("outer", frame->events[1].name);
+	EXPECT_EQ(0u, frame->events[1].depth);
+
+	EXPECT_GE(frame->events[1].duration, frame->events[0].duration);
+	EXPECT_LE(frame->events[1].start, frame->events[0].start);
+	EXPECT_GE(frame->duration, frame->events[1].duration);
+}
+
+
+/**
+ * Checks if only the latest frames will be kept.
+ */
+TEST(Profiler, RingBuffer) {
+	Profiler *profiler = Profiler::getInstance();
+	profiler->setCapacity(3);
+
+	for(int i=0; i<10; i++) {
+		profiler->begin("frame");
+		profiler->end();
+		profiler->nextFrame();
+	}
+
+	ASSERT_EQ(3u, profiler->getNumberOfFrames());
+	EXPECT_EQ(profiler->getFrame(0)->number + 1, profiler->getFrame(1)->number);
+	EXPECT_EQ(profiler->getFrame(1)->number + 1, profiler->getFrame(2)->number);
+
+	// no frames will be recorded while disabled
+	profiler->setEnabled(false);
+	uint32_t last_number = profiler->getFrame(2)->number;
+	profiler->begin("ignored");
+	profiler->end();
+	profiler->nextFrame();
+	EXPECT_EQ(last_number, profiler->getFrame(2)->number);
+	profiler->setEnabled(true);
+}
+
+
+/**
+ * Checks the output of all recorded phases.
+ */
+TEST(Profiler, Output) {
+	Profiler *profiler = Profiler::getInstance();
+	profiler->setCapacity(2);
+
+	profiler->begin("phase \"one\"");
+	profiler->end();
+	profiler->nextFrame();
+
+	std::stringstream trace;
+	profiler->writeChromeTrace(trace);
+	EXPECT_EQ(0u, trace.str().find("{\"traceEvents\":["));
+	EXPECT_NE(std::string::npos, trace.str().find("\"name\":\"phase \\\"one\\\"\""));
+	EXPECT_NE(std::string::npos, trace.str().find("\"ph\":\"X\""));
+
+	std::stringstream summary;
+	profiler->writeSummary(summary);
+	EXPECT_EQ(0u, summary.str().find("frames: 1"));
+	EXPECT_NE(std::string::npos, summary.str().find("phase \"one\"\t1\t"));
+}
+
+
+/**
+ * Checks if counters will be recorded per frame and written into each output.
+ */
+TEST(Profiler, Counters) {
+	Profiler *profiler = Profiler::getInstance();
+	profiler->setCapacity(2);
+
+	profiler->setCounter("draw calls", 10);
+	profiler->setCounter("draw calls", 20);
+	profiler->nextFrame();
+	profiler->nextFrame();
+
+	ASSERT_EQ(2u, profiler->getNumberOfFrames());
+
+	// the last value within a frame will be kept
+	const Profiler::Frame *first = profiler->getFrame(0);
+	ASSERT_EQ(1u, first->counters.size());
+	EXPECT_STREQ("draw calls", first->counters[0].name);
+	EXPECT_EQ(20.0, first->counters[0].value);
+
+	// counters will be cleared on each frame
+	EXPECT_EQ(0u, profiler->getFrame(1)->counters.size());
+
+	std::stringstream trace;
+	profiler->writeChromeTrace(trace);
+	EXPECT_NE(std::string::npos, trace.str().find("\"ph\":\"C\""));
+
+	std::stringstream summary;
+	profiler->writeSummary(summary);
+	EXPECT_NE(std::string::npos, summary.str().find("draw calls\t"));
+}
@@ -0,0 +1,190 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "gtest/gtest.h"
+
+#include <wiesel/util/task_queue.h>
+#include <wiesel/util/thread.h>
+
+#include <vector>
+
+
+using namespace wiesel;
+
+
+
+class ValueTask : public IRunnable
+{
+public:
+	ValueTask(int value) : value(value) {}
+
+	virtual void run() {}
+
+	int value;
+};
+
+
+class ProducerThread : public Thread
+{
+public:
+	ProducerThread(TaskQueue *queue, int first, int count) : queue(queue), first(first), count(count) {}
+
+	virtual void run() {
+		for(int i=0; i<count; i++) {
+			queue->push(new ValueTask(first + i));
+		}
+	}
+
+	TaskQueue*	queue;
+	int			first;
+	int			count;
+};
+
+
+class SharedTaskProducerThread : public Thread
+{
+public:
+	SharedTaskProducerThread(TaskQueue *queue, IRunnable *task, int count) : queue(queue), task(task), count(count) {}
+
+	virtual void run() {
+		for(int i=0; i<count; i++) {
+			queue->push(task);
+		}
+	}
+
+	TaskQueue*	queue;
+	IRunnable*	task;
+	int			count;
+};
+
+
+
+/**
+ * Checks if tasks will be taken in the order they were added.
+ */
+TEST(TaskQueue, TakeAllInOrder) {
+	TaskQueue queue;
+	EXPECT_TRUE(queue.empty());
+
+	std::vector<IRunnable*> tasks;
+	EXPECT_FALSE(queue.takeAll(&tasks));
+
+	for(int i=0; i<10; i++) {
+		queue.push(new ValueTask(i));
+	}
+
+	EXPECT_FALSE(queue.empty());
+
+	// existing entries of the list remain in front
+	tasks.push_back(keep(new ValueTask(-1)));
+	EXPECT_TRUE(queue.takeAll(&tasks));
+	EXPECT_TRUE(queue.empty());
+
+	ASSERT_EQ(11u, tasks.size());
+	for(int i=0; i<11; i++) {
+		EXPECT_EQ(i - 1, dynamic_cast<ValueTask*>(tasks[i])->value);
+		release(tasks[i]);
+	}
+}
+
+
+/**
+ * Checks if no task gets lost while multiple threads are adding tasks.
+ */
+TEST(TaskQueue, MultipleProducers) {
+	const int num_threads	= 4;
+	const int num_tasks		= 2000;
+
+	TaskQueue queue;
+	std::vector<ProducerThread*> threads;
+
+	for(int i=0; i<num_threads; i++) {
+		ProducerThread *thread = keep(new ProducerThread(&queue, i * num_tasks, num_tasks));
+		thread->start();
+		threads.push_back(thread);
+	}
+
+	// take tasks while the producers are still running
+	std::vector<IRunnable*> tasks;
+	while(tasks.size() < static_cast<size_t>(num_threads * num_tasks)) {
+		queue.takeAll(&tasks);
+	}
+
+	for(std::vector<ProducerThread*>::iterator it=threads.begin(); it!=threads.end(); it++) {
+		(*it)->join();
+		release(*it);
+	}
+
+	EXPECT_TRUE(queue.empty());
+
+	// each producer's tasks keep their order
+	std::vector<int> next_value(num_threads);
+	for(int i=0; i<num_threads; i++) {
+		next_value[i] = i * num_tasks;
+	}
+
+	for(std::vector<IRunnable*>::iterator it=tasks.begin(); it!=tasks.end(); it++) {
+		int value = dynamic_cast<ValueTask*>(*it)->value;
+		EXPECT_EQ(next_value[value / num_tasks]++, value);
+		release(*it);
+	}
+}
+
+
+/**
+ * Checks if the same task can be added by multiple threads,
+ * while its references are released on the consuming thread.
+ */
+TEST(TaskQueue, SharedTaskReferences) {
+	const int num_threads	= 4;
+	const int num_tasks		= 2000;
+
+	TaskQueue queue;
+	ValueTask *task = keep(new ValueTask(0));
+	std::vector<SharedTaskProducerThread*> threads;
+
+	for(int i=0; i<num_threads; i++) {
+		SharedTaskProducerThread *thread = keep(new SharedTaskProducerThread(&queue, task, num_tasks));
+		thread->start();
+		threads.push_back(thread);
+	}
+
+	// release each reference while the producers are still adding new ones
+	int taken = 0;
+	while(taken < num_threads * num_tasks) {
+		std::vector<IRunnable*> tasks;
+		queue.takeAll(&tasks);
+
+		for(std::vector<IRunnable*>::iterator it=tasks.begin(); it!=tasks.end(); it++) {
+			EXPECT_EQ(task, *it);
+			release(*it);
+			++taken;
+		}
+	}
+
+	for(std::vector<SharedTaskProducerThread*>::iterator it=threads.begin(); it!=threads.end(); it++) {
+		(*it)->join();
+		release(*it);
+	}
+
+	EXPECT_EQ(1, task->getReferenceCount());
+	release(task);
+}
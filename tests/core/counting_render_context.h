@@ -0,0 +1,80 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#ifndef __COUNTING_RENDER_CONTEXT_H__
+#define __COUNTING_RENDER_CONTEXT_H__
+
+#include <wiesel/video/indexbuffer.h>
+#include <wiesel/video/render_context.h>
+#include <wiesel/video/vertexbuffer.h>
+
+
+namespace wiesel {
+namespace video {
+
+	/**
+	 * A render context without any backend, which just counts the draw calls.
+	 */
+	class CountingRenderContext : public RenderContext
+	{
+	public:
+		CountingRenderContext() : RenderContext(NULL) {
+			draw_calls		= 0;
+			last_vertices	= NULL;
+		}
+
+		virtual void initContext() {}
+		virtual void setProjectionMatrix(const matrix4x4 &matrix) {}
+		virtual void setModelviewMatrix(const matrix4x4 &matrix) {}
+		virtual void setShader(Shader *shader) {}
+		virtual bool assignShaderConstantBuffer(const ShaderConstantBufferTemplate *buffer_template, ShaderConstantBuffer *buffer) { return true; }
+		virtual void setTexture(uint16_t index, Texture *texture) {}
+		virtual void clearTextures() {}
+		virtual void prepareTextureLayers(uint16_t layers) {}
+		virtual bool isInstancingSupported() const { return false; }
+		virtual void drawInstanced(Primitive primitive, const VertexBuffer *vertices, const VertexBuffer *instances) {}
+		virtual void preRender() {}
+		virtual void postRender() {}
+		virtual void onSizeChanged(const dimension &size) {}
+
+		virtual void draw(Primitive primitive, const VertexBuffer *vertices) {
+			flushBatch();
+			frame_statistics.countDrawCall(primitive, vertices->getSize());
+			++draw_calls;
+			last_vertices = vertices;
+		}
+
+		virtual void draw(Primitive primitive, const VertexBuffer *vertices, const IndexBuffer *indices) {
+			flushBatch();
+			frame_statistics.countDrawCall(primitive, indices->getSize());
+			++draw_calls;
+			last_vertices = vertices;
+		}
+
+	public:
+		int						draw_calls;
+		const VertexBuffer*		last_vertices;
+	};
+
+}
+}
+
+#endif // __COUNTING_RENDER_CONTEXT_H__
@@ -0,0 +1,443 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "gtest/gtest.h"
+#include "counting_render_context.h"
+
+#include <wiesel/graph/2d/node2d.h>
+#include <wiesel/graph/scene.h>
+#include <wiesel/graph/viewport.h>
+#include <wiesel/util/job_system.h>
+#include <wiesel/util/thread.h>
+
+
+using namespace wiesel;
+
+
+/// set on the thread running the tests, to distinguish it from worker threads.
+static WIESEL_THREAD_LOCAL bool is_test_thread = false;
+
+
+
+class BoundsTestNode : public Node2D
+{
+public:
+	BoundsTestNode(const rectangle &bounds) {
+		setBounds(bounds);
+	}
+};
+
+
+class DrawCountingNode : public Node2D
+{
+public:
+	DrawCountingNode() : draws(0) {}
+
+	DrawCountingNode(const dimension &size) : draws(0) {
+		setContentSize(size);
+	}
+
+	virtual void onDraw(video::RenderContext *render_context) {
+		++draws;
+	}
+
+	int		draws;
+};
+
+
+class ParentDependentNode : public Node2D
+{
+public:
+	ParentDependentNode() : computed(false), computed_on_test_thread(false) {}
+
+	virtual bool dependsOnParentTransform() const {
+		return true;
+	}
+
+	virtual void computeLocalTransform(matrix4x4 *transform) {
+		Node2D::computeLocalTransform(transform);
+		computed				= true;
+		computed_on_test_thread	= is_test_thread;
+	}
+
+	bool	computed;
+	bool	computed_on_test_thread;
+};
+
+
+
+/**
+ * Checks if the subtree bounds cover all children and follow their transformations.
+ */
+TEST(Node, SubtreeBounds) {
+	Node2D *root = new Node2D();
+	BoundsTestNode *a = new BoundsTestNode(rectangle(0, 0, 10, 10));
+	BoundsTestNode *b = new BoundsTestNode(rectangle(0, 0, 10, 10));
+	a->setPivot(0, 0);
+	b->setPivot(0, 0);
+	root->addChild(a);
+	root->addChild(b);
+
+	b->setPosition(100, 50);
+
+	rectangle bounds;
+	EXPECT_EQ(Node::BoundsFinite, root->getSubtreeBounds(&bounds));
+	EXPECT_FLOAT_EQ(  0.0f, bounds.getMinX());
+	EXPECT_FLOAT_EQ(  0.0f, bounds.getMinY());
+	EXPECT_FLOAT_EQ(110.0f, bounds.getMaxX());
+	EXPECT_FLOAT_EQ( 60.0f, bounds.getMaxY());
+
+	// moving a child needs to update the cached bounds of it's parent
+	b->setPosition(-20, 0);
+
+	EXPECT_EQ(Node::BoundsFinite, root->getSubtreeBounds(&bounds));
+	EXPECT_FLOAT_EQ(-20.0f, bounds.getMinX());
+	EXPECT_FLOAT_EQ( 10.0f, bounds.getMaxX());
+	EXPECT_FLOAT_EQ( 10.0f, bounds.getMaxY());
+
+	// plain nodes have unknown bounds, so their parents cannot be culled
+	Node *unbounded = new Node();
+	a->addChild(unbounded);
+	EXPECT_EQ(Node::BoundsInfinite, root->getSubtreeBounds(&bounds));
+
+	a->removeChild(unbounded);
+	EXPECT_EQ(Node::BoundsFinite, root->getSubtreeBounds(&bounds));
+
+	root->removeChild(a);
+	root->removeChild(b);
+	delete root;
+}
+
+
+/**
+ * Checks if nodes drawing without a content size will not be culled within a viewport.
+ */
+TEST(Node, UnsizedNodesNotCulled) {
+	video::CountingRenderContext *context = new video::CountingRenderContext();
+	Viewport *viewport = new Viewport();
+	viewport->setScaleMode(0, dimension(100, 100), vector2d::zero);
+
+	// a drawing node without any size within a plain container
+	Node2D *container = new Node2D();
+	container->setPosition(50, 50);
+	viewport->addChild(container);
+
+	DrawCountingNode *unsized = new DrawCountingNode();
+	container->addChild(unsized);
+
+	// a sized sibling outside of the viewport must not cause the container to be culled
+	DrawCountingNode *sibling = new DrawCountingNode(dimension(10, 10));
+	sibling->setPosition(1000, 1000);
+	container->addChild(sibling);
+
+	// sized nodes inside and outside of the viewport
+	DrawCountingNode *inside = new DrawCountingNode(dimension(10, 10));
+	inside->setPosition(20, 20);
+	viewport->addChild(inside);
+
+	DrawCountingNode *outside = new DrawCountingNode(dimension(10, 10));
+	outside->setPosition(500, 500);
+	viewport->addChild(outside);
+
+	viewport->render(context);
+	EXPECT_EQ(1, unsized->draws);
+	EXPECT_EQ(0, sibling->draws);
+	EXPECT_EQ(1, inside->draws);
+	EXPECT_EQ(0, outside->draws);
+
+	// plain containers without a size don't prevent culling
+	rectangle bounds;
+	Node2D *empty_container = new Node2D();
+	empty_container->addChild(new DrawCountingNode(dimension(10, 10)));
+	EXPECT_EQ(Node::BoundsFinite, empty_container->getSubtreeBounds(&bounds));
+	EXPECT_EQ(Node::BoundsInfinite, container->getSubtreeBounds(&bounds));
+
+	delete empty_container;
+	viewport->removeChild(container);
+	viewport->removeChild(inside);
+	viewport->removeChild(outside);
+	container->removeChild(unsized);
+	container->removeChild(sibling);
+	delete viewport;
+	delete context;
+}
+
+
+/**
+ * Checks if the world transform of 2D nodes matches their local transforms multiplied.
+ */
+TEST(Node, WorldTransform2D) {
+	Node2D *root = new Node2D();
+	BoundsTestNode *child = new BoundsTestNode(rectangle(-10, -10, 40, 20));
+	root->addChild(child);
+
+	root->setPosition(50, 20);
+	root->setRotation(30);
+	root->setScale(2.0f);
+	child->setPosition(-5, 15);
+	child->setRotation(-45);
+	child->setScaleY(0.5f);
+
+	root->updateTransform();
+	child->updateTransform();
+
+	matrix4x4 expected = child->getLocalTransform() * root->getLocalTransform();
+	for(int i=0; i<16; i++) {
+		EXPECT_NEAR(expected.m[i], child->getWorldTransform().m[i], 0.0001f);
+	}
+
+	root->removeChild(child);
+	delete root;
+}
+
+
+/**
+ * Checks if children notice a moved parent without being flagged dirty themselves.
+ */
+TEST(Node, LazyTransformUpdate) {
+	Node2D *root = new Node2D();
+	Node2D *child = new Node2D();
+	BoundsTestNode *leaf = new BoundsTestNode(rectangle(0, 0, 10, 10));
+	leaf->setPivot(0, 0);
+	root->addChild(child);
+	child->addChild(leaf);
+
+	EXPECT_FLOAT_EQ(0.0f, leaf->getWorldTransform().m14);
+	EXPECT_FALSE(leaf->isTransformDirty());
+
+	uint32_t version = leaf->getWorldTransformVersion();
+
+	// moving the root several times only flags the root itself
+	root->setPosition(10, 0);
+	root->setPosition(20, 0);
+	root->setPosition(30, 5);
+
+	EXPECT_TRUE(leaf->isTransformDirty());
+	EXPECT_FLOAT_EQ(30.0f, leaf->getWorldTransform().m14);
+	EXPECT_FLOAT_EQ( 5.0f, leaf->getWorldTransform().m24);
+	EXPECT_FALSE(leaf->isTransformDirty());
+	EXPECT_NE(version, leaf->getWorldTransformVersion());
+
+	// the cached subtree bounds of the child follow the moved root
+	rectangle bounds;
+	EXPECT_EQ(Node::BoundsFinite, child->getSubtreeBounds(&bounds));
+	EXPECT_FLOAT_EQ(30.0f, bounds.getMinX());
+
+	root->setPosition(-10, 0);
+	EXPECT_EQ(Node::BoundsFinite, child->getSubtreeBounds(&bounds));
+	EXPECT_FLOAT_EQ(-10.0f, bounds.getMinX());
+
+	// changes of unrelated nodes do not recompute the transform
+	version = leaf->getWorldTransformVersion();
+	Node2D *other = new Node2D();
+	other->setPosition(1, 1);
+	EXPECT_EQ(version, leaf->getWorldTransformVersion());
+	delete other;
+
+	child->removeChild(leaf);
+	root->removeChild(child);
+	delete root;
+}
+
+
+
+/**
+ * Checks if the parallel update of a scene computes the same transforms like the serial update.
+ */
+TEST(Node, ParallelTransformUpdate) {
+	Scene *scene = new Scene();
+	JobSystem jobs(3);
+
+	std::vector<Node2D*> leaves;
+	for(int i=0; i<4; i++) {
+		Node2D *layer = new Node2D();
+		layer->setPosition(static_cast<float>(i) * 10.0f, 0.0f);
+		scene->addChild(layer);
+
+		for(int j=0; j<20; j++) {
+			Node2D *leaf = new Node2D();
+			leaf->setPosition(0.0f, static_cast<float>(j));
+			leaf->setRotation(static_cast<float>(j) * 5.0f);
+			layer->addChild(leaf);
+			leaves.push_back(leaf);
+		}
+	}
+
+	scene->updateTransforms(&jobs);
+
+	for(std::vector<Node2D*>::iterator it=leaves.begin(); it!=leaves.end(); it++) {
+		Node2D *leaf = *it;
+		EXPECT_FALSE(leaf->isTransformDirty());
+
+		matrix4x4 expected = leaf->getLocalTransform() * leaf->getParent()->getLocalTransform() * scene->getLocalTransform();
+		for(int i=0; i<16; i++) {
+			EXPECT_NEAR(expected.m[i], leaf->getWorldTransform().m[i], 0.0001f);
+		}
+	}
+
+	while(scene->getChildren()->empty() == false) {
+		Node *layer = scene->getChildren()->back();
+
+		while(layer->getChildren()->empty() == false) {
+			layer->removeChild(layer->getChildren()->back());
+		}
+
+		scene->removeChild(layer);
+	}
+
+	delete scene;
+}
+
+
+/**
+ * Checks if subtrees containing nodes, which depend on their parent's transform,
+ * will be updated on the calling thread.
+ */
+TEST(Node, ParentDependentTransformOnCallingThread) {
+	Scene *scene = new Scene();
+	JobSystem jobs(3);
+	is_test_thread = true;
+
+	std::vector<ParentDependentNode*> dependent;
+	for(int i=0; i<8; i++) {
+		Node2D *layer = new Node2D();
+		scene->addChild(layer);
+
+		for(int j=0; j<4; j++) {
+			ParentDependentNode *node = new ParentDependentNode();
+			layer->addChild(node);
+			dependent.push_back(node);
+		}
+	}
+
+	scene->updateTransforms(&jobs);
+
+	for(std::vector<ParentDependentNode*>::iterator it=dependent.begin(); it!=dependent.end(); it++) {
+		EXPECT_TRUE((*it)->computed);
+		EXPECT_TRUE((*it)->computed_on_test_thread);
+	}
+
+	while(scene->getChildren()->empty() == false) {
+		Node *layer = scene->getChildren()->back();
+
+		while(layer->getChildren()->empty() == false) {
+			layer->removeChild(layer->getChildren()->back());
+		}
+
+		scene->removeChild(layer);
+	}
+
+	delete scene;
+}
+
+
+/**
+ * Checks if children stay sorted by their order key, keeping the insertion order of equal keys.
+ */
+TEST(Node, ChildOrder) {
+	Node *root = new Node();
+	Node *a = new Node();
+	Node *b = new Node();
+	Node *c = new Node();
+	Node *d = new Node();
+	Node *e = new Node();
+
+	root->addChild(a, 1);
+	root->addChild(b, 0);
+	root->addChild(c, 1);
+	root->addChild(d, -1);
+
+	ASSERT_EQ(4u, root->getChildren()->size());
+	EXPECT_EQ(d, root->getChildren()->at(0));
+	EXPECT_EQ(b, root->getChildren()->at(1));
+	EXPECT_EQ(a, root->getChildren()->at(2));
+	EXPECT_EQ(c, root->getChildren()->at(3));
+
+	// removing from the middle keeps the order of all other children
+	root->removeChild(b);
+	root->addChild(e, 1);
+
+	ASSERT_EQ(4u, root->getChildren()->size());
+	EXPECT_EQ(d, root->getChildren()->at(0));
+	EXPECT_EQ(a, root->getChildren()->at(1));
+	EXPECT_EQ(c, root->getChildren()->at(2));
+	EXPECT_EQ(e, root->getChildren()->at(3));
+
+	for(size_t i=0; i<root->getChildren()->size(); i++) {
+		EXPECT_EQ(i, root->getChildren()->at(i)->getChildIndex());
+	}
+
+	// add a list of children at once
+	NodeList list;
+	list.push_back(new Node());
+	list.push_back(new Node());
+	EXPECT_TRUE(root->addChildren(list, 0));
+
+	ASSERT_EQ(6u, root->getChildren()->size());
+	EXPECT_EQ(d,       root->getChildren()->at(0));
+	EXPECT_EQ(list[0], root->getChildren()->at(1));
+	EXPECT_EQ(list[1], root->getChildren()->at(2));
+	EXPECT_EQ(a,       root->getChildren()->at(3));
+
+	while(root->getChildren()->empty() == false) {
+		root->removeChild(root->getChildren()->front());
+	}
+
+	delete root;
+}
+
+
+
+class OffsetTransformNode : public Node2D
+{
+public:
+	virtual void computeLocalTransform(matrix4x4 *transform) {
+		Node2D::computeLocalTransform(transform);
+		transform->translate(0.0f, 0.0f, 5.0f);
+	}
+};
+
+
+/**
+ * Checks if subclasses overriding computeLocalTransform are not skipped by the 2D fast path.
+ */
+TEST(Node, OverriddenLocalTransform) {
+	Node2D *root = new Node2D();
+	OffsetTransformNode *child = new OffsetTransformNode();
+	root->setPosition(10.0f, 20.0f);
+	child->setPosition(1.0f, 2.0f);
+	root->addChild(child);
+
+	root->updateSubtreeTransforms();
+
+	matrix4x4 expected = child->getLocalTransform() * root->getLocalTransform();
+	for(int i=0; i<16; i++) {
+		EXPECT_NEAR(expected.m[i], child->getWorldTransform().m[i], 0.0001f);
+	}
+
+	// the translation on the z axis is only added by the subclass
+	EXPECT_FLOAT_EQ(11.0f, child->getWorldTransform().m[3]);
+	EXPECT_FLOAT_EQ(22.0f, child->getWorldTransform().m[7]);
+	EXPECT_FLOAT_EQ( 5.0f, child->getWorldTransform().m[11]);
+
+	root->removeChild(child);
+	delete root;
+}
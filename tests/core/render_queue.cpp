@@ -0,0 +1,95 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "gtest/gtest.h"
+
+#include <wiesel/video/render_queue.h>
+
+#include <vector>
+
+
+using namespace wiesel;
+using namespace wiesel::video;
+
+
+
+/**
+ * Checks if the parts of a sort key are ordered by their priority.
+ */
+TEST(RenderQueue, SortKeyPriority) {
+	// the layer has the highest priority
+	EXPECT_LT(
+			RenderQueue::createSortKey(0, 100, 100, 100, 100),
+			RenderQueue::createSortKey(1,   0,   0,   0,   0)
+	);
+
+	// followed by the order key
+	EXPECT_LT(
+			RenderQueue::createSortKey(0, 0, 100, 100, 100),
+			RenderQueue::createSortKey(0, 1,   0,   0,   0)
+	);
+
+	// the shader is more important than the texture
+	EXPECT_LT(
+			RenderQueue::createSortKey(0, 0, 1, 100, 100),
+			RenderQueue::createSortKey(0, 0, 2,   0,   0)
+	);
+
+	// values exceeding their range are clamped instead of overflowing into other parts
+	EXPECT_LT(
+			RenderQueue::createSortKey(0, 0, 0xffffffff, 0, 0),
+			RenderQueue::createSortKey(0, 1, 0,          0, 0)
+	);
+}
+
+
+/**
+ * Checks if the radix sort orders all keys and keeps the order of equal keys.
+ */
+TEST(RenderQueue, RadixSortIsStable) {
+	const uint64_t keys[] = {
+			RenderQueue::createSortKey(1, 0, 2, 1, 0),
+			RenderQueue::createSortKey(0, 3, 1, 1, 0),
+			RenderQueue::createSortKey(0, 3, 1, 1, 0),
+			RenderQueue::createSortKey(0, 0, 2, 5, 0),
+			RenderQueue::createSortKey(0, 3, 1, 1, 0),
+			RenderQueue::createSortKey(0, 0, 1, 7, 9),
+	};
+
+	const size_t count = sizeof(keys) / sizeof(keys[0]);
+
+	std::vector<RenderQueue::SortItem> items(count);
+	std::vector<RenderQueue::SortItem> scratch(count);
+
+	for(size_t i=0; i<count; i++) {
+		items[i].key   = keys[i];
+		items[i].index = static_cast<uint32_t>(i);
+	}
+
+	RenderQueue::radixSort(&items[0], &scratch[0], count);
+
+	const uint32_t expected[] = { 5, 3, 1, 2, 4, 0 };
+
+	for(size_t i=0; i<count; i++) {
+		EXPECT_EQ(expected[i], items[i].index);
+	}
+}
+
@@ -0,0 +1,85 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "gtest/gtest.h"
+
+#include <wiesel/video/render_statistics.h>
+
+
+using namespace wiesel;
+using namespace wiesel::video;
+
+
+
+/**
+ * Checks the number of primitives and vertices counted for each primitive type.
+ */
+TEST(RenderStatistics, CountDrawCall) {
+	RenderStatistics statistics;
+	EXPECT_EQ(0u, statistics.draw_calls);
+
+	statistics.countDrawCall(Triangles, 6);
+	EXPECT_EQ(1u, statistics.draw_calls);
+	EXPECT_EQ(2u, statistics.primitives);
+	EXPECT_EQ(6u, statistics.vertices);
+
+	statistics.countDrawCall(TriangleStrip, 4);
+	EXPECT_EQ(2u, statistics.draw_calls);
+	EXPECT_EQ(4u, statistics.primitives);
+	EXPECT_EQ(10u, statistics.vertices);
+
+	// each instance draws all vertices
+	statistics.countDrawCall(TriangleFan, 5, 10);
+	EXPECT_EQ(3u, statistics.draw_calls);
+	EXPECT_EQ(34u, statistics.primitives);
+	EXPECT_EQ(60u, statistics.vertices);
+}
+
+
+/**
+ * Checks if statistics can be accumulated and cleared.
+ */
+TEST(RenderStatistics, AddAndReset) {
+	RenderStatistics a;
+	a.countDrawCall(Triangles, 3);
+	a.texture_binds			= 2;
+	a.buffer_upload_bytes	= 1024;
+
+	RenderStatistics b;
+	b.countDrawCall(Triangles, 3);
+	b.shader_switches		= 1;
+	b.buffer_upload_bytes	= 512;
+
+	a += b;
+	EXPECT_EQ(2u,		a.draw_calls);
+	EXPECT_EQ(2u,		a.primitives);
+	EXPECT_EQ(1u,		a.shader_switches);
+	EXPECT_EQ(2u,		a.texture_binds);
+	EXPECT_EQ(1536u,	a.buffer_upload_bytes);
+
+	a.reset();
+	EXPECT_EQ(0u,		a.draw_calls);
+	EXPECT_EQ(0u,		a.primitives);
+	EXPECT_EQ(0u,		a.vertices);
+	EXPECT_EQ(0u,		a.shader_switches);
+	EXPECT_EQ(0u,		a.texture_binds);
+	EXPECT_EQ(0u,		a.buffer_upload_bytes);
+}
@@ -0,0 +1,96 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "gtest/gtest.h"
+
+#include <wiesel/video/shader_constantbuffer.h>
+#include <wiesel/video/shader_constantbuffer_builder.h>
+
+
+using namespace wiesel;
+using namespace wiesel::video;
+
+
+
+/**
+ * Checks if writing a value only marks the written entry as changed.
+ */
+TEST(ShaderConstantBuffer, EntryChangeVersions) {
+	ShaderConstantBufferTemplateBuilder builder;
+	builder.addEntry(TypeFloat,    1, "a");
+	builder.addEntry(TypeVector2f, 1, "b");
+	builder.addEntry(TypeFloat,    4, "c");
+
+	ShaderConstantBufferTemplate *buffer_template = keep(builder.create());
+	ShaderConstantBuffer *buffer = keep(new ShaderConstantBuffer(buffer_template));
+
+	// nothing was synced yet, so each entry counts as changed
+	ShaderConstantBuffer::version_t version = buffer->getChangeVersion();
+	EXPECT_TRUE(buffer->hasEntryChangedSince(0, 0));
+	EXPECT_TRUE(buffer->hasEntryChangedSince(1, 0));
+	EXPECT_TRUE(buffer->hasEntryChangedSince(2, 0));
+
+	// write a single value by index
+	EXPECT_TRUE(buffer->setShaderValueAt(1, vector2d(1.0f, 2.0f)));
+	EXPECT_NE(version, buffer->getChangeVersion());
+	EXPECT_FALSE(buffer->hasEntryChangedSince(0, version));
+	EXPECT_TRUE( buffer->hasEntryChangedSince(1, version));
+	EXPECT_FALSE(buffer->hasEntryChangedSince(2, version));
+
+	// write a value by name
+	version = buffer->getChangeVersion();
+	EXPECT_TRUE(buffer->setShaderValue("a", 3.0f));
+	EXPECT_TRUE( buffer->hasEntryChangedSince(0, version));
+	EXPECT_FALSE(buffer->hasEntryChangedSince(1, version));
+
+	// raw writes mark each entry overlapping the written range
+	version = buffer->getChangeVersion();
+	float values[2] = { 4.0f, 5.0f };
+	EXPECT_TRUE(buffer->writeDataAtOffset(buffer_template->findEntry("b")->offset + sizeof(float), values, sizeof(values)));
+	EXPECT_FALSE(buffer->hasEntryChangedSince(0, version));
+	EXPECT_TRUE( buffer->hasEntryChangedSince(1, version));
+	EXPECT_TRUE( buffer->hasEntryChangedSince(2, version));
+
+	release(buffer);
+	release(buffer_template);
+}
+
+
+/**
+ * Checks if writing an unchanged value keeps the buffer's version.
+ */
+TEST(ShaderConstantBuffer, UnchangedValueKeepsVersion) {
+	ShaderConstantBufferTemplateBuilder builder;
+	builder.addEntry(TypeMatrix4x4f, 1, "m");
+
+	ShaderConstantBufferTemplate *buffer_template = keep(builder.create());
+	ShaderConstantBuffer *buffer = keep(new ShaderConstantBuffer(buffer_template));
+
+	EXPECT_TRUE(buffer->setShaderValueAt(0, matrix4x4::identity));
+	ShaderConstantBuffer::version_t version = buffer->getChangeVersion();
+
+	EXPECT_TRUE(buffer->setShaderValueAt(0, matrix4x4::identity));
+	EXPECT_EQ(version, buffer->getChangeVersion());
+	EXPECT_FALSE(buffer->hasEntryChangedSince(0, version));
+
+	release(buffer);
+	release(buffer_template);
+}
@@ -0,0 +1,121 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "gtest/gtest.h"
+
+#include <wiesel/graph/2d/node2d.h>
+#include <wiesel/graph/spatial_index.h>
+
+
+using namespace wiesel;
+
+
+
+class IndexTestNode : public Node2D
+{
+public:
+	IndexTestNode(float x, float y, float w, float h) {
+		setPivot(0, 0);
+		setBounds(rectangle(0, 0, w, h));
+		setPosition(x, y);
+	}
+};
+
+
+
+/**
+ * Checks point and area queries on a spatial grid.
+ */
+TEST(SpatialIndex, GridQueries) {
+	SpatialGrid grid(10.0f);
+	grid.insert(1, rectangle(  0,  0,   5,   5));
+	grid.insert(2, rectangle( 25, 25,  10,  10));
+	grid.insert(3, rectangle(-50,-50, 500, 500));
+
+	SpatialGrid::ItemList items;
+	grid.findItemsAt(vector2d(2, 2), &items);
+	EXPECT_EQ(2u, items.size());
+
+	items.clear();
+	grid.findItemsIn(rectangle(20, 20, 10, 10), &items);
+	ASSERT_EQ(2u, items.size());
+
+	// moving an item
+	grid.insert(1, rectangle(100, 100, 5, 5));
+	items.clear();
+	grid.findItemsAt(vector2d(2, 2), &items);
+	ASSERT_EQ(1u, items.size());
+	EXPECT_EQ(3u, items[0]);
+
+	grid.remove(3);
+	items.clear();
+	grid.findItemsAt(vector2d(2, 2), &items);
+	EXPECT_TRUE(items.empty());
+}
+
+
+/**
+ * Checks if the scene index follows changes of nodes and sorts results by their draw order.
+ */
+TEST(SpatialIndex, NodesByDrawOrder) {
+	Node2D *root = new Node2D();
+	IndexTestNode *back  = new IndexTestNode(0, 0, 10, 10);
+	IndexTestNode *front = new IndexTestNode(5, 5, 10, 10);
+	IndexTestNode *below = new IndexTestNode(0, 0, 50, 50);
+	root->addChild(back,   0);
+	root->addChild(front,  1);
+	root->addChild(below, -1);
+
+	SpatialIndex *index = new SpatialIndex(root, 16.0f);
+
+	NodeList nodes;
+	index->findNodesAt(vector2d(7, 7), &nodes);
+	ASSERT_EQ(3u, nodes.size());
+	EXPECT_EQ(front, nodes[0]);
+	EXPECT_EQ(back,  nodes[1]);
+	EXPECT_EQ(below, nodes[2]);
+
+	EXPECT_TRUE(SpatialIndex::isInFrontOf(front, back));
+	EXPECT_TRUE(SpatialIndex::isInFrontOf(back, root));
+	EXPECT_TRUE(SpatialIndex::isInFrontOf(root, below));
+
+	// moved nodes are updated on the next query
+	front->setPosition(100, 100);
+	nodes.clear();
+	index->findNodesAt(vector2d(7, 7), &nodes);
+	EXPECT_EQ(2u, nodes.size());
+
+	nodes.clear();
+	index->findNodesIn(rectangle(90, 90, 20, 20), &nodes);
+	ASSERT_EQ(1u, nodes.size());
+	EXPECT_EQ(front, nodes[0]);
+
+	// removed nodes are removed from the index
+	root->removeChild(front);
+	EXPECT_EQ(2u, index->size());
+
+	delete index;
+
+	root->removeChild(back);
+	root->removeChild(below);
+	delete root;
+}
+
@@ -0,0 +1,279 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "gtest/gtest.h"
+#include "counting_render_context.h"
+
+#include <wiesel/graph/static_batch_node.h>
+#include <wiesel/graph/2d/rect_shape_node.h>
+#include <wiesel/video/indexbuffer.h>
+#include <wiesel/video/render_buffer.h>
+#include <wiesel/video/render_context.h>
+#include <wiesel/video/shader_builder.h>
+#include <wiesel/video/shader_constantbuffer_builder.h>
+#include <wiesel/video/vertexbuffer.h>
+
+
+using namespace wiesel;
+using namespace wiesel::video;
+
+
+
+/**
+ * Reads the x coordinate of a single vertex.
+ */
+static float getVertexX(const VertexBuffer *vertices, unsigned int index) {
+	float position[3] = { 0.0f, 0.0f, 0.0f };
+	VertexBuffer::readComponent(
+			vertices->getDataPtr() + (vertices->getVertexSize() * index),
+			vertices->getPositionDescription(),
+			position
+	);
+
+	return position[0];
+}
+
+
+/**
+ * A node drawing a triangle directly, bypassing the capture of draw calls.
+ */
+class DirectDrawNode : public Node
+{
+public:
+	DirectDrawNode() {
+		vertices = keep(new VertexBuffer());
+		vertices->setupVertexPositions(2);
+		vertices->addVertex(0.0f, 0.0f);
+		vertices->addVertex(10.0f, 0.0f);
+		vertices->addVertex(0.0f, 10.0f);
+	}
+
+	virtual ~DirectDrawNode() {
+		release(vertices);
+	}
+
+protected:
+	virtual void onDraw(RenderContext *render_context) {
+		render_context->draw(Triangles, vertices);
+	}
+
+private:
+	VertexBuffer*	vertices;
+};
+
+
+/**
+ * A node rendering its children into another render target.
+ */
+class RenderTargetNode : public Node
+{
+public:
+	RenderTargetNode() {
+		render_buffer = keep(new RenderBuffer());
+	}
+
+	virtual ~RenderTargetNode() {
+		release(render_buffer);
+	}
+
+	virtual void render(RenderContext *render_context) {
+		render_context->pushRenderBuffer(render_buffer);
+		Node::render(render_context);
+		render_context->popRenderBuffer(render_buffer);
+	}
+
+private:
+	RenderBuffer*	render_buffer;
+};
+
+
+
+/**
+ * Checks if a static subtree will be drawn with a single draw call
+ * and baked again only after a change.
+ */
+TEST(StaticBatchNode, BakeAndRebake) {
+	CountingRenderContext *context = new CountingRenderContext();
+	context->setBatchingEnabled(false);
+
+	StaticBatchNode *batch = new StaticBatchNode();
+
+	RectShapeNode *shapes[3];
+	for(int i=0; i<3; i++) {
+		shapes[i] = new RectShapeNode(10, 10);
+		shapes[i]->setPivot(0, 0);
+		shapes[i]->setPosition(i * 20.0f, 0.0f);
+		shapes[i]->setColor(1, 1, 1, 1);
+		batch->addChild(shapes[i]);
+	}
+
+	batch->render(context);
+	EXPECT_TRUE(batch->isBaked());
+	EXPECT_EQ(1u, batch->getNumberOfMeshes());
+	EXPECT_EQ(1, context->draw_calls);
+
+	// the vertices are stored in world space
+	ASSERT_TRUE(context->last_vertices != NULL);
+	ASSERT_EQ(12u, context->last_vertices->getSize());
+	EXPECT_FLOAT_EQ(40.0f, getVertexX(context->last_vertices, 8));
+
+	// nothing changed, so the same mesh is drawn again
+	const VertexBuffer *baked_vertices = context->last_vertices;
+	batch->render(context);
+	EXPECT_EQ(2, context->draw_calls);
+	EXPECT_EQ(baked_vertices, context->last_vertices);
+
+	// moving a child requires baking again
+	shapes[2]->setPosition(100.0f, 0.0f);
+	batch->render(context);
+	EXPECT_EQ(3, context->draw_calls);
+	ASSERT_TRUE(context->last_vertices != NULL);
+	EXPECT_FLOAT_EQ(100.0f, getVertexX(context->last_vertices, 8));
+
+	// without baking, each child is drawn separately
+	batch->setBakingEnabled(false);
+	batch->render(context);
+	EXPECT_EQ(6, context->draw_calls);
+
+	delete batch;
+	delete context;
+}
+
+
+/**
+ * Checks if geometry with different constant buffer values will be kept in separate meshes.
+ */
+TEST(StaticBatchNode, ConstantBufferValues) {
+	CountingRenderContext *context = new CountingRenderContext();
+	context->setBatchingEnabled(false);
+
+	ShaderConstantBufferTemplateBuilder template_builder;
+	template_builder.addEntry(TypeFloat, 1, "intensity");
+	ShaderConstantBufferTemplate *buffer_template = keep(template_builder.create());
+
+	ShaderBuilder shader_builder;
+	shader_builder.addConstantBuffer("material", Shader::Context_FragmentShader, buffer_template);
+	Shader *shader = keep(shader_builder.create());
+
+	StaticBatchNode *batch = new StaticBatchNode();
+
+	RectShapeNode *shapes[2];
+	for(int i=0; i<2; i++) {
+		shapes[i] = new RectShapeNode(10, 10);
+		shapes[i]->setPosition(i * 20.0f, 0.0f);
+		shapes[i]->setShader(shader);
+		batch->addChild(shapes[i]);
+	}
+
+	// both shapes differ only in a single constant
+	shapes[0]->setShaderValue("intensity", 0.5f);
+	shapes[1]->setShaderValue("intensity", 1.0f);
+
+	batch->render(context);
+	EXPECT_TRUE(batch->isBaked());
+	EXPECT_EQ(2u, batch->getNumberOfMeshes());
+	EXPECT_EQ(2, context->draw_calls);
+
+	// with equal content, both shapes can share a single mesh
+	shapes[1]->setShaderValue("intensity", 0.5f);
+	batch->render(context);
+	EXPECT_EQ(1u, batch->getNumberOfMeshes());
+	EXPECT_EQ(3, context->draw_calls);
+
+	// changing a constant of a merged shape requires baking again
+	shapes[1]->setShaderValue("intensity", 0.75f);
+	batch->render(context);
+	EXPECT_EQ(2u, batch->getNumberOfMeshes());
+	EXPECT_EQ(5, context->draw_calls);
+
+	delete batch;
+	release(shader);
+	release(buffer_template);
+	delete context;
+}
+
+
+/**
+ * Checks if subtrees drawing directly will be rendered as usual instead of being baked.
+ */
+TEST(StaticBatchNode, DirectDrawsNotBaked) {
+	CountingRenderContext *context = new CountingRenderContext();
+	context->setBatchingEnabled(false);
+
+	StaticBatchNode *batch = new StaticBatchNode();
+	batch->addChild(new DirectDrawNode());
+
+	// the direct draw call happens while baking, which fails
+	batch->render(context);
+	EXPECT_FALSE(batch->isBaked());
+	EXPECT_EQ(0u, batch->getNumberOfMeshes());
+
+	// the child is still drawn in each following frame
+	int draw_calls = context->draw_calls;
+	batch->render(context);
+	EXPECT_EQ(draw_calls + 1, context->draw_calls);
+	batch->render(context);
+	EXPECT_EQ(draw_calls + 2, context->draw_calls);
+
+	// mixed with bakeable children, all children are drawn separately
+	RectShapeNode *shape = new RectShapeNode(10, 10);
+	shape->setColor(1, 1, 1, 1);
+	batch->addChild(shape);
+
+	batch->render(context);
+	EXPECT_FALSE(batch->isBaked());
+
+	draw_calls = context->draw_calls;
+	batch->render(context);
+	EXPECT_EQ(draw_calls + 2, context->draw_calls);
+
+	delete batch;
+	delete context;
+}
+
+
+/**
+ * Checks if subtrees drawing into another render target will not be baked.
+ */
+TEST(StaticBatchNode, RenderTargetsNotBaked) {
+	CountingRenderContext *context = new CountingRenderContext();
+	context->setBatchingEnabled(false);
+
+	RectShapeNode *shape = new RectShapeNode(10, 10);
+	shape->setColor(1, 1, 1, 1);
+
+	RenderTargetNode *target = new RenderTargetNode();
+	target->addChild(shape);
+
+	StaticBatchNode *batch = new StaticBatchNode();
+	batch->addChild(target);
+
+	batch->render(context);
+	EXPECT_FALSE(batch->isBaked());
+	EXPECT_EQ(0u, batch->getNumberOfMeshes());
+	EXPECT_EQ(1, context->draw_calls);
+
+	batch->render(context);
+	EXPECT_EQ(2, context->draw_calls);
+
+	delete batch;
+	delete context;
+}
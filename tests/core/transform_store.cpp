@@ -0,0 +1,103 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "gtest/gtest.h"
+
+#include <wiesel/graph/2d/node2d.h>
+#include <wiesel/graph/transform_store.h>
+
+
+using namespace wiesel;
+
+
+
+/**
+ * Compares the world transform of a node with the product of all local transforms up to the root.
+ */
+static void expectWorldTransform(Node *node) {
+	matrix4x4 expected = node->getLocalTransform();
+	for(Node *parent=node->getParent(); parent; parent=parent->getParent()) {
+		expected *= parent->getLocalTransform();
+	}
+
+	for(int i=0; i<16; i++) {
+		EXPECT_NEAR(expected.m[i], node->getWorldTransform().m[i], 0.0001f);
+	}
+}
+
+
+
+/**
+ * Checks if the store computes the same world transforms like each single node.
+ */
+TEST(TransformStore, WorldTransforms) {
+	Node2D *root  = new Node2D();
+	Node2D *child = new Node2D();
+	Node2D *leaf  = new Node2D();
+	root->addChild(child);
+	child->addChild(leaf);
+
+	root->setPosition(10, 20);
+	child->setRotation(45);
+	leaf->setPosition(5, 0);
+	leaf->setScale(2.0f);
+
+	TransformStore *store = new TransformStore(root);
+	store->update();
+	EXPECT_EQ(3u, store->size());
+	EXPECT_FALSE(store->isDirty());
+	expectWorldTransform(leaf);
+
+	// moving the root needs to update all children within the next update
+	uint32_t version = leaf->getWorldTransformVersion();
+	root->setPosition(-30, 0);
+	EXPECT_TRUE(leaf->isTransformDirty());
+	expectWorldTransform(leaf);
+	EXPECT_NE(version, leaf->getWorldTransformVersion());
+
+	// changing the leaf does not affect it's parents
+	version = child->getWorldTransformVersion();
+	leaf->setRotation(90);
+	expectWorldTransform(leaf);
+	EXPECT_EQ(version, child->getWorldTransformVersion());
+
+	// added nodes will be stored on the next update
+	Node2D *added = new Node2D();
+	added->setPosition(3, 4);
+	leaf->addChild(added);
+	expectWorldTransform(added);
+	EXPECT_EQ(4u, store->size());
+
+	// removed nodes will be updated by themselves again
+	leaf->removeChild(added);
+	store->update();
+	EXPECT_EQ(3u, store->size());
+
+	delete store;
+
+	// after removing the store, nodes are updated one by one again
+	root->setPosition(0, 0);
+	expectWorldTransform(leaf);
+
+	child->removeChild(leaf);
+	root->removeChild(child);
+	delete root;
+}
@@ -0,0 +1,105 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "gtest/gtest.h"
+
+#include <wiesel/engine_interfaces.h>
+#include <wiesel/util/job_system.h>
+
+#include <vector>
+
+
+using namespace wiesel;
+
+
+
+class SharedCounter : public virtual SharedObject
+{
+};
+
+
+class CountingUpdateable : public IUpdateable
+{
+public:
+	CountingUpdateable(SharedCounter *shared, bool thread_safe) :
+		shared(shared), thread_safe(thread_safe), updates(0), elapsed(0.0f)
+	{}
+
+	virtual void update(float dt) {
+		// the reference counter may be changed by other updateables at the same time
+		for(int i=0; i<1000; i++) {
+			keep(shared);
+			release(shared);
+		}
+
+		++updates;
+		elapsed += dt;
+	}
+
+	virtual bool isThreadSafe() const {
+		return thread_safe;
+	}
+
+	SharedCounter*	shared;
+	bool			thread_safe;
+	int				updates;
+	float			elapsed;
+};
+
+
+
+/**
+ * Checks if thread-safe updateables will be updated concurrently exactly once,
+ * while all other updateables will be skipped.
+ */
+TEST(Updateable, ThreadSafeUpdateables) {
+	JobSystem jobs(3);
+	SharedCounter *shared = keep(new SharedCounter());
+
+	std::vector<IUpdateable*> updateables;
+	for(int i=0; i<32; i++) {
+		updateables.push_back(keep(new CountingUpdateable(shared, (i % 4) != 0)));
+	}
+
+	for(int frame=0; frame<10; frame++) {
+		updateThreadSafeUpdateables(&jobs, updateables, 0.5f);
+	}
+
+	// the same without a job system
+	updateThreadSafeUpdateables(NULL, updateables, 0.5f);
+
+	for(std::vector<IUpdateable*>::iterator it=updateables.begin(); it!=updateables.end(); it++) {
+		CountingUpdateable *updateable = dynamic_cast<CountingUpdateable*>(*it);
+
+		if (updateable->isThreadSafe()) {
+			EXPECT_EQ(11, updateable->updates);
+			EXPECT_FLOAT_EQ(5.5f, updateable->elapsed);
+		}
+		else {
+			EXPECT_EQ(0, updateable->updates);
+		}
+
+		release(updateable);
+	}
+
+	EXPECT_EQ(1, shared->getReferenceCount());
+	release(shared);
+}
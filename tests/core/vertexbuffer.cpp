@@ -0,0 +1,348 @@
+/**
+ * Copyright (C) 2012
+ * Christian Fischer
+ *
+ * https://bitbucket.org/baldur/wiesel/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ */
+#include "gtest/gtest.h"
+
+#include <wiesel/video/indexbuffer.h>
+#include <wiesel/video/typed_vertexbuffer.h>
+
+#include <string.h>
+
+
+using namespace wiesel;
+using namespace wiesel::video;
+
+
+
+/**
+ * Checks if the layout of a typed vertex buffer matches its vertex structure.
+ */
+TEST(VertexBuffer, TypedLayout) {
+	TVertexBuffer<VertexP2T2> *vbo_p2t2 = new TVertexBuffer<VertexP2T2>();
+	EXPECT_EQ(sizeof(VertexP2T2), vbo_p2t2->getVertexSize());
+	EXPECT_EQ(2, vbo_p2t2->getVertexDimensions());
+	EXPECT_EQ(0, vbo_p2t2->getVertexColorComponents());
+	EXPECT_EQ(1, vbo_p2t2->getNumberOfTextureLayers());
+	delete vbo_p2t2;
+
+	TVertexBuffer<VertexP2C4T2> *vbo_p2c4t2 = new TVertexBuffer<VertexP2C4T2>();
+	EXPECT_EQ(sizeof(VertexP2C4T2), vbo_p2c4t2->getVertexSize());
+	EXPECT_EQ(2, vbo_p2c4t2->getVertexDimensions());
+	EXPECT_EQ(4, vbo_p2c4t2->getVertexColorComponents());
+	EXPECT_EQ(1, vbo_p2c4t2->getNumberOfTextureLayers());
+	delete vbo_p2c4t2;
+
+	TVertexBuffer<SpriteInstance> *vbo_instances = new TVertexBuffer<SpriteInstance>();
+	EXPECT_EQ(sizeof(SpriteInstance), vbo_instances->getVertexSize());
+	EXPECT_EQ(36u, sizeof(SpriteInstance));
+	EXPECT_EQ(4, vbo_instances->getVertexColorComponents());
+	EXPECT_EQ(3, vbo_instances->getNumberOfTextureLayers());
+	EXPECT_EQ(12, vbo_instances->getTextureDescription(0).offset);
+	EXPECT_EQ(28, vbo_instances->getTextureDescription(2).offset);
+	delete vbo_instances;
+}
+
+
+/**
+ * Checks if vertices written as structs and via cursor result in the same data.
+ */
+TEST(VertexBuffer, TypedAndCursorWrites) {
+	TVertexBuffer<VertexP2T2> *typed = new TVertexBuffer<VertexP2T2>();
+	VertexP2T2 *vertices = typed->allocVertices(2);
+	vertices[0] = VertexP2T2(1.0f, 2.0f, 0.25f, 0.5f);
+	vertices[1] = VertexP2T2(3.0f, 4.0f, 0.75f, 1.0f);
+
+	VertexBuffer *generic = new VertexBuffer();
+	generic->setupVertexPositions(2);
+	generic->setupTextureLayer(0);
+	generic->addVertices(2)
+			.position(1.0f, 2.0f).texcoord(0.25f, 0.5f).next()
+			.position(3.0f, 4.0f).texcoord(0.75f, 1.0f).next();
+
+	ASSERT_EQ(2u, typed->getSize());
+	ASSERT_EQ(2u, generic->getSize());
+	EXPECT_EQ(0, memcmp(typed->getDataPtr(), generic->getDataPtr(), 2 * sizeof(VertexP2T2)));
+	EXPECT_FLOAT_EQ(3.0f, typed->getVertex(1).x);
+	EXPECT_FLOAT_EQ(1.0f, typed->getVertex(1).v);
+
+	delete typed;
+	delete generic;
+}
+
+
+/**
+ * Checks adding and editing vertices via cursor, the buffer growth and reset.
+ */
+TEST(VertexBuffer, AddVertices) {
+	VertexBuffer *vbo = new VertexBuffer();
+	vbo->setupVertexPositions(2);
+	vbo->setupVertexColors(4);
+
+	VertexBuffer::Cursor cursor = vbo->addVertices(3);
+	EXPECT_EQ(vbo->getDataPtr(), cursor.getPtr());
+	EXPECT_EQ(3u, vbo->getSize());
+	EXPECT_EQ(3u, vbo->getCapacity());
+
+	for(int i=0; i<3; i++) {
+		cursor.position(float(i), float(i * 2)).color(0.0f, 0.5f, 1.0f).next();
+	}
+
+	// the buffer grows geometrically
+	VertexBuffer::Cursor appended = vbo->addVertices(1);
+	EXPECT_EQ(vbo->getDataPtr() + 3 * vbo->getVertexSize(), appended.getPtr());
+	EXPECT_EQ(4u, vbo->getSize());
+	EXPECT_EQ(6u, vbo->getCapacity());
+	appended.position(7.0f, 8.0f).color(1.0f, 1.0f, 1.0f, 0.0f);
+
+	// edit an existing vertex
+	vbo->editVertices(1, 1).position(5.0f, 6.0f);
+
+	const float expected[4][2] = { { 0.0f, 0.0f }, { 5.0f, 6.0f }, { 2.0f, 4.0f }, { 7.0f, 8.0f } };
+	for(int i=0; i<4; i++) {
+		float position[2];
+		float color[4];
+		const unsigned char *vertex = vbo->getDataPtr() + i * vbo->getVertexSize();
+		VertexBuffer::readComponent(vertex, vbo->getPositionDescription(), position);
+		VertexBuffer::readComponent(vertex, vbo->getColorDescription(),    color);
+		EXPECT_FLOAT_EQ(expected[i][0], position[0]);
+		EXPECT_FLOAT_EQ(expected[i][1], position[1]);
+		EXPECT_FLOAT_EQ(i == 3 ? 0.0f : 1.0f, color[3]);
+	}
+
+	// copy raw vertex data
+	VertexBuffer::index_t first = vbo->addVertices(vbo->getDataPtr(), 2);
+	EXPECT_EQ(4u, first);
+	EXPECT_EQ(6u, vbo->getSize());
+	EXPECT_EQ(0, memcmp(vbo->getDataPtr(), vbo->getDataPtr() + 4 * vbo->getVertexSize(), 2 * vbo->getVertexSize()));
+
+	// reset keeps the allocated memory
+	vbo->reset();
+	EXPECT_EQ(0u, vbo->getSize());
+	EXPECT_EQ(6u, vbo->getCapacity());
+
+	delete vbo;
+}
+
+
+/**
+ * Checks adding a range of indices with a base offset.
+ */
+TEST(IndexBuffer, AddIndices) {
+	IndexBuffer *ibo = new IndexBuffer(1);
+	ibo->addIndex(3);
+
+	const VertexBuffer::index_t values[] = { 0, 2, 1 };
+	EXPECT_EQ(1u, ibo->addIndices(values, 3, 10));
+
+	ASSERT_EQ(4u, ibo->getSize());
+	EXPECT_EQ(3u,  ibo->getIndex(0));
+	EXPECT_EQ(10u, ibo->getIndex(1));
+	EXPECT_EQ(12u, ibo->getIndex(2));
+	EXPECT_EQ(11u, ibo->getIndex(3));
+
+	delete ibo;
+}
+
+
+/**
+ * Checks if compact data types are stored and read back correctly.
+ */
+TEST(VertexBuffer, CompactDataTypes) {
+	TVertexBuffer<VertexP2C4T2Packed> *packed = new TVertexBuffer<VertexP2C4T2Packed>();
+	EXPECT_EQ(16u, packed->getVertexSize());
+	packed->addVertex(VertexP2C4T2Packed(1.0f, 2.0f, 1.0f, 0.5f, 0.0f, 1.0f, 0.25f, 1.0f));
+
+	VertexBuffer *generic = new VertexBuffer();
+	generic->setupVertexPositions(2);
+	generic->setupVertexColors(4, VertexDataUInt8Normalized);
+	generic->setupTextureLayer(0, VertexDataUInt16Normalized);
+	generic->addVertex(1.0f, 2.0f);
+	generic->setVertexColor(0, 1.0f, 0.5f, 0.0f, 1.0f);
+	generic->setVertexTextureCoordinate(0, 0.25f, 1.0f);
+
+	ASSERT_EQ(packed->getVertexSize(), generic->getVertexSize());
+	EXPECT_EQ(0, memcmp(packed->getDataPtr(), generic->getDataPtr(), packed->getVertexSize()));
+
+	float color[4];
+	VertexBuffer::readComponent(generic->getDataPtr(), generic->getColorDescription(), color);
+	EXPECT_FLOAT_EQ(1.0f,           color[0]);
+	EXPECT_FLOAT_EQ(128.0f/255.0f,  color[1]);
+	EXPECT_FLOAT_EQ(0.0f,           color[2]);
+
+	delete packed;
+	delete generic;
+
+	// half floats and shorts
+	VertexBuffer *compact = new VertexBuffer();
+	compact->setupVertexPositions(3, VertexDataInt16);
+	compact->setupTextureLayer(0, VertexDataHalfFloat);
+	EXPECT_EQ(12u, compact->getVertexSize());
+
+	compact->addVertices(1)
+			.position(-12.0f, 300.4f, 7.6f)
+			.texcoord(0.5f, -2.25f);
+
+	float position[3];
+	VertexBuffer::readComponent(compact->getDataPtr(), compact->getPositionDescription(), position);
+	EXPECT_FLOAT_EQ(-12.0f, position[0]);
+	EXPECT_FLOAT_EQ(300.0f, position[1]);
+	EXPECT_FLOAT_EQ(8.0f,   position[2]);
+
+	float texcoord[2];
+	VertexBuffer::readComponent(compact->getDataPtr(), compact->getTextureDescription(0), texcoord);
+	EXPECT_FLOAT_EQ(0.5f,   texcoord[0]);
+	EXPECT_FLOAT_EQ(-2.25f, texcoord[1]);
+
+	// rounding values just below a power of two carries into the exponent
+	const float rounded[][2] = {
+		{ 1.9999f,		2.0f },
+		{ 3.9999f,		4.0f },
+		{ 7.999f,		8.0f },
+		{ -1.9996f,		-2.0f },
+		{ 65519.0f,		65504.0f },
+	};
+
+	for(size_t i=0; i<sizeof(rounded)/sizeof(rounded[0]); i++) {
+		compact->setVertexTextureCoordinate(0, rounded[i][0], 0.0f);
+		VertexBuffer::readComponent(compact->getDataPtr(), compact->getTextureDescription(0), texcoord);
+		EXPECT_FLOAT_EQ(rounded[i][1], texcoord[0]);
+	}
+
+	// values rounding beyond the largest half float become infinity
+	compact->setVertexTextureCoordinate(0, 65520.0f, 0.0f);
+	VertexBuffer::readComponent(compact->getDataPtr(), compact->getTextureDescription(0), texcoord);
+	EXPECT_GT(texcoord[0], 65504.0f);
+
+	delete compact;
+}
+
+
+/**
+ * Checks if writing vertices widens the dirty range to exactly the written bytes.
+ */
+TEST(VertexBuffer, DirtyRange) {
+	VertexBuffer *vbo = new VertexBuffer();
+	vbo->setupVertexPositions(2);
+	vbo->setCapacity(8);
+	ASSERT_EQ(8u, vbo->getVertexSize());
+
+	// allocating memory marks the whole buffer
+	EXPECT_TRUE(vbo->isDirty());
+	EXPECT_EQ(0u,  vbo->getDirtyRangeBegin());
+	EXPECT_EQ(64u, vbo->getDirtyRangeEnd());
+
+	vbo->addVertices(4);
+	vbo->clearDirtyRange();
+	EXPECT_FALSE(vbo->isDirty());
+
+	vbo->setVertexPosition(2, 1.0f, 2.0f);
+	EXPECT_TRUE(vbo->isDirty());
+	EXPECT_EQ(16u, vbo->getDirtyRangeBegin());
+	EXPECT_EQ(24u, vbo->getDirtyRangeEnd());
+
+	vbo->setVertexPosition(1, 3.0f, 4.0f);
+	EXPECT_EQ(8u,  vbo->getDirtyRangeBegin());
+	EXPECT_EQ(24u, vbo->getDirtyRangeEnd());
+
+	vbo->clearDirtyRange();
+	EXPECT_FALSE(vbo->isDirty());
+
+	// changing the usage hint marks the whole buffer, setting the same hint does not
+	vbo->setUsage(BufferUsageStatic);
+	EXPECT_FALSE(vbo->isDirty());
+
+	vbo->setUsage(BufferUsageStream);
+	EXPECT_EQ(0u,  vbo->getDirtyRangeBegin());
+	EXPECT_EQ(64u, vbo->getDirtyRangeEnd());
+
+	// resizing marks the whole new buffer
+	vbo->clearDirtyRange();
+	vbo->setCapacity(16);
+	EXPECT_EQ(0u,   vbo->getDirtyRangeBegin());
+	EXPECT_EQ(128u, vbo->getDirtyRangeEnd());
+
+	delete vbo;
+}
+
+
+/**
+ * Checks if writing indices widens the dirty range to exactly the written bytes.
+ */
+TEST(IndexBuffer, DirtyRange) {
+	IndexBuffer *ibo = new IndexBuffer(2);
+	ibo->setCapacity(8);
+	EXPECT_EQ(0u,  ibo->getDirtyRangeBegin());
+	EXPECT_EQ(16u, ibo->getDirtyRangeEnd());
+
+	for(int i=0; i<6; i++) {
+		ibo->addIndex(i);
+	}
+
+	ibo->clearDirtyRange();
+	EXPECT_FALSE(ibo->isDirty());
+
+	ibo->setIndex(3, 7);
+	EXPECT_EQ(6u, ibo->getDirtyRangeBegin());
+	EXPECT_EQ(8u, ibo->getDirtyRangeEnd());
+
+	ibo->setIndex(5, 9);
+	EXPECT_EQ(6u,  ibo->getDirtyRangeBegin());
+	EXPECT_EQ(12u, ibo->getDirtyRangeEnd());
+
+	ibo->clearDirtyRange();
+	ibo->setUsage(BufferUsageDynamic);
+	EXPECT_EQ(0u,  ibo->getDirtyRangeBegin());
+	EXPECT_EQ(16u, ibo->getDirtyRangeEnd());
+
+	ibo->clearDirtyRange();
+	ibo->setCapacity(32);
+	EXPECT_EQ(0u,  ibo->getDirtyRangeBegin());
+	EXPECT_EQ(64u, ibo->getDirtyRangeEnd());
+
+	delete ibo;
+}
+
+
+/**
+ * Checks the bulk creation of quad indices.
+ */
+TEST(IndexBuffer, AddQuads) {
+	IndexBuffer *ibo = new IndexBuffer(2);
+	ibo->addQuads(4, 2);
+
+	const VertexBuffer::index_t expected[] = {
+		4, 5, 6,   5, 7, 6,
+		8, 9, 10,  9, 11, 10,
+	};
+
+	ASSERT_EQ(12u, ibo->getSize());
+	for(unsigned int i=0; i<12; i++) {
+		EXPECT_EQ(expected[i], ibo->getIndex(i));
+	}
+
+	// reset keeps the allocated memory
+	IndexBuffer::index_t capacity = ibo->getCapacity();
+	ibo->reset();
+	EXPECT_EQ(0u, ibo->getSize());
+	EXPECT_EQ(capacity, ibo->getCapacity());
+
+	delete ibo;
+}